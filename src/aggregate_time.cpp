@@ -23,6 +23,8 @@
 */
 #include "aggregate_time.h"
 
+#include "tdigest.h"
+
 
 
 struct aggregator_time_slice_singleband {
@@ -225,6 +227,39 @@ struct median_aggregtor_time_slice_singleband : public aggregator_time_slice_sin
 };
 
 
+/**
+ * @brief Implementation of aggregator to estimate quantiles (e.g. the median) of time slices with bounded memory
+ * @note Uses one t-digest sketch per pixel, see gdalcubes::tdigest
+ */
+struct quantile_approx_aggregtor_time_slice_singleband : public aggregator_time_slice_singleband {
+    quantile_approx_aggregtor_time_slice_singleband(double p) : _p(p), _sketches() {}
+
+    void init(double *out, uint32_t size_x, uint32_t size_y) override {
+        _sketches.assign(size_x * size_y, gdalcubes::tdigest(gdalcubes::config::instance()->get_approx_quantile_compression()));
+        for (uint32_t ixy = 0; ixy < size_x * size_y; ++ixy) {
+            out[ixy] = NAN;
+        }
+    }
+
+    void combine(double* out, double* in, uint32_t size_x, uint32_t size_y) override {
+        for (uint32_t ixy = 0; ixy < size_x * size_y; ++ixy) {
+            double v = in[ixy];
+            if (!std::isnan(v)) {
+                _sketches[ixy].add(v);
+            }
+        }
+    }
+
+    void finalize(double *out, uint32_t size_x, uint32_t size_y) override {
+        for (uint32_t ixy = 0; ixy < size_x * size_y; ++ixy) {
+            out[ixy] = _sketches[ixy].quantile(_p);
+        }
+    }
+   private:
+    double _p;
+    std::vector<gdalcubes::tdigest> _sketches;
+};
+
 /**
  * @brief Implementation of reducer to calculate variance values over time using Welford's Online algorithm
  */
@@ -283,6 +318,7 @@ namespace gdalcubes {
 std::shared_ptr<chunk_data> aggregate_time_cube::read_chunk(chunkid_t id) {
     GCBS_TRACE("aggregate_time_cube::read_chunk(" + std::to_string(id) + ")");
     std::shared_ptr<chunk_data> out = std::make_shared<chunk_data>();
+    profile_scope profile(this, out);
     if (id >= count_chunks())
         return out;  // chunk is outside of the view, we don't need to read anything.
 
@@ -316,6 +352,15 @@ std::shared_ptr<chunk_data> aggregate_time_cube::read_chunk(chunkid_t id) {
         else if (_in_func == "median") {
             agg.push_back(new median_aggregtor_time_slice_singleband());
         }
+        else if (_in_func == "median_approx") {
+            agg.push_back(new quantile_approx_aggregtor_time_slice_singleband(0.5));
+        }
+        else if (_in_func == "Q1_approx") {
+            agg.push_back(new quantile_approx_aggregtor_time_slice_singleband(0.25));
+        }
+        else if (_in_func == "Q3_approx") {
+            agg.push_back(new quantile_approx_aggregtor_time_slice_singleband(0.75));
+        }
         else if (_in_func == "count") {
             agg.push_back(new count_aggregtor_time_slice_singleband());
         }
@@ -88,6 +88,9 @@ class aggregate_time_cube : public cube {
             func == "max" ||
             func == "mean" ||
             func == "median" ||
+            func == "median_approx" ||
+            func == "Q1_approx" ||
+            func == "Q3_approx" ||
             func == "count" ||
             func == "var" ||
             func == "sd" ||
@@ -0,0 +1,714 @@
+/*
+    MIT License
+
+    Copyright (c) 2026 Marius Appel <marius.appel@uni-muenster.de>
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+/**
+ * gdalcubes_bench runs a fixed set of workloads on synthetic, self-generated data and reports timings as JSON.
+ *
+ * Input data is generated before the first workload runs and does not depend on any external files:
+ * - an image collection of overlapping two-band GeoTIFF tiles (EPSG:3857) for a number of consecutive days,
+ * - a synthetic data cube (dummy_cube + apply_pixel over pixel indexes),
+ * - a netCDF file written from the synthetic cube,
+ * - a GeoJSON file with a regular grid of polygons.
+ * Pixel values are derived from std::mt19937 raw output only, so that generated files are identical on all platforms
+ * for the same seed.
+ *
+ * Each workload runs `--warmup` times untimed and `--repeat` times timed. Results include all measured wall clock
+ * times, their minimum / median / mean, and the number of processed input cells. If a baseline result file is given,
+ * medians are compared against the baseline and the program returns 2 if any workload is slower than the tolerance allows.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <regex>
+#include <sstream>
+#include <thread>
+
+#include <gdal_priv.h>
+#include <ogr_spatialref.h>
+
+#include "../gdalcubes.h"
+#include "../timer.h"
+
+using namespace gdalcubes;
+
+struct bench_params {
+    std::string preset;
+    uint32_t tile_size;  // number of pixels per side of generated GeoTIFF tiles
+    uint32_t tiles;      // number of tiles per side of the collection
+    uint32_t dates;      // number of daily acquisitions, one image per tile and date
+    double overlap;      // fraction of a tile that overlaps with its neighbours
+    uint32_t cube_nx;    // size of the synthetic data cube
+    uint32_t cube_ny;
+    uint32_t cube_nt;
+    uint32_t points;    // number of points for query_points
+    uint32_t polygons;  // number of polygons per side for zonal_statistics
+    uint32_t seed;
+};
+
+static bench_params make_preset(std::string name) {
+    bench_params p;
+    p.preset = name;
+    p.seed = 42;
+    if (name == "small") {
+        p.tile_size = 256;
+        p.tiles = 2;
+        p.dates = 8;
+        p.overlap = 0.1;
+        p.cube_nx = 256;
+        p.cube_ny = 256;
+        p.cube_nt = 32;
+        p.points = 1000;
+        p.polygons = 4;
+    } else if (name == "medium") {
+        p.tile_size = 512;
+        p.tiles = 3;
+        p.dates = 16;
+        p.overlap = 0.1;
+        p.cube_nx = 1024;
+        p.cube_ny = 1024;
+        p.cube_nt = 64;
+        p.points = 10000;
+        p.polygons = 8;
+    } else if (name == "large") {
+        p.tile_size = 1024;
+        p.tiles = 4;
+        p.dates = 32;
+        p.overlap = 0.2;
+        p.cube_nx = 2048;
+        p.cube_ny = 2048;
+        p.cube_nt = 128;
+        p.points = 100000;
+        p.polygons = 16;
+    } else {
+        throw std::string("ERROR in gdalcubes_bench: unknown preset '" + name + "', expected small, medium, or large");
+    }
+    return p;
+}
+
+static json11::Json params_to_json(const bench_params& p) {
+    return json11::Json::object{
+        {"preset", p.preset},
+        {"tile_size", (int)p.tile_size},
+        {"tiles", (int)p.tiles},
+        {"dates", (int)p.dates},
+        {"overlap", p.overlap},
+        {"cube_nx", (int)p.cube_nx},
+        {"cube_ny", (int)p.cube_ny},
+        {"cube_nt", (int)p.cube_nt},
+        {"points", (int)p.points},
+        {"polygons", (int)p.polygons},
+        {"seed", (int)p.seed}};
+}
+
+/**
+ * Spatial and temporal extent of the generated image collection
+ */
+struct collection_extent {
+    static constexpr double res = 30.0;
+    static constexpr double left = 1000000.0;
+    static constexpr double top = 6000000.0;
+    uint32_t step;  // distance between neighbouring tile origins in pixels
+    uint32_t size;  // size of the whole collection extent in pixels
+    datetime t0;
+    datetime t1;
+
+    collection_extent(const bench_params& p) {
+        step = std::max(uint32_t(1), (uint32_t)std::round(p.tile_size * (1.0 - p.overlap)));
+        size = step * (p.tiles - 1) + p.tile_size;
+        t0 = datetime::from_string("2020-01-01");
+        t1 = t0 + duration(p.dates - 1, datetime_unit::DAY);
+    }
+    double right() const { return left + size * res; }
+    double bottom() const { return top - size * res; }
+};
+
+static void remove_recursive(std::string path) {
+    if (!filesystem::exists(path)) return;
+    if (filesystem::is_directory(path)) {
+        std::vector<std::string> entries;
+        filesystem::iterate_directory_recursive(path, [&entries](const std::string& p) { entries.push_back(p); });
+        // deepest entries first, so that directories are empty before being removed
+        std::sort(entries.begin(), entries.end(), [](const std::string& a, const std::string& b) { return a.size() > b.size(); });
+        for (auto& e : entries) filesystem::remove(e);
+    }
+    filesystem::remove(path);
+}
+
+/**
+ * Write overlapping GeoTIFF tiles with two UInt16 bands, returns the file names
+ */
+static std::vector<std::string> generate_geotiffs(const bench_params& p, std::string dir) {
+    collection_extent e(p);
+    filesystem::mkdir_recursive(dir);
+
+    GDALDriver* drv = GetGDALDriverManager()->GetDriverByName("GTiff");
+    if (!drv) {
+        throw std::string("ERROR in gdalcubes_bench: GDAL GTiff driver is not available");
+    }
+
+    OGRSpatialReference srs;
+    srs.importFromEPSG(3857);
+    char* wkt = nullptr;
+    srs.exportToWkt(&wkt);
+    std::string srs_wkt(wkt);
+    CPLFree(wkt);
+
+    char** create_options = nullptr;
+    create_options = CSLSetNameValue(create_options, "TILED", "YES");
+    create_options = CSLSetNameValue(create_options, "BLOCKXSIZE", "256");
+    create_options = CSLSetNameValue(create_options, "BLOCKYSIZE", "256");
+
+    std::mt19937 rng(p.seed);
+    std::vector<uint16_t> buf(p.tile_size * p.tile_size);
+    std::vector<std::string> out;
+    for (uint32_t it = 0; it < p.dates; ++it) {
+        std::string date_str = (e.t0 + duration(it, datetime_unit::DAY)).to_string(datetime_unit::DAY);
+        for (uint32_t ty = 0; ty < p.tiles; ++ty) {
+            for (uint32_t tx = 0; tx < p.tiles; ++tx) {
+                std::string name = filesystem::join(dir, "img_" + date_str + "_" + std::to_string(ty) + "_" + std::to_string(tx) + ".tif");
+                GDALDataset* ds = drv->Create(name.c_str(), p.tile_size, p.tile_size, 2, GDT_UInt16, create_options);
+                if (!ds) {
+                    CSLDestroy(create_options);
+                    throw std::string("ERROR in gdalcubes_bench: cannot create '" + name + "'");
+                }
+                double affine[6] = {e.left + tx * e.step * e.res, e.res, 0.0, e.top - ty * e.step * e.res, 0.0, -e.res};
+                ds->SetGeoTransform(affine);
+                ds->SetProjection(srs_wkt.c_str());
+                for (uint16_t ib = 0; ib < 2; ++ib) {
+                    for (uint32_t iy = 0; iy < p.tile_size; ++iy) {
+                        for (uint32_t ix = 0; ix < p.tile_size; ++ix) {
+                            uint32_t r = rng();
+                            // roughly 1% no data
+                            if (r % 100 == 0) {
+                                buf[iy * p.tile_size + ix] = 0;
+                                continue;
+                            }
+                            double gx = double(tx * e.step + ix);
+                            double gy = double(ty * e.step + iy);
+                            double v = 2000.0 + 1000.0 * std::sin(gx / 97.0) * std::cos(gy / 89.0) + 50.0 * it + 500.0 * ib;
+                            buf[iy * p.tile_size + ix] = uint16_t(std::max(1.0, v + double(r % 200)));
+                        }
+                    }
+                    GDALRasterBand* band = ds->GetRasterBand(ib + 1);
+                    band->SetNoDataValue(0);
+                    if (band->RasterIO(GF_Write, 0, 0, p.tile_size, p.tile_size, buf.data(), p.tile_size, p.tile_size, GDT_UInt16, 0, 0, NULL) != CE_None) {
+                        GDALClose((GDALDatasetH)ds);
+                        CSLDestroy(create_options);
+                        throw std::string("ERROR in gdalcubes_bench: cannot write '" + name + "'");
+                    }
+                }
+                GDALClose((GDALDatasetH)ds);
+                out.push_back(name);
+            }
+        }
+    }
+    CSLDestroy(create_options);
+    return out;
+}
+
+static collection_format bench_collection_format() {
+    collection_format f;
+    f.load_string(R"({
+        "description" : "Synthetic GeoTIFF tiles generated by gdalcubes_bench",
+        "pattern" : ".*img_.+\\.tif",
+        "images" : { "pattern" : ".*/(img_.+)\\.tif" },
+        "datetime" : { "pattern" : ".*img_([0-9]{4}-[0-9]{2}-[0-9]{2})_.*", "format" : "%Y-%m-%d" },
+        "bands" : {
+            "B1" : { "pattern" : ".+", "band" : 1, "nodata" : 0 },
+            "B2" : { "pattern" : ".+", "band" : 2, "nodata" : 0 }
+        }
+    })");
+    return f;
+}
+
+/**
+ * Write a GeoJSON file with a regular grid of square polygons covering the image collection extent
+ */
+static void generate_polygons(const bench_params& p, std::string path) {
+    collection_extent e(p);
+    double w = (e.right() - e.left) / p.polygons;
+    double h = (e.top - e.bottom()) / p.polygons;
+    std::ofstream f(path);
+    if (!f.is_open()) {
+        throw std::string("ERROR in gdalcubes_bench: cannot create '" + path + "'");
+    }
+    f.precision(10);
+    f << "{\"type\":\"FeatureCollection\",\"crs\":{\"type\":\"name\",\"properties\":{\"name\":\"urn:ogc:def:crs:EPSG::3857\"}},\"features\":[";
+    for (uint32_t iy = 0; iy < p.polygons; ++iy) {
+        for (uint32_t ix = 0; ix < p.polygons; ++ix) {
+            double x0 = e.left + ix * w, x1 = x0 + w;
+            double y1 = e.top - iy * h, y0 = y1 - h;
+            if (ix > 0 || iy > 0) f << ",";
+            f << "{\"type\":\"Feature\",\"properties\":{\"id\":" << iy * p.polygons + ix << "},\"geometry\":{\"type\":\"Polygon\",\"coordinates\":[[";
+            f << "[" << x0 << "," << y0 << "],[" << x1 << "," << y0 << "],[" << x1 << "," << y1 << "],[" << x0 << "," << y1 << "],[" << x0 << "," << y0 << "]";
+            f << "]]}}";
+        }
+    }
+    f << "]}";
+}
+
+/**
+ * Data cube view covering the image collection at its native resolution and daily temporal resolution
+ */
+static cube_view collection_view(const bench_params& p) {
+    collection_extent e(p);
+    cube_view v;
+    v.srs("EPSG:3857");
+    v.set_x_axis(e.left, e.right(), e.res);
+    v.set_y_axis(e.bottom(), e.top, e.res);
+    v.set_t_axis(e.t0, e.t1, duration::from_string("P1D"));
+    v.aggregation_method() = aggregation::aggregation_type::AGG_MEAN;
+    v.resampling_method() = resampling::resampling_type::RSMPL_NEAR;
+    return v;
+}
+
+/**
+ * Data cube view in geographic coordinates (EPSG:4326) covering the image collection, such that reading requires warping
+ */
+static cube_view warped_view(const bench_params& p) {
+    collection_extent e(p);
+    OGRSpatialReference src, dst;
+    src.SetFromUserInput("EPSG:3857");
+    dst.SetFromUserInput("EPSG:4326");
+    OGRCoordinateTransformation* ct = OGRCreateCoordinateTransformation(&src, &dst);
+    if (!ct) {
+        throw std::string("ERROR in gdalcubes_bench: cannot transform coordinates from EPSG:3857 to EPSG:4326");
+    }
+    double x[2] = {e.left, e.right()};
+    double y[2] = {e.bottom(), e.top};
+    ct->Transform(2, x, y);
+    OCTDestroyCoordinateTransformation(ct);
+
+    cube_view v;
+    v.srs("EPSG:4326");
+    v.set_x_axis(x[0], x[1], e.size);
+    v.set_y_axis(y[0], y[1], e.size);
+    v.set_t_axis(e.t0, e.t1, duration::from_string("P1D"));
+    v.aggregation_method() = aggregation::aggregation_type::AGG_MEAN;
+    v.resampling_method() = resampling::resampling_type::RSMPL_BILINEAR;
+    return v;
+}
+
+/**
+ * Synthetic single-band data cube with values varying in space and time but without any input files
+ */
+static std::shared_ptr<cube> synthetic_cube(const bench_params& p) {
+    cube_view v;
+    v.srs("EPSG:3857");
+    v.set_x_axis(0.0, double(p.cube_nx) * 100.0, 100.0);
+    v.set_y_axis(0.0, double(p.cube_ny) * 100.0, 100.0);
+    v.set_t_axis(datetime::from_string("2020-01-01"), datetime::from_string("2020-01-01") + duration(p.cube_nt - 1, datetime_unit::DAY), duration::from_string("P1D"));
+    auto d = dummy_cube::create(v, 1, 1.0);
+    d->set_chunk_size(16, 256, 256);
+    return apply_pixel_cube::create(d, {"band1 * 1000 + 200 * sin(ix / 17) * cos(iy / 23) + 10 * it"}, {"value"});
+}
+
+static uint64_t cells(std::shared_ptr<cube> c) {
+    return uint64_t(c->bands().count()) * uint64_t(c->size_t()) * uint64_t(c->size_y()) * uint64_t(c->size_x());
+}
+
+/**
+ * Read all chunks of a data cube with the default chunk processor and discard the results
+ */
+static void read_all(std::shared_ptr<cube> c) {
+    config::instance()->get_default_chunk_processor()->apply(c, [](chunkid_t, std::shared_ptr<chunk_data>, std::mutex&) {});
+}
+
+struct workload {
+    std::string name;
+    std::string group;
+    std::function<uint64_t()> run;     // returns the number of processed input cells
+    std::function<void()> cleanup;  // untimed, called after each run
+};
+
+struct bench_data {
+    bench_params params;
+    std::string workdir;
+    std::shared_ptr<image_collection> ic;
+    std::string ncdf_file;
+    std::string polygons_file;
+    json11::Json::object setup_seconds;
+};
+
+static bench_data setup(const bench_params& p, std::string workdir) {
+    bench_data d;
+    d.params = p;
+    d.workdir = workdir;
+    filesystem::mkdir_recursive(workdir);
+
+    timer t;
+    std::vector<std::string> files = generate_geotiffs(p, filesystem::join(workdir, "tif"));
+    d.setup_seconds["generate_geotiff"] = t.time();
+
+    t.start();
+    d.ic = image_collection::create(bench_collection_format(), files, true);
+    d.setup_seconds["create_image_collection"] = t.time();
+
+    t.start();
+    d.ncdf_file = filesystem::join(workdir, "synthetic.nc");
+    synthetic_cube(p)->write_netcdf_file(d.ncdf_file);
+    d.setup_seconds["generate_netcdf"] = t.time();
+
+    d.polygons_file = filesystem::join(workdir, "polygons.geojson");
+    generate_polygons(p, d.polygons_file);
+    return d;
+}
+
+static std::vector<workload> make_workloads(const bench_data& d) {
+    const bench_params& p = d.params;
+    std::shared_ptr<image_collection> ic = d.ic;
+    std::string out = filesystem::join(d.workdir, "out");
+    std::vector<workload> w;
+
+    auto ic_cube = [p, ic]() {
+        auto c = image_collection_cube::create(ic, collection_view(p));
+        c->set_chunk_size(1, 256, 256);
+        return c;
+    };
+
+    /* reading */
+    w.push_back({"image_collection_read", "read", [ic_cube]() {
+                     auto c = ic_cube();
+                     read_all(c);
+                     return cells(c);
+                 }, nullptr});
+    w.push_back({"image_collection_warp", "read", [p, ic]() {
+                     auto c = image_collection_cube::create(ic, warped_view(p));
+                     c->set_chunk_size(1, 256, 256);
+                     read_all(c);
+                     return cells(c);
+                 }, nullptr});
+    w.push_back({"image_collection_aggregate", "read", [p, ic]() {
+                     cube_view v = collection_view(p);
+                     v.set_t_axis(v.t0(), v.t1(), duration::from_string("P4D"));
+                     v.aggregation_method() = aggregation::aggregation_type::AGG_MEDIAN;
+                     auto c = image_collection_cube::create(ic, v);
+                     c->set_chunk_size(1, 256, 256);
+                     read_all(c);
+                     return cells(c);
+                 }, nullptr});
+    std::string ncdf_file = d.ncdf_file;
+    w.push_back({"ncdf_read", "read", [ncdf_file]() {
+                     auto c = ncdf_cube::create(ncdf_file);
+                     read_all(c);
+                     return cells(c);
+                 }, nullptr});
+
+    /* operators on the synthetic cube, apply_pixel measures the cost of generating the input */
+    w.push_back({"apply_pixel", "operator", [p]() {
+                     auto in = synthetic_cube(p);
+                     auto c = apply_pixel_cube::create(in, {"sqrt(value) * 2 + log(value + 1)", "value / 3"}, {"a", "b"});
+                     read_all(c);
+                     return cells(in);
+                 }, nullptr});
+    w.push_back({"reduce_time_mean", "operator", [p]() {
+                     auto in = synthetic_cube(p);
+                     read_all(reduce_time_cube::create(in, {{"mean", "value"}}));
+                     return cells(in);
+                 }, nullptr});
+    w.push_back({"reduce_time_median", "operator", [p]() {
+                     auto in = synthetic_cube(p);
+                     read_all(reduce_time_cube::create(in, {{"median", "value"}}));
+                     return cells(in);
+                 }, nullptr});
+    w.push_back({"reduce_space_mean", "operator", [p]() {
+                     auto in = synthetic_cube(p);
+                     read_all(reduce_space_cube::create(in, {{"mean", "value"}}));
+                     return cells(in);
+                 }, nullptr});
+    w.push_back({"window_time_mean", "operator", [p]() {
+                     auto in = synthetic_cube(p);
+                     read_all(window_time_cube::create(in, {{"mean", "value"}}, 2, 2));
+                     return cells(in);
+                 }, nullptr});
+    w.push_back({"window_time_kernel", "operator", [p]() {
+                     auto in = synthetic_cube(p);
+                     read_all(window_time_cube::create(in, {-1.0, 0.0, 1.0}, 1, 1));
+                     return cells(in);
+                 }, nullptr});
+    w.push_back({"aggregate_time_mean", "operator", [p]() {
+                     auto in = synthetic_cube(p);
+                     read_all(aggregate_time_cube::create(in, "P7D", "mean"));
+                     return cells(in);
+                 }, nullptr});
+
+    /* vector queries on the image collection */
+    w.push_back({"query_points", "vector", [p, ic_cube]() {
+                     collection_extent e(p);
+                     std::mt19937 rng(p.seed);
+                     std::vector<double> x, y;
+                     std::vector<std::string> t;
+                     for (uint32_t i = 0; i < p.points; ++i) {
+                         x.push_back(e.left + (e.right() - e.left) * (double(rng()) / double(rng.max())));
+                         y.push_back(e.bottom() + (e.top - e.bottom()) * (double(rng()) / double(rng.max())));
+                         t.push_back((e.t0 + duration(rng() % p.dates, datetime_unit::DAY)).to_string(datetime_unit::DAY));
+                     }
+                     auto c = ic_cube();
+                     vector_queries::query_points(c, x, y, t, "EPSG:3857");
+                     return uint64_t(p.points) * c->bands().count();
+                 }, nullptr});
+    std::string polygons_file = d.polygons_file;
+    std::string zs_out = filesystem::join(d.workdir, "zonal_statistics.gpkg");
+    w.push_back({"zonal_statistics", "vector", [ic_cube, polygons_file, zs_out]() {
+                     auto c = ic_cube();
+                     vector_queries::zonal_statistics(c, polygons_file, {{"mean", "B1"}, {"median", "B2"}, {"count", "B1"}}, zs_out, true);
+                     return cells(c);
+                 }, [zs_out]() { remove_recursive(zs_out); }});
+
+    /* writers, all write the synthetic cube */
+    auto writer = [&w, p, out](std::string name, std::function<void(std::shared_ptr<cube>, std::string)> f) {
+        std::string path = filesystem::join(out, name);
+        w.push_back({name, "write", [p, path, f]() {
+                         auto c = synthetic_cube(p);
+                         f(c, path);
+                         return cells(c);
+                     },
+                     [path]() {
+                         remove_recursive(path);
+                         remove_recursive(path + ".nc");
+                         remove_recursive(path + ".gcs");
+                     }});
+    };
+    writer("write_netcdf_file", [](std::shared_ptr<cube> c, std::string path) { c->write_netcdf_file(path + ".nc"); });
+    writer("write_netcdf_file_deflate", [](std::shared_ptr<cube> c, std::string path) { c->write_netcdf_file(path + ".nc", 1); });
+    writer("write_chunks_netcdf", [](std::shared_ptr<cube> c, std::string path) { c->write_chunks_netcdf(path); });
+    writer("write_chunks_gtiff", [](std::shared_ptr<cube> c, std::string path) { c->write_chunks_gtiff(path); });
+    writer("write_tif_collection", [](std::shared_ptr<cube> c, std::string path) { c->write_tif_collection(path); });
+    writer("write_tif_collection_cog", [](std::shared_ptr<cube> c, std::string path) { c->write_tif_collection(path, "", true, true); });
+    writer("write_png_collection", [](std::shared_ptr<cube> c, std::string path) { c->write_png_collection(path, "", {}, {0}, {1500}); });
+    writer("write_zarr", [](std::shared_ptr<cube> c, std::string path) { c->write_zarr(path, 1); });
+    writer("write_chunkstore", [](std::shared_ptr<cube> c, std::string path) { c->write_chunkstore(path + ".gcs", 1); });
+
+    return w;
+}
+
+static double median(std::vector<double> x) {
+    std::sort(x.begin(), x.end());
+    size_t n = x.size();
+    if (n == 0) return NAN;
+    return (n % 2 == 1) ? x[n / 2] : 0.5 * (x[n / 2 - 1] + x[n / 2]);
+}
+
+static void print_usage() {
+    std::cout << "Usage: gdalcubes_bench [options]" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Runs benchmark workloads on generated data and writes results as JSON." << std::endl;
+    std::cout << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << "  --preset NAME            Size of generated data: small (default), medium, or large" << std::endl;
+    std::cout << "  --tile-size N            Override number of pixels per side of generated GeoTIFF tiles" << std::endl;
+    std::cout << "  --tiles N                Override number of tiles per side of the image collection" << std::endl;
+    std::cout << "  --dates N                Override number of acquisition dates of the image collection" << std::endl;
+    std::cout << "  --overlap X              Override fractional overlap of neighbouring tiles, in [0, 1)" << std::endl;
+    std::cout << "  --seed N                 Seed of the random number generator (default 42)" << std::endl;
+    std::cout << "  --repeat N               Number of timed runs per workload (default 3)" << std::endl;
+    std::cout << "  --warmup N               Number of untimed runs per workload (default 1)" << std::endl;
+    std::cout << "  --threads N              Number of threads of the chunk processor (default: hardware concurrency)" << std::endl;
+    std::cout << "  --filter REGEX           Only run workloads whose name matches the regular expression" << std::endl;
+    std::cout << "  --workdir DIR            Parent directory for generated data and outputs (default: temporary directory)," << std::endl;
+    std::cout << "                           data is written to a new subdirectory gdalcubes_bench_XXXXXXXX of DIR" << std::endl;
+    std::cout << "  --keep                   Do not remove the generated subdirectory after running" << std::endl;
+    std::cout << "  --output FILE            Write JSON results to FILE instead of stdout" << std::endl;
+    std::cout << "  --baseline FILE          Compare medians with the results in FILE" << std::endl;
+    std::cout << "  --tolerance X            Allowed relative slowdown compared to the baseline (default 0.1)" << std::endl;
+    std::cout << "  --list                   Print names of all workloads and exit" << std::endl;
+    std::cout << "  --help                   Print this message and exit" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    std::map<std::string, std::string> args;
+    std::vector<std::string> flags = {"--keep", "--list", "--help"};
+    for (int i = 1; i < argc; ++i) {
+        std::string a(argv[i]);
+        if (std::find(flags.begin(), flags.end(), a) != flags.end()) {
+            args[a] = "";
+        } else if (a.size() > 2 && a.substr(0, 2) == "--" && i + 1 < argc) {
+            args[a] = argv[++i];
+        } else {
+            std::cout << "ERROR in gdalcubes_bench: invalid argument '" << a << "'" << std::endl;
+            print_usage();
+            return 1;
+        }
+    }
+    if (args.count("--help")) {
+        print_usage();
+        return 0;
+    }
+
+    config::instance()->gdalcubes_init();
+    config::instance()->set_default_progress_bar(std::make_shared<progress_none>());
+
+    int ret = 0;
+    try {
+        bench_params p = make_preset(args.count("--preset") ? args["--preset"] : "small");
+        if (args.count("--tile-size")) p.tile_size = std::stoul(args["--tile-size"]);
+        if (args.count("--tiles")) p.tiles = std::stoul(args["--tiles"]);
+        if (args.count("--dates")) p.dates = std::stoul(args["--dates"]);
+        if (args.count("--overlap")) p.overlap = std::stod(args["--overlap"]);
+        if (args.count("--seed")) p.seed = std::stoul(args["--seed"]);
+        if (p.tile_size == 0 || p.tiles == 0 || p.dates == 0 || p.overlap < 0 || p.overlap >= 1) {
+            throw std::string("ERROR in gdalcubes_bench: invalid image collection parameters");
+        }
+
+        uint32_t repeat = args.count("--repeat") ? std::stoul(args["--repeat"]) : 3;
+        uint32_t warmup = args.count("--warmup") ? std::stoul(args["--warmup"]) : 1;
+        uint32_t nthreads = args.count("--threads") ? std::stoul(args["--threads"]) : std::max(1u, std::thread::hardware_concurrency());
+        double tolerance = args.count("--tolerance") ? std::stod(args["--tolerance"]) : 0.1;
+        std::regex filter(args.count("--filter") ? args["--filter"] : ".*");
+        if (repeat == 0) repeat = 1;
+        config::instance()->set_default_chunk_processor(std::make_shared<chunk_processor_multithread>(nthreads));
+
+        // always use a new subdirectory, such that only files generated by the benchmark are removed afterwards
+        std::string workdir = filesystem::join(args.count("--workdir") ? args["--workdir"] : filesystem::get_tempdir(),
+                                               utils::generate_unique_filename(8, "gdalcubes_bench_"));
+        while (filesystem::exists(workdir)) {
+            workdir = filesystem::join(filesystem::parent(workdir), utils::generate_unique_filename(8, "gdalcubes_bench_"));
+        }
+        bool keep = args.count("--keep") > 0;
+
+        if (args.count("--list")) {
+            bench_data empty;
+            empty.params = p;
+            empty.workdir = workdir;
+            for (auto& x : make_workloads(empty)) {
+                std::cout << x.group << "\t" << x.name << std::endl;
+            }
+            config::instance()->gdalcubes_cleanup();
+            return 0;
+        }
+
+        json11::Json::object baseline;
+        if (args.count("--baseline")) {
+            std::ifstream f(args["--baseline"]);
+            if (!f.is_open()) {
+                throw std::string("ERROR in gdalcubes_bench: cannot open baseline file '" + args["--baseline"] + "'");
+            }
+            std::stringstream s;
+            s << f.rdbuf();
+            std::string err;
+            json11::Json b = json11::Json::parse(s.str(), err);
+            if (!err.empty()) {
+                throw std::string("ERROR in gdalcubes_bench: cannot parse baseline file: " + err);
+            }
+            for (auto& r : b["results"].array_items()) {
+                baseline[r["name"].string_value()] = r;
+            }
+        }
+
+        bench_data d = setup(p, workdir);
+
+        json11::Json::array results;
+        bool regression = false;
+        for (auto& x : make_workloads(d)) {
+            if (!std::regex_search(x.name, filter)) continue;
+            for (uint32_t i = 0; i < warmup; ++i) {
+                x.run();
+                if (x.cleanup) x.cleanup();
+            }
+            std::vector<double> seconds;
+            uint64_t ncells = 0;
+            for (uint32_t i = 0; i < repeat; ++i) {
+                timer t;
+                ncells = x.run();
+                seconds.push_back(t.time());
+                if (x.cleanup) x.cleanup();
+            }
+            double med = median(seconds);
+            double mean = 0;
+            for (double s : seconds) mean += s;
+            mean /= seconds.size();
+
+            json11::Json::object r{
+                {"name", x.name},
+                {"group", x.group},
+                {"seconds", json11::Json(seconds)},
+                {"min", *std::min_element(seconds.begin(), seconds.end())},
+                {"median", med},
+                {"mean", mean},
+                {"cells", double(ncells)},
+                {"cells_per_second", double(ncells) / med}};
+
+            std::cerr << x.name << ": median " << med << " s, " << double(ncells) / med / 1e6 << " Mcells/s";
+            if (baseline.count(x.name) && baseline[x.name]["median"].number_value() > 0) {
+                double ratio = med / baseline[x.name]["median"].number_value();
+                r["baseline_ratio"] = ratio;
+                std::cerr << ", " << ratio << "x baseline";
+                if (ratio > 1 + tolerance) {
+                    regression = true;
+                    std::cerr << " (REGRESSION)";
+                }
+            }
+            std::cerr << std::endl;
+            results.push_back(r);
+        }
+
+        version_info v = config::instance()->get_version_info();
+        json11::Json::object o{
+            {"version", std::to_string(v.VERSION_MAJOR) + "." + std::to_string(v.VERSION_MINOR) + "." + std::to_string(v.VERSION_PATCH)},
+            {"git_commit", v.GIT_COMMIT},
+            {"git_desc", v.GIT_DESC},
+            {"build_date", v.BUILD_DATE + " " + v.BUILD_TIME},
+            {"gdal", config::instance()->gdal_version_info()},
+            {"timestamp", utils::get_curdatetime()},
+            {"threads", (int)nthreads},
+            {"repeat", (int)repeat},
+            {"warmup", (int)warmup},
+            {"parameters", params_to_json(p)},
+            {"setup_seconds", d.setup_seconds},
+            {"results", results}};
+        d.ic.reset();
+        if (!keep) {
+            remove_recursive(workdir);
+        } else {
+            std::cerr << "Generated data has been kept in '" << workdir << "'" << std::endl;
+        }
+
+        std::string json = json11::Json(o).dump();
+        if (args.count("--output")) {
+            std::ofstream f(args["--output"]);
+            if (!f.is_open()) {
+                throw std::string("ERROR in gdalcubes_bench: cannot write output file '" + args["--output"] + "'");
+            }
+            f << json << std::endl;
+        } else {
+            std::cout << json << std::endl;
+        }
+        if (regression) ret = 2;
+    } catch (std::string s) {
+        std::cout << s << std::endl;
+        config::instance()->gdalcubes_cleanup();
+        return 1;
+    } catch (std::exception& e) {
+        std::cout << "ERROR in gdalcubes_bench: unexpected exception" << std::endl;
+        std::cout << "what():" << e.what() << std::endl;
+        config::instance()->gdalcubes_cleanup();
+        return 1;
+    }
+    config::instance()->gdalcubes_cleanup();
+    return ret;
+}
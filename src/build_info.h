@@ -5,11 +5,11 @@
 #define GDALCUBES_VERSION_MAJOR 0
 #define GDALCUBES_VERSION_MINOR 3
 #define GDALCUBES_VERSION_PATCH 2
-#define GDALCUBES_GIT_DESC "v0.3.0-45-gdf51e935"
-#define GDALCUBES_GIT_COMMIT "df51e9352d60d399f7186d870421fa9f523f24d2"
+#define GDALCUBES_GIT_DESC "eaaaf03b"
+#define GDALCUBES_GIT_COMMIT "eaaaf03b26b28d84d50310e16e7d5feb2ecc4be8"
 
-#define COLLECTION_FORMAT_VERSION_MAJOR
-#define COLLECTION_FORMAT_VERSION_MINOR
-#define COLLECTION_FORMAT_VERSION_PATCH
+#define COLLECTION_FORMAT_VERSION_MAJOR 
+#define COLLECTION_FORMAT_VERSION_MINOR 
+#define COLLECTION_FORMAT_VERSION_PATCH 
 
-#endif  // BUILD_INFO_H
+#endif // BUILD_INFO_H
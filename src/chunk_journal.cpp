@@ -0,0 +1,152 @@
+/*
+    MIT License
+
+    Copyright (c) 2026 Marius Appel <marius.appel@uni-muenster.de>
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+#include "chunk_journal.h"
+
+#include <fstream>
+#include <sstream>
+
+#include "filesystem.h"
+
+namespace gdalcubes {
+
+static const std::string JOURNAL_HEADER = "gdalcubes-journal-v1";
+
+chunk_journal::chunk_journal(std::string path, std::string key) : _path(path), _done(), _mutex(), _file(nullptr), _resumed(false) {
+    std::string first_line = JOURNAL_HEADER + " " + key;
+
+    if (filesystem::is_regular_file(path)) {
+        std::ifstream is(path, std::ios::in | std::ios::binary);
+        std::stringstream ss;
+        ss << is.rdbuf();
+        std::string content = ss.str();
+
+        // only consider complete lines, the last line might have been written partially
+        std::vector<std::string> lines;
+        std::size_t start = 0;
+        std::size_t pos;
+        while ((pos = content.find('\n', start)) != std::string::npos) {
+            lines.push_back(content.substr(start, pos - start));
+            start = pos + 1;
+        }
+        if (!lines.empty() && lines[0] == first_line) {
+            for (std::size_t i = 1; i < lines.size(); ++i) {
+                std::size_t sep = lines[i].find(' ');
+                std::string id_str = lines[i].substr(0, sep);
+                if (id_str.empty() || id_str.find_first_not_of("0123456789") != std::string::npos) {
+                    GCBS_DEBUG("Ignoring invalid line in journal '" + path + "'");
+                    continue;
+                }
+                _done[(chunkid_t)std::stoul(id_str)] = (sep == std::string::npos) ? "" : lines[i].substr(sep + 1);
+            }
+            _resumed = true;
+            // drop a partially written last line to keep the file parsable
+            if (start < content.size()) {
+                std::ofstream os(path, std::ios::out | std::ios::binary | std::ios::trunc);
+                os.write(content.data(), start);
+            }
+            GCBS_INFO("Resuming export with " + std::to_string(_done.size()) + " completed chunks from journal '" + path + "'");
+        } else {
+            GCBS_WARN("Journal '" + path + "' belongs to a different export and will be discarded");
+        }
+    }
+
+    _file = std::fopen(path.c_str(), _resumed ? "ab" : "wb");
+    if (!_file) {
+        throw std::string("ERROR in chunk_journal::chunk_journal(): cannot open journal file '" + path + "'");
+    }
+    if (!_resumed) {
+        std::fputs((first_line + "\n").c_str(), _file);
+        std::fflush(_file);
+    }
+}
+
+chunk_journal::~chunk_journal() {
+    if (_file) std::fclose(_file);
+}
+
+std::string chunk_journal::make_key(std::string s) {
+    // 64 bit FNV-1a, stable across platforms and runs
+    uint64_t h = 14695981039346656037ULL;
+    for (std::size_t i = 0; i < s.size(); ++i) {
+        h ^= (uint8_t)s[i];
+        h *= 1099511628211ULL;
+    }
+    char hex[17];
+    std::snprintf(hex, sizeof(hex), "%016llx", (unsigned long long)h);
+    return std::string(hex);
+}
+
+bool chunk_journal::is_done(chunkid_t id) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _done.find(id) != _done.end();
+}
+
+std::string chunk_journal::info(chunkid_t id) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto it = _done.find(id);
+    return it == _done.end() ? "" : it->second;
+}
+
+uint32_t chunk_journal::count_done() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _done.size();
+}
+
+std::vector<chunkid_t> chunk_journal::remaining(uint32_t nchunks) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::vector<chunkid_t> out;
+    for (chunkid_t i = 0; i < nchunks; ++i) {
+        if (_done.find(i) == _done.end()) out.push_back(i);
+    }
+    return out;
+}
+
+void chunk_journal::done(chunkid_t id, std::string info) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _done[id] = info;
+    std::string line = info.empty() ? std::to_string(id) + "\n" : std::to_string(id) + " " + info + "\n";
+    if (std::fputs(line.c_str(), _file) < 0 || std::fflush(_file) != 0) {
+        GCBS_WARN("Failed to write to journal '" + _path + "'");
+    }
+}
+
+bool chunk_journal::finish(uint32_t nchunks) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_file) {
+        std::fclose(_file);
+        _file = nullptr;
+    }
+    uint32_t ndone = 0;
+    for (auto it = _done.begin(); it != _done.end(); ++it) {
+        if (it->first < nchunks) ++ndone;
+    }
+    if (ndone < nchunks) {
+        GCBS_WARN(std::to_string(nchunks - ndone) + " chunk(s) failed; run the same export again to resume from journal '" + _path + "'");
+        return false;
+    }
+    filesystem::remove(_path);
+    return true;
+}
+
+}  // namespace gdalcubes
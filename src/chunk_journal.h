@@ -0,0 +1,108 @@
+/*
+    MIT License
+
+    Copyright (c) 2026 Marius Appel <marius.appel@uni-muenster.de>
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+#ifndef CHUNK_JOURNAL_H
+#define CHUNK_JOURNAL_H
+
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "cube.h"
+
+namespace gdalcubes {
+
+/**
+ * @brief Sidecar file that records completed chunks of an export
+ *
+ * The journal is an append-only text file. The first line identifies the export (a key derived from the
+ * process graph and output options), every following line contains the id of a completed chunk and optional
+ * writer-specific information. Lines are flushed immediately, such that an export that has been interrupted can be resumed
+ * by processing only the remaining chunks. A journal of a different export (key mismatch) is discarded.
+ */
+class chunk_journal {
+   public:
+    /**
+     * @brief Open an existing journal or create a new one
+     * @param path path of the journal file
+     * @param key string identifying the export
+     */
+    chunk_journal(std::string path, std::string key);
+
+    ~chunk_journal();
+
+    /**
+     * @brief Derive a short key from an arbitrarily long string (e.g. a serialized process graph)
+     */
+    static std::string make_key(std::string s);
+
+    /**
+     * @brief Check whether a chunk has been completed before
+     */
+    bool is_done(chunkid_t id);
+
+    /**
+     * @brief Get writer-specific information for a completed chunk, or an empty string
+     */
+    std::string info(chunkid_t id);
+
+    /**
+     * @brief Number of completed chunks
+     */
+    uint32_t count_done();
+
+    /**
+     * @brief List ids of chunks that still need to be processed in ascending order
+     * @param nchunks total number of chunks
+     */
+    std::vector<chunkid_t> remaining(uint32_t nchunks);
+
+    /**
+     * @brief Record a completed chunk, thread-safe
+     * @param id chunk id
+     * @param info optional writer-specific information (must not contain line breaks)
+     */
+    void done(chunkid_t id, std::string info = "");
+
+    /**
+     * @brief Close the journal and remove the file if all chunks have been completed
+     * @param nchunks total number of chunks
+     * @return true, if all chunks have been completed
+     */
+    bool finish(uint32_t nchunks);
+
+    inline bool resumed() { return _resumed; }
+
+   private:
+    std::string _path;
+    std::map<chunkid_t, std::string> _done;
+    std::mutex _mutex;
+    FILE *_file;
+    bool _resumed;
+};
+
+}  // namespace gdalcubes
+
+#endif  // CHUNK_JOURNAL_H
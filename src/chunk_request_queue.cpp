@@ -0,0 +1,160 @@
+/*
+    MIT License
+
+    Copyright (c) 2026 Marius Appel <marius.appel@uni-muenster.de>
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+#include "chunk_request_queue.h"
+
+#include <algorithm>
+
+namespace gdalcubes {
+
+const int16_t chunk_request_queue::PRIORITY_INTERACTIVE;
+const int16_t chunk_request_queue::PRIORITY_BATCH;
+
+bool chunk_request_queue::push(key_type key, int16_t priority) {
+    std::lock_guard<std::mutex> lock(_m);
+    if (_running.count(key) > 0) {
+        return false;
+    }
+    auto q = _queued.find(key);
+    if (q != _queued.end()) {
+        if (q->second >= priority) {
+            return false;
+        }
+        // move request to the higher priority
+        auto &fifo = _queues[q->second][key.first];
+        fifo.erase(std::find(fifo.begin(), fifo.end(), key.second));
+        if (fifo.empty()) {
+            _queues[q->second].erase(key.first);
+            if (_queues[q->second].empty()) {
+                _queues.erase(q->second);
+            }
+        }
+        q->second = priority;
+        _queues[priority][key.first].push_back(key.second);
+        return false;
+    }
+    _queued[key] = priority;
+    _queues[priority][key.first].push_back(key.second);
+    _max_depth = std::max(_max_depth, uint32_t(_queued.size()));
+    _cond_pop.notify_one();
+    return true;
+}
+
+bool chunk_request_queue::pop(key_type &key) {
+    std::unique_lock<std::mutex> lock(_m);
+    _cond_pop.wait(lock, [this] { return _closed || !_queued.empty(); });
+    if (_closed) {
+        return false;
+    }
+
+    auto level = _queues.begin();  // highest priority
+    std::map<uint32_t, std::deque<uint32_t>> &cubes = level->second;
+
+    // next cube after the last served one
+    auto last = _last_cube.find(level->first);
+    auto c = (last == _last_cube.end()) ? cubes.begin() : cubes.upper_bound(last->second);
+    if (c == cubes.end()) {
+        c = cubes.begin();
+    }
+    key = std::make_pair(c->first, c->second.front());
+    _last_cube[level->first] = c->first;
+
+    c->second.pop_front();
+    if (c->second.empty()) {
+        cubes.erase(c);
+        if (cubes.empty()) {
+            _last_cube.erase(level->first);
+            _queues.erase(level);
+        }
+    }
+    _queued.erase(key);
+    _running.insert(key);
+    return true;
+}
+
+void chunk_request_queue::done(key_type key) {
+    std::lock_guard<std::mutex> lock(_m);
+    if (_running.erase(key) > 0) {
+        ++_processed;
+    }
+    _cond_done.notify_all();
+}
+
+void chunk_request_queue::wait(key_type key, std::function<bool()> finished) {
+    std::unique_lock<std::mutex> lock(_m);
+    _cond_done.wait(lock, [this, &key, &finished] {
+        return (_queued.count(key) == 0 && _running.count(key) == 0) || (finished && finished());
+    });
+}
+
+void chunk_request_queue::close() {
+    std::lock_guard<std::mutex> lock(_m);
+    _closed = true;
+    _cond_pop.notify_all();
+    _cond_done.notify_all();
+}
+
+bool chunk_request_queue::is_queued(key_type key) {
+    std::lock_guard<std::mutex> lock(_m);
+    return _queued.count(key) > 0;
+}
+
+bool chunk_request_queue::is_running(key_type key) {
+    std::lock_guard<std::mutex> lock(_m);
+    return _running.count(key) > 0;
+}
+
+uint32_t chunk_request_queue::depth() {
+    std::lock_guard<std::mutex> lock(_m);
+    return _queued.size();
+}
+
+uint32_t chunk_request_queue::depth(int16_t priority) {
+    std::lock_guard<std::mutex> lock(_m);
+    auto level = _queues.find(priority);
+    if (level == _queues.end()) {
+        return 0;
+    }
+    uint32_t n = 0;
+    for (auto it = level->second.begin(); it != level->second.end(); ++it) {
+        n += it->second.size();
+    }
+    return n;
+}
+
+uint32_t chunk_request_queue::running() {
+    std::lock_guard<std::mutex> lock(_m);
+    return _running.size();
+}
+
+uint64_t chunk_request_queue::processed() {
+    std::lock_guard<std::mutex> lock(_m);
+    return _processed;
+}
+
+uint32_t chunk_request_queue::max_depth() {
+    std::lock_guard<std::mutex> lock(_m);
+    return _max_depth;
+}
+
+}  // namespace gdalcubes
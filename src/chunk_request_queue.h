@@ -0,0 +1,147 @@
+/*
+    MIT License
+
+    Copyright (c) 2026 Marius Appel <marius.appel@uni-muenster.de>
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+#ifndef CHUNK_REQUEST_QUEUE_H
+#define CHUNK_REQUEST_QUEUE_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <set>
+#include <utility>
+
+namespace gdalcubes {
+
+/**
+ * @brief Thread-safe queue of chunk read requests with priorities and per-cube fairness
+ *
+ * Requests are identified by std::pair<cube_id, chunk_id>. Requests with higher priority are always served first.
+ * Among requests with the same priority, cubes are served in a round-robin fashion such that a cube with many
+ * queued chunks does not starve other cubes, and chunks of the same cube are served in FIFO order.
+ *
+ * Besides queued requests, the queue keeps track of running requests, i.e. requests that have been popped by a worker
+ * but not yet marked as done, such that clients can wait for the completion of a request.
+ */
+class chunk_request_queue {
+   public:
+    typedef std::pair<uint32_t, uint32_t> key_type;
+
+    /**
+     * @brief Priority of interactive requests such as previews
+     */
+    static const int16_t PRIORITY_INTERACTIVE = 10;
+
+    /**
+     * @brief Default priority of batch requests
+     */
+    static const int16_t PRIORITY_BATCH = 0;
+
+    chunk_request_queue() : _m(), _cond_pop(), _cond_done(), _queues(), _queued(), _running(), _last_cube(), _closed(false), _processed(0), _max_depth(0) {}
+
+    /**
+     * @brief Add a request to the queue
+     *
+     * If the request is already queued with a lower priority, its priority is increased.
+     * @param key request identifier (cube_id, chunk_id)
+     * @param priority priority, higher values are served first
+     * @return false, if the request is already queued or running
+     */
+    bool push(key_type key, int16_t priority = PRIORITY_BATCH);
+
+    /**
+     * @brief Take the next request from the queue, blocks until a request is available or the queue is closed
+     * @param[out] key request identifier (cube_id, chunk_id)
+     * @return false if the queue has been closed
+     */
+    bool pop(key_type &key);
+
+    /**
+     * @brief Mark a running request as done and notify waiting threads
+     * @param key request identifier (cube_id, chunk_id)
+     */
+    void done(key_type key);
+
+    /**
+     * @brief Block until a request is neither queued nor running
+     * @param key request identifier (cube_id, chunk_id)
+     * @param finished optional predicate, waiting stops as soon as it returns true
+     */
+    void wait(key_type key, std::function<bool()> finished = nullptr);
+
+    /**
+     * @brief Wake up all waiting workers, subsequent calls of pop() return false
+     */
+    void close();
+
+    bool is_queued(key_type key);
+    bool is_running(key_type key);
+
+    /**
+     * @brief Number of queued requests
+     */
+    uint32_t depth();
+
+    /**
+     * @brief Number of queued requests with a given priority
+     */
+    uint32_t depth(int16_t priority);
+
+    /**
+     * @brief Number of running requests
+     */
+    uint32_t running();
+
+    /**
+     * @brief Number of requests that have been marked as done
+     */
+    uint64_t processed();
+
+    /**
+     * @brief Maximum number of queued requests observed so far
+     */
+    uint32_t max_depth();
+
+   private:
+    std::mutex _m;
+    std::condition_variable _cond_pop;
+    std::condition_variable _cond_done;
+
+    // priority -> cube_id -> FIFO of chunk ids, highest priority first
+    std::map<int16_t, std::map<uint32_t, std::deque<uint32_t>>, std::greater<int16_t>> _queues;
+    std::map<key_type, int16_t> _queued;  // priority of queued requests
+    std::set<key_type> _running;
+
+    // last cube served per priority, for round-robin selection
+    std::map<int16_t, uint32_t> _last_cube;
+
+    bool _closed;
+    uint64_t _processed;
+    uint32_t _max_depth;
+};
+
+}  // namespace gdalcubes
+
+#endif  // CHUNK_REQUEST_QUEUE_H
@@ -0,0 +1,274 @@
+/*
+    MIT License
+
+    Copyright (c) 2026 Marius Appel <marius.appel@uni-muenster.de>
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+#include "chunk_wire.h"
+
+#include <cpl_conv.h>
+#include <cstring>
+
+namespace gdalcubes {
+
+static const char CHUNK_WIRE_MAGIC[4] = {'G', 'C', 'W', 'C'};
+static const uint8_t CHUNK_WIRE_VERSION = 1;
+static const uint8_t CHUNK_WIRE_FLAG_MASK = 1;
+
+const uint32_t chunk_wire::HEADER_SIZE;
+
+bool chunk_wire::is_encoded(const char *buf, std::size_t n) {
+    return n >= HEADER_SIZE && std::memcmp(buf, CHUNK_WIRE_MAGIC, 4) == 0;
+}
+
+void chunk_wire::rle_encode(const uint8_t *in, std::size_t n, std::vector<uint8_t> &out) {
+    std::size_t i = 0;
+    while (i < n) {
+        std::size_t j = i + 1;
+        while (j < n && j - i < 128 && in[j] == in[i]) ++j;
+        if (j - i >= 3) {
+            // run of 3 to 128 equal bytes: control byte 1 - length as int8
+            out.push_back(uint8_t(257 - (j - i)));
+            out.push_back(in[i]);
+            i = j;
+            continue;
+        }
+        // literals up to the next run of at least 3 equal bytes, at most 128
+        std::size_t k = i;
+        while (k < n && k - i < 128) {
+            if (k + 2 < n && in[k] == in[k + 1] && in[k] == in[k + 2]) break;
+            ++k;
+        }
+        out.push_back(uint8_t(k - i - 1));
+        out.insert(out.end(), in + i, in + k);
+        i = k;
+    }
+}
+
+bool chunk_wire::rle_decode(const uint8_t *in, std::size_t nin, uint8_t *out, std::size_t n) {
+    std::size_t i = 0;
+    std::size_t o = 0;
+    while (i < nin) {
+        int8_t c = int8_t(in[i++]);
+        if (c >= 0) {
+            std::size_t len = std::size_t(c) + 1;
+            if (i + len > nin || o + len > n) return false;
+            std::memcpy(out + o, in + i, len);
+            i += len;
+            o += len;
+        } else if (c != -128) {
+            std::size_t len = 1 - int(c);
+            if (i >= nin || o + len > n) return false;
+            std::memset(out + o, in[i++], len);
+            o += len;
+        }
+    }
+    return o == n;
+}
+
+std::vector<char> chunk_wire::encode(std::shared_ptr<chunk_data> dat, uint8_t comp) {
+    std::size_t n = std::size_t(dat->size()[0]) * dat->size()[1] * dat->size()[2] * dat->size()[3];
+    const double *values = (const double *)dat->buf();
+    if (dat->empty()) {
+        n = 0;
+    }
+
+    // count valid values and check whether float32 is lossless
+    uint64_t nvalid = 0;
+    bool f32 = true;
+    for (std::size_t i = 0; i < n; ++i) {
+        if (!std::isnan(values[i])) {
+            ++nvalid;
+            f32 = f32 && (double(float(values[i])) == values[i]);
+        }
+    }
+    uint8_t es = f32 ? 4 : 8;
+    std::size_t mask_bytes = (nvalid < n) ? (n + 7) / 8 : 0;
+    std::size_t raw_size = mask_bytes + nvalid * es;
+
+    // build uncompressed payload
+    std::vector<uint8_t> raw(raw_size, 0);
+    uint8_t *vals = raw.data() + mask_bytes;
+    bool shuffle = comp != NONE;
+    uint64_t iv = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        if (std::isnan(values[i])) continue;
+        if (mask_bytes > 0) raw[i / 8] |= uint8_t(1 << (i % 8));
+        uint8_t bytes[8];
+        if (f32) {
+            float v = float(values[i]);
+            std::memcpy(bytes, &v, 4);
+        } else {
+            std::memcpy(bytes, &values[i], 8);
+        }
+        if (shuffle) {
+            for (uint8_t b = 0; b < es; ++b) {
+                vals[b * nvalid + iv] = bytes[b];
+            }
+        } else {
+            std::memcpy(vals + iv * es, bytes, es);
+        }
+        ++iv;
+    }
+
+    // compress, fall back to uncompressed payload if this does not pay off
+    std::vector<uint8_t> compressed;
+    if (comp == SHUFFLE_RLE && raw_size > 0) {
+        compressed.reserve(raw_size / 4);
+        rle_encode(raw.data(), raw_size, compressed);
+    } else if (comp == SHUFFLE_DEFLATE && raw_size > 0) {
+        compressed.resize(raw_size);
+        std::size_t compressed_size = 0;
+        if (CPLZLibDeflate(raw.data(), raw_size, 1, compressed.data(), compressed.size(), &compressed_size) != nullptr) {
+            compressed.resize(compressed_size);
+        } else {
+            compressed.clear();  // output buffer too small
+        }
+    }
+    if (compressed.empty() || compressed.size() >= raw_size) {
+        comp = NONE;
+    }
+    const std::vector<uint8_t> &payload = (comp == NONE) ? raw : compressed;
+    if (comp == NONE && shuffle && raw_size > 0) {
+        // undo shuffling, uncompressed payloads store values contiguously
+        std::vector<uint8_t> tmp(vals, vals + nvalid * es);
+        for (uint64_t j = 0; j < nvalid; ++j) {
+            for (uint8_t b = 0; b < es; ++b) {
+                vals[j * es + b] = tmp[b * nvalid + j];
+            }
+        }
+    }
+
+    std::vector<char> out(HEADER_SIZE + payload.size());
+    char *h = out.data();
+    std::memcpy(h, CHUNK_WIRE_MAGIC, 4);
+    h[4] = CHUNK_WIRE_VERSION;
+    h[5] = f32 ? FLOAT32 : FLOAT64;
+    h[6] = comp;
+    h[7] = mask_bytes > 0 ? CHUNK_WIRE_FLAG_MASK : 0;
+    uint32_t size[4] = {dat->size()[0], dat->size()[1], dat->size()[2], dat->size()[3]};
+    std::memcpy(h + 8, size, 4 * sizeof(uint32_t));
+    uint64_t raw_size64 = raw_size;
+    std::memcpy(h + 24, &nvalid, sizeof(uint64_t));
+    std::memcpy(h + 32, &raw_size64, sizeof(uint64_t));
+    if (!payload.empty()) {
+        std::memcpy(h + HEADER_SIZE, payload.data(), payload.size());
+    }
+    return out;
+}
+
+std::shared_ptr<chunk_data> chunk_wire::decode(const char *buf, std::size_t n) {
+    if (!is_encoded(buf, n)) {
+        throw std::string("ERROR in chunk_wire::decode(): invalid header");
+    }
+    uint8_t version = buf[4];
+    uint8_t type = buf[5];
+    uint8_t comp = buf[6];
+    uint8_t flags = buf[7];
+    if (version != CHUNK_WIRE_VERSION) {
+        throw std::string("ERROR in chunk_wire::decode(): unsupported version " + std::to_string(version));
+    }
+    if (type != FLOAT64 && type != FLOAT32) {
+        throw std::string("ERROR in chunk_wire::decode(): unsupported element type " + std::to_string(type));
+    }
+    uint32_t size[4];
+    uint64_t nvalid, raw_size;
+    std::memcpy(size, buf + 8, 4 * sizeof(uint32_t));
+    std::memcpy(&nvalid, buf + 24, sizeof(uint64_t));
+    std::memcpy(&raw_size, buf + 32, sizeof(uint64_t));
+
+    std::shared_ptr<chunk_data> out = std::make_shared<chunk_data>();
+    out->size({size[0], size[1], size[2], size[3]});
+    std::size_t nvalues = std::size_t(size[0]) * size[1] * size[2] * size[3];
+    if (nvalues == 0) {
+        return out;
+    }
+
+    uint8_t es = (type == FLOAT32) ? 4 : 8;
+    std::size_t mask_bytes = (flags & CHUNK_WIRE_FLAG_MASK) ? (nvalues + 7) / 8 : 0;
+    if (nvalid > nvalues || raw_size != mask_bytes + nvalid * es || (mask_bytes == 0 && nvalid != nvalues)) {
+        throw std::string("ERROR in chunk_wire::decode(): inconsistent header");
+    }
+
+    // decompress payload
+    const uint8_t *payload = (const uint8_t *)(buf + HEADER_SIZE);
+    std::size_t payload_size = n - HEADER_SIZE;
+    std::vector<uint8_t> raw;
+    const uint8_t *r = payload;
+    if (comp == NONE) {
+        if (payload_size != raw_size) {
+            throw std::string("ERROR in chunk_wire::decode(): unexpected payload size");
+        }
+    } else if (comp == SHUFFLE_RLE) {
+        raw.resize(raw_size);
+        if (!rle_decode(payload, payload_size, raw.data(), raw_size)) {
+            throw std::string("ERROR in chunk_wire::decode(): corrupt run-length encoded payload");
+        }
+        r = raw.data();
+    } else if (comp == SHUFFLE_DEFLATE) {
+        raw.resize(raw_size);
+        std::size_t raw_out = 0;
+        if (CPLZLibInflate(payload, payload_size, raw.data(), raw_size, &raw_out) == nullptr || raw_out != raw_size) {
+            throw std::string("ERROR in chunk_wire::decode(): corrupt deflate compressed payload");
+        }
+        r = raw.data();
+    } else {
+        throw std::string("ERROR in chunk_wire::decode(): unsupported compression " + std::to_string(comp));
+    }
+
+    // expand values directly into the chunk buffer
+    double *values = (double *)std::malloc(nvalues * sizeof(double));
+    out->buf(values);
+    const uint8_t *mask = r;
+    const uint8_t *vals = r + mask_bytes;
+    bool shuffle = comp != NONE;
+    uint64_t iv = 0;
+    for (std::size_t i = 0; i < nvalues; ++i) {
+        if (mask_bytes > 0 && !(mask[i / 8] & (1 << (i % 8)))) {
+            values[i] = NAN;
+            continue;
+        }
+        if (iv >= nvalid) {
+            throw std::string("ERROR in chunk_wire::decode(): validity mask does not match number of valid values");
+        }
+        uint8_t bytes[8];
+        if (shuffle) {
+            for (uint8_t b = 0; b < es; ++b) {
+                bytes[b] = vals[b * nvalid + iv];
+            }
+        } else {
+            std::memcpy(bytes, vals + iv * es, es);
+        }
+        if (es == 4) {
+            float v;
+            std::memcpy(&v, bytes, 4);
+            values[i] = v;
+        } else {
+            std::memcpy(&values[i], bytes, 8);
+        }
+        ++iv;
+    }
+    if (iv != nvalid) {
+        throw std::string("ERROR in chunk_wire::decode(): validity mask does not match number of valid values");
+    }
+    return out;
+}
+
+}  // namespace gdalcubes
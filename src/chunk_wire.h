@@ -0,0 +1,101 @@
+/*
+    MIT License
+
+    Copyright (c) 2026 Marius Appel <marius.appel@uni-muenster.de>
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+#ifndef CHUNK_WIRE_H
+#define CHUNK_WIRE_H
+
+#include "cube.h"
+
+namespace gdalcubes {
+
+/**
+ * @brief Compact binary encoding of chunk data for transfers between gdalcubes_swarm and gdalcubes_server
+ *
+ * Encoded chunks start with a 40 bytes header in native (little endian) byte order
+ *
+ *     char     magic[4]     "GCWC"
+ *     uint8    version      currently 1
+ *     uint8    type         element type of values, see chunk_wire::element_type
+ *     uint8    compression  see chunk_wire::compression
+ *     uint8    flags        bit 0: payload contains a validity mask
+ *     uint32   size[4]      chunk size (b, t, y, x)
+ *     uint64   nvalid       number of valid, i.e. not NaN, values
+ *     uint64   raw_size     size of the uncompressed payload in bytes
+ *
+ * followed by the (compressed) payload. The uncompressed payload consists of an optional validity bitmask with one
+ * bit per value (1 = valid), followed by the valid values only. Values are stored as float32 if this is lossless for
+ * all values and as float64 otherwise. Before compression, bytes of values are shuffled, i.e. the first bytes of all
+ * values are followed by the second bytes of all values and so on, which makes sign, exponent, and zero mantissa bytes
+ * of typical raster data highly compressible.
+ */
+class chunk_wire {
+   public:
+    enum element_type : uint8_t {
+        FLOAT64 = 0,
+        FLOAT32 = 1
+    };
+
+    enum compression : uint8_t {
+        NONE = 0,
+        SHUFFLE_RLE = 1,      // byte shuffle + run-length encoding, very fast
+        SHUFFLE_DEFLATE = 2,  // byte shuffle + fast deflate
+    };
+
+    static const uint32_t HEADER_SIZE = 40;
+
+    /**
+     * @brief Encode chunk data
+     * @param dat chunk data
+     * @param comp requested compression, the payload is stored uncompressed if compression does not reduce its size
+     * @return encoded chunk including the header
+     */
+    static std::vector<char> encode(std::shared_ptr<chunk_data> dat, uint8_t comp = SHUFFLE_RLE);
+
+    /**
+     * @brief Decode chunk data
+     * @param buf encoded chunk including the header
+     * @param n size of buf in bytes
+     * @return chunk data
+     */
+    static std::shared_ptr<chunk_data> decode(const char *buf, std::size_t n);
+
+    /**
+     * @brief Check whether a buffer starts with the header of an encoded chunk
+     */
+    static bool is_encoded(const char *buf, std::size_t n);
+
+    /**
+     * @brief Run-length encoding of bytes (PackBits)
+     */
+    static void rle_encode(const uint8_t *in, std::size_t n, std::vector<uint8_t> &out);
+
+    /**
+     * @brief Run-length decoding of bytes (PackBits)
+     * @return false if the input is corrupt or does not decode to exactly n bytes
+     */
+    static bool rle_decode(const uint8_t *in, std::size_t nin, uint8_t *out, std::size_t n);
+};
+
+}  // namespace gdalcubes
+
+#endif  // CHUNK_WIRE_H
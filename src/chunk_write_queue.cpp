@@ -0,0 +1,118 @@
+/*
+    MIT License
+
+    Copyright (c) 2026 Marius Appel <marius.appel@uni-muenster.de>
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+#include "chunk_write_queue.h"
+
+namespace gdalcubes {
+
+chunk_write_queue::chunk_write_queue(uint32_t capacity, bool ordered, std::function<void(chunk_write_job &)> write) : _capacity(capacity < 1 ? 1 : capacity),
+                                                                                                                    _ordered(ordered),
+                                                                                                                    _write(write),
+                                                                                                                    _pending(),
+                                                                                                                    _next(0),
+                                                                                                                    _done(false),
+                                                                                                                    _mutex(),
+                                                                                                                    _cv_writer(),
+                                                                                                                    _cv_space(),
+                                                                                                                    _writer(),
+                                                                                                                    _error(),
+                                                                                                                    _nfailed(0) {
+    _writer = std::thread(&chunk_write_queue::run, this);
+}
+
+chunk_write_queue::~chunk_write_queue() {
+    // never throw from the destructor, errors are only reported by finish()
+    join();
+}
+
+void chunk_write_queue::push(chunk_write_job &&job) {
+    trace_span span_wait("write_queue_wait", "writer", job.id);
+    std::unique_lock<std::mutex> lock(_mutex);
+    _cv_space.wait(lock, [this] { return _pending.size() < _capacity; });
+    span_wait.end();
+    chunkid_t id = job.id;
+    _pending[id] = std::move(job);
+    lock.unlock();
+    _cv_writer.notify_one();
+}
+
+void chunk_write_queue::finish() {
+    join();
+    if (_nfailed > 0) {
+        throw std::string("ERROR in chunk_write_queue::finish(): " + std::to_string(_nfailed) + " chunk(s) could not be written, first error: " + _error);
+    }
+}
+
+void chunk_write_queue::join() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _done = true;
+    }
+    _cv_writer.notify_one();
+    if (_writer.joinable()) {
+        _writer.join();
+    }
+}
+
+void chunk_write_queue::run() {
+    trace_recorder::thread_name("chunk_write_queue");
+    while (true) {
+        chunk_write_job job;
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _cv_writer.wait(lock, [this] {
+                if (_pending.empty()) return _done;
+                if (!_ordered || _done) return true;
+                return _pending.begin()->first == _next || _pending.size() >= _capacity;
+            });
+            if (_pending.empty()) break;  // done
+            auto it = _pending.begin();
+            job = std::move(it->second);
+            _pending.erase(it);
+            _next = job.id + 1;
+        }
+        _cv_space.notify_one();
+        if (!job.dat && job.packed.empty()) continue;  // nothing to write
+        if (_nfailed > 0) {
+            // output is incomplete anyway, keep consuming chunks such that workers do not block
+            ++_nfailed;
+            continue;
+        }
+        std::string err;
+        try {
+            trace_span span_write("write_chunk", "writer", job.id);
+            _write(job);
+        } catch (std::string s) {
+            err = s;
+        } catch (...) {
+            err = "unexpected exception while writing chunk " + std::to_string(job.id);
+        }
+        if (!err.empty()) {
+            GCBS_ERROR(err);
+            _error = err;
+            ++_nfailed;
+        }
+    }
+}
+
+}  // namespace gdalcubes
@@ -0,0 +1,116 @@
+/*
+    MIT License
+
+    Copyright (c) 2026 Marius Appel <marius.appel@uni-muenster.de>
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+#ifndef CHUNK_WRITE_QUEUE_H
+#define CHUNK_WRITE_QUEUE_H
+
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "cube.h"
+
+namespace gdalcubes {
+
+/**
+ * @brief A chunk that is ready to be written to an output file
+ */
+struct chunk_write_job {
+    chunk_write_job() : id(0), dat(nullptr), packed() {}
+
+    chunkid_t id;
+
+    /**
+     * @brief Original chunk data, used if packed is empty
+     */
+    std::shared_ptr<chunk_data> dat;
+
+    /**
+     * @brief Band-wise packed chunk data, if packing has been applied
+     */
+    std::vector<uint8_t> packed;
+};
+
+/**
+ * @brief Bounded queue that passes chunks from worker threads to a single writer thread
+ *
+ * Workers prepare chunks (e.g. apply packing) in parallel and push them to the queue, while a dedicated writer
+ * thread calls a write function for all chunks one after another. The write function therefore does not need
+ * any synchronization, and workers block only if the queue is full. In ordered mode, chunks are written
+ * in order of their ids, which corresponds to the storage order of most output formats. Ordering is best effort:
+ * if the queue is full and the next chunk is missing (e.g. because reading it failed), the chunk with the smallest
+ * id is written anyway.
+ */
+class chunk_write_queue {
+   public:
+    /**
+     * @brief Create a queue and start the writer thread
+     * @param capacity maximum number of chunks in the queue
+     * @param ordered write chunks in order of their ids
+     * @param write function that writes a single chunk, called from the writer thread only
+     */
+    chunk_write_queue(uint32_t capacity, bool ordered, std::function<void(chunk_write_job &)> write);
+
+    ~chunk_write_queue();
+    chunk_write_queue(const chunk_write_queue &) = delete;
+    void operator=(const chunk_write_queue &) = delete;
+
+    /**
+     * @brief Add a chunk to the queue, blocks while the queue is full
+     * @note Chunks without any data should also be pushed in ordered mode, such that subsequent chunks
+     * are not delayed.
+     */
+    void push(chunk_write_job &&job);
+
+    /**
+     * @brief Write all remaining chunks and stop the writer thread
+     * @note If the write function failed for at least one chunk, the first error is thrown as std::string after the
+     * writer thread has been stopped. Chunks that arrive after a failure are dropped without calling the write function.
+     */
+    void finish();
+
+   private:
+    void run();
+    void join();
+
+    uint32_t _capacity;
+    bool _ordered;
+    std::function<void(chunk_write_job &)> _write;
+    std::map<chunkid_t, chunk_write_job> _pending;
+    chunkid_t _next;
+    bool _done;
+    std::mutex _mutex;
+    std::condition_variable _cv_writer;
+    std::condition_variable _cv_space;
+    std::thread _writer;
+    std::string _error;
+    uint32_t _nfailed;
+};
+
+}  // namespace gdalcubes
+
+#endif  // CHUNK_WRITE_QUEUE_H
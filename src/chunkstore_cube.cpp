@@ -0,0 +1,255 @@
+/*
+    MIT License
+
+    Copyright (c) 2026 Marius Appel <marius.appel@uni-muenster.de>
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+#include "chunkstore_cube.h"
+
+#include <cpl_conv.h>
+
+#include <fstream>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "filesystem.h"
+#include "packing.h"
+
+namespace gdalcubes {
+
+// Make length bytes of a file starting at offset available in memory and return an object that owns the memory.
+// On POSIX systems, this creates a private (copy-on-write) mapping, i.e., the memory can be modified without
+// affecting the file or other chunks. Offsets do not need to be aligned to the page size.
+static std::shared_ptr<void> map_file_region(int fd, std::string path, uint64_t offset, uint64_t length, void **data) {
+#ifndef _WIN32
+    static const uint64_t page_size = sysconf(_SC_PAGESIZE);
+    uint64_t map_offset = (offset / page_size) * page_size;
+    uint64_t map_length = length + (offset - map_offset);
+    void *base = mmap(nullptr, map_length, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, map_offset);
+    if (base == MAP_FAILED) {
+        throw std::string("ERROR in chunkstore_cube: failed to map " + std::to_string(length) + " bytes at offset " + std::to_string(offset) + " of '" + path + "'");
+    }
+    *data = (void *)(((uint8_t *)base) + (offset - map_offset));
+    return std::shared_ptr<void>(base, [map_length](void *p) { munmap(p, map_length); });
+#else
+    void *buf = std::malloc(length);
+    std::ifstream is(path, std::ios::in | std::ios::binary);
+    is.seekg(offset);
+    is.read((char *)buf, length);
+    if (!is) {
+        std::free(buf);
+        throw std::string("ERROR in chunkstore_cube: failed to read " + std::to_string(length) + " bytes at offset " + std::to_string(offset) + " of '" + path + "'");
+    }
+    *data = buf;
+    return std::shared_ptr<void>(buf, std::free);
+#endif
+}
+
+chunkstore_cube::chunkstore_cube(std::string path) : cube(), _path(path), _orig_bands(), _band_selection(), _band_idx(), _header(), _index(), _scale(), _offset(), _nodata(), _fd(-1) {
+    if (!filesystem::is_regular_file(path)) {
+        GCBS_ERROR("Chunk store file '" + path + "' does not exist or is not a file");
+        throw std::string("Chunk store file '" + path + "' does not exist or is not a file");
+    }
+
+#ifndef _WIN32
+    _fd = open(path.c_str(), O_RDONLY);
+    if (_fd < 0) {
+        GCBS_ERROR("Failed to open chunk store file '" + path + "'");
+        throw std::string("Failed to open chunk store file '" + path + "'");
+    }
+#endif
+
+    // header, index, and metadata are small and copied to memory
+    try {
+        void *data;
+        std::shared_ptr<void> mem = map_file_region(_fd, _path, 0, sizeof(chunkstore_header), &data);
+        std::memcpy(&_header, data, sizeof(chunkstore_header));
+        if (std::memcmp(_header.magic, CHUNKSTORE_MAGIC, sizeof(CHUNKSTORE_MAGIC)) != 0) {
+            throw std::string("ERROR in chunkstore_cube: '" + path + "' is not a valid chunk store file or has not been written completely");
+        }
+        if (_header.version != CHUNKSTORE_VERSION) {
+            throw std::string("ERROR in chunkstore_cube: unsupported chunk store version " + std::to_string(_header.version) + " in '" + path + "'");
+        }
+        if (_header.byte_order != CHUNKSTORE_BYTE_ORDER) {
+            throw std::string("ERROR in chunkstore_cube: chunk store file '" + path + "' has been created on a machine with different byte order");
+        }
+
+        _index.resize(_header.nchunks);
+        if (_header.nchunks > 0) {
+            mem = map_file_region(_fd, _path, _header.index_offset, _header.nchunks * sizeof(chunkstore_index_entry), &data);
+            std::memcpy(_index.data(), data, _header.nchunks * sizeof(chunkstore_index_entry));
+        }
+
+        mem = map_file_region(_fd, _path, _header.metadata_offset, _header.metadata_size, &data);
+        std::string err;
+        json11::Json j = json11::Json::parse(std::string((char *)data, _header.metadata_size), err);
+        if (!err.empty()) {
+            throw std::string("ERROR in chunkstore_cube: failed to parse metadata of '" + path + "': " + err);
+        }
+
+        if (j["datetime_type"].string_value() == "regular") {
+            cube_stref_regular ref;
+            ref.set_x_axis(j["left"].number_value(), j["right"].number_value(), (uint32_t)j["nx"].int_value());
+            ref.set_y_axis(j["bottom"].number_value(), j["top"].number_value(), (uint32_t)j["ny"].int_value());
+            ref.srs(j["srs"].string_value());
+            ref.set_t_axis(datetime::from_string(j["t0"].string_value()), datetime::from_string(j["t1"].string_value()), duration::from_string(j["dt"].string_value()));
+            _st_ref = std::make_shared<cube_stref_regular>(ref);
+        } else {
+            cube_stref_labeled_time ref;
+            ref.set_x_axis(j["left"].number_value(), j["right"].number_value(), (uint32_t)j["nx"].int_value());
+            ref.set_y_axis(j["bottom"].number_value(), j["top"].number_value(), (uint32_t)j["ny"].int_value());
+            ref.srs(j["srs"].string_value());
+            std::vector<datetime> labels;
+            for (uint32_t i = 0; i < j["time_labels"].array_items().size(); ++i) {
+                labels.push_back(datetime::from_string(j["time_labels"][i].string_value()));
+            }
+            ref.set_time_labels(labels);
+            _st_ref = std::make_shared<cube_stref_labeled_time>(ref);
+        }
+
+        _chunk_size = {(uint32_t)j["chunk_size"][0].int_value(), (uint32_t)j["chunk_size"][1].int_value(), (uint32_t)j["chunk_size"][2].int_value()};
+
+        for (uint16_t i = 0; i < j["bands"].array_items().size(); ++i) {
+            json11::Json jb = j["bands"][i];
+            band b(jb["name"].string_value());
+            b.offset = jb["offset"].number_value();
+            b.scale = jb["scale"].number_value();
+            b.unit = jb["unit"].string_value();
+            b.type = jb["type"].string_value();
+            b.no_data_value = jb["nodata"].string_value();
+            _orig_bands.add(b);
+            _bands.add(b);
+            _band_idx.push_back(i);
+            _scale.push_back(jb["pack_scale"].is_null() ? 1.0 : jb["pack_scale"].number_value());
+            _offset.push_back(jb["pack_offset"].is_null() ? 0.0 : jb["pack_offset"].number_value());
+            _nodata.push_back(jb["pack_nodata"].is_null() ? NAN : jb["pack_nodata"].number_value());
+        }
+
+        if (_header.nchunks != count_chunks()) {
+            throw std::string("ERROR in chunkstore_cube: chunk index of '" + path + "' does not match the data cube shape");
+        }
+    } catch (std::string s) {
+        GCBS_ERROR(s);
+#ifndef _WIN32
+        close(_fd);
+#endif
+        throw s;
+    }
+}
+
+chunkstore_cube::~chunkstore_cube() {
+#ifndef _WIN32
+    // existing mappings of returned chunks remain valid after closing the file descriptor
+    if (_fd >= 0) close(_fd);
+#endif
+}
+
+void chunkstore_cube::select_bands(std::vector<std::string> bands) {
+    _band_selection.clear();
+    _band_idx.clear();
+    _bands = band_collection();
+    for (uint16_t i = 0; i < bands.size(); ++i) {
+        if (_orig_bands.has(bands[i])) {
+            _bands.add(_orig_bands.get(bands[i]));
+            _band_selection.push_back(bands[i]);
+            _band_idx.push_back(_orig_bands.get_index(bands[i]));
+        } else {
+            GCBS_WARN("Data cube has no band with name '" + bands[i] + "'; band will be skipped");
+        }
+    }
+    if (_bands.count() == 0) {
+        _band_selection.clear();
+        _bands = _orig_bands;
+        for (uint16_t i = 0; i < _orig_bands.count(); ++i) {
+            _band_idx.push_back(i);
+        }
+    }
+}
+
+std::shared_ptr<chunk_data> chunkstore_cube::read_chunk(chunkid_t id) {
+    GCBS_TRACE("chunkstore_cube::read_chunk(" + std::to_string(id) + ")");
+
+    std::shared_ptr<chunk_data> out = std::make_shared<chunk_data>();
+    profile_scope profile(this, out);
+    trace_span span("chunkstore_cube::read_chunk", "source", id);
+    if (id >= count_chunks()) {
+        // chunk is outside of the cube, we don't need to read anything.
+        GCBS_WARN("Chunk id " + std::to_string(id) + " is out of range");
+        return out;
+    }
+    if (_index[id].size == 0) {
+        // empty chunks are not stored
+        return out;
+    }
+
+    coords_nd<uint32_t, 3> size_tyx = chunk_size(id);
+    coords_nd<uint32_t, 4> size_btyx = {_bands.count(), size_tyx[0], size_tyx[1], size_tyx[2]};
+    std::size_t n = std::size_t(size_tyx[0]) * size_tyx[1] * size_tyx[2];
+
+    packed_export::packing_type type = (packed_export::packing_type)_header.data_type;
+    std::size_t value_size = packing_kernels::value_size(type);
+
+    // Zero copy: selected bands are a contiguous block of doubles in the file
+    bool contiguous = true;
+    for (uint16_t i = 1; i < _band_idx.size(); ++i) {
+        if (_band_idx[i] != _band_idx[i - 1] + 1) {
+            contiguous = false;
+            break;
+        }
+    }
+    if (type == packed_export::packing_type::PACK_NONE && _header.compression == 0 && contiguous) {
+        void *data;
+        std::shared_ptr<void> mem = map_file_region(_fd, _path, _index[id].offset + _band_idx[0] * n * sizeof(double),
+                                                    _band_idx.size() * n * sizeof(double), &data);
+        out->size(size_btyx);
+        out->buf(data, mem);
+        return out;
+    }
+
+    void *data;
+    std::shared_ptr<void> mem = map_file_region(_fd, _path, _index[id].offset, _index[id].size, &data);
+    std::shared_ptr<void> inflated;
+    if (_header.compression == 1) {
+        std::size_t expected_size = _orig_bands.count() * n * value_size;
+        inflated = std::shared_ptr<void>(std::malloc(expected_size), std::free);
+        std::size_t inflated_size = 0;
+        if (!CPLZLibInflate(data, _index[id].size, inflated.get(), expected_size, &inflated_size) || inflated_size != expected_size) {
+            GCBS_ERROR("Failed to decompress chunk " + std::to_string(id) + " of '" + _path + "'");
+            throw std::string("Failed to decompress chunk " + std::to_string(id) + " of '" + _path + "'");
+        }
+        data = inflated.get();
+    }
+
+    out->size(size_btyx);
+    out->buf(std::malloc(size_btyx[0] * n * sizeof(double)));
+    for (uint16_t i = 0; i < size_btyx[0]; ++i) {
+        uint16_t ib = _band_idx[i];
+        const uint8_t *in = ((const uint8_t *)data) + ib * n * value_size;
+        double *o = ((double *)out->buf()) + i * n;
+        packing_kernels::unpack(type, in, o, n, _scale[ib], _offset[ib], _nodata[ib]);
+    }
+    return out;
+}
+
+}  // namespace gdalcubes
@@ -0,0 +1,126 @@
+/*
+    MIT License
+
+    Copyright (c) 2026 Marius Appel <marius.appel@uni-muenster.de>
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+#ifndef CHUNKSTORE_CUBE_H
+#define CHUNKSTORE_CUBE_H
+
+#include "cube.h"
+
+namespace gdalcubes {
+
+/**
+ * @brief Fixed-size header at the beginning of a chunk store file
+ *
+ * A chunk store file consists of this header, chunk payloads, a chunk index with one
+ * chunkstore_index_entry per chunk, and JSON metadata describing the cube. Chunk payloads contain all bands of a chunk
+ * (in btyx order) with the data type given in the header and are aligned to CHUNKSTORE_ALIGNMENT bytes.
+ * The header is written last, i.e., incomplete files can be detected by an invalid magic string.
+ */
+struct chunkstore_header {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;   // CHUNKSTORE_BYTE_ORDER as written by the creating machine
+    uint32_t data_type;    // packed_export::packing_type, PACK_NONE = 8 byte doubles
+    uint32_t compression;  // 0 = none, 1 = zlib
+    uint64_t nchunks;
+    uint64_t index_offset;
+    uint64_t metadata_offset;
+    uint64_t metadata_size;
+    uint8_t reserved[8];
+};
+
+/**
+ * @brief Location of a single chunk in a chunk store file, size == 0 for empty chunks
+ */
+struct chunkstore_index_entry {
+    uint64_t offset;
+    uint64_t size;
+};
+
+static const char CHUNKSTORE_MAGIC[8] = {'G', 'C', 'B', 'S', 'C', 'S', 'T', 'R'};
+static const uint32_t CHUNKSTORE_VERSION = 1;
+static const uint32_t CHUNKSTORE_BYTE_ORDER = 0x01020304;
+static const uint64_t CHUNKSTORE_ALIGNMENT = 64;
+
+/**
+ * @brief A data cube that reads chunks from a gdalcubes chunk store file
+ *
+ * Chunk store files are created with cube::write_chunkstore() and contain chunks exactly as
+ * computed by the original cube. Chunks are read with memory mapping. Uncompressed, unpacked chunks are passed to
+ * consumers without any copies (using private, copy-on-write mappings) and reading does not require any locks.
+ */
+class chunkstore_cube : public cube {
+   public:
+    /**
+     * @brief Create a data cube from a chunk store file
+     * @note This static creation method should preferably be used instead of the constructors as
+     * the constructors will not set connections between cubes properly.
+     * @param path path to a chunk store file
+     * @return a shared pointer to the created data cube instance
+     */
+    static std::shared_ptr<chunkstore_cube> create(std::string path) {
+        return std::make_shared<chunkstore_cube>(path);
+    }
+
+   public:
+    chunkstore_cube(std::string path);
+
+   public:
+    ~chunkstore_cube();
+
+    /**
+     * @brief Select bands by names
+     * @param bands vector of bands to be considered in the cube, if empty, all bands will be selected
+     */
+    void select_bands(std::vector<std::string> bands);
+
+    std::shared_ptr<chunk_data> read_chunk(chunkid_t id) override;
+
+    json11::Json make_constructible_json() override {
+        json11::Json::object out;
+        out["cube_type"] = "chunkstore";
+        out["file"] = _path;
+        json11::Json::array b;
+        for (uint16_t i = 0; i < _band_selection.size(); ++i) {
+            b.push_back(_band_selection[i]);
+        }
+        if (!b.empty()) out["band_selection"] = b;
+        return out;
+    }
+
+   private:
+    std::string _path;
+    band_collection _orig_bands;
+    std::vector<std::string> _band_selection;
+    std::vector<uint16_t> _band_idx;  // indexes of selected bands in the file
+    chunkstore_header _header;
+    std::vector<chunkstore_index_entry> _index;
+    std::vector<double> _scale;   // per band of the file, only for packed data
+    std::vector<double> _offset;  // per band of the file, only for packed data
+    std::vector<double> _nodata;  // per band of the file, only for packed data
+    int _fd;
+};
+
+}  // namespace gdalcubes
+
+#endif  // CHUNKSTORE_CUBE_H
@@ -0,0 +1,545 @@
+/*
+    MIT License
+
+    Copyright (c) 2026 Marius Appel <marius.appel@uni-muenster.de>
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+#include "cog_writer.h"
+
+#include <cpl_conv.h>
+
+#include <algorithm>
+#include <cstring>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "packing.h"
+#include "utils.h"
+
+namespace gdalcubes {
+
+// TIFF field types
+static const uint16_t TIFF_ASCII = 2;
+static const uint16_t TIFF_SHORT = 3;
+static const uint16_t TIFF_LONG = 4;
+static const uint16_t TIFF_DOUBLE = 12;
+static const uint16_t TIFF_LONG8 = 16;
+
+// A single IFD entry with its values in host byte order
+struct tiff_entry {
+    uint16_t tag;
+    uint16_t type;
+    uint64_t count;
+    std::vector<uint8_t> data;
+};
+
+template <typename T>
+static tiff_entry make_entry(uint16_t tag, uint16_t type, std::vector<T> values) {
+    tiff_entry e;
+    e.tag = tag;
+    e.type = type;
+    e.count = values.size();
+    e.data.resize(values.size() * sizeof(T));
+    std::memcpy(e.data.data(), values.data(), e.data.size());
+    return e;
+}
+
+static tiff_entry make_ascii_entry(uint16_t tag, std::string s) {
+    tiff_entry e;
+    e.tag = tag;
+    e.type = TIFF_ASCII;
+    e.count = s.size() + 1;
+    e.data.assign(s.begin(), s.end());
+    e.data.push_back(0);
+    return e;
+}
+
+static uint64_t align8(uint64_t x) {
+    return (x + 7) & ~uint64_t(7);
+}
+
+template <typename T>
+static void append(std::vector<uint8_t> &out, T v) {
+    const uint8_t *b = (const uint8_t *)&v;
+    out.insert(out.end(), b, b + sizeof(T));
+}
+
+// Size of a serialized IFD including values that do not fit into entries
+static uint64_t ifd_size(const std::vector<tiff_entry> &entries, bool big) {
+    uint64_t field_size = big ? 8 : 4;
+    uint64_t size = (big ? 8 : 2) + entries.size() * (big ? 20 : 12) + (big ? 8 : 4);
+    for (uint32_t i = 0; i < entries.size(); ++i) {
+        if (entries[i].data.size() > field_size) size = align8(size) + entries[i].data.size();
+    }
+    return align8(size);
+}
+
+// Serialize an IFD that will be written at file position pos, value_pos receives the file position of the values per tag
+static std::vector<uint8_t> serialize_ifd(const std::vector<tiff_entry> &entries, bool big, uint64_t pos, uint64_t next_ifd, std::map<uint16_t, uint64_t> &value_pos) {
+    uint64_t field_size = big ? 8 : 4;
+    std::vector<uint8_t> out;
+    std::vector<uint8_t> extra;
+    uint64_t extra_pos = pos + (big ? 8 : 2) + entries.size() * (big ? 20 : 12) + (big ? 8 : 4);
+
+    if (big) {
+        append<uint64_t>(out, entries.size());
+    } else {
+        append<uint16_t>(out, entries.size());
+    }
+    for (uint32_t i = 0; i < entries.size(); ++i) {
+        const tiff_entry &e = entries[i];
+        append<uint16_t>(out, e.tag);
+        append<uint16_t>(out, e.type);
+        if (big) {
+            append<uint64_t>(out, e.count);
+        } else {
+            append<uint32_t>(out, (uint32_t)e.count);
+        }
+        if (e.data.size() <= field_size) {
+            value_pos[e.tag] = pos + out.size();
+            out.insert(out.end(), e.data.begin(), e.data.end());
+            out.resize(out.size() + field_size - e.data.size(), 0);
+        } else {
+            uint64_t p = align8(extra_pos + extra.size());
+            extra.resize(p - extra_pos, 0);
+            value_pos[e.tag] = p;
+            if (big) {
+                append<uint64_t>(out, p);
+            } else {
+                append<uint32_t>(out, (uint32_t)p);
+            }
+            extra.insert(extra.end(), e.data.begin(), e.data.end());
+        }
+    }
+    if (big) {
+        append<uint64_t>(out, next_ifd);
+    } else {
+        append<uint32_t>(out, (uint32_t)next_ifd);
+    }
+    out.insert(out.end(), extra.begin(), extra.end());
+    out.resize(ifd_size(entries, big), 0);
+    return out;
+}
+
+bool cog_writer::supports_resampling(std::string resampling) {
+    std::transform(resampling.begin(), resampling.end(), resampling.begin(), (int (*)(int))std::toupper);
+    return resampling == "NEAREST" || resampling == "AVERAGE";
+}
+
+uint16_t cog_writer::count_overviews(uint32_t nx, uint32_t ny, uint32_t tile_size) {
+    uint16_t n = 0;
+    while (std::max(nx, ny) > (uint64_t(tile_size) << n)) ++n;
+    return n;
+}
+
+cog_writer::cog_writer(std::string path, uint32_t nx, uint32_t ny, std::vector<std::string> band_names, double affine[6], int epsg, bool geographic,
+                       packed_export packing, uint32_t tile_size, uint8_t deflate_level, std::string resampling)
+    : _path(path), _nx(nx), _ny(ny), _nbands(band_names.size()), _band_names(band_names), _affine(), _epsg(epsg), _geographic(geographic), _packing(packing), _tile_size(tile_size), _deflate_level(deflate_level), _average(false), _value_size(sizeof(double)), _bigtiff(false), _slot_size(0), _levels(), _mutex(), _next_offset(0), _finished(false), _fd(-1), _fout(), _io_mutex() {
+    std::copy(affine, affine + 6, _affine);
+    std::transform(resampling.begin(), resampling.end(), resampling.begin(), (int (*)(int))std::toupper);
+    _average = resampling == "AVERAGE";
+
+    if (_nbands == 0 || nx == 0 || ny == 0) {
+        throw std::string("ERROR in cog_writer::cog_writer(): empty image");
+    }
+    if (tile_size == 0 || tile_size % 16 != 0) {
+        throw std::string("ERROR in cog_writer::cog_writer(): tile size must be a multiple of 16");
+    }
+    if (_packing.type != packed_export::packing_type::PACK_NONE && _packing.type != packed_export::packing_type::PACK_FLOAT32) {
+        if (_packing.scale.empty() || _packing.offset.size() != _packing.scale.size() || _packing.nodata.size() != _packing.scale.size()) {
+            throw std::string("ERROR in cog_writer::cog_writer(): invalid packing");
+        }
+    }
+
+    _value_size = packing_kernels::value_size(_packing.type);
+
+    uint64_t raw_tile_size = uint64_t(tile_size) * tile_size * _value_size;
+    _slot_size = raw_tile_size;
+    if (_deflate_level > 0) {
+        // zlib compressBound() plus some margin
+        _slot_size = raw_tile_size + (raw_tile_size >> 12) + (raw_tile_size >> 14) + (raw_tile_size >> 25) + 13 + 64;
+    }
+
+    // levels
+    uint16_t noverviews = count_overviews(nx, ny, tile_size);
+    uint64_t estimated_size = 0;
+    for (uint16_t k = 0; k <= noverviews; ++k) {
+        level_info l;
+        l.factor = 1 << k;
+        l.width = (nx + l.factor - 1) / l.factor;
+        l.height = (ny + l.factor - 1) / l.factor;
+        l.ntiles_x = (l.width + tile_size - 1) / tile_size;
+        l.ntiles_y = (l.height + tile_size - 1) / tile_size;
+        l.offsets.resize(uint64_t(l.ntiles_x) * l.ntiles_y * _nbands, 0);
+        l.bytecounts.resize(uint64_t(l.ntiles_x) * l.ntiles_y * _nbands, 0);
+        l.offsets_pos = l.bytecounts_pos = l.reserved_pos = 0;
+        estimated_size += l.offsets.size() * (_slot_size + 16);
+        _levels.push_back(l);
+    }
+    _bigtiff = estimated_size > 4000000000ULL;  // like GDAL's BIGTIFF=IF_SAFER
+
+#ifndef _WIN32
+    _fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (_fd < 0) {
+        throw std::string("ERROR in cog_writer::cog_writer(): cannot create file '" + path + "'");
+    }
+#else
+    _fout.open(path, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!_fout.is_open()) {
+        throw std::string("ERROR in cog_writer::cog_writer(): cannot create file '" + path + "'");
+    }
+#endif
+    write_header();
+}
+
+cog_writer::~cog_writer() {
+    if (!_finished) {
+        try {
+            finish();
+        } catch (std::string s) {
+            GCBS_ERROR(s);
+        }
+    }
+}
+
+void cog_writer::write_header() {
+    uint16_t bits = _value_size * 8;
+    uint16_t sample_format = 3;
+    if (_packing.type == packed_export::packing_type::PACK_UINT8 || _packing.type == packed_export::packing_type::PACK_UINT16 || _packing.type == packed_export::packing_type::PACK_UINT32) {
+        sample_format = 1;
+    } else if (_packing.type == packed_export::packing_type::PACK_INT16 || _packing.type == packed_export::packing_type::PACK_INT32) {
+        sample_format = 2;
+    }
+
+    std::string nodata = "nan";
+    bool packed = _packing.type != packed_export::packing_type::PACK_NONE && _packing.type != packed_export::packing_type::PACK_FLOAT32;
+    if (packed) {
+        nodata = utils::dbl_to_string(_packing.nodata[0]);  // GeoTIFF supports only one NoData value for all bands
+    }
+
+    std::string md = "<GDALMetadata>";
+    for (uint16_t ib = 0; ib < _nbands; ++ib) {
+        md += "<Item name=\"DESCRIPTION\" sample=\"" + std::to_string(ib) + "\" role=\"description\">" + _band_names[ib] + "</Item>";
+        if (packed) {
+            double scale = _packing.scale.size() == _nbands ? _packing.scale[ib] : _packing.scale[0];
+            double offset = _packing.offset.size() == _nbands ? _packing.offset[ib] : _packing.offset[0];
+            md += "<Item name=\"OFFSET\" sample=\"" + std::to_string(ib) + "\" role=\"offset\">" + utils::dbl_to_string(offset) + "</Item>";
+            md += "<Item name=\"SCALE\" sample=\"" + std::to_string(ib) + "\" role=\"scale\">" + utils::dbl_to_string(scale) + "</Item>";
+        }
+    }
+    md += "</GDALMetadata>";
+
+    // GeoKeyDirectory: version 1.1.0, model type, raster type = PixelIsArea, and EPSG code
+    std::vector<uint16_t> geokeys = {1, 1, 0, 3,
+                                     1024, 0, 1, uint16_t(_geographic ? 2 : 1),
+                                     1025, 0, 1, 1,
+                                     uint16_t(_geographic ? 2048 : 3072), 0, 1, uint16_t(_epsg)};
+
+    // build entries (sorted by tag) and compute layout
+    std::vector<std::vector<tiff_entry>> ifds;
+    for (uint16_t k = 0; k < _levels.size(); ++k) {
+        level_info &l = _levels[k];
+        uint64_t ntiles = l.offsets.size();
+        std::vector<tiff_entry> e;
+        e.push_back(make_entry<uint32_t>(254, TIFF_LONG, {k == 0 ? 0u : 1u}));
+        e.push_back(make_entry<uint32_t>(256, TIFF_LONG, {l.width}));
+        e.push_back(make_entry<uint32_t>(257, TIFF_LONG, {l.height}));
+        e.push_back(make_entry<uint16_t>(258, TIFF_SHORT, std::vector<uint16_t>(_nbands, bits)));
+        e.push_back(make_entry<uint16_t>(259, TIFF_SHORT, {uint16_t(_deflate_level > 0 ? 8 : 1)}));
+        e.push_back(make_entry<uint16_t>(262, TIFF_SHORT, {1}));
+        e.push_back(make_entry<uint16_t>(277, TIFF_SHORT, {_nbands}));
+        e.push_back(make_entry<uint16_t>(284, TIFF_SHORT, {uint16_t(_nbands > 1 ? 2 : 1)}));
+        e.push_back(make_entry<uint32_t>(322, TIFF_LONG, {_tile_size}));
+        e.push_back(make_entry<uint32_t>(323, TIFF_LONG, {_tile_size}));
+        if (_bigtiff) {
+            e.push_back(make_entry<uint64_t>(324, TIFF_LONG8, std::vector<uint64_t>(ntiles, 0)));
+            e.push_back(make_entry<uint64_t>(325, TIFF_LONG8, std::vector<uint64_t>(ntiles, 0)));
+        } else {
+            e.push_back(make_entry<uint32_t>(324, TIFF_LONG, std::vector<uint32_t>(ntiles, 0)));
+            e.push_back(make_entry<uint32_t>(325, TIFF_LONG, std::vector<uint32_t>(ntiles, 0)));
+        }
+        if (_nbands > 1) {
+            e.push_back(make_entry<uint16_t>(338, TIFF_SHORT, std::vector<uint16_t>(_nbands - 1, 0)));
+        }
+        e.push_back(make_entry<uint16_t>(339, TIFF_SHORT, std::vector<uint16_t>(_nbands, sample_format)));
+        if (k == 0) {
+            e.push_back(make_entry<double>(33550, TIFF_DOUBLE, {_affine[1], -_affine[5], 0.0}));
+            e.push_back(make_entry<double>(33922, TIFF_DOUBLE, {0.0, 0.0, 0.0, _affine[0], _affine[3], 0.0}));
+            e.push_back(make_entry<uint16_t>(34735, TIFF_SHORT, geokeys));
+            e.push_back(make_ascii_entry(42112, md));
+        }
+        e.push_back(make_ascii_entry(42113, nodata));
+        ifds.push_back(e);
+    }
+
+    uint64_t pos = _bigtiff ? 16 : 8;
+    std::vector<uint64_t> ifd_pos;
+    for (uint16_t k = 0; k < ifds.size(); ++k) {
+        ifd_pos.push_back(pos);
+        pos += ifd_size(ifds[k], _bigtiff);
+    }
+
+    // reserved areas for the first tile of each level, smallest overview first
+    for (int32_t k = _levels.size() - 1; k >= 0; --k) {
+        _levels[k].reserved_pos = pos;
+        pos += _slot_size;
+    }
+    _next_offset = pos;
+
+    std::vector<uint8_t> out;
+    uint16_t one = 1;
+    bool little_endian = *((uint8_t *)&one) == 1;
+    out.push_back(little_endian ? 'I' : 'M');
+    out.push_back(little_endian ? 'I' : 'M');
+    if (_bigtiff) {
+        append<uint16_t>(out, 43);
+        append<uint16_t>(out, 8);
+        append<uint16_t>(out, 0);
+        append<uint64_t>(out, ifd_pos[0]);
+    } else {
+        append<uint16_t>(out, 42);
+        append<uint32_t>(out, (uint32_t)ifd_pos[0]);
+    }
+    for (uint16_t k = 0; k < ifds.size(); ++k) {
+        std::map<uint16_t, uint64_t> value_pos;
+        std::vector<uint8_t> ifd = serialize_ifd(ifds[k], _bigtiff, ifd_pos[k], uint32_t(k + 1) < ifds.size() ? ifd_pos[k + 1] : 0, value_pos);
+        out.insert(out.end(), ifd.begin(), ifd.end());
+        _levels[k].offsets_pos = value_pos[324];
+        _levels[k].bytecounts_pos = value_pos[325];
+    }
+    if (!write_at(out.data(), out.size(), 0)) {
+        throw std::string("ERROR in cog_writer::write_header(): failed to write to '" + _path + "'");
+    }
+}
+
+bool cog_writer::write_at(const void *buf, uint64_t size, uint64_t offset) {
+#ifndef _WIN32
+    const uint8_t *b = (const uint8_t *)buf;
+    while (size > 0) {
+        ssize_t written = pwrite(_fd, b, size, offset);
+        if (written <= 0) return false;
+        b += written;
+        offset += written;
+        size -= written;
+    }
+    return true;
+#else
+    std::lock_guard<std::mutex> lock(_io_mutex);
+    _fout.seekp(offset);
+    _fout.write((const char *)buf, size);
+    return !_fout.fail();
+#endif
+}
+
+uint64_t cog_writer::expected_pixels(uint16_t level, uint32_t tx, uint32_t ty) {
+    uint64_t fsize = uint64_t(_tile_size) * _levels[level].factor;
+    uint64_t x0 = tx * fsize;
+    uint64_t x1 = std::min<uint64_t>(_nx, (tx + 1) * fsize);
+    uint64_t y0 = ty * fsize;
+    uint64_t y1 = std::min<uint64_t>(_ny, (ty + 1) * fsize);
+    return (x1 - x0) * (y1 - y0);
+}
+
+void cog_writer::write(const double *buf, std::size_t band_stride, uint32_t x0, uint32_t y0, uint32_t w, uint32_t h) {
+    if (w == 0 || h == 0) return;
+    const uint32_t T = _tile_size;
+    std::vector<completed_tile> completed;
+
+    _mutex.lock();
+    for (uint16_t k = 0; k < _levels.size(); ++k) {
+        level_info &l = _levels[k];
+        const uint32_t f = l.factor;
+        uint32_t tx0 = (x0 / f) / T;
+        uint32_t tx1 = ((x0 + w - 1) / f) / T;
+        uint32_t ty0 = (y0 / f) / T;
+        uint32_t ty1 = ((y0 + h - 1) / f) / T;
+        for (uint32_t ty = ty0; ty <= ty1; ++ty) {
+            for (uint32_t tx = tx0; tx <= tx1; ++tx) {
+                // overlap of the block with the footprint of the tile in full resolution pixels
+                uint64_t fsize = uint64_t(T) * f;
+                uint32_t ox0 = std::max<uint64_t>(x0, tx * fsize);
+                uint32_t ox1 = std::min<uint64_t>({uint64_t(x0) + w, (tx + 1) * fsize, uint64_t(_nx)});
+                uint32_t oy0 = std::max<uint64_t>(y0, ty * fsize);
+                uint32_t oy1 = std::min<uint64_t>({uint64_t(y0) + h, (ty + 1) * fsize, uint64_t(_ny)});
+                if (ox0 >= ox1 || oy0 >= oy1) continue;
+
+                uint32_t tile_idx = ty * l.ntiles_x + tx;
+                tile_state &s = l.tiles[tile_idx];
+                if (s.values.empty()) {
+                    if (_average && k > 0) {
+                        s.values.resize(std::size_t(_nbands) * T * T, 0.0);
+                        s.count.resize(std::size_t(_nbands) * T * T, 0);
+                    } else {
+                        s.values.resize(std::size_t(_nbands) * T * T, NAN);
+                    }
+                }
+                s.received += uint64_t(ox1 - ox0) * (oy1 - oy0);
+
+                if (buf) {
+                    if (k == 0) {
+                        for (uint16_t ib = 0; ib < _nbands; ++ib) {
+                            for (uint32_t y = oy0; y < oy1; ++y) {
+                                std::memcpy(s.values.data() + std::size_t(ib) * T * T + std::size_t(y - ty * T) * T + (ox0 - tx * T),
+                                            buf + ib * band_stride + std::size_t(y - y0) * w + (ox0 - x0), (ox1 - ox0) * sizeof(double));
+                            }
+                        }
+                    } else if (!_average) {
+                        // nearest neighbor: pick the pixel at the center of each block
+                        for (uint32_t ly = oy0 / f; ly <= (oy1 - 1) / f; ++ly) {
+                            uint32_t sy = std::min<uint64_t>(uint64_t(ly) * f + f / 2, _ny - 1);
+                            if (sy < oy0 || sy >= oy1) continue;
+                            for (uint32_t lx = ox0 / f; lx <= (ox1 - 1) / f; ++lx) {
+                                uint32_t sx = std::min<uint64_t>(uint64_t(lx) * f + f / 2, _nx - 1);
+                                if (sx < ox0 || sx >= ox1) continue;
+                                for (uint16_t ib = 0; ib < _nbands; ++ib) {
+                                    s.values[std::size_t(ib) * T * T + std::size_t(ly - ty * T) * T + (lx - tx * T)] = buf[ib * band_stride + std::size_t(sy - y0) * w + (sx - x0)];
+                                }
+                            }
+                        }
+                    } else {
+                        for (uint16_t ib = 0; ib < _nbands; ++ib) {
+                            for (uint32_t y = oy0; y < oy1; ++y) {
+                                std::size_t row = std::size_t(ib) * T * T + std::size_t(y / f - ty * T) * T;
+                                const double *in = buf + ib * band_stride + std::size_t(y - y0) * w;
+                                for (uint32_t x = ox0; x < ox1; ++x) {
+                                    double v = in[x - x0];
+                                    if (std::isnan(v)) continue;
+                                    s.values[row + (x / f - tx * T)] += v;
+                                    s.count[row + (x / f - tx * T)] += 1;
+                                }
+                            }
+                        }
+                    }
+                }
+
+                if (s.received == expected_pixels(k, tx, ty)) {
+                    completed_tile c;
+                    c.level = k;
+                    c.tile = tile_idx;
+                    c.state = std::move(s);
+                    l.tiles.erase(tile_idx);
+                    completed.push_back(std::move(c));
+                }
+            }
+        }
+    }
+    _mutex.unlock();
+
+    // encode and write complete tiles without holding the lock
+    for (uint32_t i = 0; i < completed.size(); ++i) {
+        write_tile(completed[i]);
+    }
+}
+
+void cog_writer::write_tile(completed_tile &t) {
+    const std::size_t n = std::size_t(_tile_size) * _tile_size;
+    level_info &l = _levels[t.level];
+
+    if (_average && t.level > 0) {
+        for (std::size_t i = 0; i < t.state.values.size(); ++i) {
+            t.state.values[i] = t.state.count[i] > 0 ? t.state.values[i] / t.state.count[i] : NAN;
+        }
+    }
+
+    std::vector<uint8_t> raw(n * _value_size);
+    for (uint16_t ib = 0; ib < _nbands; ++ib) {
+        const double *in = t.state.values.data() + ib * n;
+        packing_kernels::pack_band(_packing, ib, in, raw.data(), n);
+
+        const void *out = raw.data();
+        uint64_t out_size = raw.size();
+        void *compressed = nullptr;
+        if (_deflate_level > 0) {
+            std::size_t compressed_size = 0;
+            compressed = CPLZLibDeflate(raw.data(), raw.size(), _deflate_level, nullptr, 0, &compressed_size);
+            if (!compressed) {
+                throw std::string("ERROR in cog_writer::write_tile(): compression failed for '" + _path + "'");
+            }
+            out = compressed;
+            out_size = compressed_size;
+        }
+
+        uint64_t idx = uint64_t(ib) * l.ntiles_x * l.ntiles_y + t.tile;
+        uint64_t offset = (idx == 0 && out_size <= _slot_size) ? l.reserved_pos : _next_offset.fetch_add(out_size);
+        bool ok = write_at(out, out_size, offset);
+        if (compressed) CPLFree(compressed);
+        if (!ok) {
+            throw std::string("ERROR in cog_writer::write_tile(): failed to write to '" + _path + "'");
+        }
+        l.offsets[idx] = offset;
+        l.bytecounts[idx] = out_size;
+    }
+}
+
+void cog_writer::finish() {
+    if (_finished) return;
+    _finished = true;
+
+    // tiles that did not receive all pixels, e.g. due to failed chunks
+    std::vector<completed_tile> remaining;
+    _mutex.lock();
+    for (uint16_t k = 0; k < _levels.size(); ++k) {
+        for (auto it = _levels[k].tiles.begin(); it != _levels[k].tiles.end(); ++it) {
+            completed_tile c;
+            c.level = k;
+            c.tile = it->first;
+            c.state = std::move(it->second);
+            remaining.push_back(std::move(c));
+        }
+        _levels[k].tiles.clear();
+    }
+    _mutex.unlock();
+    if (!remaining.empty()) {
+        GCBS_DEBUG(std::to_string(remaining.size()) + " incomplete tile(s) in '" + _path + "'");
+    }
+    for (uint32_t i = 0; i < remaining.size(); ++i) {
+        write_tile(remaining[i]);
+    }
+
+    bool ok = true;
+    for (uint16_t k = 0; k < _levels.size(); ++k) {
+        level_info &l = _levels[k];
+        if (_bigtiff) {
+            ok = ok && write_at(l.offsets.data(), l.offsets.size() * sizeof(uint64_t), l.offsets_pos);
+            ok = ok && write_at(l.bytecounts.data(), l.bytecounts.size() * sizeof(uint64_t), l.bytecounts_pos);
+        } else {
+            std::vector<uint32_t> offsets(l.offsets.begin(), l.offsets.end());
+            std::vector<uint32_t> bytecounts(l.bytecounts.begin(), l.bytecounts.end());
+            ok = ok && write_at(offsets.data(), offsets.size() * sizeof(uint32_t), l.offsets_pos);
+            ok = ok && write_at(bytecounts.data(), bytecounts.size() * sizeof(uint32_t), l.bytecounts_pos);
+        }
+    }
+
+#ifndef _WIN32
+    ok = (close(_fd) == 0) && ok;
+    _fd = -1;
+#else
+    _fout.close();
+    ok = !_fout.fail() && ok;
+#endif
+    if (!ok) {
+        throw std::string("ERROR in cog_writer::finish(): failed to write to '" + _path + "'");
+    }
+}
+
+}  // namespace gdalcubes
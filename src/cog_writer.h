@@ -0,0 +1,157 @@
+/*
+    MIT License
+
+    Copyright (c) 2026 Marius Appel <marius.appel@uni-muenster.de>
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+#ifndef COG_WRITER_H
+#define COG_WRITER_H
+
+#include <atomic>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "cube.h"
+
+namespace gdalcubes {
+
+/**
+ * @brief Streaming writer for single-band or multi-band cloud-optimized GeoTIFF files
+ *
+ * The writer receives rectangular blocks of full resolution data (e.g. from data cube chunks) in arbitrary order and
+ * from multiple threads. Full resolution tiles and tiles of all overview levels are assembled in memory and written
+ * as soon as they are complete; overview pixels are computed directly from full resolution pixels (nearest neighbor or average)
+ * and hence do not require chunks to be aligned with tiles. The file is never read: IFDs of all levels are written
+ * to the beginning of the file on construction and tile offsets are filled in by finish().
+ *
+ * Tiles are stored band-sequential (PlanarConfiguration = 2). The first tile of each level is written to a reserved area at the
+ * beginning of the data section such that the file layout follows the COG conventions (smallest overview first).
+ */
+class cog_writer {
+   public:
+    /**
+     * @brief Create a new file and write TIFF headers
+     * @param path output file
+     * @param nx number of columns
+     * @param ny number of rows
+     * @param band_names names of bands, written as band descriptions
+     * @param affine geotransform (left, dx, 0, top, 0, -dy)
+     * @param epsg EPSG code of the spatial reference system
+     * @param geographic true if the spatial reference system is geographic, false if projected
+     * @param packing output data type, scale, offset, and nodata values
+     * @param tile_size tile width and height in pixels
+     * @param deflate_level 0 = no compression, otherwise DEFLATE compression level
+     * @param resampling overview resampling method, see supports_resampling()
+     */
+    cog_writer(std::string path, uint32_t nx, uint32_t ny, std::vector<std::string> band_names, double affine[6], int epsg, bool geographic,
+               packed_export packing = packed_export::make_none(), uint32_t tile_size = 256, uint8_t deflate_level = 0, std::string resampling = "NEAREST");
+
+    ~cog_writer();
+
+    /**
+     * @brief Write a rectangular block of full resolution data
+     *
+     * This function is thread-safe.
+     * @param buf pointer to values of the first band, values of the following bands are expected at multiples of band_stride, nullptr for a block containing NAN only
+     * @param band_stride number of values between bands in buf
+     * @param x0 column of the first pixel
+     * @param y0 row of the first pixel
+     * @param w number of columns of the block
+     * @param h number of rows of the block
+     */
+    void write(const double *buf, std::size_t band_stride, uint32_t x0, uint32_t y0, uint32_t w, uint32_t h);
+
+    /**
+     * @brief Write remaining tiles and tile offsets and close the file
+     */
+    void finish();
+
+    /**
+     * @brief Check whether an overview resampling method is supported
+     */
+    static bool supports_resampling(std::string resampling);
+
+    /**
+     * @brief Number of overview levels for a raster of given size
+     */
+    static uint16_t count_overviews(uint32_t nx, uint32_t ny, uint32_t tile_size);
+
+   private:
+    struct tile_state {
+        uint64_t received = 0;       // number of full resolution pixels received within the footprint of the tile
+        std::vector<double> values;  // band-sequential tile values or sums (average resampling)
+        std::vector<uint32_t> count;  // number of values per sum (average resampling)
+    };
+
+    struct level_info {
+        uint32_t factor;
+        uint32_t width;
+        uint32_t height;
+        uint32_t ntiles_x;
+        uint32_t ntiles_y;
+        uint64_t offsets_pos;     // file position of TileOffsets values
+        uint64_t bytecounts_pos;  // file position of TileByteCounts values
+        uint64_t reserved_pos;    // reserved position of the first tile
+        std::vector<uint64_t> offsets;
+        std::vector<uint64_t> bytecounts;
+        std::map<uint32_t, tile_state> tiles;
+    };
+
+    struct completed_tile {
+        uint16_t level;
+        uint32_t tile;
+        tile_state state;
+    };
+
+    void write_tile(completed_tile &t);
+    void write_header();
+    bool write_at(const void *buf, uint64_t size, uint64_t offset);
+    uint64_t expected_pixels(uint16_t level, uint32_t tx, uint32_t ty);
+
+    std::string _path;
+    uint32_t _nx;
+    uint32_t _ny;
+    uint16_t _nbands;
+    std::vector<std::string> _band_names;
+    double _affine[6];
+    int _epsg;
+    bool _geographic;
+    packed_export _packing;
+    uint32_t _tile_size;
+    uint8_t _deflate_level;
+    bool _average;
+    uint8_t _value_size;
+    bool _bigtiff;
+    uint64_t _slot_size;
+    std::vector<level_info> _levels;
+    std::mutex _mutex;
+    std::atomic<uint64_t> _next_offset;
+    bool _finished;
+    int _fd;
+    std::fstream _fout;    // only used without positional writes
+    std::mutex _io_mutex;  // only used without positional writes
+};
+
+}  // namespace gdalcubes
+
+#endif  // COG_WRITER_H
@@ -0,0 +1,268 @@
+/*
+    MIT License
+
+    Copyright (c) 2026 Marius Appel <marius.appel@uni-muenster.de>
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+#ifndef CONCURRENT_LRU_CACHE_H
+#define CONCURRENT_LRU_CACHE_H
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace gdalcubes {
+
+/**
+ * @brief Thread-safe, size-bounded least recently used (LRU) cache
+ *
+ * Entries are distributed over a fixed number of shards by their hash. Each shard has its own mutex, a hash map
+ * and a recency list, such that lookups, insertions, and evictions take O(1) time and concurrent requests for
+ * different keys rarely block each other. Recency is exact within a shard; if an insertion requires space, the
+ * least recently used entries of the inserting shard are evicted first, followed by other shards.
+ *
+ * The total weight of entries (e.g. the size in bytes) is accounted exactly and never exceeds the capacity:
+ * space is reserved before an entry becomes visible and entries heavier than the capacity are not cached at all.
+ *
+ * @tparam Key key type
+ * @tparam Value value type, typically a std::shared_ptr
+ * @tparam Weight functor returning the weight of a value as uint64_t
+ * @tparam Hash hash functor for keys
+ */
+template <class Key, class Value, class Weight, class Hash = std::hash<Key>>
+class concurrent_lru_cache {
+   public:
+    /**
+     * @brief Construct an empty cache
+     * @param capacity maximum total weight of cached entries
+     * @param nshards number of independently locked shards
+     */
+    concurrent_lru_cache(uint64_t capacity, uint16_t nshards = 16) : _shards(nshards == 0 ? 1 : nshards), _capacity(capacity), _size(0), _hits(0), _misses(0), _evictions(0) {
+        for (uint16_t i = 0; i < _shards.size(); ++i) {
+            _shards[i].reset(new shard());
+        }
+    }
+
+    concurrent_lru_cache(const concurrent_lru_cache &) = delete;
+    concurrent_lru_cache &operator=(const concurrent_lru_cache &) = delete;
+
+    /**
+     * @brief Add or replace an entry and mark it as most recently used
+     * @param key key
+     * @param value value
+     * @return false if the value is heavier than the capacity and has not been added, true otherwise
+     */
+    bool put(const Key &key, Value value) {
+        uint64_t w = Weight()(value);
+        if (w > _capacity.load()) {
+            remove(key);  // never return outdated values
+            return false;
+        }
+        uint16_t s = shard_index(key);
+        shard &sh = *_shards[s];
+
+        // replacing an existing entry releases its weight first
+        remove(key);
+
+        // reserve space, evicting LRU entries as needed
+        uint64_t cur = _size.load();
+        while (true) {
+            if (w > _capacity.load()) {
+                return false;  // capacity has been reduced concurrently
+            }
+            if (cur + w <= _capacity.load()) {
+                if (_size.compare_exchange_weak(cur, cur + w)) break;
+                continue;
+            }
+            if (!evict_one(s)) {
+                // space is reserved by concurrent insertions that are not yet visible
+                std::this_thread::yield();
+            }
+            cur = _size.load();
+        }
+
+        std::lock_guard<std::mutex> lock(sh.m);
+        auto it = sh.index.find(key);
+        if (it != sh.index.end()) {
+            // concurrent insertion of the same key won, keep the newer value
+            _size -= it->second->weight;
+            sh.lru.erase(it->second);
+            sh.index.erase(it);
+        }
+        sh.lru.push_front(entry{key, std::move(value), w});
+        sh.index[key] = sh.lru.begin();
+        return true;
+    }
+
+    /**
+     * @brief Find an entry and mark it as most recently used
+     * @param key key
+     * @param[out] value value of the entry, unchanged if not found
+     * @return true if the entry has been found
+     */
+    bool get(const Key &key, Value &value) {
+        shard &sh = *_shards[shard_index(key)];
+        std::lock_guard<std::mutex> lock(sh.m);
+        auto it = sh.index.find(key);
+        if (it == sh.index.end()) {
+            ++_misses;
+            return false;
+        }
+        sh.lru.splice(sh.lru.begin(), sh.lru, it->second);  // iterators remain valid
+        value = it->second->value;
+        ++_hits;
+        return true;
+    }
+
+    /**
+     * @brief Check whether an entry exists without changing its recency or cache statistics
+     * @param key key
+     */
+    bool contains(const Key &key) {
+        shard &sh = *_shards[shard_index(key)];
+        std::lock_guard<std::mutex> lock(sh.m);
+        return sh.index.find(key) != sh.index.end();
+    }
+
+    /**
+     * @brief Remove an entry, if it exists
+     * @param key key
+     * @return true if the entry has been removed
+     */
+    bool remove(const Key &key) {
+        shard &sh = *_shards[shard_index(key)];
+        std::lock_guard<std::mutex> lock(sh.m);
+        auto it = sh.index.find(key);
+        if (it == sh.index.end()) {
+            return false;
+        }
+        _size -= it->second->weight;
+        sh.lru.erase(it->second);
+        sh.index.erase(it);
+        return true;
+    }
+
+    /**
+     * @brief Remove all entries
+     */
+    void clear() {
+        for (uint16_t i = 0; i < _shards.size(); ++i) {
+            std::lock_guard<std::mutex> lock(_shards[i]->m);
+            for (auto it = _shards[i]->lru.begin(); it != _shards[i]->lru.end(); ++it) {
+                _size -= it->weight;
+            }
+            _shards[i]->lru.clear();
+            _shards[i]->index.clear();
+        }
+    }
+
+    /**
+     * @brief Change the capacity, entries exceeding the new capacity are evicted
+     * @param capacity new maximum total weight of entries
+     */
+    void capacity(uint64_t capacity) {
+        _capacity = capacity;
+        uint16_t s = 0;
+        while (_size.load() > _capacity.load() && evict_one(s)) {
+            s = (s + 1) % _shards.size();
+        }
+    }
+
+    inline uint64_t capacity() { return _capacity.load(); }
+
+    /**
+     * @brief Get the total weight of all entries
+     */
+    inline uint64_t size() { return _size.load(); }
+
+    /**
+     * @brief Get the number of entries
+     */
+    uint64_t count() {
+        uint64_t n = 0;
+        for (uint16_t i = 0; i < _shards.size(); ++i) {
+            std::lock_guard<std::mutex> lock(_shards[i]->m);
+            n += _shards[i]->index.size();
+        }
+        return n;
+    }
+
+    inline uint64_t hits() { return _hits.load(); }
+    inline uint64_t misses() { return _misses.load(); }
+    inline uint64_t evictions() { return _evictions.load(); }
+
+   private:
+    struct entry {
+        Key key;
+        Value value;
+        uint64_t weight;
+    };
+
+    struct shard {
+        std::mutex m;
+        std::list<entry> lru;  // front is most recently used
+        std::unordered_map<Key, typename std::list<entry>::iterator, Hash> index;
+    };
+
+    inline uint16_t shard_index(const Key &key) {
+        // mix bits, std::hash of integers is the identity for common standard libraries
+        uint64_t h = uint64_t(Hash()(key)) * UINT64_C(0x9E3779B97F4A7C15);
+        return uint16_t((h >> 32) % _shards.size());
+    }
+
+    /**
+     * Evict the least recently used entry of shard s or, if empty, of the next nonempty shard
+     * @return false if all shards are empty
+     */
+    bool evict_one(uint16_t s) {
+        for (uint16_t i = 0; i < _shards.size(); ++i) {
+            shard &sh = *_shards[(s + i) % _shards.size()];
+            Value victim;  // released after unlocking
+            {
+                std::lock_guard<std::mutex> lock(sh.m);
+                if (sh.lru.empty()) continue;
+                entry &e = sh.lru.back();
+                victim = std::move(e.value);
+                _size -= e.weight;
+                sh.index.erase(e.key);
+                sh.lru.pop_back();
+            }
+            ++_evictions;
+            return true;
+        }
+        return false;
+    }
+
+    std::vector<std::unique_ptr<shard>> _shards;
+    std::atomic<uint64_t> _capacity;
+    std::atomic<uint64_t> _size;
+    std::atomic<uint64_t> _hits;
+    std::atomic<uint64_t> _misses;
+    std::atomic<uint64_t> _evictions;
+};
+
+}  // namespace gdalcubes
+
+#endif  // CONCURRENT_LRU_CACHE_H
@@ -32,6 +32,8 @@
 #include <ogr_geometry.h>
 
 #include "cube.h"
+#include "stream_worker_pool.h"
+#include "trace_recorder.h"
 
 namespace gdalcubes {
 
@@ -43,10 +45,24 @@ config::config() : _chunk_processor(std::make_shared<chunk_processor_singlethrea
                    _gdal_cache_max(1024 * 1024 * 256),         // 256 MiB
                    _server_chunkcache_max(1024 * 1024 * 512),  // 512 MiB
                    _server_worker_threads_max(1),
+                   _server_result_cache(false),
+                   _server_result_cache_max(uint64_t(1024) * 1024 * 1024 * 4),  // 4 GiB
                    _swarm_curl_verbose(false),
+                   _swarm_compression(1),  // chunk_wire::SHUFFLE_RLE
+                   _swarm_max_requests_per_server(8),
+                   _swarm_chunks_per_server(4),
                    _gdal_num_threads(1),
                    _gdal_use_overviews(true),
                    _streaming_dir(filesystem::get_tempdir()),
+                   _streaming_workers(0),
+                   _streaming_worker_timeout(3600),
+                   _streaming_shm(false),
+                   _approx_quantile_compression(50),
+                   _collection_read_only(false),
+                   _collection_index_threads(1),
+                   _netcdf_write_ordered(false),
+                   _resumable_exports(false),
+                   _trace_file(),
                    _collection_format_preset_dirs() {}
 
 version_info config::get_version_info() {
@@ -116,6 +132,18 @@ void config::gdal_err_handler_default(CPLErr eErrClass, int err_no, const char *
     return;
 }
 
+void config::set_trace_file(std::string path) {
+    if (!_trace_file.empty() && trace_recorder::enabled()) {
+        trace_recorder::stop();
+        trace_recorder::write(_trace_file);
+        GCBS_INFO("Trace events have been written to '" + _trace_file + "'");
+    }
+    _trace_file = path;
+    if (!_trace_file.empty()) {
+        trace_recorder::start();
+    }
+}
+
 void config::gdal_err_handler_silent(CPLErr eErrClass, int err_no, const char *msg) {
     return;
 }
@@ -142,6 +170,10 @@ void config::gdalcubes_init() {
 #endif
     CPLSetConfigOption("GDAL_DISABLE_READDIR_ON_OPEN", "TRUE");  // avoid directory scans for every opened GDAL dataset
 
+    if (std::getenv("GDALCUBES_TRACE") != NULL) {
+        set_trace_file(std::getenv("GDALCUBES_TRACE"));
+    }
+
     // Add default locations where to look for collection format presets
     if (std::getenv("GDALCUBES_DATA_DIR") != NULL) {
         if (filesystem::exists(std::getenv("GDALCUBES_DATA_DIR"))) {
@@ -179,6 +211,12 @@ void config::gdalcubes_init() {
 }
 
 void config::gdalcubes_cleanup() {
+    stream_worker_pool::shutdown_all();
+    try {
+        set_trace_file("");
+    } catch (std::string s) {
+        GCBS_WARN(s);
+    }
 #ifndef GDALCUBES_NO_SWARM
     curl_global_cleanup();
 #endif
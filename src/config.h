@@ -128,17 +128,82 @@ class config {
         return _server_worker_threads_max;
     }
 
+    // persist computed chunks in the working directory of gdalcubes_server and reuse them for identical cubes
+    inline bool get_server_result_cache() { return _server_result_cache; }
+    inline void set_server_result_cache(bool persist) { _server_result_cache = persist; }
+
+    // maximum total size of persisted chunks of gdalcubes_server, least recently used chunks are removed first
+    inline uint64_t get_server_result_cache_max() { return _server_result_cache_max; }
+    inline void set_server_result_cache_max(uint64_t size_bytes) { _server_result_cache_max = size_bytes; }
+
     inline bool get_gdal_use_overviews() { return _gdal_use_overviews; }
     inline void set_gdal_use_overviews(bool use_overviews) { _gdal_use_overviews = use_overviews; }
 
     inline bool get_swarm_curl_verbose() { return _swarm_curl_verbose; }
     inline void set_swarm_curl_verbose(bool verbose) { _swarm_curl_verbose = verbose; }
 
+    // Get / set the compression of chunks downloaded from gdalcubes_server instances, see chunk_wire::compression
+    inline uint8_t get_swarm_compression() { return _swarm_compression; }
+    inline void set_swarm_compression(uint8_t compression) { _swarm_compression = compression; }
+
+    // Get / set the maximum number of concurrent HTTP requests per gdalcubes_server instance of a swarm
+    inline uint16_t get_swarm_max_requests_per_server() { return _swarm_max_requests_per_server; }
+    inline void set_swarm_max_requests_per_server(uint16_t n) { _swarm_max_requests_per_server = n; }
+
+    // Get / set the maximum number of chunks that are assigned to a gdalcubes_server instance of a swarm at the same time
+    inline uint16_t get_swarm_chunks_per_server() { return _swarm_chunks_per_server; }
+    inline void set_swarm_chunks_per_server(uint16_t n) { _swarm_chunks_per_server = n; }
+
     // Get / set directory where to store chunk data for file-based streaming. This
     // should ideally fast storage like a ramdisk such as /dev/shm
     inline std::string get_streaming_dir() { return _streaming_dir; }
     inline void set_streaming_dir(std::string dir) { _streaming_dir = dir; }
 
+    // Get / set the number of persistent worker processes per streaming command. If zero (default), a new process is
+    // started for each chunk, otherwise the external program must implement the protocol of stream_worker_pool
+    inline uint16_t get_streaming_workers() { return _streaming_workers; }
+    inline void set_streaming_workers(uint16_t workers) { _streaming_workers = workers; }
+
+    // Get / set the maximum time in seconds a persistent streaming worker may take for one chunk before it is killed
+    // and restarted, zero means no limit
+    inline uint32_t get_streaming_worker_timeout() { return _streaming_worker_timeout; }
+    inline void set_streaming_worker_timeout(uint32_t seconds) { _streaming_worker_timeout = seconds; }
+
+    // Get / set whether streaming operators exchange chunk data in POSIX shared memory (Linux only) instead of
+    // files in the streaming directory, see stream_transport. Disabled by default, since /dev/shm is often small
+    // e.g. in containers
+    inline bool get_streaming_shm() { return _streaming_shm; }
+    inline void set_streaming_shm(bool shm) { _streaming_shm = shm; }
+
+    // Get / set the compression parameter of sketches used by approximate quantile reducers such as
+    // "median_approx". Larger values reduce the approximation error but need more memory per pixel.
+    inline uint16_t get_approx_quantile_compression() { return _approx_quantile_compression; }
+    inline void set_approx_quantile_compression(uint16_t compression) { _approx_quantile_compression = compression; }
+
+    // Get / set whether image collection cubes open collection files in read-only mode, see
+    // image_collection::is_read_only(). Collection files must not be modified while being read.
+    inline bool get_collection_read_only() { return _collection_read_only; }
+    inline void set_collection_read_only(bool read_only) { _collection_read_only = read_only; }
+
+    // Get / set the number of threads used to read metadata of GDAL datasets while adding them to image collections
+    inline uint16_t get_collection_index_threads() { return _collection_index_threads; }
+    inline void set_collection_index_threads(uint16_t threads) { _collection_index_threads = threads; }
+
+    // Get / set whether chunks are written to netCDF files in order of their ids, which corresponds to the
+    // order of netCDF storage chunks and leads to sequential disk access at the cost of some buffering
+    inline bool get_netcdf_write_ordered() { return _netcdf_write_ordered; }
+    inline void set_netcdf_write_ordered(bool ordered) { _netcdf_write_ordered = ordered; }
+
+    // Get / set whether chunk-wise exports (chunk netCDF / GeoTIFF files, Zarr, chunk store) record completed chunks
+    // in a journal file and resume interrupted exports, see chunk_journal
+    inline bool get_resumable_exports() { return _resumable_exports; }
+    inline void set_resumable_exports(bool resumable) { _resumable_exports = resumable; }
+
+    // Get / set the output file of a Chrome trace event timeline (see trace_recorder), setting a file starts recording,
+    // events are written when setting another file, an empty string, or on gdalcubes_cleanup()
+    inline std::string get_trace_file() { return _trace_file; }
+    void set_trace_file(std::string path);
+
     inline bool get_gdal_debug() { return _gdal_debug; }
     void set_gdal_debug(bool debug);
 
@@ -162,8 +227,23 @@ class config {
    */
     version_info get_version_info();
 
+    /**
+     * @brief Set the function that handles error, warning, and log messages
+     *
+     * Also sets the level of messages passed to the handler (see logger::set_level()), such that messages ignored by
+     * the handler are not even formatted. Custom handlers receive all messages, unless logger::set_level() is called
+     * afterwards.
+     * @param f error handler
+     */
     inline void set_error_handler(error_action f) {
         _error_handler = f;
+        if (f == error_handler::default_error_handler) {
+            logger::set_level(error_level::ERRLVL_WARNING);
+        } else if (f == error_handler::error_handler_debug || f == error_handler::error_handler_debug_server) {
+            logger::set_level(error_level::ERRLVL_DEBUG);
+        } else {
+            logger::set_level(error_level::ERRLVL_TRACE);
+        }
     }
 
     inline error_action get_error_handler() {
@@ -193,11 +273,25 @@ class config {
     uint32_t _gdal_cache_max;
     uint32_t _server_chunkcache_max;
     uint16_t _server_worker_threads_max;  // number of threads for parallel chunk reads
+    bool _server_result_cache;
+    uint64_t _server_result_cache_max;
     bool _swarm_curl_verbose;
+    uint8_t _swarm_compression;
+    uint16_t _swarm_max_requests_per_server;
+    uint16_t _swarm_chunks_per_server;
     uint16_t _gdal_num_threads;
     bool _gdal_debug;
     bool _gdal_use_overviews;
     std::string _streaming_dir;
+    uint16_t _streaming_workers;
+    uint32_t _streaming_worker_timeout;
+    bool _streaming_shm;
+    uint16_t _approx_quantile_compression;
+    bool _collection_read_only;
+    uint16_t _collection_index_threads;
+    bool _netcdf_write_ordered;
+    bool _resumable_exports;
+    std::string _trace_file;
     std::vector<std::string> _collection_format_preset_dirs;
 
    private:
@@ -28,12 +28,24 @@ SOFTWARE.
 #include <netcdf.h>
 
 #include <algorithm>  // std::transform
+#include <atomic>
 #include <fstream>
+#include <sstream>
 #include <thread>
 #include <cstring>
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 #include "build_info.h"
+#include "chunk_journal.h"
+#include "chunk_write_queue.h"
+#include "chunkstore_cube.h"
+#include "cog_writer.h"
 #include "filesystem.h"
+#include "packing.h"
 
 #if defined(R_PACKAGE) && defined(__sun) && defined(__SVR4)
 #define USE_NCDF4 0
@@ -66,10 +78,17 @@ void cube::write_chunks_gtiff(std::string dir, std::shared_ptr<chunk_processor>
     // NOTE: the following will only work as long as all cube st reference types with regular spatial dimensions inherit from  cube_stref_regular class
     std::shared_ptr<cube_stref_regular> stref = std::dynamic_pointer_cast<cube_stref_regular>(_st_ref);
 
+    std::shared_ptr<chunk_journal> journal;
+    if (config::instance()->get_resumable_exports()) {
+        journal = std::make_shared<chunk_journal>(filesystem::join(dir, "chunks.journal"),
+                                                  chunk_journal::make_key(make_constructible_json().dump() + "|gtiff_chunks"));
+    }
+
     std::shared_ptr<progress> prg = config::instance()->get_default_progress_bar()->get();
-    prg->set(0);  // explicitly set to zero to show progress bar immediately
+    prg->set(journal ? (double)journal->count_done() / (double)count_chunks() : 0);  // explicitly set to show progress bar immediately
 
-    std::function<void(chunkid_t, std::shared_ptr<chunk_data>, std::mutex &)> f = [this, dir, prg, gtiff_driver, stref](chunkid_t id, std::shared_ptr<chunk_data> dat, std::mutex &m) {
+    std::function<void(chunkid_t, std::shared_ptr<chunk_data>, std::mutex &)> f = [this, dir, prg, gtiff_driver, stref, journal](chunkid_t id, std::shared_ptr<chunk_data> dat, std::mutex &m) {
+        bool ok = true;
         bounds_st cextent = this->bounds_from_chunk(id);  // implemented in derived classes
         double affine[6];
         affine[0] = cextent.s.left;
@@ -92,6 +111,7 @@ void cube::write_chunks_gtiff(std::string dir, std::shared_ptr<chunk_processor>
                 CPLErr res = gdal_out->GetRasterBand(1)->RasterIO(GF_Write, 0, 0, dat->size()[3], dat->size()[2], ((double *)dat->buf()) + (ib * dat->size()[1] * dat->size()[2] * dat->size()[3] + it * dat->size()[2] * dat->size()[3]), dat->size()[3], dat->size()[2], GDT_Float64, 0, 0, NULL);
                 if (res != CE_None) {
                     GCBS_WARN("RasterIO (write) failed for band " + _bands.get(ib).name);
+                    ok = false;
                 }
                 gdal_out->GetRasterBand(1)->SetNoDataValue(std::stod(_bands.get(ib).no_data_value));
                 char *wkt_out;
@@ -106,10 +126,16 @@ void cube::write_chunks_gtiff(std::string dir, std::shared_ptr<chunk_processor>
                 GDALClose(gdal_out);
             }
         }
+        if (journal && ok) journal->done(id);
         prg->increment((double)1 / (double)this->count_chunks());
     };
 
-    p->apply(shared_from_this(), f);
+    if (journal) {
+        p->apply(shared_from_this(), journal->remaining(count_chunks()), f);
+        journal->finish(count_chunks());
+    } else {
+        p->apply(shared_from_this(), f);
+    }
     prg->finalize();
 }
 
@@ -187,6 +213,168 @@ void cube::write_tif_collection(std::string dir, std::string prefix,
     std::shared_ptr<progress> prg = config::instance()->get_default_progress_bar()->get();
     prg->set(0);  // explicitly set to zero to show progress bar immediately
 
+    // COGs are streamed directly from chunks if possible, i.e. overviews are computed
+    // while chunks arrive and no temporary file must be read again
+    if (cog) {
+        std::string reason;
+        uint32_t tile_size = 256;
+        uint8_t deflate_level = 0;
+        bool compress = false;
+        for (auto it = creation_options.begin(); it != creation_options.end() && reason.empty(); ++it) {
+            std::string key = it->first;
+            std::string value = it->second;
+            std::transform(key.begin(), key.end(), key.begin(), (int (*)(int))std::toupper);
+            std::transform(value.begin(), value.end(), value.begin(), (int (*)(int))std::toupper);
+            if (key == "TILED" || key == "COPY_SRC_OVERVIEWS") {
+                GCBS_WARN("Setting" + it->first + "=" + it->second + "is not allowed, ignoring GeoTIFF creation option.");
+            } else if (key == "BLOCKXSIZE" || key == "BLOCKYSIZE") {
+                tile_size = std::atoi(it->second.c_str());
+            } else if (key == "COMPRESS") {
+                if (value == "DEFLATE") {
+                    compress = true;
+                } else if (value != "NONE") {
+                    reason = it->first + "=" + it->second;
+                }
+            } else if (key == "ZLEVEL") {
+                deflate_level = std::atoi(it->second.c_str());
+            } else if (key == "BIGTIFF") {
+                if (value != "IF_NEEDED" && value != "IF_SAFER") {
+                    reason = it->first + "=" + it->second;
+                }
+            } else {
+                reason = it->first + "=" + it->second;
+            }
+        }
+        if (compress && deflate_level == 0) {
+            deflate_level = 6;
+        }
+        if (!compress) {
+            deflate_level = 0;
+        }
+        if (reason.empty() && creation_options.find("BLOCKXSIZE") != creation_options.end() && creation_options.find("BLOCKYSIZE") != creation_options.end() &&
+            creation_options["BLOCKXSIZE"] != creation_options["BLOCKYSIZE"]) {
+            reason = "non-square blocks";
+        }
+        if (reason.empty() && (tile_size == 0 || tile_size % 16 != 0)) {
+            reason = "block size not a multiple of 16";
+        }
+        if (reason.empty() && !cog_writer::supports_resampling(overview_resampling)) {
+            reason = "overview resampling " + overview_resampling;
+        }
+
+        OGRSpatialReference srs = st_reference()->srs_ogr();
+        srs.AutoIdentifyEPSG();
+        int epsg = 0;
+        if (reason.empty()) {
+            const char *auth_name = srs.GetAuthorityName(NULL);
+            const char *auth_code = srs.GetAuthorityCode(NULL);
+            if (auth_name && auth_code && std::string(auth_name) == "EPSG") {
+                epsg = std::atoi(auth_code);
+            }
+            if (epsg <= 0 || epsg > 65535) {
+                reason = "spatial reference system without EPSG code";
+            }
+        }
+
+        if (!reason.empty()) {
+            GCBS_DEBUG("Falling back to GDAL for COG export (" + reason + ")");
+        } else {
+            double affine[6];
+            affine[0] = st_reference()->left();
+            affine[3] = st_reference()->top();
+            affine[1] = stref->dx();
+            affine[5] = -stref->dy();
+            affine[2] = 0.0;
+            affine[4] = 0.0;
+
+            std::vector<std::string> band_names;
+            for (uint16_t ib = 0; ib < size_bands(); ++ib) {
+                band_names.push_back(_bands.get(ib).name);
+            }
+
+            // writers are opened when the first chunk of a time chunk arrives and closed after its last chunk,
+            // such that only few files are open and tiles of few time slices are held in memory
+            std::function<std::vector<std::shared_ptr<cog_writer>>(uint32_t)> open_writers = [this, &dir, &prefix, &band_names, &affine, epsg, &srs, &packing, tile_size, deflate_level, &overview_resampling](uint32_t ct) {
+                std::vector<std::shared_ptr<cog_writer>> out;
+                uint32_t it_end = std::min((ct + 1) * chunk_size()[0], size_t());
+                for (uint32_t it = ct * chunk_size()[0]; it < it_end; ++it) {
+                    std::string name = filesystem::join(dir, prefix + st_reference()->datetime_at_index(it).to_string() + ".tif");
+                    out.push_back(std::make_shared<cog_writer>(name, size_x(), size_y(), band_names, affine, epsg, srs.IsGeographic(), packing, tile_size, deflate_level, overview_resampling));
+                }
+                return out;
+            };
+
+            std::vector<std::vector<std::shared_ptr<cog_writer>>> writers(count_chunks_t());
+            std::vector<uint32_t> chunks_left(count_chunks_t(), count_chunks_x() * count_chunks_y());
+            std::mutex mtx_writers;
+            std::vector<std::string> errors;
+
+            std::function<void(chunkid_t, std::shared_ptr<chunk_data>, std::mutex &)> f = [this, prg, &writers, &chunks_left, &mtx_writers, &errors, &open_writers](chunkid_t id, std::shared_ptr<chunk_data> dat, std::mutex &m) {
+                uint32_t ct = chunk_coords_from_id(id)[0];
+                std::vector<std::shared_ptr<cog_writer>> w;
+                {
+                    std::lock_guard<std::mutex> lock(mtx_writers);
+                    if (writers[ct].empty()) {
+                        writers[ct] = open_writers(ct);
+                    }
+                    w = writers[ct];
+                }
+
+                // empty chunks still count towards complete tiles
+                bounds_nd<uint32_t, 3> climits = chunk_limits(id);
+                uint32_t nt = climits.high[0] - climits.low[0] + 1;
+                uint32_t ny = climits.high[1] - climits.low[1] + 1;
+                uint32_t nx = climits.high[2] - climits.low[2] + 1;
+                for (uint32_t it = 0; it < nt; ++it) {
+                    const double *buf = dat->empty() ? nullptr : ((const double *)dat->buf()) + std::size_t(it) * ny * nx;
+                    w[it]->write(buf, std::size_t(nt) * ny * nx, climits.low[2], climits.low[1], nx, ny);
+                }
+
+                bool last = false;
+                {
+                    std::lock_guard<std::mutex> lock(mtx_writers);
+                    last = (--chunks_left[ct] == 0);
+                    if (last) writers[ct].clear();
+                }
+                if (last) {
+                    for (uint32_t it = 0; it < w.size(); ++it) {
+                        try {
+                            w[it]->finish();
+                        } catch (std::string s) {
+                            std::lock_guard<std::mutex> lock(mtx_writers);
+                            errors.push_back(s);
+                        }
+                    }
+                }
+                prg->increment((double)1 / (double)this->count_chunks());
+            };
+            p->apply(shared_from_this(), f);
+
+            // time chunks with failed chunks are still open, time chunks without any successful chunk have not been created yet
+            for (uint32_t ct = 0; ct < count_chunks_t(); ++ct) {
+                if (chunks_left[ct] == 0) continue;
+                try {
+                    if (writers[ct].empty()) {
+                        writers[ct] = open_writers(ct);
+                    }
+                    for (uint32_t it = 0; it < writers[ct].size(); ++it) {
+                        writers[ct][it]->finish();
+                    }
+                } catch (std::string s) {
+                    errors.push_back(s);
+                }
+                writers[ct].clear();
+            }
+            if (!errors.empty()) {
+                prg->finalize();
+                throw std::string("ERROR in cube::write_tif_collection(): " + std::to_string(errors.size()) + " file(s) could not be written, first error: " + errors[0]);
+            }
+            prg->set(1.0);
+            prg->finalize();
+            return;
+        }
+    }
+
     // avoid parallel RasterIO calls writing to the same file
     std::map<uint32_t, std::mutex> mtx;  // time_slice_index -> mutex
 
@@ -267,13 +455,32 @@ void cube::write_tif_collection(std::string dir, std::string prefix,
         GDALClose((GDALDatasetH)gdal_out);
     }
 
-    std::function<void(chunkid_t, std::shared_ptr<chunk_data>, std::mutex &)> f = [this, dir, prg, &mtx, &prefix, &packing, cog, overviews](chunkid_t id, std::shared_ptr<chunk_data> dat, std::mutex &m) {
+    std::function<void(chunkid_t, std::shared_ptr<chunk_data>, std::mutex &)> f = [this, dir, prg, &mtx, &prefix, &packing, ot, cog, overviews](chunkid_t id, std::shared_ptr<chunk_data> dat, std::mutex &m) {
         if (!dat->empty()) {
             for (uint32_t it = 0; it < dat->size()[1]; ++it) {
                 uint32_t cur_t_index = chunk_limits(id).low[0] + it;
                 std::string name = cog ? filesystem::join(dir, prefix + st_reference()->datetime_at_index(cur_t_index).to_string() + "_temp.tif") : filesystem::join(dir, prefix + st_reference()->datetime_at_index(cur_t_index).to_string() + ".tif");
 
+                std::size_t n = std::size_t(dat->size()[2]) * dat->size()[3];
+
+                /*
+                 * If band of cube already has scale + offset, we do not apply this before.
+                 * As a consequence, provided scale and offset values refer to actual data values
+                 * but ignore band metadata.
+                 */
+                // pack before acquiring the lock, the chunk buffer remains unmodified
+                std::vector<uint8_t> packed;
+                if (packing.type != packed_export::packing_type::PACK_NONE) {
+                    packed.resize(size_bands() * n * GDALGetDataTypeSizeBytes(ot));
+                    for (uint16_t ib = 0; ib < size_bands(); ++ib) {
+                        packing_kernels::pack_band(packing, ib, ((double *)dat->buf()) + (ib * dat->size()[1] * n + it * n), packed.data() + ib * n * GDALGetDataTypeSizeBytes(ot), n);
+                    }
+                }
+
+                trace_span span_wait("lock_wait", "writer", id);
                 mtx[cur_t_index].lock();
+                span_wait.end();
+                trace_span span_write("write_slice", "writer", id);
                 GDALDataset *gdal_out = (GDALDataset *)GDALOpen(name.c_str(), GA_Update);
                 if (!gdal_out) {
                     GCBS_WARN("GDAL failed to open " + name);
@@ -281,53 +488,15 @@ void cube::write_tif_collection(std::string dir, std::string prefix,
                     continue;
                 }
 
-                // apply packing
-                if (packing.type != packed_export::packing_type::PACK_NONE) {
-                    for (uint16_t ib = 0; ib < size_bands(); ++ib) {
-                        double cur_scale;
-                        double cur_offset;
-                        double cur_nodata;
-                        if (packing.scale.size() == size_bands()) {
-                            cur_scale = packing.scale[ib];
-                            cur_offset = packing.offset[ib];
-                            cur_nodata = packing.nodata[ib];
-                        } else {
-                            cur_scale = packing.scale[0];
-                            cur_offset = packing.offset[0];
-                            cur_nodata = packing.nodata[0];
-                        }
-
-                        /*
-                         * If band of cube already has scale + offset, we do not apply this before.
-                         * As a consequence, provided scale and offset values refer to actual data values
-                         * but ignore band metadata. The following commented code would apply the
-                         * unpacking before
-                         */
-                        /*
-                        if (bands().get(ib).scale != 1 || bands().get(ib).offset != 0) {
-                            for (uint32_t i = 0; i < dat->size()[2] * dat->size()[3]; ++i) {
-                                double &v = ((double *)(dat->buf()))[ib * dat->size()[1] * dat->size()[2] * dat->size()[3] +
-                                                                     it * dat->size()[2] * dat->size()[3]  + i];
-                                v = v * bands().get(ib).scale + bands().get(ib).offset;
-                            }
-                        } */
-
-                        for (uint32_t i = 0; i < dat->size()[2] * dat->size()[3]; ++i) {
-                            double &v = ((double *)(dat->buf()))[ib * dat->size()[1] * dat->size()[2] * dat->size()[3] +
-                                                                 it * dat->size()[2] * dat->size()[3] + i];
-                            if (std::isnan(v)) {
-                                v = cur_nodata;
-                            } else {
-                                v = std::round((v - cur_offset) / cur_scale);  // use std::round to avoid truncation bias
-                            }
-                        }
-                    }
-                }  // if packing
-
                 for (uint16_t ib = 0; ib < size_bands(); ++ib) {
+                    void *band_buf;
+                    if (packing.type != packed_export::packing_type::PACK_NONE) {
+                        band_buf = (void *)(packed.data() + ib * n * GDALGetDataTypeSizeBytes(ot));
+                    } else {
+                        band_buf = (void *)(((double *)dat->buf()) + (ib * dat->size()[1] * n + it * n));
+                    }
                     CPLErr res = gdal_out->GetRasterBand(ib + 1)->RasterIO(GF_Write, chunk_limits(id).low[2], chunk_limits(id).low[1], dat->size()[3], dat->size()[2],
-                                                                           ((double *)dat->buf()) + (ib * dat->size()[1] * dat->size()[2] * dat->size()[3] + it * dat->size()[2] * dat->size()[3]),
-                                                                           dat->size()[3], dat->size()[2], GDT_Float64, 0, 0, NULL);
+                                                                           band_buf, dat->size()[3], dat->size()[2], ot, 0, 0, NULL);
                     if (res != CE_None) {
                         GCBS_WARN("RasterIO (write) failed for " + name);
                         break;
@@ -595,7 +764,10 @@ void cube::write_png_collection(std::string dir, std::string prefix, std::vector
             for (uint32_t it = 0; it < dat->size()[1]; ++it) {
                 uint32_t cur_t_index = chunk_limits(id).low[0] + it;
                 std::string name = filesystem::join(tempdir, std::to_string(cur_t_index) + ".tif");
+                trace_span span_wait("lock_wait", "writer", id);
                 mtx[cur_t_index].lock();
+                span_wait.end();
+                trace_span span_write("write_slice", "writer", id);
                 GDALDataset *gdal_out = (GDALDataset *)GDALOpen(name.c_str(), GA_Update);
                 if (!gdal_out) {
                     GCBS_WARN("GDAL failed to open " + name);
@@ -1069,138 +1241,66 @@ void cube::write_netcdf_file(std::string path, uint8_t compression_level, bool w
         if (dim_x_bnds) std::free(dim_x_bnds);
     }
 
-    std::function<void(chunkid_t, std::shared_ptr<chunk_data>, std::mutex &)> f = [this, op, prg, &v_bands, ncout, &packing](chunkid_t id, std::shared_ptr<chunk_data> dat, std::mutex &m) {
+    // size of packed values in bytes, zero if no packing is applied
+    uint8_t packed_size = packing.type == packed_export::packing_type::PACK_NONE ? 0 : packing_kernels::value_size(packing.type);
+
+    // All netCDF calls happen in a single writer thread, workers only pack chunks and pass them to the writer
+    // ordered writes need more space to buffer chunks that are finished early
+    bool ordered = config::instance()->get_netcdf_write_ordered();
+    uint32_t queue_size = std::max(uint32_t(2), (ordered ? 4 : 2) * p->max_threads());
+    chunk_write_queue writer(queue_size, ordered, [this, &v_bands, ncout, packed_size](chunk_write_job &job) {
+        bounds_nd<uint32_t, 3> climits = chunk_limits(job.id);
+        std::size_t startp[] = {climits.low[0], climits.low[1], climits.low[2]};
+        std::size_t countp[] = {climits.high[0] - climits.low[0] + 1, climits.high[1] - climits.low[1] + 1, climits.high[2] - climits.low[2] + 1};
+        std::size_t n = countp[0] * countp[1] * countp[2];
+        for (uint16_t i = 0; i < bands().count(); ++i) {
+            void *band_buf;
+            if (packed_size > 0) {
+                band_buf = (void *)(job.packed.data() + i * n * packed_size);
+            } else {
+                band_buf = (void *)(((double *)job.dat->buf()) + i * n);
+            }
+            int res = nc_put_vara(ncout, v_bands[i], startp, countp, band_buf);
+            if (res != NC_NOERR) {
+                throw std::string("Failed to write chunk " + std::to_string(job.id) + " to netCDF file: " + std::string(nc_strerror(res)));
+            }
+        }
+    });
+
+    std::function<void(chunkid_t, std::shared_ptr<chunk_data>, std::mutex &)> f = [this, prg, &writer, &packing, packed_size](chunkid_t id, std::shared_ptr<chunk_data> dat, std::mutex &m) {
+        chunk_write_job job;
+        job.id = id;
 
         // TODO: check if it is OK to simply not write anything to netCDF or if we need to fill dat explicity with no data values, check also for packed output
         if (!dat->empty()) {
-            chunk_size_btyx csize = dat->size();
-            bounds_nd<uint32_t, 3> climits = chunk_limits(id);
-            std::size_t startp[] = {climits.low[0], climits.low[1], climits.low[2]};
-            std::size_t countp[] = {csize[1], csize[2], csize[3]};
-
-            for (uint16_t i = 0; i < bands().count(); ++i) {
-                if (packing.type != packed_export::packing_type::PACK_NONE) {
-                    double cur_scale;
-                    double cur_offset;
-                    double cur_nodata;
-                    if (packing.scale.size() == size_bands()) {
-                        cur_scale = packing.scale[i];
-                        cur_offset = packing.offset[i];
-                        cur_nodata = packing.nodata[i];
-                    } else {
-                        cur_scale = packing.scale[0];
-                        cur_offset = packing.offset[0];
-                        cur_nodata = packing.nodata[0];
-                    }
-
-                    /*
-                   * If band of cube already has scale + offset, we do not apply this before.
-                   * As a consequence, provided scale and offset values refer to actual data values
-                   * but ignore band metadata. The following commented code would apply the
-                   * unpacking before
-                     */
-                    /*
-                  if (bands().get(i).scale != 1 || bands().get(i).offset != 0) {
-                      for (uint32_t i = 0; i < dat->size()[1] * dat->size()[2] * dat->size()[3]; ++i) {
-                          double &v = ((double *)(dat->buf()))[i * dat->size()[1] * dat->size()[2] * dat->size()[3] + i];
-                          v = v * bands().get(i).scale + bands().get(i).offset;
-                      }
-                  } */
-
-                    uint8_t *packedbuf = nullptr;
-
-                    if (packing.type == packed_export::packing_type::PACK_UINT8) {
-                        packedbuf = (uint8_t *)std::malloc(dat->size()[1] * dat->size()[2] * dat->size()[3] * sizeof(uint8_t));
-                        for (uint32_t iv = 0; iv < dat->size()[1] * dat->size()[2] * dat->size()[3]; ++iv) {
-                            double &v = ((double *)(dat->buf()))[i * dat->size()[1] * dat->size()[2] * dat->size()[3] + iv];
-                            if (std::isnan(v)) {
-                                v = cur_nodata;
-                            } else {
-                                v = std::round((v - cur_offset) / cur_scale);  // use std::round to avoid truncation bias
-                            }
-                            ((uint8_t *)(packedbuf))[iv] = v;
-                        }
-                        m.lock();
-                        nc_put_vara(ncout, v_bands[i], startp, countp, (void *)(packedbuf));
-                        m.unlock();
-                    } else if (packing.type == packed_export::packing_type::PACK_UINT16) {
-                        packedbuf = (uint8_t *)std::malloc(dat->size()[1] * dat->size()[2] * dat->size()[3] * sizeof(uint16_t));
-                        for (uint32_t iv = 0; iv < dat->size()[1] * dat->size()[2] * dat->size()[3]; ++iv) {
-                            double &v = ((double *)(dat->buf()))[i * dat->size()[1] * dat->size()[2] * dat->size()[3] + iv];
-                            if (std::isnan(v)) {
-                                v = cur_nodata;
-                            } else {
-                                v = std::round((v - cur_offset) / cur_scale);  // use std::round to avoid truncation bias
-                            }
-                            ((uint16_t *)(packedbuf))[iv] = v;
-                        }
-                        m.lock();
-                        nc_put_vara(ncout, v_bands[i], startp, countp, (void *)(packedbuf));
-                        m.unlock();
-                    } else if (packing.type == packed_export::packing_type::PACK_UINT32) {
-                        packedbuf = (uint8_t *)std::malloc(dat->size()[1] * dat->size()[2] * dat->size()[3] * sizeof(uint32_t));
-                        for (uint32_t iv = 0; iv < dat->size()[1] * dat->size()[2] * dat->size()[3]; ++iv) {
-                            double &v = ((double *)(dat->buf()))[i * dat->size()[1] * dat->size()[2] * dat->size()[3] + iv];
-                            if (std::isnan(v)) {
-                                v = cur_nodata;
-                            } else {
-                                v = std::round((v - cur_offset) / cur_scale);  // use std::round to avoid truncation bias
-                            }
-                            ((uint32_t *)(packedbuf))[iv] = v;
-                        }
-                        m.lock();
-                        nc_put_vara(ncout, v_bands[i], startp, countp, (void *)(packedbuf));
-                        m.unlock();
-                    } else if (packing.type == packed_export::packing_type::PACK_INT16) {
-                        packedbuf = (uint8_t *)std::malloc(dat->size()[1] * dat->size()[2] * dat->size()[3] * sizeof(int16_t));
-                        for (uint32_t iv = 0; iv < dat->size()[1] * dat->size()[2] * dat->size()[3]; ++iv) {
-                            double &v = ((double *)(dat->buf()))[i * dat->size()[1] * dat->size()[2] * dat->size()[3] + iv];
-                            if (std::isnan(v)) {
-                                v = cur_nodata;
-                            } else {
-                                v = std::round((v - cur_offset) / cur_scale);  // use std::round to avoid truncation bias
-                            }
-                            ((int16_t *)(packedbuf))[iv] = v;
-                        }
-                        m.lock();
-                        nc_put_vara(ncout, v_bands[i], startp, countp, (void *)(packedbuf));
-                        m.unlock();
-                    } else if (packing.type == packed_export::packing_type::PACK_INT32) {
-                        packedbuf = (uint8_t *)std::malloc(dat->size()[1] * dat->size()[2] * dat->size()[3] * sizeof(int32_t));
-                        for (uint32_t iv = 0; iv < dat->size()[1] * dat->size()[2] * dat->size()[3]; ++iv) {
-                            double &v = ((double *)(dat->buf()))[i * dat->size()[1] * dat->size()[2] * dat->size()[3] + iv];
-                            if (std::isnan(v)) {
-                                v = cur_nodata;
-                            } else {
-                                v = std::round((v - cur_offset) / cur_scale);  // use std::round to avoid truncation bias
-                            }
-                            ((int32_t *)(packedbuf))[iv] = v;
-                        }
-                        m.lock();
-                        nc_put_vara(ncout, v_bands[i], startp, countp, (void *)(packedbuf));
-                        m.unlock();
-                    } else if (packing.type == packed_export::packing_type::PACK_FLOAT32) {
-                        packedbuf = (uint8_t *)std::malloc(dat->size()[1] * dat->size()[2] * dat->size()[3] * sizeof(float));
-                        for (uint32_t iv = 0; iv < dat->size()[1] * dat->size()[2] * dat->size()[3]; ++iv) {
-                            double &v = ((double *)(dat->buf()))[i * dat->size()[1] * dat->size()[2] * dat->size()[3] + iv];
-                            ((float *)(packedbuf))[iv] = v;
-                        }
-                        m.lock();
-                        nc_put_vara(ncout, v_bands[i], startp, countp, (void *)(packedbuf));
-                        m.unlock();
-                    }
-                    if (packedbuf) std::free(packedbuf);
-                } else {
-                    m.lock();
-                    nc_put_vara(ncout, v_bands[i], startp, countp, (void *)(((double *)dat->buf()) + (int)i * (int)csize[1] * (int)csize[2] * (int)csize[3]));
-                    m.unlock();
+            if (packed_size > 0) {
+                /*
+                 * If band of cube already has scale + offset, we do not apply this before.
+                 * As a consequence, provided scale and offset values refer to actual data values
+                 * but ignore band metadata.
+                 */
+                std::size_t n = dat->size()[1] * dat->size()[2] * dat->size()[3];
+                job.packed.resize(dat->size()[0] * n * packed_size);
+                for (uint16_t i = 0; i < bands().count(); ++i) {
+                    packing_kernels::pack_band(packing, i, ((double *)dat->buf()) + i * n, job.packed.data() + i * n * packed_size, n);
                 }
+            } else {
+                job.dat = dat;
             }
         }
+        // empty chunks are passed to the writer as well, which is needed to write chunks in order
+        writer.push(std::move(job));
         prg->increment((double)1 / (double)this->count_chunks());
     };
 
     p->apply(shared_from_this(), f);
+    try {
+        writer.finish();
+    } catch (std::string s) {
+        nc_close(ncout);
+        prg->finalize();
+        throw std::string("ERROR in cube::write_netcdf_file(): failed to write " + path + ": " + s);
+    }
     nc_close(ncout);
     prg->finalize();
 
@@ -1244,6 +1344,544 @@ void cube::write_netcdf_file(std::string path, uint8_t compression_level, bool w
     }
 }
 
+void cube::write_zarr(std::string dir, uint8_t compression_level, packed_export packing, std::shared_ptr<chunk_processor> p) {
+    std::string op = filesystem::make_absolute(dir);
+    if (filesystem::is_regular_file(op)) {
+        throw std::string("ERROR in cube::write_zarr(): output already exists and is a file.");
+    }
+    if (filesystem::is_directory(op)) {
+        GCBS_INFO("Existing Zarr store '" + op + "' will be overwritten");
+    }
+
+    if (!_st_ref->has_regular_space()) {
+        throw std::string("ERROR in cube::write_zarr(): Zarr export currently does not support irregular spatial dimensions");
+    }
+    // NOTE: the following will only work as long as all cube st reference types with regular spatial dimensions inherit from  cube_stref_regular class
+    std::shared_ptr<cube_stref_regular> stref = std::dynamic_pointer_cast<cube_stref_regular>(_st_ref);
+
+    if (packing.type != packed_export::packing_type::PACK_NONE) {
+        if (packing.type == packed_export::packing_type::PACK_FLOAT32) {
+            packing.offset = {0.0};
+            packing.scale = {1.0};
+            packing.nodata = {std::numeric_limits<float>::quiet_NaN()};
+        }
+        if (!(packing.scale.size() == 1 || packing.scale.size() == size_bands()) ||
+            packing.scale.size() != packing.offset.size() || packing.scale.size() != packing.nodata.size()) {
+            std::string msg = "Packed export needs either n or 1 scale / offset / nodata values for n bands.";
+            GCBS_ERROR(msg);
+            throw(msg);
+        }
+    }
+
+    // data type string, see https://zarr.readthedocs.io/en/stable/spec/v2.html#data-type-encoding
+    uint16_t one = 1;
+    std::string endian = (*((uint8_t *)&one) == 1) ? "<" : ">";
+    std::string dtype = endian + "f8";
+    if (packing.type == packed_export::packing_type::PACK_UINT8) {
+        dtype = "|u1";
+    } else if (packing.type == packed_export::packing_type::PACK_UINT16) {
+        dtype = endian + "u2";
+    } else if (packing.type == packed_export::packing_type::PACK_UINT32) {
+        dtype = endian + "u4";
+    } else if (packing.type == packed_export::packing_type::PACK_INT16) {
+        dtype = endian + "i2";
+    } else if (packing.type == packed_export::packing_type::PACK_INT32) {
+        dtype = endian + "i4";
+    } else if (packing.type == packed_export::packing_type::PACK_FLOAT32) {
+        dtype = endian + "f4";
+    }
+
+    uint8_t value_size = packing_kernels::value_size(packing.type);
+
+    for (uint16_t i = 0; i < size_bands(); ++i) {
+        filesystem::mkdir_recursive(filesystem::join(op, bands().get(i).name));
+    }
+
+    std::shared_ptr<chunk_journal> journal;
+    if (config::instance()->get_resumable_exports()) {
+        journal = std::make_shared<chunk_journal>(filesystem::join(op, ".gdalcubes_journal"),
+                                                  chunk_journal::make_key(make_constructible_json().dump() + "|zarr|" + dtype + "|" + std::to_string(compression_level)));
+    }
+
+    std::shared_ptr<progress> prg = config::instance()->get_default_progress_bar()->get();
+    prg->set(journal ? (double)journal->count_done() / (double)count_chunks() : 0);  // explicitly set to show progress bar immediately
+
+    // Chunks are written to separate files by the chunk processor threads, only errors are synchronized.
+    std::vector<std::string> errors;
+    // chunks whose computation fails are skipped by the chunk processor and would be read as fill value
+    std::vector<uint8_t> written(count_chunks(), 0);
+    if (journal) {
+        for (chunkid_t i = 0; i < count_chunks(); ++i) {
+            if (journal->is_done(i)) written[i] = 1;
+        }
+    }
+    std::function<void(chunkid_t, std::shared_ptr<chunk_data>, std::mutex &)> f = [this, op, prg, journal, &packing, value_size, compression_level, &errors, &written](chunkid_t id, std::shared_ptr<chunk_data> dat, std::mutex &m) {
+        bool ok = true;
+        chunk_coordinate_tyx ccoords = chunk_coords_from_id(id);
+        std::string chunk_name = std::to_string(ccoords[0]) + "." + std::to_string(ccoords[1]) + "." + std::to_string(ccoords[2]);
+
+        // empty chunks are not written, Zarr readers use the fill value instead; files from a previous export
+        // of the same store must be removed
+        if (dat->empty()) {
+            for (uint16_t i = 0; i < bands().count(); ++i) {
+                std::string path = filesystem::join(filesystem::join(op, bands().get(i).name), chunk_name);
+                if (filesystem::exists(path)) filesystem::remove(path);
+            }
+        } else {
+            // Zarr chunks always have the full chunk size, i.e. chunks at the boundary must be padded
+            std::size_t nt = dat->size()[1], ny = dat->size()[2], nx = dat->size()[3];
+            std::size_t n_full = std::size_t(_chunk_size[0]) * std::size_t(_chunk_size[1]) * std::size_t(_chunk_size[2]);
+            std::vector<double> full(n_full);
+            std::vector<uint8_t> packed;
+            if (packing.type != packed_export::packing_type::PACK_NONE) {
+                packed.resize(n_full * value_size);
+            }
+
+            for (uint16_t i = 0; i < bands().count(); ++i) {
+                std::fill(full.begin(), full.end(), NAN);
+                const double *in = ((double *)dat->buf()) + i * nt * ny * nx;
+                for (std::size_t it = 0; it < nt; ++it) {
+                    for (std::size_t iy = 0; iy < ny; ++iy) {
+                        std::memcpy(full.data() + (it * _chunk_size[1] + iy) * _chunk_size[2], in + (it * ny + iy) * nx, nx * sizeof(double));
+                    }
+                }
+
+                const uint8_t *out = (const uint8_t *)full.data();
+                if (packing.type != packed_export::packing_type::PACK_NONE) {
+                    packing_kernels::pack_band(packing, i, full.data(), packed.data(), n_full);
+                    out = packed.data();
+                }
+
+                std::size_t out_size = n_full * value_size;
+                void *compressed = nullptr;
+                if (compression_level > 0) {
+                    // zlib stream, compatible with the numcodecs zlib compressor
+                    std::size_t compressed_size = 0;
+                    compressed = CPLZLibDeflate(out, out_size, compression_level, nullptr, 0, &compressed_size);
+                    if (!compressed) {
+                        std::string msg = "Failed to compress chunk " + std::to_string(id) + " of band " + bands().get(i).name;
+                        GCBS_ERROR(msg);
+                        std::string path = filesystem::join(filesystem::join(op, bands().get(i).name), chunk_name);
+                        if (filesystem::exists(path)) filesystem::remove(path);
+                        std::lock_guard<std::mutex> lock(m);
+                        errors.push_back(msg);
+                        ok = false;
+                        continue;
+                    }
+                    out = (const uint8_t *)compressed;
+                    out_size = compressed_size;
+                }
+
+                std::string path = filesystem::join(filesystem::join(op, bands().get(i).name), chunk_name);
+                std::ofstream fout(path, std::ios::out | std::ios::binary | std::ios::trunc);
+                fout.write((const char *)out, out_size);
+                fout.close();
+                if (fout.fail()) {
+                    std::string msg = "Failed to write chunk file '" + path + "'";
+                    GCBS_ERROR(msg);
+                    if (filesystem::exists(path)) filesystem::remove(path);
+                    std::lock_guard<std::mutex> lock(m);
+                    errors.push_back(msg);
+                    ok = false;
+                }
+                if (compressed) CPLFree(compressed);
+            }
+        }
+        if (ok) written[id] = 1;
+        if (journal && ok) journal->done(id);
+        prg->increment((double)1 / (double)this->count_chunks());
+    };
+    if (journal) {
+        p->apply(shared_from_this(), journal->remaining(count_chunks()), f);
+    } else {
+        p->apply(shared_from_this(), f);
+    }
+    if (!errors.empty()) {
+        throw std::string("ERROR in cube::write_zarr(): " + std::to_string(errors.size()) + " chunk file(s) could not be written, first error: " + errors[0]);
+    }
+    uint32_t nmissing = std::count(written.begin(), written.end(), 0);
+    if (nmissing > 0) {
+        throw std::string("ERROR in cube::write_zarr(): " + std::to_string(nmissing) + " chunk(s) could not be computed, Zarr store '" + op + "' is incomplete");
+    }
+
+    // Write metadata and coordinate arrays once all chunks are written
+    OGRSpatialReference srs = st_reference()->srs_ogr();
+    std::string yname = srs.IsProjected() ? "y" : "latitude";
+    std::string xname = srs.IsProjected() ? "x" : "longitude";
+    char *wkt;
+    srs.exportToWkt(&wkt);
+    std::string wkt_str(wkt);
+    CPLFree(wkt);
+
+    datetime_unit dtu = stref->dt().dt_unit;
+    int32_t dt_factor = 1;
+    if (dtu == datetime_unit::WEEK) {
+        dtu = datetime_unit::DAY;  // UDUNIT does not support week
+        dt_factor = 7;
+    }
+    std::vector<double> dim_t(size_t());
+    for (uint32_t i = 0; i < size_t(); ++i) {
+        if (stref->has_regular_time()) {
+            dim_t[i] = i * stref->dt().dt_interval * dt_factor;
+        } else {
+            dim_t[i] = (stref->datetime_at_index(i) - stref->t0()).dt_interval * dt_factor;
+        }
+    }
+    std::vector<double> dim_y(size_y());
+    for (uint32_t i = 0; i < size_y(); ++i) {
+        dim_y[i] = stref->win().top - (i + 0.5) * stref->dy();  // cell center
+    }
+    std::vector<double> dim_x(size_x());
+    for (uint32_t i = 0; i < size_x(); ++i) {
+        dim_x[i] = stref->win().left + (i + 0.5) * stref->dx();
+    }
+
+    std::string dtunit_str;
+    if (dtu == datetime_unit::YEAR) {
+        dtunit_str = "years";
+    } else if (dtu == datetime_unit::MONTH) {
+        dtunit_str = "months";
+    } else if (dtu == datetime_unit::DAY) {
+        dtunit_str = "days";
+    } else if (dtu == datetime_unit::HOUR) {
+        dtunit_str = "hours";
+    } else if (dtu == datetime_unit::MINUTE) {
+        dtunit_str = "minutes";
+    } else if (dtu == datetime_unit::SECOND) {
+        dtunit_str = "seconds";
+    }
+    dtunit_str += " since " + stref->t0().to_string(datetime_unit::SECOND);
+
+    auto write_text = [](std::string path, std::string text) {
+        std::ofstream fout(path, std::ios::out | std::ios::trunc);
+        fout << text;
+        fout.close();
+        if (fout.fail()) {
+            throw std::string("ERROR in cube::write_zarr(): failed to write '" + path + "'");
+        }
+    };
+
+    // coordinate arrays, stored uncompressed as a single chunk
+    auto write_coords = [&](std::string name, std::vector<double> &values, json11::Json::object attrs) {
+        std::string d = filesystem::join(op, name);
+        filesystem::mkdir_recursive(d);
+        json11::Json::object zarray;
+        zarray["zarr_format"] = 2;
+        zarray["shape"] = json11::Json::array{(double)values.size()};
+        zarray["chunks"] = json11::Json::array{(double)values.size()};
+        zarray["dtype"] = endian + "f8";
+        zarray["compressor"] = nullptr;
+        zarray["fill_value"] = "NaN";
+        zarray["order"] = "C";
+        zarray["filters"] = nullptr;
+        write_text(filesystem::join(d, ".zarray"), json11::Json(zarray).dump());
+        attrs["_ARRAY_DIMENSIONS"] = json11::Json::array{name};
+        write_text(filesystem::join(d, ".zattrs"), json11::Json(attrs).dump());
+        std::ofstream fout(filesystem::join(d, "0"), std::ios::out | std::ios::binary | std::ios::trunc);
+        fout.write((const char *)values.data(), values.size() * sizeof(double));
+        fout.close();
+    };
+    write_coords("time", dim_t, json11::Json::object{{"standard_name", "time"}, {"long_name", "time"}, {"units", dtunit_str}, {"calendar", "gregorian"}, {"axis", "T"}});
+    if (srs.IsProjected()) {
+        write_coords(yname, dim_y, json11::Json::object{{"standard_name", "projection_y_coordinate"}, {"long_name", "y coordinate of projection"}, {"axis", "Y"}});
+        write_coords(xname, dim_x, json11::Json::object{{"standard_name", "projection_x_coordinate"}, {"long_name", "x coordinate of projection"}, {"axis", "X"}});
+    } else {
+        write_coords(yname, dim_y, json11::Json::object{{"standard_name", "latitude"}, {"long_name", "latitude"}, {"units", "degrees_north"}, {"axis", "Y"}});
+        write_coords(xname, dim_x, json11::Json::object{{"standard_name", "longitude"}, {"long_name", "longitude"}, {"units", "degrees_east"}, {"axis", "X"}});
+    }
+
+    for (uint16_t i = 0; i < size_bands(); ++i) {
+        std::string d = filesystem::join(op, bands().get(i).name);
+
+        double pscale = bands().get(i).scale;
+        double poff = bands().get(i).offset;
+        json11::Json fill_value = "NaN";
+        if (packing.type != packed_export::packing_type::PACK_NONE && packing.type != packed_export::packing_type::PACK_FLOAT32) {
+            pscale = packing.scale.size() == size_bands() ? packing.scale[i] : packing.scale[0];
+            poff = packing.offset.size() == size_bands() ? packing.offset[i] : packing.offset[0];
+            fill_value = packing.nodata.size() == size_bands() ? packing.nodata[i] : packing.nodata[0];
+        }
+
+        json11::Json::object zarray;
+        zarray["zarr_format"] = 2;
+        zarray["shape"] = json11::Json::array{(double)size_t(), (double)size_y(), (double)size_x()};
+        zarray["chunks"] = json11::Json::array{(double)_chunk_size[0], (double)_chunk_size[1], (double)_chunk_size[2]};
+        zarray["dtype"] = dtype;
+        if (compression_level > 0) {
+            zarray["compressor"] = json11::Json::object{{"id", "zlib"}, {"level", (double)compression_level}};
+        } else {
+            zarray["compressor"] = nullptr;
+        }
+        zarray["fill_value"] = fill_value;
+        zarray["order"] = "C";
+        zarray["filters"] = nullptr;
+        zarray["dimension_separator"] = ".";
+        write_text(filesystem::join(d, ".zarray"), json11::Json(zarray).dump());
+
+        json11::Json::object zattrs;
+        zattrs["_ARRAY_DIMENSIONS"] = json11::Json::array{"time", yname, xname};
+        zattrs["scale_factor"] = pscale;
+        zattrs["add_offset"] = poff;
+        zattrs["grid_mapping"] = "crs";
+        zattrs["_CRS"] = json11::Json::object{{"wkt", wkt_str}};  // read by the GDAL Zarr driver
+        if (!bands().get(i).unit.empty()) zattrs["units"] = bands().get(i).unit;
+        write_text(filesystem::join(d, ".zattrs"), json11::Json(zattrs).dump());
+    }
+
+    write_text(filesystem::join(op, ".zgroup"), json11::Json(json11::Json::object{{"zarr_format", 2}}).dump());
+    std::string att_source = "gdalcubes " + std::to_string(GDALCUBES_VERSION_MAJOR) + "." + std::to_string(GDALCUBES_VERSION_MINOR) + "." + std::to_string(GDALCUBES_VERSION_PATCH);
+    json11::Json::object root_attrs;
+    root_attrs["Conventions"] = "CF-1.6";
+    root_attrs["source"] = att_source;
+    root_attrs["gdalcubes_datetime_type"] = stref->has_regular_time() ? "regular" : "labeled";
+    root_attrs["gdalcubes_datetime_t0"] = stref->t0().to_string();
+    root_attrs["gdalcubes_datetime_t1"] = stref->t1().to_string();
+    root_attrs["gdalcubes_datetime_dt"] = stref->dt().to_string();
+    root_attrs["process_graph"] = make_constructible_json().dump();
+    write_text(filesystem::join(op, ".zattrs"), json11::Json(root_attrs).dump());
+
+    // the journal is kept until metadata has been written
+    if (journal) journal->finish(count_chunks());
+    prg->finalize();
+}
+
+void cube::write_chunkstore(std::string path, uint8_t compression_level, packed_export packing, std::shared_ptr<chunk_processor> p) {
+    std::string op = filesystem::make_absolute(path);
+    if (filesystem::is_directory(op)) {
+        throw std::string("ERROR in cube::write_chunkstore(): output already exists and is a directory.");
+    }
+    if (filesystem::is_regular_file(op)) {
+        GCBS_INFO("Existing file '" + op + "' will be overwritten for chunk store export");
+    }
+    if (!filesystem::exists(filesystem::parent(op))) {
+        filesystem::mkdir_recursive(filesystem::parent(op));
+    }
+
+    if (!_st_ref->has_regular_space()) {
+        throw std::string("ERROR in cube::write_chunkstore(): chunk store export currently does not support irregular spatial dimensions");
+    }
+    // NOTE: the following will only work as long as all cube st reference types with regular spatial dimensions inherit from  cube_stref_regular class
+    std::shared_ptr<cube_stref_regular> stref = std::dynamic_pointer_cast<cube_stref_regular>(_st_ref);
+
+    if (packing.type != packed_export::packing_type::PACK_NONE) {
+        if (packing.type == packed_export::packing_type::PACK_FLOAT32) {
+            packing.offset = {0.0};
+            packing.scale = {1.0};
+            packing.nodata = {std::numeric_limits<float>::quiet_NaN()};
+        }
+        if (!(packing.scale.size() == 1 || packing.scale.size() == size_bands()) ||
+            packing.scale.size() != packing.offset.size() || packing.scale.size() != packing.nodata.size()) {
+            std::string msg = "Packed export needs either n or 1 scale / offset / nodata values for n bands.";
+            GCBS_ERROR(msg);
+            throw(msg);
+        }
+    }
+
+    uint8_t value_size = packing_kernels::value_size(packing.type);
+
+    std::shared_ptr<chunk_journal> journal;
+    if (config::instance()->get_resumable_exports()) {
+        journal = std::make_shared<chunk_journal>(op + ".journal",
+                                                  chunk_journal::make_key(make_constructible_json().dump() + "|chunkstore|" + std::to_string((int)packing.type) + "|" + std::to_string(compression_level)));
+    }
+    bool resume = journal && journal->resumed() && filesystem::is_regular_file(op);
+
+#ifndef _WIN32
+    int fd = open(op.c_str(), resume ? O_WRONLY : (O_WRONLY | O_CREAT | O_TRUNC), 0644);
+    if (fd < 0) {
+        throw std::string("ERROR in cube::write_chunkstore(): cannot create file '" + op + "'");
+    }
+#else
+    std::fstream fout(op, resume ? (std::ios::in | std::ios::out | std::ios::binary) : (std::ios::out | std::ios::binary | std::ios::trunc));
+    std::mutex fout_mutex;
+    if (!fout.is_open()) {
+        throw std::string("ERROR in cube::write_chunkstore(): cannot create file '" + op + "'");
+    }
+#endif
+
+    // Write size bytes at the given offset, positional writes to disjoint regions do not need any synchronization
+    std::function<bool(const void *, uint64_t, uint64_t)> write_at = [&](const void *buf, uint64_t size, uint64_t offset) {
+#ifndef _WIN32
+        const uint8_t *b = (const uint8_t *)buf;
+        while (size > 0) {
+            ssize_t written = pwrite(fd, b, size, offset);
+            if (written <= 0) return false;
+            b += written;
+            offset += written;
+            size -= written;
+        }
+        return true;
+#else
+        std::lock_guard<std::mutex> lock(fout_mutex);
+        fout.seekp(offset);
+        fout.write((const char *)buf, size);
+        return !fout.fail();
+#endif
+    };
+
+    // The header is written last, an incomplete file has no valid magic string
+    chunkstore_header header;
+    std::memset(&header, 0, sizeof(chunkstore_header));
+    write_at(&header, sizeof(chunkstore_header), 0);
+
+    auto align = [](uint64_t x) { return ((x + CHUNKSTORE_ALIGNMENT - 1) / CHUNKSTORE_ALIGNMENT) * CHUNKSTORE_ALIGNMENT; };
+    std::atomic<uint64_t> next_offset(align(sizeof(chunkstore_header)));
+    std::vector<chunkstore_index_entry> index(count_chunks(), chunkstore_index_entry{0, 0});
+    std::atomic<bool> failed(false);
+
+    // chunks whose computation fails are skipped by the chunk processor and would look like empty chunks in the index
+    std::vector<uint8_t> written(count_chunks(), 0);
+
+    // restore the index of chunks that have been written before, new chunks are appended
+    if (resume) {
+        uint64_t end = next_offset;
+        for (chunkid_t i = 0; i < count_chunks(); ++i) {
+            if (!journal->is_done(i)) continue;
+            written[i] = 1;
+            std::istringstream iss(journal->info(i));
+            iss >> index[i].offset >> index[i].size;
+            if (index[i].size > 0) end = std::max(end, index[i].offset + align(index[i].size));
+        }
+        next_offset = end;
+    }
+
+    std::shared_ptr<progress> prg = config::instance()->get_default_progress_bar()->get();
+    prg->set(journal ? (double)journal->count_done() / (double)count_chunks() : 0);  // explicitly set to show progress bar immediately
+
+    std::function<void(chunkid_t, std::shared_ptr<chunk_data>, std::mutex &)> f = [&](chunkid_t id, std::shared_ptr<chunk_data> dat, std::mutex &m) {
+        // empty chunks are not written, the index entry with size 0 marks them as empty
+        if (!dat->empty() && !dat->all_nan()) {
+            std::size_t n = dat->count_values();
+            const void *out = dat->buf();
+            uint64_t out_size = uint64_t(dat->count_bands()) * n * value_size;
+
+            std::vector<uint8_t> packed;
+            if (packing.type != packed_export::packing_type::PACK_NONE) {
+                packed.resize(out_size);
+                for (uint16_t i = 0; i < dat->count_bands(); ++i) {
+                    packing_kernels::pack_band(packing, i, ((const double *)dat->buf()) + i * n, packed.data() + i * n * value_size, n);
+                }
+                out = packed.data();
+            }
+
+            void *compressed = nullptr;
+            if (compression_level > 0) {
+                std::size_t compressed_size = 0;
+                compressed = CPLZLibDeflate(out, out_size, compression_level, nullptr, 0, &compressed_size);
+                if (!compressed) {
+                    GCBS_ERROR("Failed to compress chunk " + std::to_string(id));
+                    failed = true;
+                    prg->increment((double)1 / (double)this->count_chunks());
+                    return;
+                }
+                out = compressed;
+                out_size = compressed_size;
+            }
+
+            // reserve space in the file without locking
+            uint64_t offset = next_offset.fetch_add(align(out_size));
+            if (write_at(out, out_size, offset)) {
+                index[id].offset = offset;
+                index[id].size = out_size;
+                written[id] = 1;
+                if (journal) journal->done(id, std::to_string(offset) + " " + std::to_string(out_size));
+            } else {
+                GCBS_ERROR("Failed to write chunk " + std::to_string(id) + " to '" + op + "'");
+                failed = true;
+            }
+            if (compressed) CPLFree(compressed);
+        } else {
+            written[id] = 1;
+            if (journal) journal->done(id, "0 0");
+        }
+        prg->increment((double)1 / (double)this->count_chunks());
+    };
+    if (journal) {
+        p->apply(shared_from_this(), journal->remaining(count_chunks()), f);
+    } else {
+        p->apply(shared_from_this(), f);
+    }
+    uint32_t nmissing = std::count(written.begin(), written.end(), 0);
+    if (nmissing > 0) {
+        GCBS_ERROR(std::to_string(nmissing) + " chunk(s) could not be computed or written, chunk store '" + op + "' will be incomplete");
+        failed = true;
+    }
+
+    // Metadata
+    json11::Json::object meta;
+    meta["srs"] = stref->srs();
+    meta["left"] = stref->left();
+    meta["right"] = stref->right();
+    meta["bottom"] = stref->bottom();
+    meta["top"] = stref->top();
+    meta["nx"] = (int)stref->nx();
+    meta["ny"] = (int)stref->ny();
+    meta["datetime_type"] = stref->has_regular_time() ? "regular" : "labeled";
+    meta["t0"] = stref->t0().to_string();
+    meta["t1"] = stref->t1().to_string();
+    meta["dt"] = stref->dt().to_string();
+    if (!stref->has_regular_time()) {
+        json11::Json::array labels;
+        for (uint32_t i = 0; i < size_t(); ++i) {
+            labels.push_back(stref->datetime_at_index(i).to_string());
+        }
+        meta["time_labels"] = labels;
+    }
+    meta["chunk_size"] = json11::Json::array{(int)_chunk_size[0], (int)_chunk_size[1], (int)_chunk_size[2]};
+    json11::Json::array meta_bands;
+    for (uint16_t i = 0; i < size_bands(); ++i) {
+        json11::Json::object b;
+        b["name"] = bands().get(i).name;
+        b["offset"] = bands().get(i).offset;
+        b["scale"] = bands().get(i).scale;
+        b["unit"] = bands().get(i).unit;
+        b["type"] = bands().get(i).type;
+        b["nodata"] = bands().get(i).no_data_value;
+        if (packing.type != packed_export::packing_type::PACK_NONE && packing.type != packed_export::packing_type::PACK_FLOAT32) {
+            b["pack_scale"] = packing.scale.size() == size_bands() ? packing.scale[i] : packing.scale[0];
+            b["pack_offset"] = packing.offset.size() == size_bands() ? packing.offset[i] : packing.offset[0];
+            b["pack_nodata"] = packing.nodata.size() == size_bands() ? packing.nodata[i] : packing.nodata[0];
+        }
+        meta_bands.push_back(b);
+    }
+    meta["bands"] = meta_bands;
+    meta["process_graph"] = make_constructible_json();
+    std::string meta_str = json11::Json(meta).dump();
+
+    std::memcpy(header.magic, CHUNKSTORE_MAGIC, sizeof(CHUNKSTORE_MAGIC));
+    header.version = CHUNKSTORE_VERSION;
+    header.byte_order = CHUNKSTORE_BYTE_ORDER;
+    header.data_type = (uint32_t)packing.type;
+    header.compression = compression_level > 0 ? 1 : 0;
+    header.nchunks = index.size();
+    header.index_offset = next_offset;
+    header.metadata_offset = header.index_offset + index.size() * sizeof(chunkstore_index_entry);
+    header.metadata_size = meta_str.size();
+
+    if (!write_at(index.data(), index.size() * sizeof(chunkstore_index_entry), header.index_offset) ||
+        !write_at(meta_str.data(), meta_str.size(), header.metadata_offset)) {
+        failed = true;
+    }
+    if (!failed) {
+        write_at(&header, sizeof(chunkstore_header), 0);
+    }
+
+#ifndef _WIN32
+    bool closed = close(fd) == 0;
+#else
+    fout.close();
+    bool closed = !fout.fail();
+#endif
+    if (journal && !failed && closed) journal->finish(count_chunks());
+    prg->finalize();
+    if (nmissing > 0) {
+        throw std::string("ERROR in cube::write_chunkstore(): " + std::to_string(nmissing) + " chunk(s) could not be computed or written, chunk store file '" + op + "' is incomplete");
+    }
+    if (failed || !closed) {
+        throw std::string("ERROR in cube::write_chunkstore(): failed to write chunk store file '" + op + "'");
+    }
+}
+
 void cube::write_single_chunk_netcdf(gdalcubes::chunkid_t id, std::string path, uint8_t compression_level) {
 
 
@@ -1465,6 +2103,9 @@ void cube::write_single_chunk_netcdf(gdalcubes::chunkid_t id, std::string path,
 
 void cube::write_chunks_netcdf(std::string dir, std::string name, uint8_t compression_level, std::shared_ptr<chunk_processor> p) {
     if (name.empty()) {
+        if (config::instance()->get_resumable_exports()) {
+            GCBS_WARN("Chunk-wise netCDF export without name cannot be resumed");
+        }
         name = utils::generate_unique_filename();
     }
 
@@ -1478,10 +2119,17 @@ void cube::write_chunks_netcdf(std::string dir, std::string name, uint8_t compre
         filesystem::mkdir_recursive(dir);
     }
 
+    std::shared_ptr<chunk_journal> journal;
+    if (config::instance()->get_resumable_exports()) {
+        journal = std::make_shared<chunk_journal>(filesystem::join(dir, name + ".journal"),
+                                                  chunk_journal::make_key(make_constructible_json().dump() + "|netcdf_chunks|" + std::to_string(compression_level)));
+    }
+
     std::shared_ptr<progress> prg = config::instance()->get_default_progress_bar()->get();
-    prg->set(0);  // explicitly set to zero to show progress bar immediately
+    prg->set(journal ? (double)journal->count_done() / (double)count_chunks() : 0);  // explicitly set to show progress bar immediately
 
-    std::function<void(chunkid_t, std::shared_ptr<chunk_data>, std::mutex &)> f = [this, prg, &compression_level, &name, &dir](chunkid_t id, std::shared_ptr<chunk_data> dat, std::mutex &m) {
+    std::function<void(chunkid_t, std::shared_ptr<chunk_data>, std::mutex &)> f = [this, prg, journal, &compression_level, &name, &dir](chunkid_t id, std::shared_ptr<chunk_data> dat, std::mutex &m) {
+        bool ok = true;
 
         // TODO: check if it is OK to simply not write anything to netCDF or if we need to fill dat explicity with no data values, check also for packed output
         if (!dat->empty()) {
@@ -1529,10 +2177,18 @@ void cube::write_chunks_netcdf(std::string dir, std::string name, uint8_t compre
             int ncout;
 
 #if USE_NCDF4 == 1
-            nc_create(fname.c_str(), NC_NETCDF4, &ncout);
+            int ncres = nc_create(fname.c_str(), NC_NETCDF4, &ncout);
 #else
-            nc_create(fname.c_str(), NC_CLASSIC_MODEL, &ncout);
+            int ncres = nc_create(fname.c_str(), NC_CLASSIC_MODEL, &ncout);
 #endif
+            if (ncres != NC_NOERR) {
+                GCBS_ERROR("Failed to create netCDF file '" + fname + "': " + nc_strerror(ncres));
+                std::free(dim_t);
+                std::free(dim_y);
+                std::free(dim_x);
+                prg->increment((double)1 / (double)this->count_chunks());
+                return;
+            }
 
             int d_t, d_y, d_x;
             nc_def_dim(ncout, "time", dat->size()[1], &d_t);
@@ -1675,11 +2331,11 @@ void cube::write_chunks_netcdf(std::string dir, std::string name, uint8_t compre
                 v_bands.push_back(v);
             }
 
-            nc_enddef(ncout);  ////////////////////////////////////////////////////
+            ncres = nc_enddef(ncout);  ////////////////////////////////////////////////////
 
-            nc_put_var(ncout, v_t, (void *)dim_t);
-            nc_put_var(ncout, v_y, (void *)dim_y);
-            nc_put_var(ncout, v_x, (void *)dim_x);
+            if (ncres == NC_NOERR) ncres = nc_put_var(ncout, v_t, (void *)dim_t);
+            if (ncres == NC_NOERR) ncres = nc_put_var(ncout, v_y, (void *)dim_y);
+            if (ncres == NC_NOERR) ncres = nc_put_var(ncout, v_x, (void *)dim_x);
 
             if (dim_t) std::free(dim_t);
             if (dim_y) std::free(dim_y);
@@ -1688,15 +2344,27 @@ void cube::write_chunks_netcdf(std::string dir, std::string name, uint8_t compre
             std::size_t startp[] = {0, 0, 0};
             std::size_t countp[] = {dat->size()[1], dat->size()[2], dat->size()[3]};
 
-            for (uint16_t i = 0; i < bands().count(); ++i) {
-                nc_put_vara(ncout, v_bands[i], startp, countp, (void *)(((double *)dat->buf()) + (int)i * (int)dat->size()[1] * (int)dat->size()[2] * (int)dat->size()[3]));
+            for (uint16_t i = 0; i < bands().count() && ncres == NC_NOERR; ++i) {
+                ncres = nc_put_vara(ncout, v_bands[i], startp, countp, (void *)(((double *)dat->buf()) + (int)i * (int)dat->size()[1] * (int)dat->size()[2] * (int)dat->size()[3]));
+            }
+            int ncres_close = nc_close(ncout);
+            if (ncres == NC_NOERR) ncres = ncres_close;
+            ok = ncres == NC_NOERR;
+            if (!ok) {
+                // do not mark the chunk as done, a resumed export will write it again
+                GCBS_ERROR("Failed to write netCDF file '" + fname + "': " + nc_strerror(ncres));
             }
-            nc_close(ncout);
         }
+        if (journal && ok) journal->done(id);
         prg->increment((double)1 / (double)this->count_chunks());
     };
 
-    p->apply(shared_from_this(), f);
+    if (journal) {
+        p->apply(shared_from_this(), journal->remaining(count_chunks()), f);
+        journal->finish(count_chunks());
+    } else {
+        p->apply(shared_from_this(), f);
+    }
     prg->finalize();
 }
 
@@ -1705,20 +2373,68 @@ void chunk_processor_singlethread::apply(std::shared_ptr<cube> c,
     std::mutex mutex;
     uint32_t nchunks = c->count_chunks();
     for (uint32_t i = 0; i < nchunks; ++i) {
+        trace_span span_read("read_chunk", "processor", i);
         std::shared_ptr<chunk_data> dat = c->read_chunk(i);
+        span_read.end();
+        trace_span span_process("process_chunk", "processor", i);
         f(i, dat, mutex);
     }
 }
 
+void chunk_processor::apply(std::shared_ptr<cube> c, std::vector<chunkid_t> chunks,
+                            std::function<void(chunkid_t, std::shared_ptr<chunk_data>, std::mutex &)> f) {
+    std::mutex mutex;
+    for (uint32_t i = 0; i < chunks.size(); ++i) {
+        trace_span span_read("read_chunk", "processor", chunks[i]);
+        std::shared_ptr<chunk_data> dat = c->read_chunk(chunks[i]);
+        span_read.end();
+        trace_span span_process("process_chunk", "processor", chunks[i]);
+        f(chunks[i], dat, mutex);
+    }
+}
+
+void chunk_processor_multithread::apply(std::shared_ptr<cube> c, std::vector<chunkid_t> chunks,
+                                        std::function<void(chunkid_t, std::shared_ptr<chunk_data>, std::mutex &)> f) {
+    std::mutex mutex;
+    std::vector<std::thread> workers;
+    for (uint16_t it = 0; it < _nthreads; ++it) {
+        workers.push_back(std::thread([this, &c, &chunks, f, it, &mutex](void) {
+            trace_recorder::thread_name("chunk_processor");
+            for (uint32_t i = it; i < chunks.size(); i += _nthreads) {
+                try {
+                    trace_span span_read("read_chunk", "processor", chunks[i]);
+                    std::shared_ptr<chunk_data> dat = c->read_chunk(chunks[i]);
+                    span_read.end();
+                    trace_span span_process("process_chunk", "processor", chunks[i]);
+                    f(chunks[i], dat, mutex);
+                } catch (std::string s) {
+                    GCBS_ERROR(s);
+                    continue;
+                } catch (...) {
+                    GCBS_ERROR("unexpected exception while processing chunk " + std::to_string(chunks[i]));
+                    continue;
+                }
+            }
+        }));
+    }
+    for (uint16_t it = 0; it < _nthreads; ++it) {
+        workers[it].join();
+    }
+}
+
 void chunk_processor_multithread::apply(std::shared_ptr<cube> c,
                                         std::function<void(chunkid_t, std::shared_ptr<chunk_data>, std::mutex &)> f) {
     std::mutex mutex;
     std::vector<std::thread> workers;
     for (uint16_t it = 0; it < _nthreads; ++it) {
         workers.push_back(std::thread([this, &c, f, it, &mutex](void) {
+            trace_recorder::thread_name("chunk_processor");
             for (uint32_t i = it; i < c->count_chunks(); i += _nthreads) {
                 try {
+                    trace_span span_read("read_chunk", "processor", i);
                     std::shared_ptr<chunk_data> dat = c->read_chunk(i);
+                    span_read.end();
+                    trace_span span_process("process_chunk", "processor", i);
                     f(i, dat, mutex);
                 } catch (std::string s) {
                     GCBS_ERROR(s);
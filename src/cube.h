@@ -29,6 +29,8 @@
 #include <set>
 
 #include "config.h"
+#include "profiler.h"
+#include "trace_recorder.h"
 #include "view.h"
 
 namespace gdalcubes {
@@ -175,6 +177,17 @@ class chunk_processor {
      */
     virtual void
     apply(std::shared_ptr<cube> c, std::function<void(chunkid_t, std::shared_ptr<chunk_data>, std::mutex &)> f) = 0;
+
+    /**
+     * Apply a function f over a subset of chunks of a given data cube c
+     *
+     * The default implementation processes chunks sequentially, derived classes may override this method for parallel processing.
+     * @param c data cube
+     * @param chunks ids of the chunks to be processed
+     * @param f function to be applied over the chunks, see chunk_processor::apply
+     */
+    virtual void
+    apply(std::shared_ptr<cube> c, std::vector<chunkid_t> chunks, std::function<void(chunkid_t, std::shared_ptr<chunk_data>, std::mutex &)> f);
 };
 
 /**
@@ -194,6 +207,8 @@ class chunk_processor_singlethread : public chunk_processor {
      */
     void apply(std::shared_ptr<cube> c,
                std::function<void(chunkid_t, std::shared_ptr<chunk_data>, std::mutex &)> f) override;
+
+    using chunk_processor::apply;
 };
 
 /**
@@ -220,6 +235,12 @@ class chunk_processor_multithread : public chunk_processor {
     void apply(std::shared_ptr<cube> c,
                std::function<void(chunkid_t, std::shared_ptr<chunk_data>, std::mutex &)> f) override;
 
+    /**
+    * @copydoc chunk_processor::apply(std::shared_ptr<cube>, std::vector<chunkid_t>, std::function<void(chunkid_t, std::shared_ptr<chunk_data>, std::mutex &)>)
+    */
+    void apply(std::shared_ptr<cube> c, std::vector<chunkid_t> chunks,
+               std::function<void(chunkid_t, std::shared_ptr<chunk_data>, std::mutex &)> f) override;
+
     /**
      * Query the number of threads to be used in parallel chunk processing
      * @return the number of threads
@@ -320,10 +341,10 @@ class chunk_data {
     /**
      * @brief Default constructor that creates an empty chunk
      */
-    chunk_data() : _buf(nullptr), _size({{0, 0, 0, 0}}) {}
+    chunk_data() : _buf(nullptr), _size({{0, 0, 0, 0}}), _owner(nullptr) {}
 
     ~chunk_data() {
-        if (_buf && _size[0] * _size[1] * _size[2] * _size[3] > 0) std::free(_buf);
+        if (!_owner && _buf && _size[0] * _size[1] * _size[2] * _size[3] > 0) std::free(_buf);
     }
 
     /**
@@ -388,10 +409,26 @@ class chunk_data {
      * @param b new buffer object, this class takes the ownership, i.e., eventually std::frees memory automatically in the destructor.
      */
     inline void buf(void *b) {
-        if (_buf && _size[0] * _size[1] * _size[2] * _size[3] > 0) std::free(_buf);
+        if (!_owner && _buf && _size[0] * _size[1] * _size[2] * _size[3] > 0) std::free(_buf);
+        _owner.reset();
         _buf = b;
     }
 
+    /**
+     * @brief (Re)set the raw buffer to memory that is owned by another object, e.g., a memory mapped file region
+     *
+     * The buffer will not be freed by this class. Instead, a reference to the owner is kept as long as the buffer
+     * is in use, which allows to pass chunk data without copies.
+     *
+     * @param b new buffer object, must remain valid as long as owner exists and must be writable
+     * @param owner object that owns the memory of b
+     */
+    inline void buf(void *b, std::shared_ptr<void> owner) {
+        buf(nullptr);
+        _buf = b;
+        _owner = owner;
+    }
+
     /**
      * @brief Query the size of the contained data
      *
@@ -430,6 +467,7 @@ class chunk_data {
    private:
     void *_buf;
     chunk_size_btyx _size;
+    std::shared_ptr<void> _owner;
 };
 
 /**
@@ -462,7 +500,7 @@ class cube : public std::enable_shared_from_this<cube> {
         // TODO: add bands
     }
 
-    virtual ~cube() {}
+    virtual ~cube() { profiler::remove(this); }
 
     /**
      * @brief Find the chunk that contains a given point
@@ -828,6 +866,35 @@ class cube : public std::enable_shared_from_this<cube> {
 
     void write_single_chunk_netcdf(chunkid_t id, std::string path, uint8_t compression_level = 0);
 
+    /**
+     * Write a data cube as a Zarr (version 2) store with one array per band
+     *
+     * Chunks of the Zarr arrays are identical to the chunks of the data cube. Chunk files are written
+     * independently by the threads of the chunk processor, coordinate arrays and metadata (.zarray, .zattrs, .zgroup)
+     * are written once all chunks have been computed. Empty chunks are not written.
+     *
+     * @param dir path of the target directory
+     * @param compression_level zlib level, 0 = no compression, 1 = fast, 9 = small
+     * @param packing reduce size of output with packing (apply scale + offset and use smaller integer data types)
+     * @param p chunk processor instance, defaults to the global configuration
+     */
+    void write_zarr(std::string dir, uint8_t compression_level = 0, packed_export packing = packed_export::make_none(),
+                    std::shared_ptr<chunk_processor> p = config::instance()->get_default_chunk_processor());
+
+    /**
+     * Write a data cube as a gdalcubes chunk store file, which can be read with chunkstore_cube
+     *
+     * Chunks are written in parallel by the threads of the chunk processor, each to its own region of the file.
+     * The file contains a chunk index and the cube metadata, chunks that are empty or contain only NAN values are not written.
+     *
+     * @param path path of the target file
+     * @param compression_level zlib level, 0 = no compression (fastest reading), 1 = fast, 9 = small
+     * @param packing reduce size of output with packing (apply scale + offset and use smaller integer data types)
+     * @param p chunk processor instance, defaults to the global configuration
+     */
+    void write_chunkstore(std::string path, uint8_t compression_level = 0, packed_export packing = packed_export::make_none(),
+                          std::shared_ptr<chunk_processor> p = config::instance()->get_default_chunk_processor());
+
     /**
      * @brief Writes a data cube as a collection of PNG files
      *
@@ -877,6 +944,19 @@ class cube : public std::enable_shared_from_this<cube> {
         _pre.push_back(std::weak_ptr<cube>(c));
     }
 
+    /**
+     * @brief Get the data cubes this cube takes as input
+     * @return input cubes that are still alive, in the order they have been added
+     */
+    inline std::vector<std::shared_ptr<cube>> parent_cubes() {
+        std::vector<std::shared_ptr<cube>> out;
+        for (auto it = _pre.begin(); it != _pre.end(); ++it) {
+            std::shared_ptr<cube> c = it->lock();
+            if (c) out.push_back(c);
+        }
+        return out;
+    }
+
     /**
      * @brief Add a child data cube to keep track of cubes connections
      * @param c derived data cube
@@ -29,6 +29,7 @@
 #include "aggregate_time.h"
 #include "aggregate_space.h"
 #include "apply_pixel.h"
+#include "chunkstore_cube.h"
 #include "crop.h"
 #include "dummy.h"
 #include "external/json11/json11.hpp"
@@ -307,7 +308,11 @@ void cube_factory::register_default() {
                     std::string mask_type = j["mask"]["mask_type"].string_value();
                     std::vector<uint8_t> bits;
                     for (uint16_t i = 0; i < j["mask"]["bits"].array_items().size(); ++i) {
-                        bits.push_back(j["mask"]["bits"][i].int_value());
+                        int b = j["mask"]["bits"][i].int_value();
+                        if (b < 0 || b > 31) {
+                            throw std::string("ERROR in cube_generators[\"image_collection\"](): mask bit position " + std::to_string(b) + " is out of range [0, 31]");
+                        }
+                        bits.push_back(b);
                     }
                     if (mask_type == "value_mask") {
                         std::unordered_set<double> vals;
@@ -317,6 +322,12 @@ void cube_factory::register_default() {
                         x->set_mask(j["mask_band"].string_value(), std::make_shared<value_mask>(vals, j["mask"]["invert"].bool_value(), bits));
                     } else if (mask_type == "range_mask") {
                         x->set_mask(j["mask_band"].string_value(), std::make_shared<range_mask>(j["mask"]["min"].number_value(), j["mask"]["max"].number_value(), j["mask"]["invert"].bool_value(), bits));
+                    } else if (mask_type == "bitflag_mask") {
+                        std::vector<std::pair<uint32_t, uint32_t>> tests;
+                        for (uint16_t i = 0; i < j["mask"]["tests"].array_items().size(); ++i) {
+                            tests.push_back(std::make_pair((uint32_t)j["mask"]["tests"][i]["bitmask"].number_value(), (uint32_t)j["mask"]["tests"][i]["value"].number_value()));
+                        }
+                        x->set_mask(j["mask_band"].string_value(), std::make_shared<bitflag_mask>(tests, j["mask"]["invert"].bool_value()));
                     } else {
                         GCBS_WARN("ERROR in cube_generators[\"image_collection\"](): invalid mask type, mask will be ignored");
                     }
@@ -395,6 +406,19 @@ void cube_factory::register_default() {
             }
             return x;
         }));
+
+    cube_generators.insert(std::make_pair<std::string, std::function<std::shared_ptr<cube>(json11::Json&)>>(
+        "chunkstore", [](json11::Json& j) {
+            auto x = chunkstore_cube::create(j["file"].string_value());
+            if (!j["band_selection"].is_null()) {
+                std::vector<std::string> bands;
+                for (uint32_t i = 0; i < j["band_selection"].array_items().size(); ++i) {
+                    bands.push_back(j["band_selection"][i].string_value());
+                }
+                x->select_bands(bands);
+            }
+            return x;
+        }));
 }
 
 }  // namespace gdalcubes
\ No newline at end of file
@@ -29,6 +29,7 @@ namespace gdalcubes {
 std::shared_ptr<chunk_data> dummy_cube::read_chunk(chunkid_t id) {
     GCBS_TRACE("dummy_cube::read_chunk(" + std::to_string(id) + ")");
     std::shared_ptr<chunk_data> out = std::make_shared<chunk_data>();
+    profile_scope profile(this, out);
     if (id >= count_chunks())
         return out;  // chunk is outside of the view, we don't need to read anything.
 
@@ -48,6 +49,7 @@ std::shared_ptr<chunk_data> dummy_cube::read_chunk(chunkid_t id) {
 std::shared_ptr<chunk_data> empty_cube::read_chunk(chunkid_t id) {
     GCBS_TRACE("empty_cube::read_chunk(" + std::to_string(id) + ")");
     std::shared_ptr<chunk_data> out = std::make_shared<chunk_data>();
+    profile_scope profile(this, out);
     if (id >= count_chunks())
         return out;  // chunk is outside of the view, we don't need to read anything.
 
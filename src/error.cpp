@@ -29,6 +29,7 @@
 namespace gdalcubes {
 
 std::mutex logger::_m;
+std::atomic<int> logger::_level(int(error_level::ERRLVL_WARNING));  // see error_handler::default_error_handler
 // TODO: move mutex to specific error handler implementations
 void logger::error(std::string msg, std::string where, int error_code) {
     _m.lock();
@@ -25,6 +25,7 @@
 #ifndef ERROR_H
 #define ERROR_H
 
+#include <atomic>
 #include <iostream>
 #include <mutex>
 #include <string>
@@ -33,13 +34,6 @@
 
 namespace gdalcubes {
 
-#define GCBS_FATAL(MSG) logger::fatal(MSG, std::string(__FILE__) + ":" + std::string(__func__) + ":" + std::to_string(__LINE__) + "")
-#define GCBS_ERROR(MSG) logger::error(MSG, std::string(__FILE__) + ":" + std::string(__func__) + ":" + std::to_string(__LINE__) + "")
-#define GCBS_WARN(MSG) logger::warn(MSG, std::string(__FILE__) + ":" + std::string(__func__) + ":" + std::to_string(__LINE__) + "")
-#define GCBS_DEBUG(MSG) logger::debug(MSG, std::string(__FILE__) + ":" + std::string(__func__) + ":" + std::to_string(__LINE__) + "")
-#define GCBS_INFO(MSG) logger::info(MSG, std::string(__FILE__) + ":" + std::string(__func__) + ":" + std::to_string(__LINE__) + "")
-#define GCBS_TRACE(MSG) logger::trace(MSG, std::string(__FILE__) + ":" + std::string(__func__) + ":" + std::to_string(__LINE__) + "")
-
 enum class error_level {
     ERRLVL_TRACE = 6,
     ERRLVL_DEBUG = 5,
@@ -48,6 +42,32 @@ enum class error_level {
     ERRLVL_ERROR = 2,
     ERRLVL_FATAL = 1
 };
+/**
+ * Most verbose error level that is compiled in, messages of higher levels are removed at compile time. For example,
+ * compile with -DGCBS_LOG_LEVEL=3 to keep only warnings and errors.
+ */
+#ifndef GCBS_LOG_LEVEL
+#define GCBS_LOG_LEVEL 6
+#endif
+
+/*
+ * The level is checked before the message and its location are formatted, i.e. arguments of disabled log macros
+ * are never evaluated.
+ */
+#define GCBS_LOG(LEVEL, FUNC, MSG)                                                                    \
+    do {                                                                                              \
+        if (int(LEVEL) <= GCBS_LOG_LEVEL && logger::enabled(LEVEL)) {                                 \
+            logger::FUNC(MSG, std::string(__FILE__) + ":" + __func__ + ":" + std::to_string(__LINE__)); \
+        }                                                                                             \
+    } while (0)
+
+#define GCBS_FATAL(MSG) GCBS_LOG(error_level::ERRLVL_FATAL, fatal, MSG)
+#define GCBS_ERROR(MSG) GCBS_LOG(error_level::ERRLVL_ERROR, error, MSG)
+#define GCBS_WARN(MSG) GCBS_LOG(error_level::ERRLVL_WARNING, warn, MSG)
+#define GCBS_DEBUG(MSG) GCBS_LOG(error_level::ERRLVL_DEBUG, debug, MSG)
+#define GCBS_INFO(MSG) GCBS_LOG(error_level::ERRLVL_INFO, info, MSG)
+#define GCBS_TRACE(MSG) GCBS_LOG(error_level::ERRLVL_TRACE, trace, MSG)
+
 /**
  * @brief Function pointer prototype for custom error handlers
  */
@@ -92,8 +112,25 @@ class logger {
     */
     static void trace(std::string msg, std::string where = "", int error_code = 0);
 
+    /**
+     * @brief Set the most verbose level of messages that are passed to the error handler
+     *
+     * The level is set automatically by config::set_error_handler() for the error handlers implemented in
+     * error_handler and defaults to ERRLVL_TRACE for custom error handlers.
+     * @param level error level
+     */
+    static void set_level(error_level level) { _level.store(int(level)); }
+
+    static error_level level() { return error_level(_level.load()); }
+
+    /**
+     * @brief Check whether messages of a given level are passed to the error handler
+     */
+    static inline bool enabled(error_level level) { return int(level) <= _level.load(std::memory_order_relaxed); }
+
    private:
     static std::mutex _m;
+    static std::atomic<int> _level;
 };
 
 /**
@@ -220,6 +220,7 @@ extract_geom::extract_geom(std::shared_ptr<cube> in, std::string ogr_dataset,
 std::shared_ptr<chunk_data> extract_geom::read_chunk(chunkid_t id) {
     GCBS_TRACE("extract_geom::read_chunk(" + std::to_string(id) + ")");
     std::shared_ptr<chunk_data> out = std::make_shared<chunk_data>();
+    profile_scope profile(this, out);
 
     if (id >= count_chunks()) {
         return std::make_shared<chunk_data>();  // chunk is outside of the view, we don't need to read anything.
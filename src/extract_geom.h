@@ -47,6 +47,8 @@ class extract_geom : public cube {
      */
     static std::shared_ptr<extract_geom> create(std::shared_ptr<cube> in, std::string ogr_dataset, std::string time_column = "", std::string ogr_layer = "") {
         std::shared_ptr<extract_geom> out = std::make_shared<extract_geom>(in, ogr_dataset, time_column,  ogr_layer);
+        in->add_child_cube(out);
+        out->add_parent_cube(in);
         return out;
     }
 
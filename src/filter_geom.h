@@ -45,6 +45,8 @@ class filter_geom_cube : public cube {
          */
     static std::shared_ptr<filter_geom_cube> create(std::shared_ptr<cube> in, std::string wkt, std::string srs) {
         std::shared_ptr<filter_geom_cube> out = std::make_shared<filter_geom_cube>(in, wkt, srs);
+        in->add_child_cube(out);
+        out->add_parent_cube(in);
         return out;
     }
 
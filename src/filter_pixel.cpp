@@ -33,11 +33,12 @@ namespace gdalcubes {
 
 std::shared_ptr<chunk_data> filter_pixel_cube::read_chunk(chunkid_t id) {
     GCBS_TRACE("filter_pixel_cube::read_chunk(" + std::to_string(id) + ")");
+    std::shared_ptr<chunk_data> out = std::make_shared<chunk_data>();
+    profile_scope profile(this, out);
 
     if (id >= count_chunks())
-        return  std::make_shared<chunk_data>();  // chunk is outside of the view, we don't need to read anything.
+        return out;  // chunk is outside of the view, we don't need to read anything.
 
-    std::shared_ptr<chunk_data> out = std::make_shared<chunk_data>();
     std::shared_ptr<chunk_data> in = _in_cube->read_chunk(id);
     if (in->empty()) {
         return out;
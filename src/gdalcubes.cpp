@@ -68,6 +68,8 @@ void print_usage(std::string command = "") {
         std::cout << "  -R, --recursive               If IN is a directory, do a recursive file listing" << std::endl;
         std::cout << "    , --noarchives              If given, do not scan within zip, tar, gz, tar.gz archive files" << std::endl;
         std::cout << "  -s, --strict                  Cancel if a single GDALDataset cannot be added to the collection. If not given, ignore failing datasets in the output collection" << std::endl;
+        std::cout << "  -t, --threads                 Number of threads used to read metadata of GDALDatasets, defaults to 1" << std::endl;
+        std::cout << "  -u, --update                  If DEST exists, only add new and modified GDALDatasets from IN and remove GDALDatasets missing in IN, using file size and modification time" << std::endl;
         std::cout << "  -d, --debug                   Print debug messages" << std::endl;
         std::cout << std::endl;
     } else if (command == "info") {
@@ -80,6 +82,7 @@ void print_usage(std::string command = "") {
         std::cout << std::endl;
         std::cout << "Evaluate a JSON-serialized SOURCE data cube and store the result as a NetCDF file (DEST)."
                   << std::endl;
+        std::cout << "If DEST ends with .zarr, the result is written as a Zarr store (directory) instead." << std::endl;
         std::cout << std::endl;
         std::cout << "Options:" << std::endl;
         std::cout << "    , --deflate            Deflate compression level for output NetCDF file (0=no compression, 9=max compression), defaults to 1" << std::endl;
@@ -169,7 +172,7 @@ int main(int argc, char* argv[]) {
             po::options_description cc_desc("create_collection arguments");
             cc_desc.add_options()("recursive,R", "Scan provided directory recursively")("format,f",
                                                                                         po::value<std::string>(), "")(
-                "strict,s", "")("noarchives", "")("input", po::value<std::string>(), "")("output",
+                "strict,s", "")("threads,t", po::value<uint16_t>()->default_value(1), "")("update,u", "")("noarchives", "")("input", po::value<std::string>(), "")("output",
                                                                                          po::value<std::string>(),
                                                                                          "");
 
@@ -198,10 +201,10 @@ int main(int argc, char* argv[]) {
             if (vm.count("noarchives")) {
                 scan_archives = false;
             }
+            config::instance()->set_collection_index_threads(vm["threads"].as<uint16_t>());
 
             std::string input = vm["input"].as<std::string>();
             std::string output = vm["output"].as<std::string>();
-            std::string format = vm["format"].as<std::string>();
 
             std::vector<std::string> in;
 
@@ -230,10 +233,17 @@ int main(int argc, char* argv[]) {
                 in = image_collection::unroll_archives(in);
             }
 
-            collection_format f(format);
-            auto ic = image_collection::create(f, in, strict);
-            ic->write(output);
-            std::cout << ic->to_string() << std::endl;
+            if (vm.count("update") && filesystem::exists(output)) {
+                auto ic = std::make_shared<image_collection>(output);
+                ic->refresh(in, strict);
+                std::cout << ic->to_string() << std::endl;
+            } else {
+                std::string format = vm["format"].as<std::string>();
+                collection_format f(format);
+                auto ic = image_collection::create(f, in, strict);
+                ic->write(output);
+                std::cout << ic->to_string() << std::endl;
+            }
 
         } else if (cmd == "info") {
             po::options_description info_desc("info arguments");
@@ -324,6 +334,8 @@ int main(int argc, char* argv[]) {
             std::shared_ptr<cube> c = cube_factory::instance()->create_from_json_file(input);
             if (vm.count("chunk")) {
                 c->write_single_chunk_netcdf(vm["chunk"].as<chunkid_t>(), output, deflate);
+            } else if (filesystem::extension(output) == "zarr") {
+                c->write_zarr(output, deflate);
             } else {
                 c->write_netcdf_file(output, deflate);
             }
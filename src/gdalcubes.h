@@ -31,6 +31,7 @@
 #include "aggregate_space.h"
 #include "apply_pixel.h"
 #include "build_info.h"
+#include "chunkstore_cube.h"
 #include "config.h"
 #include "cube.h"
 #include "crop.h"
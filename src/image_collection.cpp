@@ -24,21 +24,25 @@
 
 #include "image_collection.h"
 
+#include <cpl_vsi.h>
 #include <gdalwarper.h>
 #include <sqlite3.h>
 
+#include <condition_variable>
 #include <regex>
 #include <set>
+#include <thread>
 #include <unordered_set>
 
 #include "config.h"
 #include "external/date.h"
 #include "filesystem.h"
+#include "timer.h"
 #include "utils.h"
 
 namespace gdalcubes {
 
-image_collection::image_collection() : _format(), _filename(""), _db(nullptr) {
+image_collection::image_collection() : _format(), _filename(""), _db(nullptr), _read_only(false), _ro_mutex(), _ro_idle(), _ro_all() {
     if (sqlite3_open_v2("", &_db, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_FULLMUTEX, NULL) != SQLITE_OK) {
         std::string msg = "ERROR in image_collection::create(): cannot create temporary image collection file.";
         throw msg;
@@ -88,7 +92,8 @@ image_collection::image_collection() : _format(), _filename(""), _db(nullptr) {
     std::string sql_schema_gdalrefs =
         "CREATE TABLE gdalrefs (image_id INTEGER, band_id INTEGER, descriptor TEXT, band_num INTEGER, FOREIGN KEY (image_id) REFERENCES images(id) ON DELETE CASCADE, PRIMARY KEY (image_id, band_id), FOREIGN KEY (band_id) REFERENCES bands(id) ON DELETE CASCADE);"
         "CREATE INDEX idx_gdalrefs_bandid ON gdalrefs(band_id);"
-        "CREATE INDEX idx_gdalrefs_imageid ON gdalrefs(image_id);";
+        "CREATE INDEX idx_gdalrefs_imageid ON gdalrefs(image_id);"
+        "CREATE INDEX idx_gdalrefs_descriptor ON gdalrefs(descriptor);";
     if (sqlite3_exec(_db, sql_schema_gdalrefs.c_str(), NULL, NULL, NULL) != SQLITE_OK) {
         throw std::string("ERROR in collection_format::apply(): cannot create image collection schema (vi).");
     }
@@ -131,12 +136,56 @@ image_collection::image_collection(collection_format format) : image_collection(
     }
 }
 
-image_collection::image_collection(std::string filename) : _format(), _filename(filename), _db(nullptr) {
+/**
+ * Open a database file as immutable and read-only with memory-mapped I/O
+ * @param filename path to the database file
+ * @param flags additional flags for sqlite3_open_v2(), i.e. threading mode
+ * @return SQLite handle or nullptr if opening failed
+ */
+static sqlite3* open_read_only(std::string filename, int flags) {
+    // build URI filename, see https://www.sqlite.org/uri.html
+    std::string uri = "file:";
+    for (uint32_t i = 0; i < filename.size(); ++i) {
+        char c = filename[i];
+        if (c == '%') {
+            uri += "%25";
+        } else if (c == '?') {
+            uri += "%3f";
+        } else if (c == '#') {
+            uri += "%23";
+        }
+#ifdef _WIN32
+        else if (c == '\\') {
+            uri += "/";
+        }
+#endif
+        else {
+            uri += c;
+        }
+    }
+    uri += "?immutable=1";
+
+    sqlite3* db = nullptr;
+    if (sqlite3_open_v2(uri.c_str(), &db, SQLITE_OPEN_READONLY | SQLITE_OPEN_URI | flags, NULL) != SQLITE_OK) {
+        if (db) sqlite3_close(db);
+        return nullptr;
+    }
+    // pages are shared between connections through the OS page cache
+    sqlite3_exec(db, "PRAGMA mmap_size=268435456;", NULL, NULL, NULL);  // 256 MiB
+    return db;
+}
+
+image_collection::image_collection(std::string filename, bool read_only) : _format(), _filename(filename), _db(nullptr), _read_only(read_only), _ro_mutex(), _ro_idle(), _ro_all() {
     // TODO: IMPLEMENT VERSIONING OF COLLECTION FORMATS AND CHECK COMPATIBILITY HERE
     if (!filesystem::exists(filename)) {
         throw std::string("ERROR in image_collection::image_collection(): input collection '" + filename + "' does not exist.");
     }
-    if (sqlite3_open_v2(filename.c_str(), &_db, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_FULLMUTEX, NULL) != SQLITE_OK) {
+    if (read_only) {
+        _db = open_read_only(filename, SQLITE_OPEN_FULLMUTEX);
+        if (!_db) {
+            throw std::string("ERROR in image_collection::image_collection(): cannot open existing image collection file in read-only mode.");
+        }
+    } else if (sqlite3_open_v2(filename.c_str(), &_db, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_FULLMUTEX, NULL) != SQLITE_OK) {
         std::string msg = "ERROR in image_collection::image_collection(): cannot open existing image collection file.";
         throw msg;
     }
@@ -160,6 +209,15 @@ image_collection::image_collection(std::string filename) : _format(), _filename(
 }
 
 image_collection::~image_collection() {
+    for (uint32_t i = 0; i < _ro_all.size(); ++i) {
+        for (auto it = _ro_all[i]->stmts.begin(); it != _ro_all[i]->stmts.end(); ++it) {
+            sqlite3_finalize(it->second);
+        }
+        sqlite3_close(_ro_all[i]->db);
+        delete _ro_all[i];
+    }
+    _ro_all.clear();
+    _ro_idle.clear();
     if (_db) {
         sqlite3_close(_db);
         _db = nullptr;
@@ -200,6 +258,40 @@ struct image_band {
     std::string nodata;
 };
 
+/**
+ * @brief Information extracted from a single GDAL dataset that is needed to add it to an image collection
+ * @see image_collection::add_with_collection_format
+ */
+struct indexed_dataset {
+    indexed_dataset() : skip(false), debug(""), error(""), warning(""), warnings(), image_name(""), pt(), datetime_failed(false), bbox(), srs(""), bands(), band_matches(), raster_count(0), md() {}
+
+    /**
+     * @brief Mark the dataset as failed
+     * @param err error message, thrown in strict mode
+     * @param warn warning message, reported in non-strict mode
+     */
+    void fail(std::string err, std::string warn) {
+        error = err;
+        warning = warn;
+    }
+
+    bool skip;  // ignore the dataset, e.g. because it does not match the global pattern
+    std::string debug;
+    std::string error;
+    std::string warning;
+    std::vector<std::string> warnings;  // additional warnings that do not prevent adding the dataset
+
+    std::string image_name;
+    date::sys_seconds pt;
+    bool datetime_failed;
+    bounds_2d<double> bbox;
+    std::string srs;
+    std::vector<image_band> bands;
+    std::vector<uint16_t> band_matches;  // indexes of collection format bands with matching pattern
+    uint16_t raster_count;
+    std::vector<std::pair<std::string, std::string>> md;  // image metadata key value pairs
+};
+
 void image_collection::add_with_datetime(std::vector<std::string> descriptors, std::vector<std::string> date_time,
                                          std::vector<std::string> band_names, bool use_subdatasets) {
     if (!_format.is_null()) {
@@ -728,37 +820,36 @@ void image_collection::add_with_collection_format(std::vector<std::string> descr
         }
     }
 
-    uint32_t counter = -1;
-    std::shared_ptr<progress> p = config::instance()->get_default_progress_bar()->get();
-    p->set(0);  // explicitly set to zero to show progress bar immediately
-    for (auto it = descriptors.begin(); it != descriptors.end(); ++it) {
-        ++counter;
-
-        p->set((double)counter / (double)descriptors.size());
-        if (!global_pattern.empty()) {  // prevent unnecessary GDALOpen calls
-            if (!std::regex_match(*it, regex_global_pattern)) {
-                // std::cout << "ignoring " << *it << std::endl;
-                GCBS_DEBUG("Dataset " + *it + " doesn't match the global collection pattern and will be ignored");
-                continue;
-            }
+    std::unordered_set<std::string> image_md_fields;
+    if (!_format.json()["image_md_fields"].is_null()) {
+        for (uint16_t imd_fields = 0; imd_fields < _format.json()["image_md_fields"].array_items().size(); ++imd_fields) {
+            image_md_fields.insert(_format.json()["image_md_fields"][imd_fields].string_value());
         }
+    }
 
-        // Read GDAL metadata
-        GDALDataset* dataset = (GDALDataset*)GDALOpen((*it).c_str(), GA_ReadOnly);
-        if (!dataset) {
-            if (strict) throw std::string("ERROR in image_collection::add(): GDAL cannot open '" + *it + "'.");
-            GCBS_WARN("GDAL failed to open " + *it);
-            continue;
+    // Derive an SRS identifier, preferably as authority code
+    auto srs_to_string = [](OGRSpatialReference& srs_in) {
+        std::string srs_str;
+        if (srs_in.GetAuthorityName(NULL) != NULL && srs_in.GetAuthorityCode(NULL) != NULL) {
+            srs_str = std::string(srs_in.GetAuthorityName(NULL)) + ":" + std::string(srs_in.GetAuthorityCode(NULL));
+        } else {
+            char* tmp;
+            srs_in.exportToWkt(&tmp);
+            srs_str = std::string(tmp);
+            CPLFree(tmp);
         }
-        // if check = false, the following is not really needed if image is already in the database due to another file.
+        return srs_str;
+    };
+
+    // Extract everything needed to add a dataset from its descriptor and GDAL metadata. This
+    // function does not access the database and may be called concurrently from several threads.
+    auto extract_from_dataset = [&](const std::string& descriptor, GDALDataset* dataset, indexed_dataset& out) {
         double affine_in[6] = {0, 0, 1, 0, 0, 1};
         bounds_2d<double> bbox;
         std::string srs_str;
         if (dataset->GetGeoTransform(affine_in) != CE_None) {
             // No affine transformation, maybe GCPs?
             if (dataset->GetGCPCount() > 0) {
-                dataset->GetGCPProjection();  // TODO replace with GetGCPSpatialRef if available (GDAL > 2.5)
-
                 // First try, find GCPs for corner pixels
                 double xmin = std::numeric_limits<double>::infinity();
                 double ymin = std::numeric_limits<double>::infinity();
@@ -768,26 +859,17 @@ void image_collection::add_with_collection_format(std::vector<std::string> descr
 
                 for (int32_t igcp = 0; igcp < dataset->GetGCPCount(); ++igcp) {
                     GDAL_GCP gcp = dataset->GetGCPs()[igcp];
+                    bool corner = false;
                     if (gcp.dfGCPLine == 0 && gcp.dfGCPPixel == 0) {
-                        x1 = true;
-                        if (gcp.dfGCPX < xmin) xmin = gcp.dfGCPX;
-                        if (gcp.dfGCPX > xmax) xmax = gcp.dfGCPX;
-                        if (gcp.dfGCPY < ymin) ymin = gcp.dfGCPY;
-                        if (gcp.dfGCPY > ymax) ymax = gcp.dfGCPY;
+                        x1 = corner = true;
                     } else if (gcp.dfGCPLine == dataset->GetRasterYSize() - 1 && gcp.dfGCPPixel == 0) {
-                        x2 = true;
-                        if (gcp.dfGCPX < xmin) xmin = gcp.dfGCPX;
-                        if (gcp.dfGCPX > xmax) xmax = gcp.dfGCPX;
-                        if (gcp.dfGCPY < ymin) ymin = gcp.dfGCPY;
-                        if (gcp.dfGCPY > ymax) ymax = gcp.dfGCPY;
+                        x2 = corner = true;
                     } else if (gcp.dfGCPLine == 0 && gcp.dfGCPPixel == dataset->GetRasterXSize() - 1) {
-                        x3 = true;
-                        if (gcp.dfGCPX < xmin) xmin = gcp.dfGCPX;
-                        if (gcp.dfGCPX > xmax) xmax = gcp.dfGCPX;
-                        if (gcp.dfGCPY < ymin) ymin = gcp.dfGCPY;
-                        if (gcp.dfGCPY > ymax) ymax = gcp.dfGCPY;
+                        x3 = corner = true;
                     } else if (gcp.dfGCPLine == dataset->GetRasterYSize() - 1 && gcp.dfGCPPixel == dataset->GetRasterXSize() - 1) {
-                        x4 = true;
+                        x4 = corner = true;
+                    }
+                    if (corner) {
                         if (gcp.dfGCPX < xmin) xmin = gcp.dfGCPX;
                         if (gcp.dfGCPX > xmax) xmax = gcp.dfGCPX;
                         if (gcp.dfGCPY < ymin) ymin = gcp.dfGCPY;
@@ -795,41 +877,22 @@ void image_collection::add_with_collection_format(std::vector<std::string> descr
                     }
                 }
 
+                OGRSpatialReference srs_in;
+                srs_in.SetFromUserInput(dataset->GetGCPProjection());  // TODO replace with GetGCPSpatialRef if available (GDAL > 2.5)
+                srs_str = srs_to_string(srs_in);
+
                 if (x1 && x2 && x3 && x4) {
                     // use extent from corner GCPS
                     bbox.left = xmin;
                     bbox.right = xmax;
                     bbox.top = ymax;
                     bbox.bottom = ymin;
-                    OGRSpatialReference srs_in;
-                    srs_in.SetFromUserInput(dataset->GetGCPProjection());
-
-                    if ( srs_in.GetAuthorityName(NULL) != NULL &&  srs_in.GetAuthorityCode(NULL) != NULL) {
-                        srs_str = std::string( srs_in.GetAuthorityName(NULL)) + ":" + std::string(srs_in.GetAuthorityCode(NULL));
-                    }
-                    else {
-                        char *tmp;
-                        srs_in.exportToWkt(&tmp);
-                        srs_str = std::string(tmp);
-                        CPLFree(tmp);
-                    }
                     bbox.transform(srs_str, "EPSG:4326");
                 } else {
                     //approximate extent based on gdalwarp
                     double approx_geo_transform[6];
                     int nx = 0, ny = 0;
-                    double extent[4];
-                    OGRSpatialReference srs_in;
-                    srs_in.SetFromUserInput(dataset->GetGCPProjection());
-                    if ( srs_in.GetAuthorityName(NULL) != NULL &&  srs_in.GetAuthorityCode(NULL) != NULL) {
-                        srs_str = std::string( srs_in.GetAuthorityName(NULL)) + ":" + std::string(srs_in.GetAuthorityCode(NULL));
-                    }
-                    else {
-                        char *tmp;
-                        srs_in.exportToWkt(&tmp);
-                        srs_str = std::string(tmp);
-                        CPLFree(tmp);
-                    }
+                    double extent[4] = {0, 0, 0, 0};
 
                     CPLStringList transform_args;
                     transform_args.AddString(("SRC_SRS=" + std::string(srs_str)).c_str());
@@ -841,11 +904,12 @@ void image_collection::add_with_collection_format(std::vector<std::string> descr
                     if (GDALSuggestedWarpOutput2(dataset,
                                                  GDALGenImgProjTransform, transform,
                                                  approx_geo_transform, &nx, &ny, extent, 0) != CE_None) {
-                        if (strict) throw std::string("ERROR in image_collection::add(): GDAL cannot derive extent for '" + *it + "'.");
-                        GCBS_WARN("Failed to derive spatial extent from " + *it);
+                        out.fail("ERROR in image_collection::add(): GDAL cannot derive extent for '" + descriptor + "'.",
+                                 "Failed to derive spatial extent from " + descriptor);
+                        if (transform) GDALDestroyGenImgProjTransformer(transform);
+                        return;
                     }
-
-                    // TODO: error handling
+                    if (transform) GDALDestroyGenImgProjTransformer(transform);
                     bbox.left = extent[0];
                     bbox.right = extent[2];
                     bbox.top = extent[3];
@@ -853,10 +917,9 @@ void image_collection::add_with_collection_format(std::vector<std::string> descr
                 }
 
             } else {
-                GDALClose((GDALDatasetH)dataset);
-                if (strict) throw std::string("ERROR in image_collection::add(): GDAL cannot derive spatial extent for '" + *it + "'.");
-                GCBS_WARN("Failed to derive spatial extent from " + *it);
-                continue;
+                out.fail("ERROR in image_collection::add(): GDAL cannot derive spatial extent for '" + descriptor + "'.",
+                         "Failed to derive spatial extent from " + descriptor);
+                return;
             }
         } else {
             bbox.left = affine_in[0];
@@ -871,38 +934,28 @@ void image_collection::add_with_collection_format(std::vector<std::string> descr
                 if (dataset->GetProjectionRef() != NULL && !std::string(dataset->GetProjectionRef()).empty()) {
                     srs_in.SetFromUserInput(dataset->GetProjectionRef());
                     if (!srs_in.IsSame(&global_srs)) {
-                        GCBS_WARN("SRS of dataset '" + (*it) + "' is different from global SRS and will be overwritten.");
+                        out.warnings.push_back("SRS of dataset '" + descriptor + "' is different from global SRS and will be overwritten.");
                     }
                 }
                 srs_in = global_srs;
             }
-
-            if ( srs_in.GetAuthorityName(NULL) != NULL &&  srs_in.GetAuthorityCode(NULL) != NULL) {
-                srs_str = std::string( srs_in.GetAuthorityName(NULL)) + ":" + std::string(srs_in.GetAuthorityCode(NULL));
-            }
-            else {
-                char *tmp;
-                srs_in.exportToWkt(&tmp);
-                srs_str = std::string(tmp);
-                CPLFree(tmp);
-            }
+            srs_str = srs_to_string(srs_in);
             bbox.transform(srs_str, "EPSG:4326");
         }
+        out.bbox = bbox;
+        out.srs = srs_str;
 
         // TODO: check consistency for all files of an image?!
         // -> add parameter checks=true / false
 
-        std::cmatch res_image;
-        if (!std::regex_match(it->c_str(), res_image, regex_images)) {
-            if (strict) throw std::string("ERROR in image_collection::add(): image composition rule failed for " + std::string(*it));
-            GCBS_WARN("Skipping " + *it + " due to failed image composition rule");
-            continue;
+        std::cmatch res_datetime;
+        bool has_datetime = std::regex_match(descriptor.c_str(), res_datetime, regex_datetime);
+        if (has_datetime) {
+            out.pt = datetime::tryparse(datetime_format, res_datetime[1].str());
         }
 
         if (!time_as_bands) {
             // Input dataset is a SINGLE image with only one point in time
-
-            std::vector<image_band> bands;
             for (uint16_t i = 0; i < dataset->GetRasterCount(); ++i) {
                 image_band b;
                 b.type = dataset->GetRasterBand(i + 1)->GetRasterDataType();
@@ -914,223 +967,391 @@ void image_collection::add_with_collection_format(std::vector<std::string> descr
                 double nd = dataset->GetRasterBand(i + 1)->GetNoDataValue(&hasnodata);
                 if (hasnodata)
                     b.nodata = std::to_string(nd);
-                bands.push_back(b);
+                out.bands.push_back(b);
             }
-            if (bands.empty()) {
-                if (strict) throw std::string("ERROR in image_collection::add(): " + *it + " doesn't contain any band data and will be ignored");
-                GCBS_WARN("Dataset " + *it + " doesn't contain any band data and will be ignored");
-                continue;
+            if (out.bands.empty()) {
+                out.fail("ERROR in image_collection::add(): " + descriptor + " doesn't contain any band data and will be ignored",
+                         "Dataset " + descriptor + " doesn't contain any band data and will be ignored");
+                return;
             }
+            // datetime is only needed if the image has not been added before
+            out.datetime_failed = !has_datetime;
 
-            uint32_t image_id;
-            std::string sql_select_image = "SELECT id FROM images WHERE name='" + res_image[1].str() + "'";
-            sqlite3_stmt* stmt;
-            sqlite3_prepare_v2(_db, sql_select_image.c_str(), -1, &stmt, NULL);
-            if (!stmt) {
-                // @TODO do error check here
-            }
-            if (sqlite3_step(stmt) == SQLITE_DONE) {
-                // Empty result --> image has not been added before
-
-                // @TODO: Shall we check that all files óf the same image have the same date / time? Currently we don't.
-
-                // Extract datetime
-                std::cmatch res_datetime;
-                if (!std::regex_match(it->c_str(), res_datetime, regex_datetime)) {  // not sure to continue or throw an exception here...
-                    if (strict) throw std::string("ERROR in image_collection::add(): datetime rule failed for " + std::string(*it));
-                    GCBS_WARN("Skipping " + *it + " due to failed datetime rule");
-                    continue;
-                }
-
-                std::stringstream os;
-                date::sys_seconds pt;
-                pt = datetime::tryparse(datetime_format, res_datetime[1].str());
-                os << date::format("%Y-%m-%dT%H:%M:%S", pt);
-
-                // Convert to ISO string including separators (boost::to_iso_string or boost::to_iso_extended_string do not work with SQLite datetime functions)
-                std::string sql_insert_image = "INSERT OR IGNORE INTO images(name, datetime, left, top, bottom, right, proj) VALUES('" + res_image[1].str() + "','" +
-                                               os.str() + "'," +
-                                               std::to_string(bbox.left) + "," + std::to_string(bbox.top) + "," + std::to_string(bbox.bottom) + "," + std::to_string(bbox.right) + ",'" + srs_str + "')";
-                if (sqlite3_exec(_db, sql_insert_image.c_str(), NULL, NULL, NULL) != SQLITE_OK) {
-                    if (strict) throw std::string("ERROR in image_collection::add(): cannot add image to images table.");
-                    GCBS_WARN("Skipping " + *it + " due to failed image table insert");
-                    continue;
-                }
-                image_id = sqlite3_last_insert_rowid(_db);  // take care of race conditions if things run parallel at some point
-
-            } else {
-                image_id = sqlite3_column_int(stmt, 0);
-                // TODO: if checks, compare l,r,b,t, datetime,srs_str from images table with current GDAL dataset
-            }
-            sqlite3_finalize(stmt);
-
-            // Insert into gdalrefs table
             for (uint16_t i = 0; i < band_name.size(); ++i) {
-                if (std::regex_match(*it, regex_band_pattern[i])) {
-                    // TODO: if checks, check whether bandnum exists in GDALdataset
-                    // TODO: if checks, compare band type, offset, scale, unit, etc. with current GDAL dataset
-
-                    if (!band_complete[i]) {
-                        std::string sql_band_update = "UPDATE bands SET type='" + utils::string_from_gdal_type(bands[band_num[i] - 1].type) + "'";
-
-                        if (_format.json()["bands"][band_name[i]]["scale"].is_null())
-                            sql_band_update += ",scale=" + std::to_string(bands[band_num[i] - 1].scale);
-                        if (_format.json()["bands"][band_name[i]]["offset"].is_null())
-                            sql_band_update += ",offset=" + std::to_string(bands[band_num[i] - 1].offset);
-                        if (_format.json()["bands"][band_name[i]]["unit"].is_null())
-                            sql_band_update += ",unit='" + bands[band_num[i] - 1].unit + "'";
-
-                        // TODO: also add no data if not defined in image collection?
-                        sql_band_update += " WHERE name='" + band_name[i] + "';";
-
-                        if (sqlite3_exec(_db, sql_band_update.c_str(), NULL, NULL, NULL) != SQLITE_OK) {
-                            if (strict) throw std::string("ERROR in image_collection::add(): cannot update band table.");
-                            GCBS_WARN("Skipping " + *it + " due to failed band table update");
-                            continue;
-                        }
-                        band_complete[i] = true;
-                    }
-
-                    std::string sql_insert_gdalref = "INSERT INTO gdalrefs(descriptor, image_id, band_id, band_num) VALUES('" + sqlite_escape_singlequotes(*it) + "'," + std::to_string(image_id) + "," + std::to_string(band_ids[i]) + "," + std::to_string(band_num[i]) + ");";
-                    if (sqlite3_exec(_db, sql_insert_gdalref.c_str(), NULL, NULL, NULL) != SQLITE_OK) {
-                        if (strict) throw std::string("ERROR in image_collection::add(): cannot add dataset to gdalrefs table.");
-                        GCBS_WARN("Skipping " + *it + "  due to failed gdalrefs insert");
-                        break;  // break only works because there is nothing after the loop.
-                    }
+                if (std::regex_match(descriptor, regex_band_pattern[i])) {
+                    out.band_matches.push_back(i);
                 }
             }
 
             // Read image metadata from GDALDataset
-            std::unordered_set<std::string> image_md_fields;
-
-            if (!_format.json()["image_md_fields"].is_null()) {
-                for (uint16_t imd_fields = 0; imd_fields < _format.json()["image_md_fields"].array_items().size(); ++imd_fields) {
-                    image_md_fields.insert(_format.json()["image_md_fields"][imd_fields].string_value());
-                }
-            }
-
             if (image_md_fields.size() > 0) {
                 char** md_domains = dataset->GetMetadataDomainList();
                 for (auto cur_md_key = image_md_fields.begin(); cur_md_key != image_md_fields.end(); ++cur_md_key) {
                     // has domain?
                     std::size_t sep_pos = cur_md_key->find_first_of(":");
+                    const char* value = nullptr;
                     if (sep_pos != std::string::npos) {
-                        // has domain
-
                         std::string domain = cur_md_key->substr(0, sep_pos);
                         std::string field = cur_md_key->substr(sep_pos + 1, std::string::npos);
 
                         // does the domain exist?
-                        if (CSLFindString(md_domains, domain.c_str()) == -1) {
-                            // no
-                            continue;
-                        } else {
-                            // yes
-                            const char* value = CSLFetchNameValue(dataset->GetMetadata(domain.c_str()), field.c_str());
-                            if (value) {
-                                std::string sql_insert_image_md = "INSERT OR IGNORE INTO image_md(image_id, key, value) VALUES(" + std::to_string(image_id) + ",'" + *cur_md_key + "','" + std::string(value) + "');";
-                                sqlite3_exec(_db, sql_insert_image_md.c_str(), NULL, NULL, NULL);
-                            }
+                        if (CSLFindString(md_domains, domain.c_str()) != -1) {
+                            value = CSLFetchNameValue(dataset->GetMetadata(domain.c_str()), field.c_str());
                         }
                     } else {
                         // default domain
-                        const char* value = CSLFetchNameValue(dataset->GetMetadata(), cur_md_key->c_str());
-                        if (value) {
-                            std::string sql_insert_image_md = "INSERT OR IGNORE INTO image_md(image_id, key, value) VALUES(" + std::to_string(image_id) + ",'" + *cur_md_key + "','" + std::string(value) + "');";
-                            sqlite3_exec(_db, sql_insert_image_md.c_str(), NULL, NULL, NULL);
-                        }
+                        value = CSLFetchNameValue(dataset->GetMetadata(), cur_md_key->c_str());
+                    }
+                    if (value) {
+                        out.md.push_back(std::make_pair(*cur_md_key, std::string(value)));
                     }
                 }
                 CSLDestroy(md_domains);
             }
-
         } else {
             // Input dataset is multitemporal, bands represent different points in time
-            // Add as multiple images to the image collection as
-
-            std::cmatch res_datetime;
-            if (!std::regex_match(it->c_str(), res_datetime, regex_datetime)) {  // not sure to continue or throw an exception here...
-                if (strict) throw std::string("ERROR in image_collection::add(): datetime rule failed for " + std::string(*it));
-                GCBS_WARN("Skipping " + *it + " due to failed datetime rule");
-                continue;
+            if (!has_datetime) {
+                out.fail("ERROR in image_collection::add(): datetime rule failed for " + descriptor,
+                         "Skipping " + descriptor + " due to failed datetime rule");
+                return;
             }
 
-            date::sys_seconds pt;
-            pt = datetime::tryparse(datetime_format, res_datetime[1].str());
-
             // find the corresponding band of the dataset (there can be only 1 because bands represent time)
-            // and update band information in database if needed
-            int16_t band_index = -1;
             for (uint16_t i = 0; i < band_name.size(); ++i) {
-                if (std::regex_match(*it, regex_band_pattern[i])) {
-                    band_index = i;
+                if (std::regex_match(descriptor, regex_band_pattern[i])) {
+                    out.band_matches.push_back(i);
                     break;
                 }
             }
-            if (band_index == -1) {
-                continue;
+            if (out.band_matches.empty()) {
+                out.skip = true;
+                return;
             }
+            image_band b;
+            b.type = dataset->GetRasterBand(1)->GetRasterDataType();
+            b.offset = dataset->GetRasterBand(1)->GetOffset();
+            b.scale = dataset->GetRasterBand(1)->GetScale();
+            b.unit = dataset->GetRasterBand(1)->GetUnitType();
+            b.nodata = "";
+            int hasnodata = 0;
+            double nd = dataset->GetRasterBand(1)->GetNoDataValue(&hasnodata);
+            if (hasnodata)
+                b.nodata = std::to_string(nd);
+            out.bands.push_back(b);
+            out.raster_count = dataset->GetRasterCount();
+        }
+    };
 
-            if (!band_complete[band_index]) {
-                image_band b;
-                b.type = dataset->GetRasterBand(1)->GetRasterDataType();
-                b.offset = dataset->GetRasterBand(1)->GetOffset();
-                b.scale = dataset->GetRasterBand(1)->GetScale();
-                b.unit = dataset->GetRasterBand(1)->GetUnitType();
-                b.nodata = "";
-                int hasnodata = 0;
-                double nd = dataset->GetRasterBand(1)->GetNoDataValue(&hasnodata);
-                if (hasnodata)
-                    b.nodata = std::to_string(nd);
-                std::string sql_band_update = "UPDATE bands SET type='" + utils::string_from_gdal_type(b.type) + "'";
+    auto extract = [&](const std::string& descriptor, indexed_dataset& out) {
+        if (!global_pattern.empty()) {  // prevent unnecessary GDALOpen calls
+            if (!std::regex_match(descriptor, regex_global_pattern)) {
+                out.skip = true;
+                out.debug = "Dataset " + descriptor + " doesn't match the global collection pattern and will be ignored";
+                return;
+            }
+        }
+        std::cmatch res_image;
+        if (!std::regex_match(descriptor.c_str(), res_image, regex_images)) {
+            out.fail("ERROR in image_collection::add(): image composition rule failed for " + descriptor,
+                     "Skipping " + descriptor + " due to failed image composition rule");
+            return;
+        }
+        out.image_name = res_image[1].str();
 
-                if (_format.json()["bands"][band_name[band_index]]["scale"].is_null())
-                    sql_band_update += ",scale=" + std::to_string(b.scale);
-                if (_format.json()["bands"][band_name[band_index]]["offset"].is_null())
-                    sql_band_update += ",offset=" + std::to_string(b.offset);
-                if (_format.json()["bands"][band_name[band_index]]["unit"].is_null())
-                    sql_band_update += ",unit='" + b.unit + "'";
+        // Read GDAL metadata
+        GDALDataset* dataset = (GDALDataset*)GDALOpen(descriptor.c_str(), GA_ReadOnly);
+        if (!dataset) {
+            out.fail("ERROR in image_collection::add(): GDAL cannot open '" + descriptor + "'.",
+                     "GDAL failed to open " + descriptor);
+            return;
+        }
+        try {
+            extract_from_dataset(descriptor, dataset, out);
+        } catch (std::string s) {
+            out.fail(s, s);
+        } catch (...) {
+            out.fail("ERROR in image_collection::add(): failed to read metadata of '" + descriptor + "'.",
+                     "Failed to read metadata of " + descriptor);
+        }
+        GDALClose((GDALDatasetH)dataset);
+    };
+
+    // Prepared statements of the writer
+    sqlite3_stmt* stmt_select_image = nullptr;
+    sqlite3_stmt* stmt_insert_image = nullptr;
+    sqlite3_stmt* stmt_insert_gdalref = nullptr;
+    sqlite3_stmt* stmt_insert_image_md = nullptr;
+    sqlite3_prepare_v2(_db, "SELECT id FROM images WHERE name=?;", -1, &stmt_select_image, NULL);
+    sqlite3_prepare_v2(_db, "INSERT OR IGNORE INTO images(name, datetime, left, top, bottom, right, proj) VALUES(?,?,?,?,?,?,?);", -1, &stmt_insert_image, NULL);
+    sqlite3_prepare_v2(_db, "INSERT INTO gdalrefs(descriptor, image_id, band_id, band_num) VALUES(?,?,?,?);", -1, &stmt_insert_gdalref, NULL);
+    sqlite3_prepare_v2(_db, "INSERT OR IGNORE INTO image_md(image_id, key, value) VALUES(?,?,?);", -1, &stmt_insert_image_md, NULL);
+    auto finalize_statements = [&]() {
+        sqlite3_finalize(stmt_select_image);
+        sqlite3_finalize(stmt_insert_image);
+        sqlite3_finalize(stmt_insert_gdalref);
+        sqlite3_finalize(stmt_insert_image_md);
+    };
+    if (!stmt_select_image || !stmt_insert_image || !stmt_insert_gdalref || !stmt_insert_image_md) {
+        finalize_statements();
+        throw std::string("ERROR in image_collection::add(): cannot prepare insert statements.");
+    }
+
+    // Find the id of an image by name or insert it, returns false on failure
+    auto find_or_insert_image = [&](const std::string& name, const std::string& datetime_str, const bounds_2d<double>& bbox, const std::string& srs, bool insert, uint32_t& image_id) {
+        sqlite3_reset(stmt_select_image);
+        sqlite3_bind_text(stmt_select_image, 1, name.c_str(), -1, SQLITE_TRANSIENT);
+        if (sqlite3_step(stmt_select_image) == SQLITE_ROW) {
+            image_id = sqlite3_column_int(stmt_select_image, 0);
+            // TODO: if checks, compare l,r,b,t, datetime,srs_str from images table with current GDAL dataset
+            return true;
+        }
+        if (!insert) return false;
+        sqlite3_reset(stmt_insert_image);
+        sqlite3_bind_text(stmt_insert_image, 1, name.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt_insert_image, 2, datetime_str.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_double(stmt_insert_image, 3, bbox.left);
+        sqlite3_bind_double(stmt_insert_image, 4, bbox.top);
+        sqlite3_bind_double(stmt_insert_image, 5, bbox.bottom);
+        sqlite3_bind_double(stmt_insert_image, 6, bbox.right);
+        sqlite3_bind_text(stmt_insert_image, 7, srs.c_str(), -1, SQLITE_TRANSIENT);
+        if (sqlite3_step(stmt_insert_image) != SQLITE_DONE) {
+            return false;
+        }
+        image_id = sqlite3_last_insert_rowid(_db);
+        return true;
+    };
+
+    auto insert_gdalref = [&](const std::string& descriptor, uint32_t image_id, uint32_t band_id, uint16_t bnum) {
+        sqlite3_reset(stmt_insert_gdalref);
+        sqlite3_bind_text(stmt_insert_gdalref, 1, descriptor.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int(stmt_insert_gdalref, 2, image_id);
+        sqlite3_bind_int(stmt_insert_gdalref, 3, band_id);
+        sqlite3_bind_int(stmt_insert_gdalref, 4, bnum);
+        return sqlite3_step(stmt_insert_gdalref) == SQLITE_DONE;
+    };
+
+    auto update_band = [&](uint16_t i, const image_band& b) {
+        std::string sql_band_update = "UPDATE bands SET type='" + utils::string_from_gdal_type(b.type) + "'";
+        if (_format.json()["bands"][band_name[i]]["scale"].is_null())
+            sql_band_update += ",scale=" + std::to_string(b.scale);
+        if (_format.json()["bands"][band_name[i]]["offset"].is_null())
+            sql_band_update += ",offset=" + std::to_string(b.offset);
+        if (_format.json()["bands"][band_name[i]]["unit"].is_null())
+            sql_band_update += ",unit='" + b.unit + "'";
+
+        // TODO: also add no data if not defined in image collection?
+        sql_band_update += " WHERE name='" + band_name[i] + "';";
+        return sqlite3_exec(_db, sql_band_update.c_str(), NULL, NULL, NULL) == SQLITE_OK;
+    };
+
+    // Add a dataset with previously extracted information to the database, called from one thread only
+    auto write = [&](const std::string& descriptor, indexed_dataset& d) {
+        for (uint16_t iw = 0; iw < d.warnings.size(); ++iw) {
+            GCBS_WARN(d.warnings[iw]);
+        }
+        if (!d.error.empty()) {
+            if (strict) throw d.error;
+            GCBS_WARN(d.warning);
+            return;
+        }
+        if (d.skip) {
+            if (!d.debug.empty()) GCBS_DEBUG(d.debug);
+            return;
+        }
+
+        if (!time_as_bands) {
+            std::string datetime_str;
+            if (!d.datetime_failed) {
+                std::stringstream os;
+                os << date::format("%Y-%m-%dT%H:%M:%S", d.pt);
+                datetime_str = os.str();
+            }
+            uint32_t image_id;
+            if (!find_or_insert_image(d.image_name, datetime_str, d.bbox, d.srs, !d.datetime_failed, image_id)) {
+                if (d.datetime_failed) {
+                    // @TODO: Shall we check that all files óf the same image have the same date / time? Currently we don't.
+                    if (strict) throw std::string("ERROR in image_collection::add(): datetime rule failed for " + descriptor);
+                    GCBS_WARN("Skipping " + descriptor + " due to failed datetime rule");
+                } else {
+                    if (strict) throw std::string("ERROR in image_collection::add(): cannot add image to images table.");
+                    GCBS_WARN("Skipping " + descriptor + " due to failed image table insert");
+                }
+                return;
+            }
 
-                // TODO: also add no data if not defined in image collection?
-                sql_band_update += " WHERE name='" + band_name[band_index] + "';";
+            // Insert into gdalrefs table
+            for (uint16_t ib = 0; ib < d.band_matches.size(); ++ib) {
+                uint16_t i = d.band_matches[ib];
+                // TODO: if checks, compare band type, offset, scale, unit, etc. with current GDAL dataset
+                if (band_num[i] < 1 || band_num[i] > d.bands.size()) {
+                    if (strict) throw std::string("ERROR in image_collection::add(): " + descriptor + " has no band " + std::to_string(band_num[i]) + ".");
+                    GCBS_WARN("Skipping band " + band_name[i] + " of " + descriptor + " due to missing band " + std::to_string(band_num[i]));
+                    continue;
+                }
+                if (!band_complete[i]) {
+                    if (!update_band(i, d.bands[band_num[i] - 1])) {
+                        if (strict) throw std::string("ERROR in image_collection::add(): cannot update band table.");
+                        GCBS_WARN("Skipping " + descriptor + " due to failed band table update");
+                        continue;
+                    }
+                    band_complete[i] = true;
+                }
+                if (!insert_gdalref(descriptor, image_id, band_ids[i], band_num[i])) {
+                    if (strict) throw std::string("ERROR in image_collection::add(): cannot add dataset to gdalrefs table.");
+                    GCBS_WARN("Skipping " + descriptor + "  due to failed gdalrefs insert");
+                    break;
+                }
+            }
 
-                if (sqlite3_exec(_db, sql_band_update.c_str(), NULL, NULL, NULL) != SQLITE_OK) {
+            for (uint16_t imd = 0; imd < d.md.size(); ++imd) {
+                sqlite3_reset(stmt_insert_image_md);
+                sqlite3_bind_int(stmt_insert_image_md, 1, image_id);
+                sqlite3_bind_text(stmt_insert_image_md, 2, d.md[imd].first.c_str(), -1, SQLITE_TRANSIENT);
+                sqlite3_bind_text(stmt_insert_image_md, 3, d.md[imd].second.c_str(), -1, SQLITE_TRANSIENT);
+                sqlite3_step(stmt_insert_image_md);
+            }
+        } else {
+            // Add as multiple images to the image collection
+            uint16_t band_index = d.band_matches[0];
+            if (!band_complete[band_index]) {
+                if (!update_band(band_index, d.bands[0])) {
                     if (strict) throw std::string("ERROR in image_collection::add(): cannot update band table.");
-                    GCBS_WARN("Skipping " + *it + " due to failed band table update");
-                    continue;
+                    GCBS_WARN("Skipping " + descriptor + " due to failed band table update");
+                    return;
                 }
                 band_complete[band_index] = true;
             }
 
             // for all time steps (bands in the current dataset)
-            for (uint16_t i = 0; i < dataset->GetRasterCount(); ++i) {
+            for (uint16_t i = 0; i < d.raster_count; ++i) {
                 // derive datetime
-                datetime t = datetime(pt, band_time_delta.dt_unit) + (band_time_delta * i);
+                datetime t = datetime(d.pt, band_time_delta.dt_unit) + (band_time_delta * i);
 
                 // add image to collection
-                std::string image_name = res_image[1].str() + "_" + t.to_string();
-                std::string sql_insert_image = "INSERT OR IGNORE INTO images(name, datetime, left, top, bottom, right, proj) VALUES('" + image_name + "','" +
-                                               t.to_string(datetime_unit::SECOND) + "'," +
-                                               std::to_string(bbox.left) + "," + std::to_string(bbox.top) + "," + std::to_string(bbox.bottom) + "," + std::to_string(bbox.right) + ",'" + srs_str + "')";
-                if (sqlite3_exec(_db, sql_insert_image.c_str(), NULL, NULL, NULL) != SQLITE_OK) {
+                std::string image_name = d.image_name + "_" + t.to_string();
+                uint32_t image_id;
+                if (!find_or_insert_image(image_name, t.to_string(datetime_unit::SECOND), d.bbox, d.srs, true, image_id)) {
                     if (strict) throw std::string("ERROR in image_collection::add(): cannot add image to images table.");
-                    GCBS_WARN("Skipping " + *it + " due to failed image table insert");
+                    GCBS_WARN("Skipping " + descriptor + " due to failed image table insert");
                     continue;
                 }
 
-                uint32_t image_id = sqlite3_last_insert_rowid(_db);  // take care of race conditions if things run parallel at some point
-
                 // add gdalref to collection
-                std::string sql_insert_gdalref = "INSERT INTO gdalrefs(descriptor, image_id, band_id, band_num) VALUES('" + sqlite_escape_singlequotes(*it) + "'," + std::to_string(image_id) + "," + std::to_string(band_ids[band_index]) + "," + std::to_string(band_num[band_index]) + ");";
-                if (sqlite3_exec(_db, sql_insert_gdalref.c_str(), NULL, NULL, NULL) != SQLITE_OK) {
+                if (!insert_gdalref(descriptor, image_id, band_ids[band_index], band_num[band_index])) {
                     if (strict) throw std::string("ERROR in image_collection::add(): cannot add dataset to gdalrefs table.");
-                    GCBS_WARN("Skipping " + *it + "  due to failed gdalrefs insert");
-                    break;  // break only works because there is nothing after the loop.
+                    GCBS_WARN("Skipping " + descriptor + "  due to failed gdalrefs insert");
+                    break;
                 }
             }
         }
-        GDALClose((GDALDatasetH)dataset);
+    };
+
+    // Datasets are processed by a pipeline: worker threads extract information from GDAL datasets, while the calling
+    // thread adds them to the database in the original order, using large transactions.
+    const uint32_t n = descriptors.size();
+    const uint32_t batch_size = 1000;
+    uint16_t nthreads = std::max(uint16_t(1), config::instance()->get_collection_index_threads());
+    if (nthreads > n) nthreads = std::max(uint32_t(1), n);
+    const uint32_t window = 64 * nthreads;  // maximum number of extracted but not yet written datasets
+
+    std::vector<std::unique_ptr<indexed_dataset>> results(n);
+    std::mutex mtx;
+    std::condition_variable cv_ready;
+    std::condition_variable cv_space;
+    uint32_t next = 0;
+    uint32_t written = 0;
+    bool cancel = false;
+
+    std::vector<std::thread> workers;
+    auto stop_workers = [&]() {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            cancel = true;
+        }
+        cv_space.notify_all();
+        for (uint16_t it = 0; it < workers.size(); ++it) {
+            workers[it].join();
+        }
+        workers.clear();
+    };
+
+    std::shared_ptr<progress> p = config::instance()->get_default_progress_bar()->get();
+    p->set(0);  // explicitly set to zero to show progress bar immediately
+    timer t_total;
+    timer t_report;
+
+    if (nthreads > 1) {
+        for (uint16_t it = 0; it < nthreads; ++it) {
+            workers.push_back(std::thread([&]() {
+                while (true) {
+                    uint32_t i;
+                    {
+                        std::unique_lock<std::mutex> lock(mtx);
+                        cv_space.wait(lock, [&] { return cancel || next >= n || next < written + window; });
+                        if (cancel || next >= n) return;
+                        i = next++;
+                    }
+                    std::unique_ptr<indexed_dataset> d(new indexed_dataset());
+                    try {
+                        extract(descriptors[i], *d);
+                    } catch (...) {
+                        d->fail("ERROR in image_collection::add(): failed to process '" + descriptors[i] + "'.",
+                                "Failed to process " + descriptors[i]);
+                    }
+                    {
+                        std::lock_guard<std::mutex> lock(mtx);
+                        results[i] = std::move(d);
+                    }
+                    cv_ready.notify_one();
+                }
+            }));
+        }
     }
+
+    sqlite3_exec(_db, "BEGIN TRANSACTION;", NULL, NULL, NULL);
+    try {
+        for (uint32_t i = 0; i < n; ++i) {
+            std::unique_ptr<indexed_dataset> d;
+            if (nthreads > 1) {
+                std::unique_lock<std::mutex> lock(mtx);
+                cv_ready.wait(lock, [&] { return results[i] != nullptr; });
+                d = std::move(results[i]);
+            } else {
+                d.reset(new indexed_dataset());
+                extract(descriptors[i], *d);
+            }
+            write(descriptors[i], *d);
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                written = i + 1;
+            }
+            cv_space.notify_all();
+
+            if ((i + 1) % batch_size == 0) {
+                sqlite3_exec(_db, "COMMIT TRANSACTION;", NULL, NULL, NULL);
+                sqlite3_exec(_db, "BEGIN TRANSACTION;", NULL, NULL, NULL);
+            }
+            p->set((double)(i + 1) / (double)n);
+            if (t_report.time() > 10) {
+                GCBS_INFO("Indexed " + std::to_string(i + 1) + " of " + std::to_string(n) + " datasets (" +
+                          std::to_string((uint32_t)((i + 1) / t_total.time())) + " datasets/s)");
+                t_report.start();
+            }
+        }
+    } catch (...) {
+        stop_workers();
+        sqlite3_exec(_db, "COMMIT TRANSACTION;", NULL, NULL, NULL);  // keep datasets that have been added before
+        finalize_statements();
+        p->finalize();
+        throw;
+    }
+    stop_workers();
+    sqlite3_exec(_db, "COMMIT TRANSACTION;", NULL, NULL, NULL);
+    finalize_statements();
+
+    double secs = t_total.time();
+    GCBS_INFO("Indexed " + std::to_string(n) + " datasets in " + std::to_string(secs) + "s (" +
+              std::to_string((uint32_t)(n / std::max(secs, 1e-6))) + " datasets/s, " + std::to_string(nthreads) + " threads)");
     p->set(1);
     p->finalize();
 }
@@ -1140,6 +1361,149 @@ void image_collection::add_with_collection_format(std::string descriptor, bool s
     return add_with_collection_format(x, strict);
 }
 
+/**
+ * Fingerprint of a dataset from its size and modification time, or (-1,-1) if VSIStatL() fails, e.g. for
+ * datasets that are not files
+ */
+static std::pair<int64_t, int64_t> dataset_fingerprint(const std::string& descriptor) {
+    VSIStatBufL s;
+    if (VSIStatL(descriptor.c_str(), &s) != 0) {
+        return std::make_pair(int64_t(-1), int64_t(-1));
+    }
+    return std::make_pair(int64_t(s.st_size), int64_t(s.st_mtime));
+}
+
+void image_collection::refresh(std::vector<std::string> descriptors, bool strict) {
+    if (_format.is_null()) {
+        throw std::string("ERROR in image_collection::refresh(): image collection has no collection format");
+    }
+    if (!_format.json()["subdatasets"].is_null() && _format.json()["subdatasets"].bool_value()) {
+        throw std::string("ERROR in image_collection::refresh(): collection formats with subdatasets are not supported");
+    }
+
+    // datasets are deleted by descriptor, collections created by older versions have no index on descriptors
+    std::string sql_schema_fingerprints =
+        "CREATE TABLE IF NOT EXISTS dataset_fingerprints (descriptor TEXT PRIMARY KEY, size INTEGER, mtime INTEGER);"
+        "CREATE INDEX IF NOT EXISTS idx_gdalrefs_descriptor ON gdalrefs(descriptor);";
+    if (sqlite3_exec(_db, sql_schema_fingerprints.c_str(), NULL, NULL, NULL) != SQLITE_OK) {
+        throw std::string("ERROR in image_collection::refresh(): cannot create fingerprints table");
+    }
+
+    // load stored datasets and their fingerprints
+    std::unordered_map<std::string, std::pair<int64_t, int64_t>> stored;
+    std::unordered_set<std::string> stored_without_fingerprint;
+    {
+        std::string sql = "SELECT DISTINCT gdalrefs.descriptor, dataset_fingerprints.size, dataset_fingerprints.mtime FROM gdalrefs "
+                          "LEFT JOIN dataset_fingerprints ON gdalrefs.descriptor = dataset_fingerprints.descriptor;";
+        sqlite3_stmt* stmt;
+        sqlite3_prepare_v2(_db, sql.c_str(), -1, &stmt, NULL);
+        if (!stmt) {
+            throw std::string("ERROR in image_collection::refresh(): cannot read datasets of collection");
+        }
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            std::string descriptor = sqlite_as_string(stmt, 0);
+            if (sqlite3_column_type(stmt, 1) == SQLITE_NULL) {
+                stored_without_fingerprint.insert(descriptor);
+                stored[descriptor] = std::make_pair(int64_t(-1), int64_t(-1));
+            } else {
+                stored[descriptor] = std::make_pair(sqlite3_column_int64(stmt, 1), sqlite3_column_int64(stmt, 2));
+            }
+        }
+        sqlite3_finalize(stmt);
+    }
+
+    // diff
+    std::vector<std::string> to_add;
+    std::vector<std::string> to_remove;
+    std::unordered_map<std::string, std::pair<int64_t, int64_t>> fingerprints;
+    std::unordered_set<std::string> in_list;
+    uint32_t n_changed = 0;
+    for (uint32_t i = 0; i < descriptors.size(); ++i) {
+        if (!in_list.insert(descriptors[i]).second) continue;  // duplicate
+        std::pair<int64_t, int64_t> fp = dataset_fingerprint(descriptors[i]);
+        fingerprints[descriptors[i]] = fp;
+        auto it = stored.find(descriptors[i]);
+        if (it == stored.end()) {
+            to_add.push_back(descriptors[i]);
+        } else if (stored_without_fingerprint.count(descriptors[i]) == 0 && it->second != fp) {
+            to_remove.push_back(descriptors[i]);
+            to_add.push_back(descriptors[i]);
+            ++n_changed;
+        }
+    }
+    uint32_t n_vanished = 0;
+    for (auto it = stored.begin(); it != stored.end(); ++it) {
+        if (in_list.count(it->first) == 0) {
+            to_remove.push_back(it->first);
+            ++n_vanished;
+        }
+    }
+    GCBS_INFO("Refreshing image collection: " + std::to_string(to_add.size() - n_changed) + " new, " + std::to_string(n_changed) +
+              " modified, and " + std::to_string(n_vanished) + " removed datasets");
+
+    sqlite3_stmt* stmt_delete_gdalref = nullptr;
+    sqlite3_stmt* stmt_delete_fingerprint = nullptr;
+    sqlite3_stmt* stmt_insert_fingerprint = nullptr;
+    sqlite3_prepare_v2(_db, "DELETE FROM gdalrefs WHERE descriptor=?;", -1, &stmt_delete_gdalref, NULL);
+    sqlite3_prepare_v2(_db, "DELETE FROM dataset_fingerprints WHERE descriptor=?;", -1, &stmt_delete_fingerprint, NULL);
+    sqlite3_prepare_v2(_db, "INSERT OR REPLACE INTO dataset_fingerprints(descriptor, size, mtime) SELECT ?1, ?2, ?3 WHERE EXISTS (SELECT 1 FROM gdalrefs WHERE descriptor=?1);", -1, &stmt_insert_fingerprint, NULL);
+    if (!stmt_delete_gdalref || !stmt_delete_fingerprint || !stmt_insert_fingerprint) {
+        sqlite3_finalize(stmt_delete_gdalref);
+        sqlite3_finalize(stmt_delete_fingerprint);
+        sqlite3_finalize(stmt_insert_fingerprint);
+        throw std::string("ERROR in image_collection::refresh(): cannot prepare statements");
+    }
+
+    // remove vanished and modified datasets, and images without any remaining datasets
+    sqlite3_exec(_db, "BEGIN TRANSACTION;", NULL, NULL, NULL);
+    for (uint32_t i = 0; i < to_remove.size(); ++i) {
+        sqlite3_reset(stmt_delete_gdalref);
+        sqlite3_bind_text(stmt_delete_gdalref, 1, to_remove[i].c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_step(stmt_delete_gdalref);
+        sqlite3_reset(stmt_delete_fingerprint);
+        sqlite3_bind_text(stmt_delete_fingerprint, 1, to_remove[i].c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_step(stmt_delete_fingerprint);
+    }
+    if (!to_remove.empty()) {
+        sqlite3_exec(_db, "DELETE FROM images WHERE id NOT IN (SELECT DISTINCT image_id FROM gdalrefs);", NULL, NULL, NULL);
+    }
+    sqlite3_exec(_db, "COMMIT TRANSACTION;", NULL, NULL, NULL);
+
+    std::exception_ptr add_error = nullptr;
+    try {
+        if (!to_add.empty()) {
+            add_with_collection_format(to_add, strict);
+        }
+    } catch (...) {
+        // in strict mode, still store fingerprints of datasets that have been added before the error
+        add_error = std::current_exception();
+    }
+
+    // store fingerprints of new datasets and of stored datasets without fingerprint, datasets that could
+    // not be added will be tried again in the next refresh
+    std::vector<std::string> fp_update(to_add);
+    fp_update.insert(fp_update.end(), stored_without_fingerprint.begin(), stored_without_fingerprint.end());
+    sqlite3_exec(_db, "BEGIN TRANSACTION;", NULL, NULL, NULL);
+    for (uint32_t i = 0; i < fp_update.size(); ++i) {
+        auto it = fingerprints.find(fp_update[i]);
+        if (it == fingerprints.end()) continue;  // vanished
+        sqlite3_reset(stmt_insert_fingerprint);
+        sqlite3_bind_text(stmt_insert_fingerprint, 1, fp_update[i].c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int64(stmt_insert_fingerprint, 2, it->second.first);
+        sqlite3_bind_int64(stmt_insert_fingerprint, 3, it->second.second);
+        sqlite3_step(stmt_insert_fingerprint);
+    }
+    sqlite3_exec(_db, "COMMIT TRANSACTION;", NULL, NULL, NULL);
+
+    sqlite3_finalize(stmt_delete_gdalref);
+    sqlite3_finalize(stmt_delete_fingerprint);
+    sqlite3_finalize(stmt_insert_fingerprint);
+
+    if (add_error) {
+        std::rethrow_exception(add_error);
+    }
+}
+
 void image_collection::write(const std::string filename) {
     if (_filename.compare(filename) == 0) {
         // nothing to do
@@ -1324,58 +1688,85 @@ bounds_st image_collection::extent() {
 std::vector<image_collection::find_range_st_row> image_collection::find_range_st(bounds_st range, std::string srs,
                                                                                  std::vector<std::string> bands, std::vector<std::string> order_by) {
     bounds_2d<double> range_trans = (srs == "EPSG:4326") ? range.s : range.s.transform(srs, "EPSG:4326");
+
+    // The statement uses parameters only, such that its text depends on the number of bands and
+    // the sort order but not on the range, which allows to reuse prepared statements in read-only mode
     std::string sql =  // TODO: do we really need image_name ?
         "SELECT gdalrefs.image_id, images.name, gdalrefs.descriptor, images.datetime, bands.name, gdalrefs.band_num, images.proj "
         "FROM images INNER JOIN gdalrefs ON images.id = gdalrefs.image_id INNER JOIN bands ON gdalrefs.band_id = bands.id WHERE "
-        "strftime('%Y-%m-%dT%H:%M:%S', images.datetime) >= '" +
-        range.t0.to_string(datetime_unit::SECOND) + "' AND strftime('%Y-%m-%dT%H:%M:%S', images.datetime) <= '" + range.t1.to_string(datetime_unit::SECOND) +
-        "' AND NOT "
-        "(images.right < " +
-        std::to_string(range_trans.left) + " OR images.left > " + std::to_string(range_trans.right) + " OR images.bottom > " + std::to_string(range_trans.top) + " OR images.top < " + std::to_string(range_trans.bottom) + ")";
+        "strftime('%Y-%m-%dT%H:%M:%S', images.datetime) >= ?1 AND strftime('%Y-%m-%dT%H:%M:%S', images.datetime) <= ?2 AND NOT "
+        "(images.right < ?3 OR images.left > ?4 OR images.bottom > ?5 OR images.top < ?6)";
 
     if (!bands.empty()) {
         std::string bandlist = "";
-        for (uint16_t i = 0; i < bands.size() - 1; ++i) {
-            bandlist += "'" + bands[i] + "',";
+        for (uint16_t i = 0; i < bands.size(); ++i) {
+            bandlist += "?" + std::to_string(7 + i);
+            if (i < bands.size() - 1) bandlist += ",";
         }
-        bandlist += "'" + bands[bands.size() - 1] + "'";
         sql += " AND bands.name IN (" + bandlist + ")";
     }
     if (!order_by.empty()) {
-        sql += "ORDER BY ";
-        for (uint16_t io = 0; io < order_by.size() - 1; ++io) {
-            if (order_by[io] == "gdalrefs.image_id" ||
-                order_by[io] == "images.name" ||
-                order_by[io] == "gdalrefs.descriptor" ||
-                order_by[io] == "images.datetime" ||
-                order_by[io] == "bands.name" ||
-                order_by[io] == "images.proj" ||
-                order_by[io] == "gdalrefs.band_num") {
-                sql += order_by[io] + ",";
+        sql += " ORDER BY ";
+        for (uint16_t io = 0; io < order_by.size(); ++io) {
+            // columns may have an optional ASC / DESC suffix
+            std::string col = order_by[io];
+            std::string direction = "";
+            if (col.size() > 5 && col.substr(col.size() - 5) == " DESC") {
+                direction = " DESC";
+                col = col.substr(0, col.size() - 5);
+            } else if (col.size() > 4 && col.substr(col.size() - 4) == " ASC") {
+                direction = " ASC";
+                col = col.substr(0, col.size() - 4);
+            }
+            if (col == "gdalrefs.image_id" ||
+                col == "images.name" ||
+                col == "gdalrefs.descriptor" ||
+                col == "images.datetime" ||
+                col == "bands.name" ||
+                col == "images.proj" ||
+                col == "gdalrefs.band_num") {
+                sql += col + direction;
+                if (io < order_by.size() - 1) sql += ",";
             } else {
                 throw std::string("ERROR in image_collection::find_range_st(): invalid column for sorting");
             }
         }
-        uint16_t io = order_by.size() - 1;
-        if (order_by[io] == "gdalrefs.image_id" ||
-            order_by[io] == "images.name" ||
-            order_by[io] == "gdalrefs.descriptor" ||
-            order_by[io] == "images.datetime" ||
-            order_by[io] == "bands.name" ||
-            order_by[io] == "images.proj" ||
-            order_by[io] == "gdalrefs.band_num") {
-            sql += order_by[io];
-        } else {
-            throw std::string("ERROR in image_collection::find_range_st(): invalid column for sorting");
-        }
     }
     sql += ";";
 
-    sqlite3_stmt* stmt;
-    sqlite3_prepare_v2(_db, sql.c_str(), -1, &stmt, NULL);
+    sqlite3_stmt* stmt = nullptr;
+    ro_connection* con = nullptr;
+    if (_read_only) {
+        con = acquire_ro_connection();
+        auto it = con->stmts.find(sql);
+        if (it != con->stmts.end()) {
+            stmt = it->second;
+        } else {
+            sqlite3_prepare_v2(con->db, sql.c_str(), -1, &stmt, NULL);
+            if (stmt) {
+                con->stmts[sql] = stmt;
+            }
+        }
+    } else {
+        sqlite3_prepare_v2(_db, sql.c_str(), -1, &stmt, NULL);
+    }
     if (!stmt) {
+        if (con) release_ro_connection(con);
         throw std::string("ERROR in image_collection::find_range_st(): cannot prepare query statement");
     }
+
+    std::string t0 = range.t0.to_string(datetime_unit::SECOND);
+    std::string t1 = range.t1.to_string(datetime_unit::SECOND);
+    sqlite3_bind_text(stmt, 1, t0.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(stmt, 2, t1.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_double(stmt, 3, range_trans.left);
+    sqlite3_bind_double(stmt, 4, range_trans.right);
+    sqlite3_bind_double(stmt, 5, range_trans.top);
+    sqlite3_bind_double(stmt, 6, range_trans.bottom);
+    for (uint16_t i = 0; i < bands.size(); ++i) {
+        sqlite3_bind_text(stmt, 7 + i, bands[i].c_str(), -1, SQLITE_TRANSIENT);
+    }
+
     std::vector<find_range_st_row> out;
     while (sqlite3_step(stmt) == SQLITE_ROW) {
         find_range_st_row r;
@@ -1389,10 +1780,43 @@ std::vector<image_collection::find_range_st_row> image_collection::find_range_st
 
         out.push_back(r);
     }
-    sqlite3_finalize(stmt);
+    if (con) {
+        sqlite3_reset(stmt);
+        sqlite3_clear_bindings(stmt);
+        release_ro_connection(con);
+    } else {
+        sqlite3_finalize(stmt);
+    }
     return out;
 }
 
+image_collection::ro_connection* image_collection::acquire_ro_connection() {
+    {
+        std::lock_guard<std::mutex> lock(_ro_mutex);
+        if (!_ro_idle.empty()) {
+            ro_connection* con = _ro_idle.back();
+            _ro_idle.pop_back();
+            return con;
+        }
+    }
+    // open a new connection, the pool grows up to the number of concurrently querying threads
+    ro_connection* con = new ro_connection();
+    con->db = open_read_only(_filename, SQLITE_OPEN_NOMUTEX);
+    if (!con->db) {
+        delete con;
+        throw std::string("ERROR in image_collection::acquire_ro_connection(): cannot open image collection file in read-only mode.");
+    }
+    std::lock_guard<std::mutex> lock(_ro_mutex);
+    _ro_all.push_back(con);
+    GCBS_DEBUG("Opened read-only connection #" + std::to_string(_ro_all.size()) + " to image collection '" + _filename + "'");
+    return con;
+}
+
+void image_collection::release_ro_connection(ro_connection* con) {
+    std::lock_guard<std::mutex> lock(_ro_mutex);
+    _ro_idle.push_back(con);
+}
+
 std::vector<image_collection::bands_row> image_collection::get_all_bands() {
     std::vector<image_collection::bands_row> out;
 
@@ -27,6 +27,9 @@
 
 #include <ogr_spatialref.h>
 
+#include <mutex>
+#include <unordered_map>
+
 #include "collection_format.h"
 #include "coord_types.h"
 #include "datetime.h"
@@ -88,15 +91,21 @@ class image_collection {
     /**
      * Opens an existing image collection from a file
      * @param filename
+     * @param read_only open the collection in read-only mode, see is_read_only()
      */
-    image_collection(std::string filename);
+    image_collection(std::string filename, bool read_only = false);
 
     ~image_collection();
     image_collection(const image_collection&) = delete;
     void operator=(const image_collection&) = delete;
 
     // move constructor
-    image_collection(image_collection&& A) : _format(A._format), _filename(A._filename), _db(A._db) {}
+    image_collection(image_collection&& A) : _format(A._format), _filename(A._filename), _db(A._db), _read_only(A._read_only), _ro_mutex(), _ro_idle(), _ro_all() {
+        A._db = nullptr;
+        std::lock_guard<std::mutex> lock(A._ro_mutex);
+        _ro_idle.swap(A._ro_idle);
+        _ro_all.swap(A._ro_all);
+    }
 
     static std::shared_ptr<image_collection> create(collection_format format, std::vector<std::string> descriptors, bool strict = true);
     static std::shared_ptr<image_collection> create(std::vector<std::string> descriptors, std::vector<std::string> date_time,
@@ -108,6 +117,20 @@ class image_collection {
     void add_with_collection_format(std::vector<std::string> descriptors, bool strict = true);
     void add_with_collection_format(std::string descriptor, bool strict = true);
 
+    /**
+     * @brief Update the collection incrementally from the complete list of its GDAL dataset descriptors
+     *
+     * Datasets are compared to datasets of the collection by fingerprints of their size and modification time.
+     * New and modified datasets are (re)added using the collection format. Datasets missing in the list are removed,
+     * together with images that have no remaining datasets. Fingerprints are stored in the collection database,
+     * datasets of the collection without a stored fingerprint (e.g. from a collection created with an older version)
+     * are assumed to be unchanged.
+     * @param descriptors complete list of datasets, e.g. from a directory listing
+     * @param strict see add_with_collection_format()
+     * @note Requires a collection format, formats with subdatasets are not supported
+     */
+    void refresh(std::vector<std::string> descriptors, bool strict = true);
+
     void add_with_datetime(std::vector<std::string> descriptors, std::vector<std::string> date_time, std::vector<std::string> band_names = {}, bool use_subdatasets = false);
     void add_with_datetime_bands(std::vector<std::string> descriptors, std::vector<std::string> date_time,
                                                    std::vector<std::string> band_names, bool use_subdatasets = false);
@@ -196,6 +219,14 @@ class image_collection {
         uint16_t band_num;
         std::string srs;
     };
+    /**
+     * @brief Find all images / GDAL datasets intersecting with a spatiotemporal range
+     * @param range spatiotemporal range
+     * @param srs spatial reference system of range
+     * @param bands names of bands to consider, all bands if empty
+     * @param order_by list of columns to sort the result, each column may have an optional " ASC" or " DESC" suffix
+     * @return one row per band of all intersecting images
+     */
     std::vector<find_range_st_row> find_range_st(bounds_st range, std::string srs,
                                                  std::vector<std::string> bands, std::vector<std::string> order_by = {});
     inline std::vector<find_range_st_row> find_range_st(bounds_st range, std::string srs, std::vector<std::string> order_by = {}) {
@@ -270,6 +301,16 @@ class image_collection {
 
     inline std::string get_filename() { return _filename; }
 
+    /**
+     * @brief Check whether the collection has been opened in read-only mode
+     *
+     * In read-only mode, the database file is opened as immutable with memory-mapped I/O. Queries
+     * from find_range_st() run on a pool of additional connections, such that concurrent queries from
+     * different threads do not serialize on a single connection and prepared statements can be reused.
+     * The collection file must not be modified by any process while opened in read-only mode.
+     */
+    inline bool is_read_only() { return _read_only; }
+
     /**
      * @brief Check whether all images in a collection have the same SRS and spatial extent
      * @return true, if the image collection is aligned
@@ -305,6 +346,24 @@ class image_collection {
     collection_format _format;
     std::string _filename;
     sqlite3* _db;
+    bool _read_only;
+
+    /**
+     * @brief Additional read-only database connection with cached prepared statements
+     */
+    struct ro_connection {
+        ro_connection() : db(nullptr), stmts() {}
+        sqlite3* db;
+        std::unordered_map<std::string, sqlite3_stmt*> stmts;
+    };
+
+    // pool of read-only connections, one connection is used by at most one thread at a time
+    std::mutex _ro_mutex;
+    std::vector<ro_connection*> _ro_idle;
+    std::vector<ro_connection*> _ro_all;
+
+    ro_connection* acquire_ro_connection();
+    void release_ro_connection(ro_connection* con);
 
     static std::string sqlite_as_string(sqlite3_stmt* stmt, uint16_t col);
 
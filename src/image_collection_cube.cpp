@@ -28,6 +28,7 @@
 #include <map>
 #include <unordered_map>
 
+#include "config.h"
 #include "error.h"
 #include "utils.h"
 #include "warp.h"
@@ -35,15 +36,15 @@
 namespace gdalcubes {
 
 image_collection_cube::image_collection_cube(std::shared_ptr<image_collection> ic, cube_view v) : cube(std::make_shared<cube_view>(v)), _collection(ic), _input_bands(), _mask(nullptr), _mask_band("") { load_bands(); }
-image_collection_cube::image_collection_cube(std::string icfile, cube_view v) : cube(std::make_shared<cube_view>(v)), _collection(std::make_shared<image_collection>(icfile)), _input_bands(), _mask(nullptr), _mask_band("") { load_bands(); }
+image_collection_cube::image_collection_cube(std::string icfile, cube_view v) : cube(std::make_shared<cube_view>(v)), _collection(std::make_shared<image_collection>(icfile, config::instance()->get_collection_read_only())), _input_bands(), _mask(nullptr), _mask_band("") { load_bands(); }
 image_collection_cube::image_collection_cube(std::shared_ptr<image_collection> ic, std::string vfile) : cube(std::make_shared<cube_view>(cube_view::read_json(vfile))), _collection(ic), _input_bands(), _mask(nullptr), _mask_band("") { load_bands(); }
-image_collection_cube::image_collection_cube(std::string icfile, std::string vfile) : cube(std::make_shared<cube_view>(cube_view::read_json(vfile))), _collection(std::make_shared<image_collection>(icfile)), _input_bands(), _mask(nullptr), _mask_band("") { load_bands(); }
+image_collection_cube::image_collection_cube(std::string icfile, std::string vfile) : cube(std::make_shared<cube_view>(cube_view::read_json(vfile))), _collection(std::make_shared<image_collection>(icfile, config::instance()->get_collection_read_only())), _input_bands(), _mask(nullptr), _mask_band("") { load_bands(); }
 image_collection_cube::image_collection_cube(std::shared_ptr<image_collection> ic) : cube(), _collection(ic), _input_bands(), _mask(nullptr), _mask_band("") {
     st_reference(std::make_shared<cube_view>(image_collection_cube::default_view(_collection)));
     load_bands();
 }
 
-image_collection_cube::image_collection_cube(std::string icfile) : cube(), _collection(std::make_shared<image_collection>(icfile)), _input_bands(), _mask(nullptr), _mask_band("") {
+image_collection_cube::image_collection_cube(std::string icfile) : cube(), _collection(std::make_shared<image_collection>(icfile, config::instance()->get_collection_read_only())), _input_bands(), _mask(nullptr), _mask_band("") {
     st_reference(std::make_shared<cube_view>(image_collection_cube::default_view(_collection)));
     load_bands();
 }
@@ -64,6 +65,14 @@ struct aggregation_state {
     virtual void update(void *chunk_buf, void *img_buf, uint32_t t) = 0;
     virtual void finalize(void *buf) = 0;
 
+    /**
+     * @brief Check whether further images cannot change a time slice of the chunk anymore
+     * @details This is used to skip reading remaining images of a time slice, e.g. if all pixels have been filled by first / last aggregation
+     * @param t time index of the slice within the chunk
+     * @return true, if the time slice is complete
+     */
+    virtual bool is_complete(uint32_t t) { return false; }
+
    protected:
     coords_nd<uint32_t, 4> _size_btyx;
 };
@@ -151,10 +160,18 @@ struct aggregation_state_median : public aggregation_state {
     std::vector<std::vector<double>> _m_buckets;
 };
 
+/**
+ * @brief Aggregation state that keeps the first valid value of a pixel
+ * @details The number of filled pixels per time slice is tracked such that reading further images of a
+ * completely filled time slice can be skipped. If images are fed in reverse temporal order, this
+ * implements last aggregation.
+ */
 struct aggregation_state_first : public aggregation_state {
-    aggregation_state_first(coords_nd<uint32_t, 4> size_btyx) : aggregation_state(size_btyx) {}
+    aggregation_state_first(coords_nd<uint32_t, 4> size_btyx) : aggregation_state(size_btyx), _n_filled() {}
 
-    void init() override {}
+    void init() override {
+        _n_filled.resize(_size_btyx[1], 0);
+    }
 
     void update(void *chunk_buf, void *img_buf, uint32_t t) override {
         for (uint32_t ib = 0; ib < _size_btyx[0]; ++ib) {
@@ -168,12 +185,20 @@ struct aggregation_state_first : public aggregation_state {
                     continue;
                 else {
                     ((double *)chunk_buf)[chunk_buf_offset + i] = ((double *)img_buf)[img_buf_offset + i];
+                    ++_n_filled[t];
                 }
             }
         }
     }
 
     void finalize(void *buf) override {}
+
+    bool is_complete(uint32_t t) override {
+        return _n_filled[t] >= _size_btyx[0] * _size_btyx[2] * _size_btyx[3];
+    }
+
+   private:
+    std::vector<uint32_t> _n_filled;
 };
 
 struct aggregation_state_count_values : public aggregation_state {
@@ -223,26 +248,6 @@ struct aggregation_state_count_images : public aggregation_state {
     void finalize(void *buf) override {}
 };
 
-struct aggregation_state_last : public aggregation_state {
-    aggregation_state_last(coords_nd<uint32_t, 4> size_btyx) : aggregation_state(size_btyx) {}
-
-    void init() override {}
-
-    void update(void *chunk_buf, void *img_buf, uint32_t t) override {
-        for (uint32_t ib = 0; ib < _size_btyx[0]; ++ib) {
-            uint32_t chunk_buf_offset = ib * _size_btyx[1] * _size_btyx[2] * _size_btyx[3] + t * _size_btyx[2] * _size_btyx[3];
-            uint32_t img_buf_offset = ib * _size_btyx[2] * _size_btyx[3];
-            // iterate over all pixels
-            for (uint32_t i = 0; i < _size_btyx[2] * _size_btyx[3]; ++i) {
-                if (std::isnan(((double *)img_buf)[img_buf_offset + i])) continue;
-                ((double *)chunk_buf)[chunk_buf_offset + i] = ((double *)img_buf)[img_buf_offset + i];
-            }
-        }
-    }
-
-    void finalize(void *buf) override {}
-};
-
 struct aggregation_state_min : public aggregation_state {
     aggregation_state_min(coords_nd<uint32_t, 4> size_btyx) : aggregation_state(size_btyx) {}
 
@@ -315,6 +320,8 @@ struct aggregation_state_none : public aggregation_state {
 std::shared_ptr<chunk_data> image_collection_cube::read_chunk(chunkid_t id) {
     GCBS_TRACE("image_collection_cube::read_chunk(" + std::to_string(id) + ")");
     std::shared_ptr<chunk_data> out = std::make_shared<chunk_data>();
+    profile_scope profile(this, out);
+    trace_span span("image_collection_cube::read_chunk", "source", id);
     if (id >= count_chunks()) {
         // chunk is outside of the cube, we don't need to read anything.
         GCBS_WARN("Chunk id " + std::to_string(id) + " is out of range");
@@ -322,9 +329,19 @@ std::shared_ptr<chunk_data> image_collection_cube::read_chunk(chunkid_t id) {
     }
 
     // Find intersecting images from collection and iterate over these
-    // Note that these are ordered by image id and descriptor
+    // Note that these are ordered by image id and descriptor. For first / last aggregation, images are
+    // ordered by datetime (ascending / descending) such that reading can stop once a time slice is completely filled.
+    bool fill_until_complete = false;
+    std::vector<std::string> order_by{"gdalrefs.image_id", "gdalrefs.descriptor"};
+    if (view()->aggregation_method() == aggregation::aggregation_type::AGG_FIRST) {
+        fill_until_complete = true;
+        order_by = {"images.datetime", "gdalrefs.image_id", "gdalrefs.descriptor"};
+    } else if (view()->aggregation_method() == aggregation::aggregation_type::AGG_LAST) {
+        fill_until_complete = true;
+        order_by = {"images.datetime DESC", "gdalrefs.image_id DESC", "gdalrefs.descriptor"};
+    }
     bounds_st cextent = bounds_from_chunk(id);
-    std::vector<image_collection::find_range_st_row> datasets = _collection->find_range_st(cextent, _st_ref->srs(), std::vector<std::string>(), std::vector<std::string>{"gdalrefs.image_id", "gdalrefs.descriptor"});
+    std::vector<image_collection::find_range_st_row> datasets = _collection->find_range_st(cextent, _st_ref->srs(), std::vector<std::string>(), order_by);
 
     if (datasets.empty()) {
         //GCBS_DEBUG("Chunk " + std::to_string(id) + " does not intersect with any image from the image_collection_cube");
@@ -358,7 +375,7 @@ std::shared_ptr<chunk_data> image_collection_cube::read_chunk(chunkid_t id) {
     } else if (view()->aggregation_method() == aggregation::aggregation_type::AGG_FIRST) {
         agg = new aggregation_state_first(size_btyx);
     } else if (view()->aggregation_method() == aggregation::aggregation_type::AGG_LAST) {
-        agg = new aggregation_state_last(size_btyx);
+        agg = new aggregation_state_first(size_btyx);  // images are read in reverse temporal order
     } else if (view()->aggregation_method() == aggregation::aggregation_type::AGG_MEDIAN) {
         agg = new aggregation_state_median(size_btyx);
     } else if (view()->aggregation_method() == aggregation::aggregation_type::AGG_IMAGE_COUNT) {
@@ -376,6 +393,7 @@ std::shared_ptr<chunk_data> image_collection_cube::read_chunk(chunkid_t id) {
         mask_buf = std::calloc(size_btyx[3] * size_btyx[2], sizeof(double));
     }
 
+    uint32_t n_skipped = 0;
     uint32_t i = 0;
     while (i < datasets.size()) {
         std::pair<std::string, uint16_t> mask_dataset_band;
@@ -413,6 +431,10 @@ std::shared_ptr<chunk_data> image_collection_cube::read_chunk(chunkid_t id) {
         if (itime < 0 || itime >= (int)(out->size()[1])) {
             continue;  // image would be written outside of the chunk buffer
         }
+        if (fill_until_complete && agg->is_complete(itime)) {
+            ++n_skipped;
+            continue;  // all pixels of the time slice have been filled already
+        }
 
         // refill for all images
         std::fill((double *)img_buf, ((double *)img_buf) + size_btyx[0] * size_btyx[3] * size_btyx[2], NAN);
@@ -425,6 +447,7 @@ std::shared_ptr<chunk_data> image_collection_cube::read_chunk(chunkid_t id) {
                 GCBS_WARN("GDAL cannot open '" + it->first + "', image will be ignored");
                 continue;
             }
+            profiler::count(this, "images_opened");
 
             // If input dataset has more bands than requested
             bool create_band_subset_vrt = false;
@@ -479,34 +502,42 @@ std::shared_ptr<chunk_data> image_collection_cube::read_chunk(chunkid_t id) {
             }
 
             GDALDataset *gdal_out = nullptr;
-            if (create_band_subset_vrt && bandsel_vrt != nullptr) {
-                //gdal_out = (GDALDataset *)GDALWarp("", NULL, 1, (GDALDatasetH *)(&bandsel_vrt), warp_opts, NULL);
-                gdal_out = gdalwarp_client::warp(bandsel_vrt, src_srs.c_str(), _st_ref->srs().c_str(), cextent.s.left, cextent.s.right,
-                                                 cextent.s.top, cextent.s.bottom, size_btyx[3], size_btyx[2],
-                                                 resampling::to_string(view()->resampling_method()), nodata_value_list);
-            } else {
-                //gdal_out = (GDALDataset *)GDALWarp("", NULL, 1, (GDALDatasetH *)(&g), warp_opts, NULL);
-                gdal_out = gdalwarp_client::warp(g, src_srs.c_str(), _st_ref->srs().c_str(), cextent.s.left, cextent.s.right,
-                                                 cextent.s.top, cextent.s.bottom, size_btyx[3], size_btyx[2],
-                                                 resampling::to_string(view()->resampling_method()), nodata_value_list);
+            {
+                profile_timer timer(this, "warp_seconds");
+                trace_span span_warp("warp", "gdal", id);
+                if (create_band_subset_vrt && bandsel_vrt != nullptr) {
+                    //gdal_out = (GDALDataset *)GDALWarp("", NULL, 1, (GDALDatasetH *)(&bandsel_vrt), warp_opts, NULL);
+                    gdal_out = gdalwarp_client::warp(bandsel_vrt, src_srs.c_str(), _st_ref->srs().c_str(), cextent.s.left, cextent.s.right,
+                                                     cextent.s.top, cextent.s.bottom, size_btyx[3], size_btyx[2],
+                                                     resampling::to_string(view()->resampling_method()), nodata_value_list);
+                } else {
+                    //gdal_out = (GDALDataset *)GDALWarp("", NULL, 1, (GDALDatasetH *)(&g), warp_opts, NULL);
+                    gdal_out = gdalwarp_client::warp(g, src_srs.c_str(), _st_ref->srs().c_str(), cextent.s.left, cextent.s.right,
+                                                     cextent.s.top, cextent.s.bottom, size_btyx[3], size_btyx[2],
+                                                     resampling::to_string(view()->resampling_method()), nodata_value_list);
+                }
             }
 
             // For each band, call RasterIO to read and copy data to the right position in the buffers
-            for (uint16_t b = 0; b < it->second.size(); ++b) {
-                uint16_t b_internal = _bands.get_index(std::get<0>(it->second[b]));
+            {
+                profile_timer timer(this, "rasterio_seconds");
+                trace_span span_rasterio("RasterIO", "gdal", id);
+                for (uint16_t b = 0; b < it->second.size(); ++b) {
+                    uint16_t b_internal = _bands.get_index(std::get<0>(it->second[b]));
 
-                // Make sure that b_internal is valid in order to prevent buffer overflows
-                if (b_internal < 0 || b_internal >= out->size()[0])
-                    continue;
+                    // Make sure that b_internal is valid in order to prevent buffer overflows
+                    if (b_internal < 0 || b_internal >= out->size()[0])
+                        continue;
 
-                CPLErr res;
-                if (create_band_subset_vrt) {  // bands have been renumbered / sorted according to order of it->second
-                    res = gdal_out->GetRasterBand(b + 1)->RasterIO(GF_Read, 0, 0, size_btyx[3], size_btyx[2], ((double *)img_buf) + b_internal * size_btyx[2] * size_btyx[3], size_btyx[3], size_btyx[2], GDT_Float64, 0, 0, NULL);
-                } else {
-                    res = gdal_out->GetRasterBand(std::get<1>(it->second[b]))->RasterIO(GF_Read, 0, 0, size_btyx[3], size_btyx[2], ((double *)img_buf) + b_internal * size_btyx[2] * size_btyx[3], size_btyx[3], size_btyx[2], GDT_Float64, 0, 0, NULL);
-                }
-                if (res != CE_None) {
-                    GCBS_WARN("RasterIO (read) failed for " + std::string(gdal_out->GetDescription()));
+                    CPLErr res;
+                    if (create_band_subset_vrt) {  // bands have been renumbered / sorted according to order of it->second
+                        res = gdal_out->GetRasterBand(b + 1)->RasterIO(GF_Read, 0, 0, size_btyx[3], size_btyx[2], ((double *)img_buf) + b_internal * size_btyx[2] * size_btyx[3], size_btyx[3], size_btyx[2], GDT_Float64, 0, 0, NULL);
+                    } else {
+                        res = gdal_out->GetRasterBand(std::get<1>(it->second[b]))->RasterIO(GF_Read, 0, 0, size_btyx[3], size_btyx[2], ((double *)img_buf) + b_internal * size_btyx[2] * size_btyx[3], size_btyx[3], size_btyx[2], GDT_Float64, 0, 0, NULL);
+                    }
+                    if (res != CE_None) {
+                        GCBS_WARN("RasterIO (read) failed for " + std::string(gdal_out->GetDescription()));
+                    }
                 }
             }
             if (!bandsel_vrt_name.empty()) {
@@ -530,6 +561,7 @@ std::shared_ptr<chunk_data> image_collection_cube::read_chunk(chunkid_t id) {
                     GCBS_WARN("GDAL cannot open '" + mask_dataset_band.first + "', mask will be ignored");
                 }
                 else {
+                    profiler::count(this, "images_opened");
                     // If input dataset has more bands than requested
                     bool create_band_subset_vrt = false;
                     if (g->GetRasterCount() > 1) {
@@ -556,24 +588,54 @@ std::shared_ptr<chunk_data> image_collection_cube::read_chunk(chunkid_t id) {
                         GDALTranslateOptionsFree(trans_options);
                     }
 
+                    // integer masks (e.g. bit flags of QA bands) are warped and read without conversion to double,
+                    // pixels without data are then identified by an additional alpha band
+                    bool mask_int = _mask->integer_input();
+                    bool use_vrt = create_band_subset_vrt && bandsel_vrt != nullptr;
+                    uint16_t mask_band = use_vrt ? 1 : mask_dataset_band.second;
+                    std::vector<double> mask_nodata;
+                    if (mask_int) {
+                        int has_nodata = 0;
+                        double nodata = (use_vrt ? bandsel_vrt : g)->GetRasterBand(mask_band)->GetNoDataValue(&has_nodata);
+                        if (has_nodata) mask_nodata.push_back(nodata);
+                    }
+
                     GDALDataset *gdal_out = nullptr;
-                    if (create_band_subset_vrt && bandsel_vrt != nullptr) {
-                        //gdal_out = (GDALDataset *)GDALWarp("", NULL, 1, (GDALDatasetH *)(&bandsel_vrt), warp_opts, NULL);
-                        gdal_out = gdalwarp_client::warp(bandsel_vrt, src_srs.c_str(), _st_ref->srs().c_str(), cextent.s.left, cextent.s.right,
-                                                         cextent.s.top, cextent.s.bottom, size_btyx[3], size_btyx[2],
-                                                         "near", std::vector<double>());
-                    } else {
-                        //gdal_out = (GDALDataset *)GDALWarp("", NULL, 1, (GDALDatasetH *)(&g), warp_opts, NULL);
-                        gdal_out = gdalwarp_client::warp(g, src_srs.c_str(), _st_ref->srs().c_str(), cextent.s.left, cextent.s.right,
-                                                         cextent.s.top, cextent.s.bottom, size_btyx[3], size_btyx[2],
-                                                         "near", std::vector<double>());
+                    {
+                        profile_timer timer(this, "warp_seconds");
+                        trace_span span_warp("warp", "gdal", id);
+                        if (use_vrt) {
+                            //gdal_out = (GDALDataset *)GDALWarp("", NULL, 1, (GDALDatasetH *)(&bandsel_vrt), warp_opts, NULL);
+                            gdal_out = gdalwarp_client::warp(bandsel_vrt, src_srs.c_str(), _st_ref->srs().c_str(), cextent.s.left, cextent.s.right,
+                                                             cextent.s.top, cextent.s.bottom, size_btyx[3], size_btyx[2],
+                                                             "near", mask_nodata, mask_int ? GDT_UInt32 : GDT_Float64, mask_int);
+                        } else {
+                            //gdal_out = (GDALDataset *)GDALWarp("", NULL, 1, (GDALDatasetH *)(&g), warp_opts, NULL);
+                            gdal_out = gdalwarp_client::warp(g, src_srs.c_str(), _st_ref->srs().c_str(), cextent.s.left, cextent.s.right,
+                                                             cextent.s.top, cextent.s.bottom, size_btyx[3], size_btyx[2],
+                                                             "near", mask_nodata, mask_int ? GDT_UInt32 : GDT_Float64, mask_int);
+                        }
+                    }
+                    std::vector<uint8_t> mask_valid;
+                    CPLErr res;
+                    {
+                        profile_timer timer(this, "rasterio_seconds");
+                        trace_span span_rasterio("RasterIO", "gdal", id);
+                        res = gdal_out->GetRasterBand(mask_band)->RasterIO(GF_Read, 0, 0, size_btyx[3], size_btyx[2], mask_buf, size_btyx[3], size_btyx[2], mask_int ? GDT_UInt32 : GDT_Float64, 0, 0, NULL);
+                        if (mask_int && res == CE_None) {
+                            mask_valid.resize(size_btyx[3] * size_btyx[2]);
+                            res = gdal_out->GetRasterBand(gdal_out->GetRasterCount())->RasterIO(GF_Read, 0, 0, size_btyx[3], size_btyx[2], mask_valid.data(), size_btyx[3], size_btyx[2], GDT_Byte, 0, 0, NULL);
+                        }
                     }
-                    CPLErr res = gdal_out->GetRasterBand(mask_dataset_band.second)->RasterIO(GF_Read, 0, 0, size_btyx[3], size_btyx[2], mask_buf, size_btyx[3], size_btyx[2], GDT_Float64, 0, 0, NULL);
                     if (res != CE_None) {
                         GCBS_WARN("RasterIO (read) failed for " + std::string(gdal_out->GetDescription()));
                     }
                     GDALClose(gdal_out);
-                    _mask->apply((double *)mask_buf, (double *)img_buf, size_btyx[0], size_btyx[2], size_btyx[3]);
+                    if (mask_int) {
+                        _mask->apply_uint32((uint32_t *)mask_buf, mask_valid.empty() ? nullptr : mask_valid.data(), (double *)img_buf, size_btyx[0], size_btyx[2], size_btyx[3]);
+                    } else {
+                        _mask->apply((double *)mask_buf, (double *)img_buf, size_btyx[0], size_btyx[2], size_btyx[3]);
+                    }
                 }
             }
         }
@@ -585,6 +647,10 @@ std::shared_ptr<chunk_data> image_collection_cube::read_chunk(chunkid_t id) {
     agg->finalize(out->buf());
     delete agg;
 
+    if (n_skipped > 0) {
+        GCBS_DEBUG("Skipped reading " + std::to_string(n_skipped) + " images for chunk " + std::to_string(id) + " because time slices were completely filled");
+    }
+
     std::free(img_buf);
     if (mask_buf) std::free(mask_buf);
 
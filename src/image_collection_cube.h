@@ -24,6 +24,7 @@
 #ifndef IMAGE_COLLECTION_CUBE_H
 #define IMAGE_COLLECTION_CUBE_H
 
+#include <algorithm>
 #include <unordered_set>
 
 #include "cube.h"
@@ -31,48 +32,157 @@
 
 namespace gdalcubes {
 
+/**
+ * @brief Base class for masks that are applied on images while reading an image collection cube
+ *
+ * A mask is evaluated on the pixels of a mask band and sets all bands of masked pixels to NAN.
+ */
 struct image_mask {
     virtual ~image_mask() {}
     virtual void apply(double *mask_buf, double *pixel_buf, uint32_t nb, uint32_t ny, uint32_t nx) = 0;
+
+    /**
+     * @brief Check whether the mask band should be read as unsigned 32 bit integers and passed to apply_uint32()
+     * instead of apply()
+     */
+    virtual bool integer_input() { return false; }
+
+    /**
+     * @brief Apply the mask on integer mask band values, only called if integer_input() returns true
+     * @param valid optional array with one entry per pixel, mask band pixels where valid is 0 have no data and never match
+     */
+    virtual void apply_uint32(uint32_t *mask_buf, const uint8_t *valid, double *pixel_buf, uint32_t nb, uint32_t ny, uint32_t nx) {
+        throw std::string("ERROR in image_mask::apply_uint32(): mask does not support integer input");
+    }
+
     virtual json11::Json as_json() = 0;
-};
 
-struct value_mask : public image_mask {
-   public:
-    value_mask(std::unordered_set<double> mask_values, bool invert = false, std::vector<uint8_t> bits = std::vector<uint8_t>()) : _mask_values(mask_values), _invert(invert), _bits(bits) {}
-    void apply(double *mask_buf, double *pixel_buf, uint32_t nb, uint32_t ny, uint32_t nx) override {
+   protected:
+    /**
+     * @brief Extract bits from a mask band value, NAN (no data) is returned unchanged and hence never matches
+     */
+    static inline double extract_bits(double v, uint32_t bitmask) {
+        return std::isnan(v) ? v : double((uint32_t)(v)&bitmask);
+    }
+
+    /**
+     * @brief Compute a bitmask from a set of bit positions
+     * @note throws if a bit position is larger than 31, since mask band values are converted to 32 bit integers
+     */
+    static uint32_t make_bitmask(const std::vector<uint8_t> &bits) {
         uint32_t bitmask = 0;
-        if (!_bits.empty()) {
-            for (uint8_t ib = 0; ib < _bits.size(); ++ib) {
-                bitmask += (uint32_t)std::pow(2.0, (double)_bits[ib]);
+        for (uint8_t ib = 0; ib < bits.size(); ++ib) {
+            if (bits[ib] > 31) {
+                throw std::string("ERROR in image_mask::make_bitmask(): bit position " + std::to_string(bits[ib]) + " is out of range [0, 31]");
             }
+            bitmask |= (uint32_t(1) << bits[ib]);
         }
-        if (!_invert) {
-            for (uint32_t ixy = 0; ixy < ny * nx; ++ixy) {
-                if (!_bits.empty()) {
-                    mask_buf[ixy] = (uint32_t)(mask_buf[ixy]) & bitmask;
-                }
-                if (_mask_values.count(mask_buf[ixy]) == 1) {  // if mask has value
-                    // set all bands to NAN
-                    for (uint32_t ib = 0; ib < nb; ++ib) {
-                        pixel_buf[ib * nx * ny + ixy] = NAN;
-                    }
-                }
+        return bitmask;
+    }
+
+    /**
+     * @brief Evaluate a predicate on all pixels of the mask band and store the results in a packed bitmap
+     *
+     * Bit i % 64 of word i / 64 is set if pixel i is masked. The inner loop over one word has a
+     * fixed trip count and no branches if the predicate has none, such that compilers can vectorize it.
+     * @param mask_buf mask band values
+     * @param npix number of pixels
+     * @param f predicate, returning true if a pixel is masked
+     * @param out output bitmap, will be resized to (npix + 63) / 64 words
+     */
+    template <typename T, typename F>
+    static void make_bitmap(const T *mask_buf, uint32_t npix, F f, std::vector<uint64_t> &out) {
+        uint32_t nwords = (npix + 63) / 64;
+        out.resize(nwords);
+        for (uint32_t iw = 0; iw < nwords; ++iw) {
+            uint32_t begin = iw * 64;
+            uint32_t n = std::min(uint32_t(64), npix - begin);
+            uint64_t w = 0;
+            for (uint32_t k = 0; k < n; ++k) {
+                w |= uint64_t(f(mask_buf[begin + k]) ? 1 : 0) << k;
             }
-        } else {
-            for (uint32_t ixy = 0; ixy < ny * nx; ++ixy) {
-                if (!_bits.empty()) {
-                    mask_buf[ixy] = (uint32_t)(mask_buf[ixy]) & bitmask;
+            out[iw] = w;
+        }
+    }
+
+    /**
+     * @brief Set the bits of pixels without data in a packed bitmap to a fixed value
+     * @param valid array with one entry per pixel, 0 for pixels without data
+     * @param npix number of pixels
+     * @param value true if pixels without data are masked
+     * @param bitmap bitmap as computed by make_bitmap()
+     */
+    static void set_invalid(const uint8_t *valid, uint32_t npix, bool value, std::vector<uint64_t> &bitmap) {
+        for (uint32_t i = 0; i < npix; ++i) {
+            if (valid[i] == 0) {
+                if (value) {
+                    bitmap[i / 64] |= uint64_t(1) << (i % 64);
+                } else {
+                    bitmap[i / 64] &= ~(uint64_t(1) << (i % 64));
                 }
-                if (_mask_values.count(mask_buf[ixy]) == 0) {
-                    // set all bands to NAN
-                    for (uint32_t ib = 0; ib < nb; ++ib) {
-                        pixel_buf[ib * nx * ny + ixy] = NAN;
+            }
+        }
+    }
+
+    /**
+     * @brief Set all bands of pixels that are marked in a packed bitmap to NAN
+     *
+     * Bands are processed one after another, i.e. memory is written sequentially and
+     * words without any masked pixels are skipped.
+     */
+    static void apply_bitmap(const std::vector<uint64_t> &bitmap, double *pixel_buf, uint32_t nb, uint32_t npix) {
+        for (uint32_t ib = 0; ib < nb; ++ib) {
+            double *band_buf = pixel_buf + size_t(ib) * size_t(npix);
+            for (uint32_t iw = 0; iw < bitmap.size(); ++iw) {
+                uint64_t w = bitmap[iw];
+                if (w == 0) continue;
+                uint32_t begin = iw * 64;
+                uint32_t n = std::min(uint32_t(64), npix - begin);
+                if (w == ~uint64_t(0)) {
+                    std::fill(band_buf + begin, band_buf + begin + n, NAN);
+                } else {
+                    for (uint32_t k = 0; k < n; ++k) {
+                        if ((w >> k) & 1) band_buf[begin + k] = NAN;
                     }
                 }
             }
         }
     }
+};
+
+struct value_mask : public image_mask {
+   public:
+    value_mask(std::unordered_set<double> mask_values, bool invert = false, std::vector<uint8_t> bits = std::vector<uint8_t>()) : _mask_values(mask_values), _sorted_values(mask_values.begin(), mask_values.end()), _invert(invert), _bits(bits), _bitmask(make_bitmask(bits)) {
+        // NAN never equals a mask band value
+        _sorted_values.erase(std::remove_if(_sorted_values.begin(), _sorted_values.end(), [](double x) { return std::isnan(x); }), _sorted_values.end());
+        std::sort(_sorted_values.begin(), _sorted_values.end());
+    }
+    void apply(double *mask_buf, double *pixel_buf, uint32_t nb, uint32_t ny, uint32_t nx) override {
+        std::vector<uint64_t> bitmap;
+        const bool use_bits = !_bits.empty();
+        const uint32_t bitmask = _bitmask;
+        const bool invert = _invert;
+        const std::vector<double> &vals = _sorted_values;
+        if (vals.size() <= 8) {
+            // few values (the common case) are compared directly, without hashing or branches
+            make_bitmap(mask_buf, ny * nx, [use_bits, bitmask, invert, &vals](double v) {
+                if (use_bits) v = extract_bits(v, bitmask);
+                bool match = false;
+                for (uint16_t i = 0; i < vals.size(); ++i) {
+                    match |= (v == vals[i]);
+                }
+                return match != invert;
+            },
+                        bitmap);
+        } else {
+            make_bitmap(mask_buf, ny * nx, [use_bits, bitmask, invert, &vals](double v) {
+                if (use_bits) v = extract_bits(v, bitmask);
+                return std::binary_search(vals.begin(), vals.end(), v) != invert;
+            },
+                        bitmap);
+        }
+        apply_bitmap(bitmap, pixel_buf, nb, ny * nx);
+    }
 
     json11::Json as_json() override {
         json11::Json::object out;
@@ -85,46 +195,29 @@ struct value_mask : public image_mask {
 
    private:
     std::unordered_set<double> _mask_values;
+    std::vector<double> _sorted_values;
     bool _invert;
     std::vector<uint8_t> _bits;
+    uint32_t _bitmask;
 };
 
 struct range_mask : public image_mask {
    public:
-    range_mask(double min, double max, bool invert = false, std::vector<uint8_t> bits = std::vector<uint8_t>()) : _min(min), _max(max), _invert(invert), _bits(bits) {}
+    range_mask(double min, double max, bool invert = false, std::vector<uint8_t> bits = std::vector<uint8_t>()) : _min(min), _max(max), _invert(invert), _bits(bits), _bitmask(make_bitmask(bits)) {}
 
     void apply(double *mask_buf, double *pixel_buf, uint32_t nb, uint32_t ny, uint32_t nx) override {
-        uint32_t bitmask = 0;
-        if (!_bits.empty()) {
-            for (uint8_t ib = 0; ib < _bits.size(); ++ib) {
-                bitmask += (uint32_t)std::pow(2.0, (double)_bits[ib]);
-            }
-        }
-        if (!_invert) {
-            for (uint32_t ixy = 0; ixy < ny * nx; ++ixy) {
-                if (!_bits.empty()) {
-                    mask_buf[ixy] = (uint32_t)(mask_buf[ixy]) & bitmask;
-                }
-                if (mask_buf[ixy] >= _min && mask_buf[ixy] <= _max) {
-                    // set all bands to NAN
-                    for (uint32_t ib = 0; ib < nb; ++ib) {
-                        pixel_buf[ib * nx * ny + ixy] = NAN;
-                    }
-                }
-            }
-        } else {
-            for (uint32_t ixy = 0; ixy < ny * nx; ++ixy) {
-                if (!_bits.empty()) {
-                    mask_buf[ixy] = (uint32_t)(mask_buf[ixy]) & bitmask;
-                }
-                if (mask_buf[ixy] < _min || mask_buf[ixy] > _max) {
-                    // set all bands to NAN
-                    for (uint32_t ib = 0; ib < nb; ++ib) {
-                        pixel_buf[ib * nx * ny + ixy] = NAN;
-                    }
-                }
-            }
-        }
+        std::vector<uint64_t> bitmap;
+        const bool use_bits = !_bits.empty();
+        const uint32_t bitmask = _bitmask;
+        const double min = _min;
+        const double max = _max;
+        const bool invert = _invert;
+        make_bitmap(mask_buf, ny * nx, [use_bits, bitmask, min, max, invert](double v) {
+            if (use_bits) v = extract_bits(v, bitmask);
+            return (v >= min && v <= max) != invert;
+        },
+                    bitmap);
+        apply_bitmap(bitmap, pixel_buf, nb, ny * nx);
     }
 
     json11::Json as_json() override {
@@ -142,6 +235,86 @@ struct range_mask : public image_mask {
     double _max;
     bool _invert;
     std::vector<uint8_t> _bits;
+    uint32_t _bitmask;
+};
+
+/**
+ * @brief Mask for integer quality assessment bands with bit flags, such as Landsat QA_PIXEL
+ *
+ * The mask consists of one or more tests, each given as a pair (bitmask, value). A pixel is masked
+ * if (qa & bitmask) == value for at least one of the tests, or, if invert is true, if no test matches.
+ * As an example, the tests {{1 << 3, 1 << 3}, {1 << 4, 1 << 4}} mask pixels where the cloud (bit 3) or
+ * the cloud shadow (bit 4) flag of Landsat Collection 2 QA_PIXEL bands is set.
+ *
+ * In contrast to value_mask and range_mask, the mask band is read as unsigned 32 bit integers and not
+ * converted to double.
+ */
+struct bitflag_mask : public image_mask {
+   public:
+    bitflag_mask(std::vector<std::pair<uint32_t, uint32_t>> tests, bool invert = false) : _tests(tests), _invert(invert) {
+        for (uint16_t i = 0; i < _tests.size(); ++i) {
+            if ((_tests[i].second & ~_tests[i].first) != 0) {
+                GCBS_WARN("Bit flag mask test value " + std::to_string(_tests[i].second) + " has bits outside of bitmask " + std::to_string(_tests[i].first) + " and will never match");
+            }
+        }
+    }
+
+    bool integer_input() override { return true; }
+
+    void apply(double *mask_buf, double *pixel_buf, uint32_t nb, uint32_t ny, uint32_t nx) override {
+        // fallback for double input, convert to integers first, NAN pixels have no data
+        std::vector<uint32_t> qa(size_t(ny) * size_t(nx));
+        std::vector<uint8_t> valid(qa.size());
+        for (uint32_t i = 0; i < qa.size(); ++i) {
+            valid[i] = std::isnan(mask_buf[i]) ? 0 : 1;
+            qa[i] = valid[i] ? (uint32_t)mask_buf[i] : 0;
+        }
+        apply_uint32(qa.data(), valid.data(), pixel_buf, nb, ny, nx);
+    }
+
+    void apply_uint32(uint32_t *mask_buf, const uint8_t *valid, double *pixel_buf, uint32_t nb, uint32_t ny, uint32_t nx) override {
+        uint32_t npix = ny * nx;
+        std::vector<uint64_t> bitmap;
+        if (_tests.size() == 1) {
+            // most common case without inner loop over tests
+            const uint32_t m = _tests[0].first;
+            const uint32_t v = _tests[0].second;
+            const bool invert = _invert;
+            make_bitmap(mask_buf, npix, [m, v, invert](uint32_t x) { return ((x & m) == v) != invert; }, bitmap);
+        } else {
+            const std::vector<std::pair<uint32_t, uint32_t>> &tests = _tests;
+            const bool invert = _invert;
+            make_bitmap(mask_buf, npix, [&tests, invert](uint32_t x) {
+                bool match = false;
+                for (uint16_t i = 0; i < tests.size(); ++i) {
+                    match |= ((x & tests[i].first) == tests[i].second);
+                }
+                return match != invert;
+            },
+                        bitmap);
+        }
+        if (valid) {
+            // pixels without data match no test
+            set_invalid(valid, npix, _invert, bitmap);
+        }
+        apply_bitmap(bitmap, pixel_buf, nb, npix);
+    }
+
+    json11::Json as_json() override {
+        json11::Json::object out;
+        out["mask_type"] = "bitflag_mask";
+        json11::Json::array tests;
+        for (uint16_t i = 0; i < _tests.size(); ++i) {
+            tests.push_back(json11::Json::object{{"bitmask", (double)_tests[i].first}, {"value", (double)_tests[i].second}});
+        }
+        out["tests"] = tests;
+        out["invert"] = _invert;
+        return out;
+    }
+
+   private:
+    std::vector<std::pair<uint32_t, uint32_t>> _tests;
+    bool _invert;
 };
 
 // TODO: mask that applies a lambda expression / std::function on the mask band
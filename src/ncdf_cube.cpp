@@ -458,6 +458,8 @@ std::shared_ptr<chunk_data> ncdf_cube::read_chunk(chunkid_t id) {
     GCBS_TRACE("ncdf_cube::read_chunk(" + std::to_string(id) + ")");
 
     std::shared_ptr<chunk_data> out = std::make_shared<chunk_data>();
+    profile_scope profile(this, out);
+    trace_span span("ncdf_cube::read_chunk", "source", id);
     if (id >= count_chunks()) {
         // chunk is outside of the cube, we don't need to read anything.
         GCBS_WARN("Chunk id " + std::to_string(id) + " is out of range");
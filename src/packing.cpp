@@ -0,0 +1,149 @@
+/*
+    MIT License
+
+    Copyright (c) 2026 Marius Appel <marius.appel@uni-muenster.de>
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+#include "packing.h"
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace gdalcubes {
+
+template <typename T>
+static void pack_values(const double *__restrict in, T *__restrict out, std::size_t n, double scale, double offset, double nodata) {
+    // loading bounds through volatile prevents constant folding of the clamp into a form that GCC does not vectorize
+    volatile double lo_v = (double)std::numeric_limits<T>::lowest();
+    volatile double hi_v = (double)std::numeric_limits<T>::max();
+    const double lo = lo_v;
+    const double hi = hi_v;
+    const double nd = std::isnan(nodata) ? 0.0 : std::fmin(std::fmax(nodata, lo), hi);
+    const double magic = 6755399441055744.0;  // 1.5 * 2^52, adding and subtracting rounds to the nearest integer (ties to even)
+    for (std::size_t i = 0; i < n; ++i) {
+        double x = in[i];
+        double v = (x - offset) / scale;
+        // clamp first, out of range conversions to integer types are undefined
+        v = v < lo ? lo : v;
+        v = v > hi ? hi : v;
+        double r = (v + magic) - magic;
+        // round half away from zero as std::round does
+        double d = v - r;
+        r += (d == 0.5 && v > 0) ? 1.0 : 0.0;
+        r -= (d == -0.5 && v < 0) ? 1.0 : 0.0;
+        r = (x != x) ? nd : r;
+        out[i] = (T)r;
+    }
+}
+
+template <typename T>
+static void unpack_values(const T *__restrict in, double *__restrict out, std::size_t n, double scale, double offset, double nodata) {
+    for (std::size_t i = 0; i < n; ++i) {
+        double x = (double)in[i];
+        out[i] = (x == nodata) ? NAN : offset + x * scale;
+    }
+}
+
+uint8_t packing_kernels::value_size(packed_export::packing_type type) {
+    switch (type) {
+        case packed_export::packing_type::PACK_UINT8:
+            return sizeof(uint8_t);
+        case packed_export::packing_type::PACK_UINT16:
+            return sizeof(uint16_t);
+        case packed_export::packing_type::PACK_UINT32:
+            return sizeof(uint32_t);
+        case packed_export::packing_type::PACK_INT16:
+            return sizeof(int16_t);
+        case packed_export::packing_type::PACK_INT32:
+            return sizeof(int32_t);
+        case packed_export::packing_type::PACK_FLOAT32:
+            return sizeof(float);
+        default:
+            return sizeof(double);
+    }
+}
+
+void packing_kernels::pack(packed_export::packing_type type, const double *in, void *out, std::size_t n, double scale, double offset, double nodata) {
+    switch (type) {
+        case packed_export::packing_type::PACK_UINT8:
+            pack_values(in, (uint8_t *)out, n, scale, offset, nodata);
+            break;
+        case packed_export::packing_type::PACK_UINT16:
+            pack_values(in, (uint16_t *)out, n, scale, offset, nodata);
+            break;
+        case packed_export::packing_type::PACK_UINT32:
+            pack_values(in, (uint32_t *)out, n, scale, offset, nodata);
+            break;
+        case packed_export::packing_type::PACK_INT16:
+            pack_values(in, (int16_t *)out, n, scale, offset, nodata);
+            break;
+        case packed_export::packing_type::PACK_INT32:
+            pack_values(in, (int32_t *)out, n, scale, offset, nodata);
+            break;
+        case packed_export::packing_type::PACK_FLOAT32:
+            for (std::size_t i = 0; i < n; ++i) {
+                ((float *)out)[i] = (float)in[i];
+            }
+            break;
+        default:
+            std::memcpy(out, in, n * sizeof(double));
+    }
+}
+
+void packing_kernels::pack_band(const packed_export &packing, uint16_t band, const double *in, void *out, std::size_t n) {
+    if (packing.type == packed_export::packing_type::PACK_NONE || packing.type == packed_export::packing_type::PACK_FLOAT32) {
+        pack(packing.type, in, out, n, 1.0, 0.0, NAN);
+        return;
+    }
+    double scale = packing.scale.size() > band ? packing.scale[band] : packing.scale[0];
+    double offset = packing.offset.size() > band ? packing.offset[band] : packing.offset[0];
+    double nodata = packing.nodata.size() > band ? packing.nodata[band] : packing.nodata[0];
+    pack(packing.type, in, out, n, scale, offset, nodata);
+}
+
+void packing_kernels::unpack(packed_export::packing_type type, const void *in, double *out, std::size_t n, double scale, double offset, double nodata) {
+    switch (type) {
+        case packed_export::packing_type::PACK_UINT8:
+            unpack_values((const uint8_t *)in, out, n, scale, offset, nodata);
+            break;
+        case packed_export::packing_type::PACK_UINT16:
+            unpack_values((const uint16_t *)in, out, n, scale, offset, nodata);
+            break;
+        case packed_export::packing_type::PACK_UINT32:
+            unpack_values((const uint32_t *)in, out, n, scale, offset, nodata);
+            break;
+        case packed_export::packing_type::PACK_INT16:
+            unpack_values((const int16_t *)in, out, n, scale, offset, nodata);
+            break;
+        case packed_export::packing_type::PACK_INT32:
+            unpack_values((const int32_t *)in, out, n, scale, offset, nodata);
+            break;
+        case packed_export::packing_type::PACK_FLOAT32:
+            for (std::size_t i = 0; i < n; ++i) {
+                out[i] = ((const float *)in)[i];
+            }
+            break;
+        default:
+            std::memcpy(out, in, n * sizeof(double));
+    }
+}
+
+}  // namespace gdalcubes
@@ -0,0 +1,70 @@
+/*
+    MIT License
+
+    Copyright (c) 2026 Marius Appel <marius.appel@uni-muenster.de>
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+#ifndef PACKING_H
+#define PACKING_H
+
+#include "cube.h"
+
+namespace gdalcubes {
+
+/**
+ * @brief Conversion kernels between double chunk buffers and packed output data types
+ *
+ * Packing computes round((x - offset) / scale), clamps the result to the range of the target
+ * type and replaces NAN with the nodata value. The loops are written without branches such that
+ * compilers can vectorize them. All writers with packed_export options use these functions.
+ */
+class packing_kernels {
+   public:
+    /**
+     * @brief Size of one packed value in bytes (8 for PACK_NONE)
+     */
+    static uint8_t value_size(packed_export::packing_type type);
+
+    /**
+     * @brief Pack n values
+     * @param type output data type; PACK_NONE copies values, PACK_FLOAT32 ignores scale, offset, and nodata
+     * @param in input values
+     * @param out output buffer with at least n * value_size(type) bytes
+     * @param n number of values
+     * @param scale scale factor
+     * @param offset offset
+     * @param nodata value for NAN input, clamped to the range of the output type
+     */
+    static void pack(packed_export::packing_type type, const double *in, void *out, std::size_t n, double scale, double offset, double nodata);
+
+    /**
+     * @brief Pack n values of one band using the band's scale, offset, and nodata value of a packed_export
+     */
+    static void pack_band(const packed_export &packing, uint16_t band, const double *in, void *out, std::size_t n);
+
+    /**
+     * @brief Unpack n values, i.e. compute x * scale + offset and replace nodata with NAN
+     */
+    static void unpack(packed_export::packing_type type, const void *in, double *out, std::size_t n, double scale, double offset, double nodata);
+};
+
+}  // namespace gdalcubes
+
+#endif  // PACKING_H
@@ -0,0 +1,139 @@
+/*
+    MIT License
+
+    Copyright (c) 2026 Marius Appel <marius.appel@uni-muenster.de>
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+#include "profiler.h"
+
+#ifndef _WIN32
+#include <time.h>
+#endif
+
+#include "cube.h"
+
+namespace gdalcubes {
+
+std::atomic<bool> profiler::_enabled(false);
+std::mutex profiler::_mutex;
+std::map<const cube *, profiler::cube_stats> profiler::_stats;
+
+// innermost active read_chunk() call of the current thread
+static thread_local profile_scope *profile_stack_top = nullptr;
+
+void profiler::reset() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stats.clear();
+}
+
+void profiler::remove(const cube *c) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stats.erase(c);
+}
+
+profiler::cube_stats profiler::get(const cube *c) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto it = _stats.find(c);
+    return it == _stats.end() ? cube_stats() : it->second;
+}
+
+void profiler::count(const cube *c, const std::string &counter, double value) {
+    if (!enabled()) return;
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stats[c].counters[counter] += value;
+}
+
+void profiler::record(const cube *c, double wall, double cpu, double wall_total, const std::shared_ptr<chunk_data> &out) {
+    bool empty = !out || out->empty();
+    uint64_t bytes = empty ? 0 : out->total_size_bytes();
+    std::lock_guard<std::mutex> lock(_mutex);
+    cube_stats &s = _stats[c];
+    s.calls++;
+    if (empty) s.empty++;
+    s.bytes += bytes;
+    s.wall += wall;
+    s.cpu += cpu;
+    s.wall_total += wall_total;
+}
+
+double profiler::thread_cpu_time() {
+#if !defined(_WIN32) && defined(CLOCK_THREAD_CPUTIME_ID)
+    struct timespec ts;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) == 0) {
+        return double(ts.tv_sec) + double(ts.tv_nsec) * 1e-9;
+    }
+#endif
+    return 0;
+}
+
+json11::Json profiler::report(std::shared_ptr<cube> c) {
+    json11::Json j = c->make_constructible_json();
+    json11::Json::object out;
+    for (auto it = j.object_items().begin(); it != j.object_items().end(); ++it) {
+        if (it->first != "in_cube" && it->first != "in_cubes") {
+            out[it->first] = it->second;
+        }
+    }
+
+    cube_stats s = get(c.get());
+    json11::Json::object p{{"calls", (double)s.calls},
+                           {"empty_chunks", (double)s.empty},
+                           {"empty_ratio", s.calls > 0 ? double(s.empty) / double(s.calls) : 0.0},
+                           {"bytes", (double)s.bytes},
+                           {"wall_seconds", s.wall},
+                           {"cpu_seconds", s.cpu},
+                           {"wall_seconds_total", s.wall_total}};
+    for (auto it = s.counters.begin(); it != s.counters.end(); ++it) {
+        p[it->first] = it->second;
+    }
+    out["profile"] = p;
+
+    std::vector<std::shared_ptr<cube>> in = c->parent_cubes();
+    if (!j["in_cubes"].is_null()) {
+        json11::Json::array a;
+        for (uint16_t i = 0; i < in.size(); ++i) {
+            a.push_back(report(in[i]));
+        }
+        out["in_cubes"] = a;
+    } else if (!in.empty()) {
+        out["in_cube"] = report(in[0]);
+    }
+    return out;
+}
+
+void profile_scope::begin() {
+    _parent = profile_stack_top;
+    profile_stack_top = this;
+    _start_cpu = profiler::thread_cpu_time();
+    _start = std::chrono::steady_clock::now();
+}
+
+void profile_scope::end() {
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - _start).count();
+    double cpu = profiler::thread_cpu_time() - _start_cpu;
+    profile_stack_top = _parent;
+    if (_parent) {
+        _parent->_child_wall += wall;
+        _parent->_child_cpu += cpu;
+    }
+    profiler::record(_c, wall - _child_wall, cpu - _child_cpu, wall, _out);
+}
+
+}  // namespace gdalcubes
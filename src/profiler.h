@@ -0,0 +1,170 @@
+/*
+    MIT License
+
+    Copyright (c) 2026 Marius Appel <marius.appel@uni-muenster.de>
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "external/json11/json11.hpp"
+
+namespace gdalcubes {
+
+class cube;
+class chunk_data;
+
+/**
+ * @brief Opt-in profiler collecting execution statistics of cube::read_chunk() per cube node
+ *
+ * If enabled, each read_chunk() call records the number of calls, the number of empty chunks, produced bytes, and
+ * wall / CPU time excluding the time spent in read_chunk() calls of input cubes. Cubes may additionally record named
+ * counters, e.g. the number of opened images or the time spent in GDAL warp and RasterIO calls for
+ * image_collection_cube.
+ *
+ * Exclusive times are derived from a per-thread stack of active read_chunk() calls. Input chunks read in other
+ * threads are hence counted as exclusive time (waiting) of the calling cube.
+ *
+ * The profiler is disabled by default and costs a single atomic load per read_chunk() call in this case.
+ */
+class profiler {
+   public:
+    /**
+     * @brief Statistics of a single cube node
+     */
+    struct cube_stats {
+        cube_stats() : calls(0), empty(0), bytes(0), wall(0), cpu(0), wall_total(0), counters() {}
+        uint64_t calls;
+        uint64_t empty;
+        uint64_t bytes;
+        double wall;        // seconds, excluding input cubes
+        double cpu;         // seconds, excluding input cubes
+        double wall_total;  // seconds, including input cubes
+        std::map<std::string, double> counters;
+    };
+
+    /**
+     * @brief Enable or disable profiling, statistics collected so far are kept
+     */
+    static void enable(bool enabled = true) { _enabled.store(enabled); }
+
+    static inline bool enabled() { return _enabled.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Remove all collected statistics
+     */
+    static void reset();
+
+    /**
+     * @brief Remove collected statistics of a cube node, called when the cube is destructed
+     * @note statistics are keyed by address, which may be reused by cubes created later
+     */
+    static void remove(const cube *c);
+
+    /**
+     * @brief Get collected statistics of a cube node
+     */
+    static cube_stats get(const cube *c);
+
+    /**
+     * @brief Add a value to a named counter of a cube node, ignored if the profiler is disabled
+     */
+    static void count(const cube *c, const std::string &counter, double value = 1);
+
+    /**
+     * @brief Get the collected statistics of a cube graph as JSON tree
+     *
+     * The tree follows the structure of cube::make_constructible_json(), i.e., each node contains the cube's
+     * parameters, a "profile" object with its statistics, and its inputs as "in_cube" or "in_cubes".
+     * @param c root of the cube graph
+     */
+    static json11::Json report(std::shared_ptr<cube> c);
+
+    // returns the CPU time consumed by the calling thread in seconds, or 0 if not supported on this platform
+    static double thread_cpu_time();
+
+   private:
+    friend class profile_scope;
+    static void record(const cube *c, double wall, double cpu, double wall_total, const std::shared_ptr<chunk_data> &out);
+
+    static std::atomic<bool> _enabled;
+    static std::mutex _mutex;
+    static std::map<const cube *, cube_stats> _stats;
+};
+
+/**
+ * @brief Records a read_chunk() call of a cube for the profiler while in scope
+ *
+ * Must be declared after the chunk_data object returned by read_chunk() such that the result is still available
+ * when the scope is left.
+ */
+class profile_scope {
+   public:
+    profile_scope(const cube *c, const std::shared_ptr<chunk_data> &out) : _active(profiler::enabled()), _c(c), _out(out), _parent(nullptr), _child_wall(0), _child_cpu(0), _start(), _start_cpu(0) {
+        if (_active) begin();
+    }
+    ~profile_scope() {
+        if (_active) end();
+    }
+
+   private:
+    void begin();
+    void end();
+
+    bool _active;
+    const cube *_c;
+    const std::shared_ptr<chunk_data> &_out;
+    profile_scope *_parent;
+    double _child_wall;
+    double _child_cpu;
+    std::chrono::steady_clock::time_point _start;
+    double _start_cpu;
+};
+
+/**
+ * @brief Adds the wall time spent in scope to a named counter of a cube, if the profiler is enabled
+ */
+class profile_timer {
+   public:
+    profile_timer(const cube *c, const char *counter) : _active(profiler::enabled()), _c(c), _counter(counter), _start() {
+        if (_active) _start = std::chrono::steady_clock::now();
+    }
+    ~profile_timer() {
+        if (_active) profiler::count(_c, _counter, std::chrono::duration<double>(std::chrono::steady_clock::now() - _start).count());
+    }
+
+   private:
+    bool _active;
+    const cube *_c;
+    const char *_counter;
+    std::chrono::steady_clock::time_point _start;
+};
+
+}  // namespace gdalcubes
+
+#endif  //PROFILER_H
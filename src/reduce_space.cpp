@@ -24,6 +24,8 @@
 
 #include "reduce_space.h"
 
+#include "tdigest.h"
+
 namespace gdalcubes {
 
 struct reducer_singleband_s {
@@ -287,6 +289,45 @@ struct median_reducer_singleband_s : public reducer_singleband_s {
     uint16_t _band_idx_out;
 };
 
+/**
+ * @brief Implementation of reducer to estimate quantile values over space with bounded memory
+ * @note Uses one t-digest sketch per time slice, see tdigest
+ */
+struct approx_quantile_reducer_singleband_s : public reducer_singleband_s {
+    void init(std::shared_ptr<chunk_data> a, uint16_t band_idx_in, uint16_t band_idx_out, std::shared_ptr<cube> in_cube) override {
+        _band_idx_in = band_idx_in;
+        _band_idx_out = band_idx_out;
+        _sketches.resize(a->size()[1], tdigest(config::instance()->get_approx_quantile_compression()));
+    }
+
+    void combine(std::shared_ptr<chunk_data> a, std::shared_ptr<chunk_data> b, chunkid_t chunk_id) override {
+        for (uint32_t it = 0; it < b->size()[1]; ++it) {
+            for (uint32_t ixy = 0; ixy < b->size()[2] * b->size()[3]; ++ixy) {
+                double v = ((double *)b->buf())[_band_idx_in * b->size()[1] * b->size()[2] * b->size()[3] + it * b->size()[2] * b->size()[3] + ixy];
+                if (!std::isnan(v)) {
+                    _sketches[it].add(v);
+                }
+            }
+        }
+    }
+
+    void set_p(double p) {
+        _p = p;
+    }
+
+    void finalize(std::shared_ptr<chunk_data> a) override {
+        for (uint32_t it = 0; it < a->size()[1]; ++it) {
+            ((double *)a->buf())[_band_idx_out * a->size()[1] + it] = _sketches[it].quantile(_p);
+        }
+    }
+
+   private:
+    std::vector<tdigest> _sketches;
+    uint16_t _band_idx_in;
+    uint16_t _band_idx_out;
+    double _p;
+};
+
 /**
  * @brief Implementation of reducer to calculate variance values over time using Welford's Online algorithm
  */
@@ -349,23 +390,155 @@ struct sd_reducer_singleband_s : public var_reducer_singleband_s {
     }
 };
 
+/**
+ * @brief Fused reducer that computes several moment-based statistics ("count", "sum", "mean", "var", "sd", "min", "max")
+ * of the same input band in a single pass over the input chunks.
+ * @details The fused reducer keeps a shared state (count, sum, running mean / M2 using Welford's online algorithm, min, max) per
+ * time slice and derives all requested statistics in finalize().
+ */
+struct fused_reducer_singleband_s : public reducer_singleband_s {
+    /**
+     * @brief Checks whether a reducer can be computed as part of a fused reducer
+     * @param reducer name of the reducer
+     * @return true, if the given reducer can be derived from the fused state
+     */
+    static bool is_fusable(std::string reducer) {
+        return reducer == "count" || reducer == "sum" || reducer == "mean" ||
+               reducer == "var" || reducer == "sd" || reducer == "min" || reducer == "max";
+    }
+
+    /**
+     * @brief Construct a fused reducer
+     * @param stats_out vector of (reducer name, output band index) pairs, all reducers must be fusable
+     */
+    fused_reducer_singleband_s(std::vector<std::pair<std::string, uint16_t>> stats_out) : _stats_out(stats_out), _need_m2(false), _need_minmax(false) {
+        for (uint16_t i = 0; i < _stats_out.size(); ++i) {
+            if (_stats_out[i].first == "var" || _stats_out[i].first == "sd") _need_m2 = true;
+            if (_stats_out[i].first == "min" || _stats_out[i].first == "max") _need_minmax = true;
+        }
+    }
+
+    /**
+     * @copydoc reducer_singleband_s::init
+     * @note band_idx_out is ignored, output band indexes are given in the constructor
+     */
+    void init(std::shared_ptr<chunk_data> a, uint16_t band_idx_in, uint16_t band_idx_out, std::shared_ptr<cube> in_cube) override {
+        _band_idx_in = band_idx_in;
+        uint32_t nt = a->size()[1];
+        _count.assign(nt, 0);
+        _sum.assign(nt, 0);
+        _mean.assign(nt, 0);
+        _m2.assign(nt, 0);
+        _min.assign(nt, NAN);
+        _max.assign(nt, NAN);
+    }
+
+    void combine(std::shared_ptr<chunk_data> a, std::shared_ptr<chunk_data> b, chunkid_t chunk_id) override {
+        uint32_t nxy = b->size()[2] * b->size()[3];
+        for (uint32_t it = 0; it < b->size()[1]; ++it) {
+            double *v_in = ((double *)b->buf()) + _band_idx_in * b->size()[1] * nxy + it * nxy;
+            uint32_t &count = _count[it];
+            double &sum = _sum[it];
+            double &mean = _mean[it];
+            double &m2 = _m2[it];
+            double &min = _min[it];
+            double &max = _max[it];
+            for (uint32_t ixy = 0; ixy < nxy; ++ixy) {
+                double v = v_in[ixy];
+                if (std::isnan(v)) continue;
+                ++count;
+                sum += v;
+                if (_need_m2) {
+                    double delta = v - mean;
+                    mean += delta / count;
+                    m2 += delta * (v - mean);
+                }
+                if (_need_minmax) {
+                    if (std::isnan(min) || v < min) min = v;
+                    if (std::isnan(max) || v > max) max = v;
+                }
+            }
+        }
+    }
+
+    void finalize(std::shared_ptr<chunk_data> a) override {
+        uint32_t nt = a->size()[1];
+        for (uint16_t i = 0; i < _stats_out.size(); ++i) {
+            const std::string &stat = _stats_out[i].first;
+            double *v_out = ((double *)a->buf()) + _stats_out[i].second * nt;
+            for (uint32_t it = 0; it < nt; ++it) {
+                if (stat == "count") {
+                    v_out[it] = _count[it];
+                } else if (stat == "sum") {
+                    v_out[it] = _sum[it];
+                } else if (stat == "mean") {
+                    v_out[it] = _count[it] > 0 ? _sum[it] / _count[it] : NAN;
+                } else if (stat == "var") {
+                    v_out[it] = _count[it] > 1 ? _m2[it] / (_count[it] - 1) : NAN;
+                } else if (stat == "sd") {
+                    v_out[it] = _count[it] > 1 ? sqrt(_m2[it] / (_count[it] - 1)) : NAN;
+                } else if (stat == "min") {
+                    v_out[it] = _min[it];
+                } else if (stat == "max") {
+                    v_out[it] = _max[it];
+                }
+            }
+        }
+    }
+
+   private:
+    std::vector<std::pair<std::string, uint16_t>> _stats_out;
+    bool _need_m2;
+    bool _need_minmax;
+    std::vector<uint32_t> _count;
+    std::vector<double> _sum;
+    std::vector<double> _mean;
+    std::vector<double> _m2;
+    std::vector<double> _min;
+    std::vector<double> _max;
+    uint16_t _band_idx_in;
+};
+
 std::shared_ptr<chunk_data> reduce_space_cube::read_chunk(chunkid_t id) {
     GCBS_TRACE("reduce_space_cube::read_chunk(" + std::to_string(id) + ")");
     std::shared_ptr<chunk_data> out = std::make_shared<chunk_data>();
+    profile_scope profile(this, out);
     if (id >= count_chunks())
         return out;  // chunk is outside of the view, we don't need to read anything.
 
     // If input cube is already "reduced", simply return corresponding input chunk
     if (_in_cube->size_y() == 1 && _in_cube->size_x() == 1) {
-        return _in_cube->read_chunk(id);
+        out = _in_cube->read_chunk(id);
+        return out;
     }
 
     coords_nd<uint32_t, 3> size_tyx = chunk_size(id);
     coords_nd<uint32_t, 4> size_btyx = {uint32_t(_reducer_bands.size()), size_tyx[0], 1, 1};
     out->size(size_btyx);
 
+    // Group fusable reducers by input band, such that e.g. mean, sd, min, and max of the same band
+    // are computed in a single pass with shared state
+    std::map<std::string, std::vector<std::pair<std::string, uint16_t>>> fused_stats;
+    for (uint16_t i = 0; i < _reducer_bands.size(); ++i) {
+        if (fused_reducer_singleband_s::is_fusable(_reducer_bands[i].first)) {
+            fused_stats[_reducer_bands[i].second].push_back(std::make_pair(_reducer_bands[i].first, i));
+        }
+    }
+
     std::vector<reducer_singleband_s *> reducers;
+    std::vector<uint16_t> reducer_band_idx_in;
+    std::vector<uint16_t> reducer_band_idx_out;
+    for (auto it = fused_stats.begin(); it != fused_stats.end(); ++it) {
+        if (it->second.size() > 1) {
+            reducers.push_back(new fused_reducer_singleband_s(it->second));
+            reducer_band_idx_in.push_back(_in_cube->bands().get_index(it->first));
+            reducer_band_idx_out.push_back(it->second[0].second);
+        }
+    }
     for (uint16_t i = 0; i < _reducer_bands.size(); ++i) {
+        if (fused_reducer_singleband_s::is_fusable(_reducer_bands[i].first) && fused_stats[_reducer_bands[i].second].size() > 1) {
+            continue;  // already part of a fused reducer
+        }
         reducer_singleband_s *r = nullptr;
         if (_reducer_bands[i].first == "min") {
             r = new min_reducer_singleband_s();
@@ -375,6 +548,15 @@ std::shared_ptr<chunk_data> reduce_space_cube::read_chunk(chunkid_t id) {
             r = new mean_reducer_singleband_s();
         } else if (_reducer_bands[i].first == "median") {
             r = new median_reducer_singleband_s();
+        } else if (_reducer_bands[i].first == "median_approx") {
+            r = new approx_quantile_reducer_singleband_s();
+            dynamic_cast<approx_quantile_reducer_singleband_s *>(r)->set_p(0.5);
+        } else if (_reducer_bands[i].first == "Q1_approx") {
+            r = new approx_quantile_reducer_singleband_s();
+            dynamic_cast<approx_quantile_reducer_singleband_s *>(r)->set_p(0.25);
+        } else if (_reducer_bands[i].first == "Q3_approx") {
+            r = new approx_quantile_reducer_singleband_s();
+            dynamic_cast<approx_quantile_reducer_singleband_s *>(r)->set_p(0.75);
         } else if (_reducer_bands[i].first == "sum") {
             r = new sum_reducer_singleband_s();
         } else if (_reducer_bands[i].first == "count") {
@@ -389,6 +571,8 @@ std::shared_ptr<chunk_data> reduce_space_cube::read_chunk(chunkid_t id) {
             throw std::string("ERROR in reduce_time_cube::read_chunk(): Unknown reducer given");
 
         reducers.push_back(r);
+        reducer_band_idx_in.push_back(_in_cube->bands().get_index(_reducer_bands[i].second));
+        reducer_band_idx_out.push_back(i);
     }
 
     // iterate over all chunks that must be read from the input cube to compute this chunk
@@ -403,14 +587,13 @@ std::shared_ptr<chunk_data> reduce_space_cube::read_chunk(chunkid_t id) {
                 double *begin = (double *)out->buf();
                 double *end = ((double *)out->buf()) + size_btyx[0] * size_btyx[1] * size_btyx[2] * size_btyx[3];
                 std::fill(begin, end, NAN);
-                for (uint16_t ib = 0; ib < _reducer_bands.size(); ++ib) {
-                    uint16_t band_idx_in = _in_cube->bands().get_index(_reducer_bands[ib].second);
-                    reducers[ib]->init(out, band_idx_in, ib, _in_cube);
+                for (uint16_t ir = 0; ir < reducers.size(); ++ir) {
+                    reducers[ir]->init(out, reducer_band_idx_in[ir], reducer_band_idx_out[ir], _in_cube);
                 }
                 initialized = true;
             }
-            for (uint16_t ib = 0; ib < _reducer_bands.size(); ++ib) {
-                reducers[ib]->combine(out, x, i);
+            for (uint16_t ir = 0; ir < reducers.size(); ++ir) {
+                reducers[ir]->combine(out, x, i);
             }
             empty = false;
         }
@@ -419,7 +602,7 @@ std::shared_ptr<chunk_data> reduce_space_cube::read_chunk(chunkid_t id) {
         out = std::make_shared<chunk_data>();
     }
     else {
-        for (uint16_t i = 0; i < _reducer_bands.size(); ++i) {
+        for (uint16_t i = 0; i < reducers.size(); ++i) {
             reducers[i]->finalize(out);
         }
     }
@@ -75,6 +75,9 @@ class reduce_space_cube : public cube {
                   reducerstr == "max" ||
                   reducerstr == "mean" ||
                   reducerstr == "median" ||
+                  reducerstr == "median_approx" ||
+                  reducerstr == "Q1_approx" ||
+                  reducerstr == "Q3_approx" ||
                   reducerstr == "count" ||
                   reducerstr == "var" ||
                   reducerstr == "sd" ||
@@ -23,6 +23,8 @@
 */
 #include "reduce_time.h"
 
+#include "tdigest.h"
+
 namespace gdalcubes {
 
 struct reducer_singleband {
@@ -461,6 +463,46 @@ struct quantile_reducer_singleband : public reducer_singleband {
 
 
 
+/**
+ * @brief Implementation of reducer to estimate quantile values over time with bounded memory
+ * @note Uses one t-digest sketch per pixel, results are exact for short time series and approximate otherwise, see tdigest
+ */
+struct approx_quantile_reducer_singleband : public reducer_singleband {
+    void init(std::shared_ptr<chunk_data> a, uint16_t band_idx_in, uint16_t band_idx_out, std::shared_ptr<cube> in_cube) override {
+        _band_idx_in = band_idx_in;
+        _band_idx_out = band_idx_out;
+        _sketches.resize(a->size()[2] * a->size()[3], tdigest(config::instance()->get_approx_quantile_compression()));
+    }
+
+    void combine(std::shared_ptr<chunk_data> a, std::shared_ptr<chunk_data> b, chunkid_t chunk_id) override {
+        for (uint32_t it = 0; it < b->size()[1]; ++it) {
+            for (uint32_t ixy = 0; ixy < b->size()[2] * b->size()[3]; ++ixy) {
+                double v = ((double *)b->buf())[_band_idx_in * b->size()[1] * b->size()[2] * b->size()[3] + it * b->size()[2] * b->size()[3] + ixy];
+                if (!std::isnan(v)) {
+                    _sketches[ixy].add(v);
+                }
+            }
+        }
+    }
+
+    void set_p(double p) {
+        _p = p;
+    }
+
+    void finalize(std::shared_ptr<chunk_data> a) override {
+        for (uint32_t ixy = 0; ixy < a->size()[2] * a->size()[3]; ++ixy) {
+            ((double *)a->buf())[_band_idx_out * a->size()[2] * a->size()[3] + ixy] = _sketches[ixy].quantile(_p);
+        }
+        std::vector<tdigest>().swap(_sketches);
+    }
+
+   private:
+    std::vector<tdigest> _sketches;
+    uint16_t _band_idx_in;
+    uint16_t _band_idx_out;
+    double _p;
+};
+
 /**
  * @brief Implementation of reducer to calculate variance values over time using Welford's Online algorithm
  */
@@ -523,23 +565,187 @@ struct sd_reducer_singleband : public var_reducer_singleband {
     }
 };
 
+/**
+ * @brief Fused reducer that computes several moment-based statistics ("count", "sum", "mean", "var", "sd", "min", "max")
+ * of the same input band in a single pass over the input chunks.
+ * @details Instead of creating one reducer with separate buffers per statistic, the fused reducer keeps a shared state
+ * (count, sum, running mean / M2 using Welford's online algorithm, min, max) per pixel and derives all requested statistics
+ * in finalize(). Buffers are only allocated for parts of the state that are actually needed.
+ */
+struct fused_reducer_singleband : public reducer_singleband {
+    /**
+     * @brief Checks whether a reducer can be computed as part of a fused reducer
+     * @param reducer name of the reducer
+     * @return true, if the given reducer can be derived from the fused state
+     */
+    static bool is_fusable(std::string reducer) {
+        return reducer == "count" || reducer == "sum" || reducer == "mean" ||
+               reducer == "var" || reducer == "sd" || reducer == "min" || reducer == "max";
+    }
+
+    /**
+     * @brief Construct a fused reducer
+     * @param stats_out vector of (reducer name, output band index) pairs, all reducers must be fusable
+     */
+    fused_reducer_singleband(std::vector<std::pair<std::string, uint16_t>> stats_out) : _stats_out(stats_out), _need_sum(false), _need_m2(false), _need_min(false), _need_max(false),
+                                                                                         _count(nullptr), _sum(nullptr), _mean(nullptr), _m2(nullptr), _min(nullptr), _max(nullptr) {
+        for (uint16_t i = 0; i < _stats_out.size(); ++i) {
+            if (_stats_out[i].first == "sum" || _stats_out[i].first == "mean") _need_sum = true;
+            if (_stats_out[i].first == "var" || _stats_out[i].first == "sd") _need_m2 = true;
+            if (_stats_out[i].first == "min") _need_min = true;
+            if (_stats_out[i].first == "max") _need_max = true;
+        }
+    }
+
+    ~fused_reducer_singleband() {
+        free_buffers();
+    }
+
+    /**
+     * @copydoc reducer_singleband::init
+     * @note band_idx_out is ignored, output band indexes are given in the constructor
+     */
+    void init(std::shared_ptr<chunk_data> a, uint16_t band_idx_in, uint16_t band_idx_out, std::shared_ptr<cube> in_cube) override {
+        _band_idx_in = band_idx_in;
+        uint32_t nxy = a->size()[2] * a->size()[3];
+        _count = (uint32_t *)std::calloc(nxy, sizeof(uint32_t));
+        if (_need_sum) {
+            _sum = (double *)std::calloc(nxy, sizeof(double));
+        }
+        if (_need_m2) {
+            _mean = (double *)std::calloc(nxy, sizeof(double));
+            _m2 = (double *)std::calloc(nxy, sizeof(double));
+        }
+        if (_need_min) {
+            _min = (double *)std::malloc(nxy * sizeof(double));
+            std::fill(_min, _min + nxy, NAN);
+        }
+        if (_need_max) {
+            _max = (double *)std::malloc(nxy * sizeof(double));
+            std::fill(_max, _max + nxy, NAN);
+        }
+    }
+
+    void combine(std::shared_ptr<chunk_data> a, std::shared_ptr<chunk_data> b, chunkid_t chunk_id) override {
+        uint32_t nxy = b->size()[2] * b->size()[3];
+        for (uint32_t it = 0; it < b->size()[1]; ++it) {
+            double *v_in = ((double *)b->buf()) + _band_idx_in * b->size()[1] * nxy + it * nxy;
+            for (uint32_t ixy = 0; ixy < nxy; ++ixy) {
+                double v = v_in[ixy];
+                if (std::isnan(v)) continue;
+                uint32_t count = ++_count[ixy];
+                if (_need_sum) {
+                    _sum[ixy] += v;
+                }
+                if (_need_m2) {
+                    double delta = v - _mean[ixy];
+                    _mean[ixy] += delta / count;
+                    _m2[ixy] += delta * (v - _mean[ixy]);
+                }
+                if (_need_min) {
+                    if (std::isnan(_min[ixy]) || v < _min[ixy]) _min[ixy] = v;
+                }
+                if (_need_max) {
+                    if (std::isnan(_max[ixy]) || v > _max[ixy]) _max[ixy] = v;
+                }
+            }
+        }
+    }
+
+    void finalize(std::shared_ptr<chunk_data> a) override {
+        uint32_t nxy = a->size()[2] * a->size()[3];
+        for (uint16_t i = 0; i < _stats_out.size(); ++i) {
+            const std::string &stat = _stats_out[i].first;
+            double *v_out = ((double *)a->buf()) + _stats_out[i].second * nxy;
+            if (stat == "count") {
+                for (uint32_t ixy = 0; ixy < nxy; ++ixy) v_out[ixy] = _count[ixy];
+            } else if (stat == "sum") {
+                std::copy(_sum, _sum + nxy, v_out);
+            } else if (stat == "mean") {
+                for (uint32_t ixy = 0; ixy < nxy; ++ixy) v_out[ixy] = _count[ixy] > 0 ? _sum[ixy] / _count[ixy] : NAN;
+            } else if (stat == "var") {
+                for (uint32_t ixy = 0; ixy < nxy; ++ixy) v_out[ixy] = _count[ixy] > 1 ? _m2[ixy] / (_count[ixy] - 1) : NAN;
+            } else if (stat == "sd") {
+                for (uint32_t ixy = 0; ixy < nxy; ++ixy) v_out[ixy] = _count[ixy] > 1 ? sqrt(_m2[ixy] / (_count[ixy] - 1)) : NAN;
+            } else if (stat == "min") {
+                std::copy(_min, _min + nxy, v_out);
+            } else if (stat == "max") {
+                std::copy(_max, _max + nxy, v_out);
+            }
+        }
+        free_buffers();
+    }
+
+   private:
+    void free_buffers() {
+        std::free(_count);
+        std::free(_sum);
+        std::free(_mean);
+        std::free(_m2);
+        std::free(_min);
+        std::free(_max);
+        _count = nullptr;
+        _sum = nullptr;
+        _mean = nullptr;
+        _m2 = nullptr;
+        _min = nullptr;
+        _max = nullptr;
+    }
+
+    std::vector<std::pair<std::string, uint16_t>> _stats_out;
+    bool _need_sum;
+    bool _need_m2;
+    bool _need_min;
+    bool _need_max;
+    uint32_t *_count;
+    double *_sum;
+    double *_mean;
+    double *_m2;
+    double *_min;
+    double *_max;
+    uint16_t _band_idx_in;
+};
+
 std::shared_ptr<chunk_data> reduce_time_cube::read_chunk(chunkid_t id) {
     GCBS_TRACE("reduce_time_cube::read_chunk(" + std::to_string(id) + ")");
     std::shared_ptr<chunk_data> out = std::make_shared<chunk_data>();
+    profile_scope profile(this, out);
     if (id >= count_chunks())
         return out;  // chunk is outside of the view, we don't need to read anything.
 
     // If input cube is already "reduced", simply return corresponding input chunk
     if (_in_cube->size_t() == 1) {
-        return _in_cube->read_chunk(id);
+        out = _in_cube->read_chunk(id);
+        return out;
     }
 
     coords_nd<uint32_t, 3> size_tyx = chunk_size(id);
     coords_nd<uint32_t, 4> size_btyx = {uint32_t(_reducer_bands.size()), 1, size_tyx[1], size_tyx[2]};
     out->size(size_btyx);
 
+    // Group fusable reducers by input band, such that e.g. mean, sd, min, and max of the same band
+    // are computed in a single pass with shared state
+    std::map<std::string, std::vector<std::pair<std::string, uint16_t>>> fused_stats;
+    for (uint16_t i = 0; i < _reducer_bands.size(); ++i) {
+        if (fused_reducer_singleband::is_fusable(_reducer_bands[i].first)) {
+            fused_stats[_reducer_bands[i].second].push_back(std::make_pair(_reducer_bands[i].first, i));
+        }
+    }
+
     std::vector<reducer_singleband *> reducers;
+    std::vector<uint16_t> reducer_band_idx_in;
+    std::vector<uint16_t> reducer_band_idx_out;
+    for (auto it = fused_stats.begin(); it != fused_stats.end(); ++it) {
+        if (it->second.size() > 1) {
+            reducers.push_back(new fused_reducer_singleband(it->second));
+            reducer_band_idx_in.push_back(_in_cube->bands().get_index(it->first));
+            reducer_band_idx_out.push_back(it->second[0].second);
+        }
+    }
     for (uint16_t i = 0; i < _reducer_bands.size(); ++i) {
+        if (fused_reducer_singleband::is_fusable(_reducer_bands[i].first) && fused_stats[_reducer_bands[i].second].size() > 1) {
+            continue;  // already part of a fused reducer
+        }
         reducer_singleband *r = nullptr;
         if (_reducer_bands[i].first == "min") {
             r = new min_reducer_singleband();
@@ -569,10 +775,21 @@ std::shared_ptr<chunk_data> reduce_time_cube::read_chunk(chunkid_t id) {
         } else if (_reducer_bands[i].first == "Q3") {
             r = new quantile_reducer_singleband();
             dynamic_cast<quantile_reducer_singleband*>(r)->set_p(0.75);
+        } else if (_reducer_bands[i].first == "median_approx") {
+            r = new approx_quantile_reducer_singleband();
+            dynamic_cast<approx_quantile_reducer_singleband*>(r)->set_p(0.5);
+        } else if (_reducer_bands[i].first == "Q1_approx") {
+            r = new approx_quantile_reducer_singleband();
+            dynamic_cast<approx_quantile_reducer_singleband*>(r)->set_p(0.25);
+        } else if (_reducer_bands[i].first == "Q3_approx") {
+            r = new approx_quantile_reducer_singleband();
+            dynamic_cast<approx_quantile_reducer_singleband*>(r)->set_p(0.75);
         } else
             throw std::string("ERROR in reduce_time_cube::read_chunk(): Unknown reducer given");
 
         reducers.push_back(r);
+        reducer_band_idx_in.push_back(_in_cube->bands().get_index(_reducer_bands[i].second));
+        reducer_band_idx_out.push_back(i);
     }
 
     // iterate over all chunks that must be read from the input cube to compute this chunk
@@ -587,14 +804,13 @@ std::shared_ptr<chunk_data> reduce_time_cube::read_chunk(chunkid_t id) {
                 double *begin = (double *)out->buf();
                 double *end = ((double *)out->buf()) + size_btyx[0] * size_btyx[1] * size_btyx[2] * size_btyx[3];
                 std::fill(begin, end, NAN);
-                for (uint16_t ib = 0; ib < _reducer_bands.size(); ++ib) {
-                    uint16_t band_idx_in = _in_cube->bands().get_index(_reducer_bands[ib].second);
-                    reducers[ib]->init(out, band_idx_in, ib, _in_cube);
+                for (uint16_t ir = 0; ir < reducers.size(); ++ir) {
+                    reducers[ir]->init(out, reducer_band_idx_in[ir], reducer_band_idx_out[ir], _in_cube);
                 }
                 initialized = true;
             }
-            for (uint16_t ib = 0; ib < _reducer_bands.size(); ++ib) {
-                reducers[ib]->combine(out, x, i);
+            for (uint16_t ir = 0; ir < reducers.size(); ++ir) {
+                reducers[ir]->combine(out, x, i);
             }
             empty = false;
         }
@@ -603,7 +819,7 @@ std::shared_ptr<chunk_data> reduce_time_cube::read_chunk(chunkid_t id) {
        out =  std::make_shared<chunk_data>();
     }
     else {
-        for (uint16_t i = 0; i < _reducer_bands.size(); ++i) {
+        for (uint16_t i = 0; i < reducers.size(); ++i) {
             reducers[i]->finalize(out);
         }
     }
@@ -86,7 +86,10 @@ class reduce_time_cube : public cube {
                   reducerstr == "which_min" ||
                   reducerstr == "which_max" ||
                   reducerstr == "Q1" ||
-                  reducerstr == "Q3"))
+                  reducerstr == "Q3" ||
+                  reducerstr == "median_approx" ||
+                  reducerstr == "Q1_approx" ||
+                  reducerstr == "Q3_approx"))
                 throw std::string("ERROR in reduce_time_cube::reduce_time_cube(): Unknown reducer '" + reducerstr + "'");
 
             if (!(in->bands().has(bandstr))) {
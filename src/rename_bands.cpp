@@ -28,7 +28,10 @@ namespace gdalcubes {
 
 std::shared_ptr<chunk_data> rename_bands_cube::read_chunk(chunkid_t id) {
     GCBS_TRACE("rename_bands_cube::read_chunk(" + std::to_string(id) + ")");
-    return _in_cube->read_chunk(id);
+    std::shared_ptr<chunk_data> out;
+    profile_scope profile(this, out);
+    out = _in_cube->read_chunk(id);
+    return out;
 }
 
 }  // namespace gdalcubes
\ No newline at end of file
@@ -28,21 +28,23 @@ namespace gdalcubes {
 
 std::shared_ptr<chunk_data> select_bands_cube::read_chunk(chunkid_t id) {
     GCBS_TRACE("select_bands::read_chunk(" + std::to_string(id) + ")");
+    std::shared_ptr<chunk_data> out = std::make_shared<chunk_data>();
+    profile_scope profile(this, out);
     if (id >= count_chunks())
-        return  std::make_shared<chunk_data>();  // chunk is outside of the view, we don't need to read anything.
+        return out;  // chunk is outside of the view, we don't need to read anything.
 
     // if input cube is image_collection_cube, delegate (since in->select_bands has been called in the cosntructor)
     if (_defer_to_input_cube) {
-        return _in_cube->read_chunk(id);
+        out = _in_cube->read_chunk(id);
+        return out;
     }
 
     std::shared_ptr<chunk_data> in = _in_cube->read_chunk(id);
     if (in->empty()) {
-        return std::make_shared<chunk_data>();
+        return out;
     }
 
     // Fill buffers accordingly
-    std::shared_ptr<chunk_data> out = std::make_shared<chunk_data>();
     out->size({_bands.count(), in->size()[1], in->size()[2], in->size()[3]});
     out->buf(std::calloc(_bands.count() * in->size()[1] * in->size()[2] * in->size()[3], sizeof(double)));
 
@@ -6,6 +6,7 @@ namespace gdalcubes {
 std::shared_ptr<chunk_data> select_time_cube::read_chunk(chunkid_t id) {
     GCBS_TRACE("select_time_cube::read_chunk(" + std::to_string(id) + ")");
     std::shared_ptr<chunk_data> out = std::make_shared<chunk_data>();
+    profile_scope profile(this, out);
     if (id >= count_chunks())
         return out;  // chunk is outside of the view, we don't need to read anything.
 
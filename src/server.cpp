@@ -29,19 +29,26 @@
 
 #include <boost/program_options.hpp>
 #include <condition_variable>
+#include <cstdio>
+#include <fstream>
+#include <limits>
 
 #include "build_info.h"
+#include "chunk_journal.h"
+#include "chunk_wire.h"
 #include "cube_factory.h"
 #include "image_collection.h"
 #include "utils.h"
 /**
 GET  /version
+GET  /cache (chunk cache statistics as json)
+GET  /queue (chunk read queue statistics as json)
 POST /file (name query, body file)
-POST /cube (json process descr), return cube_id
+POST /cube (json process descr), return cube_id (identical cubes share the same cube_id)
 GET /cube/{cube_id}
-POST /cube/{cube_id}/{chunk_id}/start
+POST /cube/{cube_id}/{chunk_id}/start (optional query priority="interactive", "batch", or integer)
 GET /cube/{cube_id}/{chunk_id}/status status= "notrequested", "submitted" "queued" "running" "canceled" "finished" "error"
-GET /cube/{cube_id}/{chunk_id}/download
+GET /cube/{cube_id}/{chunk_id}/download (optional query compression, see chunk_wire), chunks that are not cached are read on demand
 
 
  TODO:
@@ -55,12 +62,22 @@ namespace gdalcubes {
 server_chunk_cache* server_chunk_cache::_instance = nullptr;
 std::mutex server_chunk_cache::_singleton_mutex;
 
+// split the query before decoding, such that encoded '&' and '=' in values (e.g. file names) are preserved
+static std::map<std::string, std::string> split_query_decoded(std::string query) {
+    std::map<std::string, std::string> out = web::uri::split_query(query);
+    for (auto it = out.begin(); it != out.end(); ++it) {
+        it->second = web::uri::decode(it->second);
+    }
+    return out;
+}
+
 void gdalcubes_server::handle_get(web::http::http_request req) {
     if (!_whitelist.empty()) {
         std::string remote = req.remote_address();
         if (_whitelist.find(remote) == _whitelist.end()) {
             GCBS_DEBUG("Incoming request from " + req.remote_address() + " has been blocked according to whitelist rule");
             req.reply(web::http::status_codes::NotFound);
+            return;
         }
         GCBS_DEBUG("Incoming request from " + req.remote_address() + " has been accepted according to whitelist rule");
     } else {
@@ -68,7 +85,7 @@ void gdalcubes_server::handle_get(web::http::http_request req) {
     }
 
     std::vector<std::string> path = web::uri::split_path(web::uri::decode(req.relative_uri().path()));
-    std::map<std::string, std::string> query_pars = web::uri::split_query(web::uri::decode(req.relative_uri().query()));
+    std::map<std::string, std::string> query_pars = split_query_decoded(req.relative_uri().query());
     //    std::for_each(path.begin(), path.end(), [](std::string s) { std::cout << s << std::endl; });
     //    std::for_each(query_pars.begin(), query_pars.end(), [](std::pair<std::string, std::string> s) { std::cout << s.first << ":" << s.second << std::endl; });
     if (!path.empty()) {
@@ -78,15 +95,29 @@ void gdalcubes_server::handle_get(web::http::http_request req) {
             std::stringstream ss;
             ss << "gdalcubes_server " << v.VERSION_MAJOR << "." << v.VERSION_MINOR << "." << v.VERSION_PATCH << " (" << v.GIT_COMMIT << ") built on " << v.BUILD_DATE << " " << v.BUILD_TIME;
             req.reply(web::http::status_codes::OK, ss.str().c_str(), "text/plain");
+        } else if (path[0] == "queue") {
+            GCBS_DEBUG("GET /queue");
+            json11::Json stats = json11::Json::object{{"depth", (double)_requests.depth()},
+                                                      {"depth_interactive", (double)_requests.depth(chunk_request_queue::PRIORITY_INTERACTIVE)},
+                                                      {"depth_batch", (double)_requests.depth(chunk_request_queue::PRIORITY_BATCH)},
+                                                      {"max_depth", (double)_requests.max_depth()},
+                                                      {"running", (double)_requests.running()},
+                                                      {"processed", (double)_requests.processed()},
+                                                      {"workers", (double)_workers.size()}};
+            req.reply(web::http::status_codes::OK, stats.dump().c_str(), "application/json");
+        } else if (path[0] == "cache") {
+            GCBS_DEBUG("GET /cache");
+            req.reply(web::http::status_codes::OK, server_chunk_cache::instance()->stats().dump().c_str(), "application/json");
         } else if (path[0] == "cube") {
             if (path.size() == 2) {
                 uint32_t cube_id = std::stoi(path[1]);
                 GCBS_DEBUG("GET /cube" + std::to_string(cube_id));
 
-                if (_cubestore.find(cube_id) == _cubestore.end()) {
+                std::shared_ptr<cube> c = find_cube(cube_id);
+                if (!c) {
                     req.reply(web::http::status_codes::NotFound, "ERROR in /GET /cube/{cube_id}: cube with given id is not available.", "text/plain");
                 } else {
-                    req.reply(web::http::status_codes::OK, _cubestore[cube_id]->make_constructible_json().dump().c_str(),
+                    req.reply(web::http::status_codes::OK, c->make_constructible_json().dump().c_str(),
                               "application/json");
                 }
             } else if (path.size() == 4) {
@@ -94,52 +125,61 @@ void gdalcubes_server::handle_get(web::http::http_request req) {
                 uint32_t chunk_id = std::stoi(path[2]);
 
                 std::string cmd = path[3];
+                std::shared_ptr<cube> c = find_cube(cube_id);
                 if (cmd == "download") {
                     GCBS_DEBUG("GET /cube/" + std::to_string(cube_id) + "/" + std::to_string(chunk_id) + "/download");
-                    if (_cubestore.find(cube_id) == _cubestore.end()) {
+                    if (!c) {
                         req.reply(web::http::status_codes::NotFound, "ERROR in /GET /cube/{cube_id}/{chunk_id}/download: cube is not available", "text/plain");
-                    } else if (chunk_id >= _cubestore[cube_id]->count_chunks()) {
+                    } else if (chunk_id >= c->count_chunks()) {
                         req.reply(web::http::status_codes::NotFound, "ERROR in /GET /cube/{cube_id}/{chunk_id}/download: invalid chunk_id given", "text/plain");
-                    }
-                    // if not in queue, executing, or finished, return 404
-                    else if (!server_chunk_cache::instance()->has(std::make_pair(cube_id, chunk_id)) &&
-                             _chunk_read_requests_set.find(std::make_pair(cube_id, chunk_id)) == _chunk_read_requests_set.end() &&
-                             _chunk_read_executing.find(std::make_pair(cube_id, chunk_id)) == _chunk_read_executing.end()) {
-                        req.reply(web::http::status_codes::NotFound, "ERROR in /GET /cube/{cube_id}/{chunk_id}/download: chunk read has not been requested yet", "text/plain");
                     } else {
-                        while (!server_chunk_cache::instance()->has(std::make_pair(cube_id, chunk_id))) {
-                            // req.reply(web::http::status_codes::NotFound, "ERROR in /GET /cube/{cube_id}/{chunk_id}/download: chunk is not available.", "text/plain");
-                            std::unique_lock<std::mutex> lck(_chunk_cond[std::make_pair(cube_id, chunk_id)].second);
-                            _chunk_cond[std::make_pair(cube_id, chunk_id)].first.wait(lck);
+                        // wait for queued or running reads, returns immediately otherwise
+                        _requests.wait(std::make_pair(cube_id, chunk_id));
+                        std::shared_ptr<chunk_data> dat = server_chunk_cache::instance()->find(std::make_pair(cube_id, chunk_id));
+                        if (!dat) {
+                            // chunk has not been requested, has been evicted, is larger than the cache, or its read failed
+                            GCBS_DEBUG("Chunk " + std::to_string(chunk_id) + " of cube " + std::to_string(cube_id) + " is not cached, reading it on download");
+                            try {
+                                dat = compute_chunk(std::make_pair(cube_id, chunk_id));
+                            } catch (std::string s) {
+                                req.reply(web::http::status_codes::InternalError, "ERROR in /GET /cube/{cube_id}/{chunk_id}/download: " + s, "text/plain");
+                                return;
+                            }
                         }
-                        std::shared_ptr<chunk_data> dat = server_chunk_cache::instance()->get(std::make_pair(cube_id, chunk_id));
 
-                        uint8_t* rawdata = (uint8_t*)std::malloc(4 * sizeof(uint32_t) + dat->total_size_bytes());
-                        memcpy((void*)rawdata, (void*)(dat->size().data()), 4 * sizeof(uint32_t));
-                        if (!dat->empty()) {
-                            memcpy(rawdata + 4 * sizeof(uint32_t), dat->buf(), dat->total_size_bytes());
+                        // clients that request a compression get the chunk_wire format, others the legacy raw format
+                        std::shared_ptr<std::vector<char>> body;
+                        if (query_pars.find("compression") != query_pars.end()) {
+                            uint8_t comp = chunk_wire::SHUFFLE_RLE;
+                            try {
+                                comp = std::stoi(query_pars["compression"]);
+                            } catch (...) {
+                            }
+                            body = std::make_shared<std::vector<char>>(chunk_wire::encode(dat, comp));
+                        } else {
+                            body = std::make_shared<std::vector<char>>(4 * sizeof(uint32_t) + dat->total_size_bytes());
+                            memcpy((void*)body->data(), (void*)(dat->size().data()), 4 * sizeof(uint32_t));
+                            if (!dat->empty()) {
+                                memcpy(body->data() + 4 * sizeof(uint32_t), dat->buf(), dat->total_size_bytes());
+                            }
                         }
 
-                        concurrency::streams::basic_istream<uint8_t> is = concurrency::streams::rawptr_stream<uint8_t>::open_istream(rawdata, 4 * sizeof(uint32_t) + dat->total_size_bytes());
-                        req.reply(web::http::status_codes::OK, is, 4 * sizeof(uint32_t) + dat->total_size_bytes(), "application/octet-stream").then([&is, &rawdata]() {
-                            is.close();
-                            std::free(rawdata); });
+                        concurrency::streams::basic_istream<uint8_t> is = concurrency::streams::rawptr_stream<uint8_t>::open_istream((const uint8_t*)body->data(), body->size());
+                        req.reply(web::http::status_codes::OK, is, body->size(), "application/octet-stream").then([is, body]() mutable {
+                            is.close(); });
                     }
 
                 } else if (cmd == "status") {
                     GCBS_DEBUG("GET /cube/" + std::to_string(cube_id) + "/" + std::to_string(chunk_id) + "/status");
-                    if (_cubestore.find(cube_id) == _cubestore.end()) {
+                    if (!c) {
                         req.reply(web::http::status_codes::NotFound, "ERROR in /GET /cube/{cube_id}/{chunk_id}/status: cube is not available", "text/plain");
-                    } else if (chunk_id >= _cubestore[cube_id]->count_chunks()) {
+                    } else if (chunk_id >= c->count_chunks()) {
                         req.reply(web::http::status_codes::NotFound, "ERROR in /GET /cube/{cube_id}/{chunk_id}/status: invalid chunk_id given", "text/plain");
-                    }
-
-                    if (server_chunk_cache::instance()->has(std::make_pair(cube_id, chunk_id))) {
+                    } else if (server_chunk_cache::instance()->has(std::make_pair(cube_id, chunk_id))) {
                         req.reply(web::http::status_codes::OK, "finished", "text/plain");
-                    } else if (_chunk_read_executing.find(std::make_pair(cube_id, chunk_id)) !=
-                               _chunk_read_executing.end()) {
+                    } else if (_requests.is_running(std::make_pair(cube_id, chunk_id))) {
                         req.reply(web::http::status_codes::OK, "running", "text/plain");
-                    } else if (_chunk_read_requests_set.find(std::make_pair(cube_id, chunk_id)) != _chunk_read_requests_set.end()) {
+                    } else if (_requests.is_queued(std::make_pair(cube_id, chunk_id))) {
                         req.reply(web::http::status_codes::OK, "queued", "text/plain");
                     } else {
                         req.reply(web::http::status_codes::OK, "notrequested", "text/plain");
@@ -167,6 +207,7 @@ void gdalcubes_server::handle_post(web::http::http_request req) {
         if (_whitelist.find(remote) == _whitelist.end()) {
             GCBS_DEBUG("Incoming request from " + req.remote_address() + " has been blocked according to whitelist rule");
             req.reply(web::http::status_codes::NotFound);
+            return;
         }
         GCBS_DEBUG("Incoming request from " + req.remote_address() + " has been accepted according to whitelist rule");
     } else {
@@ -174,7 +215,7 @@ void gdalcubes_server::handle_post(web::http::http_request req) {
     }
 
     std::vector<std::string> path = web::uri::split_path(web::uri::decode(req.relative_uri().path()));
-    std::map<std::string, std::string> query_pars = web::uri::split_query(web::uri::decode(req.relative_uri().query()));
+    std::map<std::string, std::string> query_pars = split_query_decoded(req.relative_uri().query());
     //    std::for_each(path.begin(), path.end(), [](std::string s) { std::cout << s << std::endl; });
     //    std::for_each(query_pars.begin(), query_pars.end(), [](std::pair<std::string, std::string> s) { std::cout << s.first << ":" << s.second << std::endl; });
 
@@ -222,10 +263,19 @@ void gdalcubes_server::handle_post(web::http::http_request req) {
                 std::string err;
                 req.extract_string(true).then([&id, this, &err](std::string s) {
                                             std::shared_ptr<cube> c = cube_factory::instance()->create_from_json(json11::Json::parse(s, err));
+                                            // identical cubes on unchanged inputs share the same id
+                                            std::string plan = plan_hash(c);
+                                            std::lock_guard<std::mutex> lock(_mutex_cubestore);
+                                            auto it = _plans.find(plan);
+                                            if (it != _plans.end()) {
+                                                id = it->second;
+                                                GCBS_DEBUG("Cube with plan hash " + plan + " already exists as cube " + std::to_string(id));
+                                                return;
+                                            }
                                             id = get_unique_id();
-                                            _mutex_cubestore.lock();
                                             _cubestore.insert(std::make_pair(id, c));
-                                            _mutex_cubestore.unlock();
+                                            _plans.insert(std::make_pair(plan, id));
+                                            _plan_hashes.insert(std::make_pair(id, plan));
                                         })
                     .wait();
                 req.reply(web::http::status_codes::OK, std::to_string(id), "text/plain");
@@ -234,82 +284,46 @@ void gdalcubes_server::handle_post(web::http::http_request req) {
                 uint32_t chunk_id = std::stoi(path[2]);
 
                 std::string cmd = path[3];
+                std::shared_ptr<cube> c = find_cube(cube_id);
                 if (cmd == "start") {
                     GCBS_DEBUG("POST /cube/" + std::to_string(cube_id) + "/" + std::to_string(chunk_id) + "/start");
 
-                    if (_cubestore.find(cube_id) == _cubestore.end()) {
+                    if (!c) {
                         req.reply(web::http::status_codes::NotFound, "ERROR in /POST /cube/{cube_id}/{chunk_id}/start: cube is not available", "text/plain");
-                    } else if (chunk_id >= _cubestore[cube_id]->count_chunks()) {
+                    } else if (chunk_id >= c->count_chunks()) {
                         req.reply(web::http::status_codes::NotFound, "ERROR in /POST /cube/{cube_id}/{chunk_id}/start: invalid chunk_id given", "text/plain");
                     }
 
-                    // if already in queue, executing, or finished, do not compute again
-                    else if (server_chunk_cache::instance()->has(std::make_pair(cube_id, chunk_id)) ||
-                             _chunk_read_requests_set.find(std::make_pair(cube_id, chunk_id)) != _chunk_read_requests_set.end() ||
-                             _chunk_read_executing.find(std::make_pair(cube_id, chunk_id)) != _chunk_read_executing.end()) {
+                    // if already finished, do not compute again, queued or running requests are ignored by the queue
+                    else if (server_chunk_cache::instance()->has(std::make_pair(cube_id, chunk_id))) {
                         req.reply(web::http::status_codes::OK);
                     } else {
-                        _mutex_worker_threads.lock();
-                        if (_worker_threads.size() < config::instance()->get_server_worker_threads_max()) {
-                            // immediately start a thread
-
-                            _worker_threads.push_back(std::thread([this, cube_id, chunk_id]() {
-                                _mutex_chunk_read_requests.lock();
-                                _chunk_read_requests.push_back(std::make_pair(cube_id, chunk_id));
-                                _chunk_read_requests_set.insert(std::make_pair(cube_id, chunk_id));
-                                _mutex_chunk_read_requests.unlock();
-                                while (1) {
-                                    _mutex_chunk_read_requests.lock();
-                                    while (!_chunk_read_requests.empty()) {
-                                        _mutex_chunk_read_executing.lock();
-                                        uint32_t xcube_id = _chunk_read_requests.front().first;
-                                        uint32_t xchunk_id = _chunk_read_requests.front().second;
-                                        _chunk_read_executing.insert(_chunk_read_requests.front());
-                                        _chunk_read_requests_set.erase(_chunk_read_requests.front());
-                                        _chunk_read_requests.pop_front();
-                                        _mutex_chunk_read_requests.unlock();
-                                        _mutex_chunk_read_executing.unlock();
-
-                                        _mutex_cubestore.lock();
-                                        std::shared_ptr<cube> c = _cubestore[xcube_id];
-                                        _mutex_cubestore.unlock();
-
-                                        std::shared_ptr<chunk_data> dat = c->read_chunk(xchunk_id);
-
-                                        server_chunk_cache::instance()->add(std::make_pair(xcube_id, xchunk_id), dat);
-
-                                        _mutex_chunk_read_executing.lock();
-                                        _chunk_read_executing.erase(std::make_pair(xcube_id, xchunk_id));
-                                        _mutex_chunk_read_executing.unlock();
-
-                                        // notify waiting download requests
-                                        if (_chunk_cond.find(std::make_pair(xcube_id, xchunk_id)) != _chunk_cond.end()) {
-                                            _chunk_cond[std::make_pair(xcube_id, xchunk_id)].first.notify_all();
-                                        }
-
-                                        _mutex_chunk_read_requests.lock();
-                                    }
-                                    _mutex_chunk_read_requests.unlock();
-
-                                    std::unique_lock<std::mutex> lock(_mutex_worker_cond);
-                                    _worker_cond.wait(lock);
+                        // client hint, e.g. interactive previews should be served before batch jobs
+                        int16_t priority = chunk_request_queue::PRIORITY_BATCH;
+                        if (query_pars.find("priority") != query_pars.end()) {
+                            if (query_pars["priority"] == "interactive") {
+                                priority = chunk_request_queue::PRIORITY_INTERACTIVE;
+                            } else if (query_pars["priority"] != "batch") {
+                                // reject trailing garbage and values outside of the queue's int16_t priority range
+                                long p = 0;
+                                std::size_t n = 0;
+                                try {
+                                    p = std::stol(query_pars["priority"], &n);
+                                } catch (...) {
+                                    n = 0;
                                 }
-                            }));
-
-                            _mutex_worker_threads.unlock();
-                            req.reply(web::http::status_codes::OK);
-                        }
-
-                        else {
-                            _mutex_worker_threads.unlock();
-                            std::lock_guard<std::mutex> lock(_mutex_worker_cond);
-                            // add to queue
-                            _mutex_chunk_read_requests.lock();
-                            _chunk_read_requests.push_back(std::make_pair(cube_id, chunk_id));
-                            _mutex_chunk_read_requests.unlock();
-                            _worker_cond.notify_all();
-                            req.reply(web::http::status_codes::OK);
+                                if (n == 0 || n != query_pars["priority"].size() ||
+                                    p < std::numeric_limits<int16_t>::min() || p > std::numeric_limits<int16_t>::max()) {
+                                    req.reply(web::http::status_codes::BadRequest, "ERROR in /POST /cube/{cube_id}/{chunk_id}/start: invalid priority given, expected \"interactive\", \"batch\", or an integer in [" +
+                                                                                       std::to_string(std::numeric_limits<int16_t>::min()) + ", " + std::to_string(std::numeric_limits<int16_t>::max()) + "]",
+                                              "text/plain");
+                                    return;
+                                }
+                                priority = (int16_t)p;
+                            }
                         }
+                        _requests.push(std::make_pair(cube_id, chunk_id), priority);
+                        req.reply(web::http::status_codes::OK);
                     }
                 } else {
                     req.reply(web::http::status_codes::NotFound);
@@ -326,12 +340,252 @@ void gdalcubes_server::handle_post(web::http::http_request req) {
     }
 }
 
+pplx::task<void> gdalcubes_server::open() {
+    if (config::instance()->get_server_result_cache()) {
+        result_cache_load();
+    }
+    start_workers();
+    return _listener.open();
+}
+
+void gdalcubes_server::start_workers() {
+    if (!_workers.empty()) {
+        return;
+    }
+    uint16_t nthreads = std::max(uint16_t(1), config::instance()->get_server_worker_threads_max());
+    for (uint16_t i = 0; i < nthreads; ++i) {
+        _workers.push_back(std::thread(&gdalcubes_server::worker_loop, this));
+    }
+}
+
+void gdalcubes_server::stop_workers() {
+    _requests.close();
+    for (uint16_t i = 0; i < _workers.size(); ++i) {
+        if (_workers[i].joinable()) {
+            _workers[i].join();
+        }
+    }
+    _workers.clear();
+}
+
+void gdalcubes_server::worker_loop() {
+    std::pair<uint32_t, uint32_t> key;
+    while (_requests.pop(key)) {
+        try {
+            std::shared_ptr<chunk_data> dat = compute_chunk(key);
+            if (!server_chunk_cache::instance()->add(key, dat)) {
+                GCBS_WARN("Chunk " + std::to_string(key.second) + " of cube " + std::to_string(key.first) + " is larger than the server chunk cache and will be read again on download or from the result cache");
+            }
+        } catch (std::string s) {
+            GCBS_ERROR("Failed to read chunk " + std::to_string(key.second) + " of cube " + std::to_string(key.first) + ": " + s);
+        } catch (...) {
+            GCBS_ERROR("Failed to read chunk " + std::to_string(key.second) + " of cube " + std::to_string(key.first));
+        }
+        _requests.done(key);  // notify waiting download requests
+    }
+}
+
+/**
+ * Append size and modification time of a local file to the identity string, other descriptors (e.g. URLs or
+ * GDAL virtual file systems) are ignored to avoid network requests
+ */
+static void append_file_identity(const std::string& p, std::string& out) {
+    if (p.empty() || p.find("://") != std::string::npos || p.compare(0, 4, "/vsi") == 0) return;
+    if (!filesystem::is_regular_file(p)) return;
+    VSIStatBufL s;
+    if (VSIStatL(p.c_str(), &s) != 0) return;
+    out += p + ":" + std::to_string(s.st_size) + ":" + std::to_string(s.st_mtime) + "\n";
+}
+
+/**
+ * Identity of all datasets of an image collection. Reading the collection and stat'ing its datasets is expensive for
+ * large collections, hence results are cached as long as size and modification time of the collection file do not
+ * change, i.e. datasets that are modified in place without updating the collection are not detected.
+ */
+static std::string image_collection_identity(const std::string& file) {
+    static std::mutex mtx;
+    static std::map<std::string, std::pair<std::string, std::string>> cache;  // file -> (own identity, identity of datasets)
+
+    std::string key;
+    append_file_identity(file, key);
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        auto it = cache.find(file);
+        if (it != cache.end() && !key.empty() && it->second.first == key) {
+            return it->second.second;
+        }
+    }
+
+    std::string out;
+    image_collection ic(file, true);
+    std::set<std::string> descriptors;
+    for (auto& r : ic.get_gdalrefs()) {
+        descriptors.insert(r.descriptor);
+    }
+    for (auto& d : descriptors) {
+        append_file_identity(d, out);
+    }
+
+    std::lock_guard<std::mutex> lock(mtx);
+    if (cache.size() >= 1000) cache.clear();
+    cache[file] = std::make_pair(key, out);
+    return out;
+}
+
+/**
+ * Collect the identity of all local files a cube depends on: files referenced by any string value in the cube's JSON
+ * (e.g. image collections, netCDF files, chunk stores, or OGR datasets uploaded via POST /file) and all datasets of
+ * referenced image collections
+ */
+static void append_input_identity(const json11::Json& j, std::string& out) {
+    if (j.is_string()) {
+        append_file_identity(j.string_value(), out);
+    } else if (j.is_array()) {
+        for (auto& x : j.array_items()) append_input_identity(x, out);
+    } else if (j.is_object()) {
+        for (auto& x : j.object_items()) append_input_identity(x.second, out);
+        if (j["cube_type"].string_value() == "image_collection" && filesystem::is_regular_file(j["file"].string_value())) {
+            out += image_collection_identity(j["file"].string_value());
+        }
+    }
+}
+
+std::string gdalcubes_server::plan_hash(std::shared_ptr<cube> c) {
+    // json11 objects are serialized with sorted keys
+    json11::Json j = c->make_constructible_json();
+    std::string plan = j.dump() + "\n";
+    append_input_identity(j, plan);
+    return chunk_journal::make_key(plan);
+}
+
+void gdalcubes_server::result_cache_load() {
+    std::string dir = filesystem::join(_workdir, "results");
+    if (!filesystem::is_directory(dir)) return;
+
+    std::vector<std::pair<int64_t, std::pair<std::string, uint64_t>>> files;  // (mtime, (path, size))
+    filesystem::iterate_directory_recursive(dir, [&files](const std::string& p) {
+        if (filesystem::extension(p) == "tmp") {
+            filesystem::remove(p);  // left over from an interrupted write
+            return;
+        }
+        if (filesystem::extension(p) != "gcwc") return;
+        VSIStatBufL s;
+        if (VSIStatL(p.c_str(), &s) == 0) {
+            files.push_back(std::make_pair(int64_t(s.st_mtime), std::make_pair(p, uint64_t(s.st_size))));
+        }
+    });
+    std::sort(files.begin(), files.end());
+    for (auto& f : files) {
+        result_cache_add(f.second.first, f.second.second);
+    }
+    GCBS_DEBUG("Found " + std::to_string(_result_files.size()) + " chunks (" + std::to_string(_result_bytes) + " bytes) in the result cache");
+}
+
+void gdalcubes_server::result_cache_add(std::string fname, uint64_t size) {
+    std::vector<std::string> evicted;
+    {
+        std::lock_guard<std::mutex> lock(_mutex_results);
+        auto it = _result_files.find(fname);
+        if (it != _result_files.end()) {
+            _result_bytes -= it->second.second;
+            _result_lru.erase(it->second.first);
+            _result_files.erase(it);
+        }
+        _result_lru.push_front(fname);
+        _result_files[fname] = std::make_pair(_result_lru.begin(), size);
+        _result_bytes += size;
+
+        uint64_t max_bytes = config::instance()->get_server_result_cache_max();
+        while (_result_bytes > max_bytes && !_result_lru.empty()) {
+            std::string f = _result_lru.back();
+            _result_lru.pop_back();
+            _result_bytes -= _result_files[f].second;
+            _result_files.erase(f);
+            evicted.push_back(f);
+        }
+    }
+    for (auto& f : evicted) {
+        filesystem::remove(f);
+        filesystem::remove(filesystem::parent(f));  // removes the plan directory only if it is empty
+    }
+    if (!evicted.empty()) {
+        GCBS_DEBUG("Removed " + std::to_string(evicted.size()) + " least recently used chunks from the result cache");
+    }
+}
+
+void gdalcubes_server::result_cache_touch(std::string fname) {
+    std::lock_guard<std::mutex> lock(_mutex_results);
+    auto it = _result_files.find(fname);
+    if (it != _result_files.end()) {
+        _result_lru.splice(_result_lru.begin(), _result_lru, it->second.first);
+    }
+}
+
+std::shared_ptr<cube> gdalcubes_server::find_cube(uint32_t cube_id) {
+    std::lock_guard<std::mutex> lock(_mutex_cubestore);
+    auto it = _cubestore.find(cube_id);
+    if (it == _cubestore.end()) return nullptr;
+    return it->second;
+}
+
+std::string gdalcubes_server::result_file(std::pair<uint32_t, uint32_t> key) {
+    std::lock_guard<std::mutex> lock(_mutex_cubestore);
+    return filesystem::join(filesystem::join(filesystem::join(_workdir, "results"), _plan_hashes[key.first]), std::to_string(key.second) + ".gcwc");
+}
+
+std::shared_ptr<chunk_data> gdalcubes_server::compute_chunk(std::pair<uint32_t, uint32_t> key) {
+    std::shared_ptr<cube> c = find_cube(key.first);
+    if (!c) {
+        throw std::string("ERROR in gdalcubes_server::compute_chunk(): cube " + std::to_string(key.first) + " is not available");
+    }
+
+    if (!config::instance()->get_server_result_cache()) {
+        return c->read_chunk(key.second);
+    }
+
+    std::string fname = result_file(key);
+    if (filesystem::exists(fname)) {
+        std::ifstream is(fname, std::ios::in | std::ios::binary);
+        std::vector<char> buf((std::istreambuf_iterator<char>(is)), std::istreambuf_iterator<char>());
+        try {
+            std::shared_ptr<chunk_data> dat = chunk_wire::decode(buf.data(), buf.size());
+            result_cache_touch(fname);
+            GCBS_DEBUG("Chunk " + std::to_string(key.second) + " of cube " + std::to_string(key.first) + " has been loaded from the result cache");
+            return dat;
+        } catch (std::string s) {
+            GCBS_WARN("Ignoring invalid result cache file '" + fname + "': " + s);
+        }
+    }
+
+    std::shared_ptr<chunk_data> dat = c->read_chunk(key.second);
+
+    // write to a temporary file first such that concurrent readers never see partially written files
+    try {
+        std::vector<char> enc = chunk_wire::encode(dat, chunk_wire::SHUFFLE_DEFLATE);
+        filesystem::mkdir_recursive(filesystem::parent(fname));
+        std::string tmp = fname + "." + utils::generate_unique_filename() + ".tmp";
+        std::ofstream os(tmp, std::ios::out | std::ios::binary);
+        os.write(enc.data(), enc.size());
+        os.close();
+        if (!os || std::rename(tmp.c_str(), fname.c_str()) != 0) {
+            if (filesystem::exists(tmp)) filesystem::remove(tmp);
+            GCBS_WARN("Failed to write chunk " + std::to_string(key.second) + " of cube " + std::to_string(key.first) + " to the result cache");
+        } else {
+            result_cache_add(fname, enc.size());
+        }
+    } catch (std::string s) {
+        GCBS_WARN("Failed to write chunk " + std::to_string(key.second) + " of cube " + std::to_string(key.first) + " to the result cache: " + s);
+    }
+    return dat;
+}
+
 void gdalcubes_server::handle_head(web::http::http_request req) {
     if (!_whitelist.empty()) {
         std::string remote = req.remote_address();
         if (_whitelist.find(remote) == _whitelist.end()) {
             GCBS_DEBUG("Incoming request from " + req.remote_address() + " has been blocked according to whitelist rule");
             req.reply(web::http::status_codes::NotFound);
+            return;
         }
         GCBS_DEBUG("Incoming request from " + req.remote_address() + " has been accepted according to whitelist rule");
     } else {
@@ -339,7 +593,7 @@ void gdalcubes_server::handle_head(web::http::http_request req) {
     }
 
     std::vector<std::string> path = web::uri::split_path(web::uri::decode(req.relative_uri().path()));
-    std::map<std::string, std::string> query_pars = web::uri::split_query(web::uri::decode(req.relative_uri().query()));
+    std::map<std::string, std::string> query_pars = split_query_decoded(req.relative_uri().query());
     if (!path.empty() && path[0] == "file") {
         GCBS_DEBUG("HEAD /file");
         std::string fname;
@@ -379,10 +633,12 @@ void print_usage() {
     std::cout << "Options:" << std::endl;
     std::cout << "  -b, --basepath              Base path for all API endpoints, defaults to /gdalcubes/api/" << std::endl;
     std::cout << "  -p, --port                  The port where gdalcubes_server is listening, defaults to 1111" << std::endl;
-    std::cout << "  -t, --worker_threads        Maximum number of threads perfoming chunk reads, defaults to 1" << std::endl;
+    std::cout << "  -t, --worker_threads        Number of threads perfoming chunk reads, defaults to 1" << std::endl;
     std::cout << "  -D, --dir                   Working directory where files are stored, defaults to {TEMPDIR}/gdalcubes" << std::endl;
     std::cout << "      --ssl                   Use HTTPS (currently not implemented)" << std::endl;
     std::cout << "  -w, --whitelist             Optional path to a whitelist text file with a list of acceptable clients" << std::endl;
+    std::cout << "      --persist               Store computed chunks in the working directory and reuse them after restarts" << std::endl;
+    std::cout << "      --persist_max           Maximum size of stored chunks in MiB, defaults to 4096" << std::endl;
     std::cout << "  -d, --debug                 Print debug messages" << std::endl;
     std::cout << std::endl;
 }
@@ -397,7 +653,7 @@ int main(int argc, char* argv[]) {
     // see https://stackoverflow.com/questions/15541498/how-to-implement-subcommands-using-boost-program-options
 
     po::options_description global_args("Options");
-    global_args.add_options()("help,h", "")("version", "")("debug,d", "")("basepath,b", po::value<std::string>()->default_value("/gdalcubes/api"), "")("port,p", po::value<uint16_t>()->default_value(1111), "")("ssl", "")("worker_threads,t", po::value<uint16_t>()->default_value(1), "")("dir,D", po::value<std::string>()->default_value((filesystem::join(filesystem::get_tempdir(), "gdalcubes")), ""))("whitelist,w", po::value<std::string>(), "");
+    global_args.add_options()("help,h", "")("version", "")("debug,d", "")("basepath,b", po::value<std::string>()->default_value("/gdalcubes/api"), "")("port,p", po::value<uint16_t>()->default_value(1111), "")("ssl", "")("worker_threads,t", po::value<uint16_t>()->default_value(1), "")("dir,D", po::value<std::string>()->default_value((filesystem::join(filesystem::get_tempdir(), "gdalcubes")), ""))("whitelist,w", po::value<std::string>(), "")("persist", "")("persist_max", po::value<uint32_t>()->default_value(4096), "");
 
     po::variables_map vm;
 
@@ -426,17 +682,19 @@ int main(int argc, char* argv[]) {
         }
 
         ssl = vm.count("ssl") > 0;
+        config::instance()->set_server_result_cache(vm.count("persist") > 0);
+        config::instance()->set_server_result_cache_max(uint64_t(vm["persist_max"].as<uint32_t>()) * 1024 * 1024);
     } catch (...) {
         std::cout << "ERROR in gdalcubes_server: cannot parse arguments." << std::endl;
         return 1;
     }
 
+    config::instance()->set_server_worker_threads_max(vm["worker_threads"].as<uint16_t>());
+
     std::unique_ptr<gdalcubes_server> srv = std::unique_ptr<gdalcubes_server>(
         new gdalcubes_server("0.0.0.0", vm["port"].as<uint16_t>(), vm["basepath"].as<std::string>(), ssl,
                              vm["dir"].as<std::string>(), whitelist));
 
-    config::instance()->set_server_worker_threads_max(vm["worker_threads"].as<uint16_t>());
-
     srv->open().wait();
     std::cout << "gdalcubes_server waiting for incoming HTTP requests on " << srv->get_service_url() << "." << std::endl;
     std::cout << "Press ENTER to exit" << std::endl;
@@ -32,7 +32,10 @@
 #include <mutex>
 #include <queue>
 #include <thread>
+#include <unordered_map>
 
+#include "chunk_request_queue.h"
+#include "concurrent_lru_cache.h"
 #include "cube.h"
 
 namespace gdalcubes {
@@ -40,7 +43,9 @@ namespace gdalcubes {
 /**
  * @brief An in-memory singleton cache for successfully read / computed chunks
  *
- * Chunks are identified by std::pair<cube_id, chunk_id>
+ * Chunks are identified by std::pair<cube_id, chunk_id>. The cache is bounded by config::get_server_chunkcache_max()
+ * bytes and evicts least recently used chunks. It is sharded, i.e. concurrent requests for different chunks
+ * rarely contend on the same lock, see concurrent_lru_cache.
  */
 class server_chunk_cache {
    public:
@@ -63,52 +68,18 @@ class server_chunk_cache {
      * @param key
      */
     void remove(std::pair<uint32_t, uint32_t> key) {
-        _m.lock();
-        auto it = _cache.find(key);
-        if (it != _cache.end()) {
-            _size_bytes -= it->second->total_size_bytes();
-            _cache.erase(it);
-        }
-
-        auto it_2 = _prio_forward.find(key);
-        uint32_t p = it_2->second;
-        if (it_2 != _prio_forward.end()) {
-            _prio_forward.erase(it_2);
-        }
-
-        auto it_3 = _prio_backward.find(p);
-        if (it_3 != _prio_backward.end()) {
-            _prio_backward.erase(it_3);
-        }
-        _m.unlock();
+        _cache.remove(key);
     }
 
     /**
-     * Add chunk data to the cache
+     * Add chunk data to the cache, least recently used chunks are evicted if needed
      * @param key chunk identifier (cube_id, chunk_id)
      * @param value chunk data to add
+     * @return false, if the chunk is larger than the cache and has not been added
      */
-    void add(std::pair<uint32_t, uint32_t> key, std::shared_ptr<chunk_data> value) {
-        if (!has(key)) {
-            _m.lock();
-            while (_size_bytes + value->total_size_bytes() > config::instance()->get_server_chunkcache_max()) {
-                auto it = _prio_backward.lower_bound(0);  // lowest value greater than or equal to 0
-
-                // remove it from the data
-                remove(it->second);
-            }
-
-            _cache[key] = value;
-            _size_bytes += value->total_size_bytes();
-
-            uint64_t p = inc_prio();  // synchronize?
-
-            _prio_forward[key] = p;
-            _prio_backward[p] = key;
-
-            _size_bytes += value->total_size_bytes();
-            _m.unlock();
-        }
+    bool add(std::pair<uint32_t, uint32_t> key, std::shared_ptr<chunk_data> value) {
+        _cache.capacity(config::instance()->get_server_chunkcache_max());
+        return _cache.put(key, value);
     }
 
     /**
@@ -117,7 +88,18 @@ class server_chunk_cache {
      * @return true, if the chunk is cached
      */
     inline bool has(std::pair<uint32_t, uint32_t> key) {
-        return _cache.find(key) != _cache.end();
+        return _cache.contains(key);
+    }
+
+    /**
+     * Find chunk data in the cache
+     * @param key chunk key (cube_id, chunk_id)
+     * @return chunk data as shared_ptr, or nullptr if the chunk is not cached
+     */
+    std::shared_ptr<chunk_data> find(std::pair<uint32_t, uint32_t> key) {
+        std::shared_ptr<chunk_data> out;
+        _cache.get(key, out);
+        return out;
     }
 
     /**
@@ -126,61 +108,47 @@ class server_chunk_cache {
      * @return chunk data as shared_ptr
      */
     std::shared_ptr<chunk_data> get(std::pair<uint32_t, uint32_t> key) {
-        if (!has(key)) {
+        std::shared_ptr<chunk_data> out = find(key);
+        if (!out) {
             throw std::string("ERROR: in server_chunk_cache::get(): requested chunk is not available");
         }
-        _m.lock();
-        uint64_t pnew = inc_prio();
-        auto it_1 = _prio_forward.find(key);
-        if (it_1 != _prio_forward.end()) {
-            uint32_t pold = it_1->second;
-            it_1->second = pnew;
-
-            auto it_2 = _prio_backward.find(pold);
-            if (it_2 != _prio_backward.end()) {
-                _prio_backward.erase(it_2);  // remove old
-                _prio_backward[pnew] = key;  // add new
-            }
-        }
-        _m.unlock();
-        return _cache[key];
+        return out;
     }
 
     /**
      * @brief Get the total amount of memory currently consumed by the cache
      * @return Size of the cache in bytes
      */
-    inline uint32_t total_size_bytes() {
-        return _size_bytes;
+    inline uint64_t total_size_bytes() {
+        return _cache.size();
     }
 
-   private:
-    const uint64_t inc_prio() {
-        if (_cur_priority == std::numeric_limits<uint64_t>::max()) {
-            uint64_t newp = 0;
-            for (auto it = _prio_forward.begin(); it != _prio_forward.end(); ++it) {
-                it->second = newp++;
-                _prio_backward.insert(std::make_pair(it->second, it->first));
-            }
-            _cur_priority = newp;
-        } else {
-            ++_cur_priority;
-        }
-        return _cur_priority;
+    /**
+     * @brief Get cache statistics as JSON object with size, capacity, count, hits, misses, and evictions
+     */
+    json11::Json stats() {
+        return json11::Json::object{{"size_bytes", (double)_cache.size()},
+                                    {"capacity_bytes", (double)_cache.capacity()},
+                                    {"count", (double)_cache.count()},
+                                    {"hits", (double)_cache.hits()},
+                                    {"misses", (double)_cache.misses()},
+                                    {"evictions", (double)_cache.evictions()}};
     }
 
-    std::map<std::pair<uint32_t, uint32_t>, std::shared_ptr<chunk_data>> _cache;
-    std::map<uint64_t, std::pair<uint32_t, uint32_t>> _prio_backward;
-    std::map<std::pair<uint32_t, uint32_t>, uint64_t> _prio_forward;
+   private:
+    struct chunk_weight {
+        uint64_t operator()(const std::shared_ptr<chunk_data>& c) const { return c->total_size_bytes(); }
+    };
+    struct key_hash {
+        std::size_t operator()(const std::pair<uint32_t, uint32_t>& k) const { return std::hash<uint64_t>()((uint64_t(k.first) << 32) | k.second); }
+    };
 
-    std::mutex _m;
-    uint64_t _size_bytes;
+    concurrent_lru_cache<std::pair<uint32_t, uint32_t>, std::shared_ptr<chunk_data>, chunk_weight, key_hash> _cache;
 
     static std::mutex _singleton_mutex;
-    uint64_t _cur_priority;
 
    private:
-    server_chunk_cache() : _cache(), _prio_backward(), _prio_forward(), _m(), _size_bytes(0), _cur_priority(0) {}
+    server_chunk_cache() : _cache(config::instance()->get_server_chunkcache_max()) {}
     ~server_chunk_cache() {}
     server_chunk_cache(const server_chunk_cache&) = delete;
     static server_chunk_cache* _instance;
@@ -199,7 +167,13 @@ class server_chunk_cache {
 /**
  * @brief Serve gdalcubes functionality as a REST-like API over HTTP on a provided host, port, and endpoint
  *
- * This class enables distributed processing by providing gdalcubes functionality of a simple HTTP REST-like API
+ * This class enables distributed processing by providing gdalcubes functionality of a simple HTTP REST-like API.
+ *
+ * Cubes are identified by a hash of their canonical JSON representation and of the size and modification time of
+ * local input files (plan hash). Clients posting identical cubes on unchanged inputs get the same cube_id and hence
+ * share computed chunks in the server_chunk_cache. If config::get_server_result_cache() is set, computed chunks are
+ * additionally persisted in the working directory and reused across server restarts, up to
+ * config::get_server_result_cache_max() bytes.
  */
 class gdalcubes_server {
    public:
@@ -210,8 +184,14 @@ class gdalcubes_server {
                                                                                                                                                                                                                                                        _ssl(ssl),
                                                                                                                                                                                                                                                        _workdir(workdir),
                                                                                                                                                                                                                                                        _cubestore(),
+                                                                                                                                                                                                                                                       _plans(),
+                                                                                                                                                                                                                                                       _plan_hashes(),
                                                                                                                                                                                                                                                        _cur_id(0),
-                                                                                                                                                                                                                                                       _chunk_cond(),
+                                                                                                                                                                                                                                                       _requests(),
+                                                                                                                                                                                                                                                       _workers(),
+                                                                                                                                                                                                                                                       _result_lru(),
+                                                                                                                                                                                                                                                       _result_files(),
+                                                                                                                                                                                                                                                       _result_bytes(0),
                                                                                                                                                                                                                                                        _whitelist(whitelist) {
         if (filesystem::exists(_workdir) && filesystem::is_directory(_workdir)) {
             // boost::filesystem::remove_all(_workdir); // TODO: uncomment after testing
@@ -233,8 +213,15 @@ class gdalcubes_server {
         _listener.support(web::http::methods::HEAD, std::bind(&gdalcubes_server::handle_head, this, std::placeholders::_1));
     }
 
+    ~gdalcubes_server() {
+        stop_workers();
+    }
+
    public:
-    inline pplx::task<void> open() { return _listener.open(); }
+    /**
+     * @brief Start worker threads and listen for incoming requests
+     */
+    pplx::task<void> open();
     inline pplx::task<void> close() { return _listener.close(); }
 
     inline std::string get_service_url() { return _listener.uri().to_string(); }
@@ -244,6 +231,51 @@ class gdalcubes_server {
     void handle_post(web::http::http_request req);
     void handle_head(web::http::http_request req);
 
+    void start_workers();
+    void stop_workers();
+    void worker_loop();
+
+    /**
+     * @brief Read a chunk from the persistent result cache or compute it
+     * @param key chunk key (cube_id, chunk_id)
+     * @return chunk data
+     */
+    std::shared_ptr<chunk_data> compute_chunk(std::pair<uint32_t, uint32_t> key);
+
+    /**
+     * @brief Look up a cube of the cube store
+     * @param cube_id cube id
+     * @return the cube or a null pointer if no cube with the given id exists
+     */
+    std::shared_ptr<cube> find_cube(uint32_t cube_id);
+
+    /**
+     * @brief Get the file where a chunk is stored in the persistent result cache
+     * @param key chunk key (cube_id, chunk_id)
+     */
+    std::string result_file(std::pair<uint32_t, uint32_t> key);
+
+    /**
+     * @brief Compute the plan hash of a cube from its JSON representation and the identity of its local input files
+     */
+    static std::string plan_hash(std::shared_ptr<cube> c);
+
+    /**
+     * @brief Index existing files of the persistent result cache after a restart, oldest files are evicted first
+     */
+    void result_cache_load();
+
+    /**
+     * @brief Add a file to the persistent result cache index and remove least recently used files exceeding
+     * config::get_server_result_cache_max()
+     */
+    void result_cache_add(std::string fname, uint64_t size);
+
+    /**
+     * @brief Mark a file of the persistent result cache as most recently used
+     */
+    void result_cache_touch(std::string fname);
+
     web::http::experimental::listener::http_listener _listener;
 
     inline uint32_t get_unique_id() {
@@ -260,27 +292,22 @@ class gdalcubes_server {
     const std::string _workdir;
 
     std::map<uint32_t, std::shared_ptr<cube>> _cubestore;
+    std::map<std::string, uint32_t> _plans;        // plan hash -> cube_id
+    std::map<uint32_t, std::string> _plan_hashes;  // cube_id -> plan hash
 
     uint16_t _cur_id;
     std::mutex _mutex_id;
     std::mutex _mutex_cubestore;
 
-    uint16_t _worker_thread_count;
-
-    std::mutex _mutex_chunk_read_requests;
-    std::list<std::pair<uint32_t, uint32_t>> _chunk_read_requests;
-    std::set<std::pair<uint32_t, uint32_t>> _chunk_read_requests_set;
-
-    std::mutex _mutex_chunk_read_executing;
-    std::set<std::pair<uint32_t, uint32_t>> _chunk_read_executing;
-
-    std::vector<std::thread> _worker_threads;
-    std::mutex _mutex_worker_threads;
-
-    std::condition_variable _worker_cond;
-    std::mutex _mutex_worker_cond;
+    // queued and running chunk reads, processed by a fixed number of worker threads
+    chunk_request_queue _requests;
+    std::vector<std::thread> _workers;
 
-    std::map<std::pair<uint32_t, uint32_t>, std::pair<std::condition_variable, std::mutex>> _chunk_cond;
+    // files of the persistent result cache, most recently used first
+    std::list<std::string> _result_lru;
+    std::unordered_map<std::string, std::pair<std::list<std::string>::iterator, uint64_t>> _result_files;
+    uint64_t _result_bytes;
+    std::mutex _mutex_results;
 
     std::set<std::string> _whitelist;
 };
@@ -229,6 +229,8 @@ std::string simple_cube::to_string() {
 
 std::shared_ptr<chunk_data> simple_cube::read_chunk(chunkid_t id) {
     std::shared_ptr<chunk_data> out = std::make_shared<chunk_data>();
+    profile_scope profile(this, out);
+    trace_span span("simple_cube::read_chunk", "source", id);
     if (id >= count_chunks()) {
         // chunk is outside of the cube, we don't need to read anything.
         GCBS_WARN("Chunk id " + std::to_string(id) + " is out of range");
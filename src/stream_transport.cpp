@@ -0,0 +1,195 @@
+/*
+    MIT License
+
+    Copyright (c) 2026 Marius Appel <marius.appel@uni-muenster.de>
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+#include "stream_transport.h"
+
+#include <cstring>
+#include <fstream>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/statvfs.h>
+#include <unistd.h>
+#define GDALCUBES_STREAMING_SHM 1
+#endif
+
+#include "filesystem.h"
+
+namespace gdalcubes {
+
+stream_transport::stream_transport(chunkid_t id) : _id(id), _shm(false), _in_name(), _out_name(), _in_path(), _out_path() {
+#ifdef GDALCUBES_STREAMING_SHM
+    if (config::instance()->get_streaming_shm() && filesystem::is_directory("/dev/shm")) {
+        std::string name = utils::generate_unique_filename(12, "gdalcubes_stream_" + std::to_string(id) + "_");
+        _shm = true;
+        _in_name = "/" + name + "_in";
+        _out_name = "/" + name + "_out";
+        _in_path = "/dev/shm" + _in_name;
+        _out_path = "/dev/shm" + _out_name;
+        return;
+    }
+#endif
+    use_files();
+}
+
+stream_transport::~stream_transport() {
+#ifdef GDALCUBES_STREAMING_SHM
+    if (_shm) {
+        // mappings of the result remain valid after unlinking
+        shm_unlink(_in_name.c_str());
+        shm_unlink(_out_name.c_str());
+        return;
+    }
+#endif
+    if (filesystem::exists(_in_path)) {
+        filesystem::remove(_in_path);
+    }
+    if (filesystem::exists(_out_path)) {
+        filesystem::remove(_out_path);
+    }
+}
+
+void stream_transport::use_files() {
+    _shm = false;
+    _in_path = filesystem::join(config::instance()->get_streaming_dir(), utils::generate_unique_filename(12, ".stream_" + std::to_string(_id) + "_", "_in"));
+    _out_path = filesystem::join(config::instance()->get_streaming_dir(), utils::generate_unique_filename(12, ".stream_" + std::to_string(_id) + "_", "_out"));
+}
+
+void stream_transport::write_input(const int size[4], const std::vector<std::string> &band_names, const double *dims, std::string srs, const double *data) {
+    std::size_t ndims = std::size_t(size[1]) + size[2] + size[3];
+    std::size_t nvalues = std::size_t(size[0]) * size[1] * size[2] * size[3];
+
+    // serialize header to memory first, values are written directly afterwards
+    std::vector<char> header(4 * sizeof(int));
+    std::memcpy(header.data(), size, 4 * sizeof(int));
+    for (uint16_t i = 0; i < band_names.size(); ++i) {
+        int str_size = band_names[i].size();
+        header.insert(header.end(), (char *)&str_size, (char *)&str_size + sizeof(int));
+        header.insert(header.end(), band_names[i].begin(), band_names[i].end());
+    }
+    header.insert(header.end(), (const char *)dims, (const char *)(dims + ndims));
+    int str_size = srs.size();
+    header.insert(header.end(), (char *)&str_size, (char *)&str_size + sizeof(int));
+    header.insert(header.end(), srs.begin(), srs.end());
+
+#ifdef GDALCUBES_STREAMING_SHM
+    if (_shm) {
+        std::size_t total = header.size() + nvalues * sizeof(double);
+        // the external program writes its result to /dev/shm too, require space for a result of the input's size
+        struct statvfs vfs;
+        bool space = statvfs("/dev/shm", &vfs) == 0 && double(vfs.f_bavail) * double(vfs.f_frsize) >= 2.0 * double(total);
+        int fd = space ? shm_open(_in_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600) : -1;
+        // reserve memory explicitly, writing to a mapping of a full tmpfs would raise SIGBUS
+        if (fd >= 0 && posix_fallocate(fd, 0, total) == 0) {
+            void *mem = mmap(nullptr, total, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            close(fd);
+            if (mem != MAP_FAILED) {
+                std::memcpy(mem, header.data(), header.size());
+                std::memcpy(((char *)mem) + header.size(), data, nvalues * sizeof(double));
+                munmap(mem, total);
+                return;
+            }
+        } else if (fd >= 0) {
+            close(fd);
+        }
+        shm_unlink(_in_name.c_str());
+        GCBS_DEBUG("Not enough space in /dev/shm or failed to create shared memory object for streaming chunk " + std::to_string(_id) + ", falling back to files");
+        use_files();
+    }
+#endif
+
+    std::ofstream f_in_stream(_in_path, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!f_in_stream.is_open()) {
+        GCBS_ERROR("Cannot write streaming input data to file '" + _in_path + "'");
+        throw std::string("ERROR in stream_transport::write_input(): cannot write streaming input data to file '" + _in_path + "'");
+    }
+    f_in_stream.write(header.data(), header.size());
+    f_in_stream.write((const char *)data, nvalues * sizeof(double));
+    f_in_stream.close();
+}
+
+std::shared_ptr<chunk_data> stream_transport::read_output() {
+    std::shared_ptr<chunk_data> out = std::make_shared<chunk_data>();
+    int size[4];
+
+#ifdef GDALCUBES_STREAMING_SHM
+    if (_shm) {
+        int fd = shm_open(_out_name.c_str(), O_RDONLY, 0);
+        if (fd < 0) {
+            GCBS_ERROR("Cannot read streaming output data from '" + _out_path + "'");
+            throw std::string("ERROR in stream_transport::read_output(): cannot read streaming output data from '" + _out_path + "'");
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size < (off_t)(4 * sizeof(int))) {
+            close(fd);
+            GCBS_ERROR("Invalid streaming output data in '" + _out_path + "'");
+            throw std::string("ERROR in stream_transport::read_output(): invalid streaming output data in '" + _out_path + "'");
+        }
+        std::size_t length = st.st_size;
+        // private mapping, consumers may modify chunk buffers in place
+        void *mem = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (mem == MAP_FAILED) {
+            GCBS_ERROR("Cannot map streaming output data in '" + _out_path + "'");
+            throw std::string("ERROR in stream_transport::read_output(): cannot map streaming output data in '" + _out_path + "'");
+        }
+        std::shared_ptr<void> mapping(mem, [length](void *p) { munmap(p, length); });
+        std::memcpy(size, mem, 4 * sizeof(int));
+        chunk_size_btyx out_size = {(uint32_t)size[0], (uint32_t)size[1], (uint32_t)size[2], (uint32_t)size[3]};
+        std::size_t nbytes = std::size_t(out_size[0]) * out_size[1] * out_size[2] * out_size[3] * sizeof(double);
+        out->size(out_size);
+        if (length - 4 * sizeof(int) >= nbytes) {
+            out->buf(((char *)mem) + 4 * sizeof(int), mapping);
+        } else {
+            out->buf(std::calloc(nbytes, 1));
+            std::memcpy(out->buf(), ((char *)mem) + 4 * sizeof(int), length - 4 * sizeof(int));
+        }
+        return out;
+    }
+#endif
+
+    std::ifstream f_out_stream(_out_path, std::ios::in | std::ios::binary);
+    if (!f_out_stream.is_open()) {
+        GCBS_ERROR("Cannot read streaming output data from file '" + _out_path + "'");
+        throw std::string("ERROR in stream_transport::read_output(): cannot read streaming output data from file '" + _out_path + "'");
+    }
+    f_out_stream.seekg(0, f_out_stream.end);
+    std::size_t length = f_out_stream.tellg();
+    f_out_stream.seekg(0, f_out_stream.beg);
+    if (length < 4 * sizeof(int)) {
+        GCBS_ERROR("Invalid streaming output data in file '" + _out_path + "'");
+        throw std::string("ERROR in stream_transport::read_output(): invalid streaming output data in file '" + _out_path + "'");
+    }
+    f_out_stream.read((char *)size, 4 * sizeof(int));
+    chunk_size_btyx out_size = {(uint32_t)size[0], (uint32_t)size[1], (uint32_t)size[2], (uint32_t)size[3]};
+    std::size_t nbytes = std::size_t(out_size[0]) * out_size[1] * out_size[2] * out_size[3] * sizeof(double);
+    out->size(out_size);
+    out->buf(std::calloc(nbytes, 1));
+    f_out_stream.read((char *)out->buf(), std::min(nbytes, length - 4 * sizeof(int)));  // read directly into the chunk buffer
+    f_out_stream.close();
+    return out;
+}
+
+}  // namespace gdalcubes
@@ -0,0 +1,99 @@
+/*
+    MIT License
+
+    Copyright (c) 2026 Marius Appel <marius.appel@uni-muenster.de>
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+#ifndef STREAM_TRANSPORT_H
+#define STREAM_TRANSPORT_H
+
+#include "cube.h"
+
+namespace gdalcubes {
+
+/**
+ * @brief Exchange of chunk data between streaming operators and external processes
+ *
+ * Input chunks are written as
+ *
+ *     int size[4] (b, t, y, x)
+ *     for each band: int n, char name[n]
+ *     double dims[t + y + x]
+ *     int n, char srs[n]
+ *     double values[b * t * y * x]
+ *
+ * and external programs write results as int size[4] followed by values.
+ *
+ * On Linux, data is exchanged in POSIX shared memory objects if config::get_streaming_shm() is true. The input is
+ * written directly to a memory mapping of the object and the result is mapped as buffer of the resulting chunk
+ * without copying. External programs receive paths under /dev/shm, i.e. they can simply read and write
+ * files as before or mmap them. Otherwise, or if /dev/shm has not enough free space for the input and a result of
+ * the same size, or if creating the shared memory object fails, files in config::get_streaming_dir() are used.
+ */
+class stream_transport {
+   public:
+    stream_transport(chunkid_t id);
+    ~stream_transport();
+
+    /**
+     * @brief Write input data
+     * @param size size of the chunk (b, t, y, x)
+     * @param band_names names of bands
+     * @param dims coordinates of t, y, and x dimensions
+     * @param srs spatial reference system
+     * @param data chunk values
+     */
+    void write_input(const int size[4], const std::vector<std::string> &band_names, const double *dims, std::string srs, const double *data);
+
+    /**
+     * @brief Read the result of the external process
+     * @return chunk with size as given in the output, values beyond the output are filled with zeros
+     */
+    std::shared_ptr<chunk_data> read_output();
+
+    /**
+     * @brief Path of the input to be passed to the external program
+     */
+    inline std::string input_path() { return _in_path; }
+
+    /**
+     * @brief Path where the external program must write results
+     */
+    inline std::string output_path() { return _out_path; }
+
+    /**
+     * @brief Whether data is exchanged in shared memory
+     */
+    inline bool shared_memory() { return _shm; }
+
+   private:
+    void use_files();
+
+    chunkid_t _id;
+    bool _shm;
+    std::string _in_name;  // names of shared memory objects
+    std::string _out_name;
+    std::string _in_path;
+    std::string _out_path;
+};
+
+}  // namespace gdalcubes
+
+#endif  // STREAM_TRANSPORT_H
@@ -0,0 +1,312 @@
+/*
+    MIT License
+
+    Copyright (c) 2026 Marius Appel <marius.appel@uni-muenster.de>
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+#include "stream_worker_pool.h"
+
+#include <chrono>
+#include <thread>
+
+#ifndef _WIN32
+#include <pthread.h>
+#include <signal.h>
+#endif
+
+#include "external/tiny-process-library/process.hpp"
+#include "trace_recorder.h"
+
+namespace gdalcubes {
+
+std::mutex stream_worker_pool::_pools_mutex;
+std::map<std::string, std::shared_ptr<stream_worker_pool>> stream_worker_pool::_pools;
+
+/* setenv / _putenv is not thread-safe, we need to get a mutex until the child process has been started. */
+static std::mutex env_mutex;
+
+int stream_worker_pool::execute(std::string cmd, chunkid_t id, std::string f_in, std::string f_out, std::string &errstr) {
+    uint16_t size = config::instance()->get_streaming_workers();
+    if (size == 0) {
+        return execute_once(cmd, id, f_in, f_out, errstr);
+    }
+    return get(cmd, size)->run(id, f_in, f_out, errstr);
+}
+
+int stream_worker_pool::execute_once(std::string cmd, chunkid_t id, std::string f_in, std::string f_out, std::string &errstr) {
+    trace_span span("stream_process", "stream", id);  // lifetime of the external process
+    env_mutex.lock();
+    utils::env::instance().set({{"GDALCUBES_STREAMING", "1"},
+                                {"GDALCUBES_STREAMING_CHUNK_ID", std::to_string(id)},
+                                {"GDALCUBES_STREAMING_FILE_IN", f_in},
+                                {"GDALCUBES_STREAMING_FILE_OUT", f_out}});
+
+    // start process
+    TinyProcessLib::Config pconf;
+    pconf.show_window = TinyProcessLib::Config::ShowWindow::hide;
+    TinyProcessLib::Process process(
+        cmd, "", [](const char *bytes, std::size_t n) {},
+        [&errstr](const char *bytes, std::size_t n) {
+            std::string s(bytes, n);
+            errstr = errstr + s;
+        },
+        false, pconf);
+    utils::env::instance().unset_all();
+    env_mutex.unlock();
+    return process.get_exit_status();
+}
+
+std::shared_ptr<stream_worker_pool> stream_worker_pool::get(std::string cmd, uint16_t size) {
+    std::lock_guard<std::mutex> lock(_pools_mutex);
+    auto it = _pools.find(cmd);
+    if (it == _pools.end() || it->second->_size != size) {
+        // a previous pool with different size stops its workers as soon as no chunk uses it anymore
+        _pools[cmd] = std::make_shared<stream_worker_pool>(cmd, size);
+    }
+    return _pools[cmd];
+}
+
+void stream_worker_pool::shutdown_all() {
+    std::map<std::string, std::shared_ptr<stream_worker_pool>> pools;
+    {
+        std::lock_guard<std::mutex> lock(_pools_mutex);
+        pools.swap(_pools);
+    }
+    pools.clear();
+}
+
+stream_worker_pool::stream_worker_pool(std::string cmd, uint16_t size) : _cmd(cmd), _size(size), _count(0), _idle(), _mutex(), _cv() {}
+
+stream_worker_pool::~stream_worker_pool() {
+    _idle.clear();
+}
+
+stream_worker_pool::worker::worker() : m(), cv(), stdout_buf(), errstr(), done(false), reply_id(), status(0), message(), process() {}
+
+stream_worker_pool::worker::~worker() {
+    if (!process) return;
+    // ask the worker to exit by closing stdin, kill if it does not react
+    process->close_stdin();
+    int exit_status;
+    for (uint16_t i = 0; i < 20; ++i) {
+        if (process->try_get_exit_status(exit_status)) {
+            process.reset();
+            return;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    GCBS_DEBUG("Streaming worker did not exit after closing stdin, killing process " + std::to_string(process->get_id()));
+    process->kill(true);
+    process->get_exit_status();
+    process.reset();
+}
+
+std::shared_ptr<stream_worker_pool::worker> stream_worker_pool::spawn() {
+    std::shared_ptr<worker> w = std::make_shared<worker>();
+    worker *wp = w.get();  // the process and its reader threads never outlive the worker
+
+    std::function<void(const char *, std::size_t)> read_stdout = [wp](const char *bytes, std::size_t n) {
+        std::lock_guard<std::mutex> lock(wp->m);
+        wp->stdout_buf.append(bytes, n);
+        std::size_t pos;
+        while ((pos = wp->stdout_buf.find('\n')) != std::string::npos) {
+            std::string line = wp->stdout_buf.substr(0, pos);
+            wp->stdout_buf.erase(0, pos + 1);
+            if (line.compare(0, 15, "GDALCUBES_DONE\t") != 0) {
+                GCBS_DEBUG(line);
+                continue;
+            }
+            std::vector<std::string> fields;
+            std::size_t start = 0;
+            std::size_t end;
+            while ((end = line.find('\t', start)) != std::string::npos) {
+                fields.push_back(line.substr(start, end - start));
+                start = end + 1;
+            }
+            fields.push_back(line.substr(start));
+            wp->reply_id = fields.size() > 1 ? fields[1] : "";
+            wp->status = fields.size() > 2 ? std::atoi(fields[2].c_str()) : 0;
+            wp->message = fields.size() > 3 ? fields[3] : "";
+            wp->done = true;
+            wp->cv.notify_all();
+        }
+    };
+    std::function<void(const char *, std::size_t)> read_stderr = [wp](const char *bytes, std::size_t n) {
+        std::lock_guard<std::mutex> lock(wp->m);
+        wp->errstr.append(bytes, n);
+    };
+
+    TinyProcessLib::Config pconf;
+    pconf.show_window = TinyProcessLib::Config::ShowWindow::hide;
+    env_mutex.lock();
+    utils::env::instance().set({{"GDALCUBES_STREAMING", "1"},
+                                {"GDALCUBES_STREAMING_PERSISTENT", "1"}});
+    w->process.reset(new TinyProcessLib::Process(_cmd, "", read_stdout, read_stderr, true, pconf));
+    utils::env::instance().unset_all();
+    env_mutex.unlock();
+
+    if (w->process->get_id() <= 0) {
+        w->process.reset();
+        GCBS_ERROR("Failed to start streaming worker '" + _cmd + "'");
+        throw std::string("ERROR in stream_worker_pool::spawn(): failed to start streaming worker '" + _cmd + "'");
+    }
+    GCBS_DEBUG("Started streaming worker with process id " + std::to_string(w->process->get_id()));
+    trace_recorder::instant("stream_worker_start", "stream");
+    return w;
+}
+
+std::shared_ptr<stream_worker_pool::worker> stream_worker_pool::acquire() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _cv.wait(lock, [this] { return !_idle.empty() || _count < _size; });
+    if (!_idle.empty()) {
+        std::shared_ptr<worker> w = _idle.front();
+        _idle.pop_front();
+        return w;
+    }
+    ++_count;
+    lock.unlock();
+    try {
+        return spawn();
+    } catch (...) {
+        lock.lock();
+        --_count;
+        _cv.notify_one();
+        throw;
+    }
+}
+
+void stream_worker_pool::release(std::shared_ptr<worker> w, bool alive) {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (alive) {
+            _idle.push_back(w);
+        } else {
+            --_count;
+        }
+    }
+    _cv.notify_one();
+    // dead workers are destroyed here, outside of the lock
+}
+
+bool stream_worker_pool::run_on(std::shared_ptr<worker> w, chunkid_t id, std::string f_in, std::string f_out, int &status, std::string &errstr) {
+    {
+        std::lock_guard<std::mutex> lock(w->m);
+        w->done = false;
+        w->reply_id.clear();
+        w->status = 0;
+        w->message.clear();
+        w->errstr.clear();
+    }
+
+    std::string request = "GDALCUBES_CHUNK\t" + std::to_string(id) + "\t" + f_in + "\t" + f_out + "\n";
+#ifndef _WIN32
+    // writing to a dead worker must not terminate the whole process with SIGPIPE
+    sigset_t sigpipe_set;
+    sigset_t old_set;
+    sigemptyset(&sigpipe_set);
+    sigaddset(&sigpipe_set, SIGPIPE);
+    pthread_sigmask(SIG_BLOCK, &sigpipe_set, &old_set);
+    bool written = w->process->write(request);
+    if (!written) {
+        struct timespec zero = {0, 0};
+        sigtimedwait(&sigpipe_set, nullptr, &zero);  // consume pending SIGPIPE
+    }
+    pthread_sigmask(SIG_SETMASK, &old_set, nullptr);
+#else
+    bool written = w->process->write(request);
+#endif
+
+    uint32_t timeout = config::instance()->get_streaming_worker_timeout();
+    auto started = std::chrono::steady_clock::now();
+    while (written) {
+        {
+            std::unique_lock<std::mutex> lock(w->m);
+            if (w->cv.wait_for(lock, std::chrono::milliseconds(100), [&w] { return w->done; })) {
+                errstr = w->errstr;
+                if (w->reply_id != std::to_string(id)) {
+                    // the worker is out of sync with requests, its output file cannot be trusted
+                    errstr += "Streaming worker responded with chunk id '" + w->reply_id + "' to request for chunk " + std::to_string(id);
+                    status = -1;
+                    lock.unlock();
+                    w->process->kill(true);
+                    return false;
+                }
+                status = w->status;
+                if (!w->message.empty()) {
+                    errstr += w->message;
+                }
+                return true;
+            }
+        }
+        if (timeout > 0 && std::chrono::steady_clock::now() - started > std::chrono::seconds(timeout)) {
+            w->process->kill(true);
+            std::lock_guard<std::mutex> lock(w->m);
+            errstr = w->errstr + "Streaming worker did not respond within " + std::to_string(timeout) + " seconds";
+            status = -1;
+            return false;
+        }
+        // not holding the lock here, try_get_exit_status() joins reader threads of finished processes
+        int exit_status;
+        if (w->process->try_get_exit_status(exit_status)) {
+            std::lock_guard<std::mutex> lock(w->m);
+            errstr = w->errstr;
+            status = exit_status != 0 ? exit_status : -1;
+            return false;
+        }
+    }
+
+    // the request could not be written, i.e. the worker has exited or closed its input, collect its exit status
+    int exit_status = 0;
+    bool exited = false;
+    auto failed = std::chrono::steady_clock::now();
+    while (!(exited = w->process->try_get_exit_status(exit_status)) && std::chrono::steady_clock::now() - failed < std::chrono::seconds(5)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    if (!exited) {
+        w->process->kill(true);
+        exit_status = w->process->get_exit_status();
+    }
+    status = exit_status != 0 ? exit_status : -1;
+    std::lock_guard<std::mutex> lock(w->m);
+    errstr = w->errstr;
+    return false;
+}
+
+int stream_worker_pool::run(chunkid_t id, std::string f_in, std::string f_out, std::string &errstr) {
+    int status = 0;
+    for (uint16_t attempt = 0; attempt < 2; ++attempt) {
+        trace_span span_wait("stream_worker_wait", "stream", id);
+        std::shared_ptr<worker> w = acquire();
+        span_wait.end();
+        trace_span span_run("stream_worker_chunk", "stream", id);
+        bool alive = run_on(w, id, f_in, f_out, status, errstr);
+        span_run.end();
+        release(w, alive);
+        if (alive) {
+            return status;
+        }
+        trace_recorder::instant("stream_worker_died", "stream", id);
+        GCBS_WARN("Streaming worker failed while processing chunk " + std::to_string(id) + (attempt == 0 ? ", restarting worker" : ""));
+        GCBS_DEBUG(errstr);
+    }
+    return status;
+}
+
+}  // namespace gdalcubes
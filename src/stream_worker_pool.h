@@ -0,0 +1,128 @@
+/*
+    MIT License
+
+    Copyright (c) 2026 Marius Appel <marius.appel@uni-muenster.de>
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+#ifndef STREAM_WORKER_POOL_H
+#define STREAM_WORKER_POOL_H
+
+#include <condition_variable>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "cube.h"
+
+namespace TinyProcessLib {
+class Process;
+}
+
+namespace gdalcubes {
+
+/**
+ * @brief A pool of long-lived external processes for streaming operators
+ *
+ * By default, streaming operators start a new process of the external program for each chunk.
+ * If config::get_streaming_workers() > 0, up to that number of processes are started per command and
+ * reused for all chunks, which avoids paying the startup time of interpreters such as R or Python per chunk.
+ *
+ * Persistent workers are started with environment variables GDALCUBES_STREAMING=1 and
+ * GDALCUBES_STREAMING_PERSISTENT=1. Chunk data is exchanged in files as for one-shot processes but requests are
+ * sent as lines to stdin of the worker:
+ *
+ *     GDALCUBES_CHUNK\t<chunk id>\t<input file>\t<output file>\n
+ *
+ * After writing the output file, the worker must respond with a line on stdout:
+ *
+ *     GDALCUBES_DONE\t<chunk id>\t<status>[\t<message>]\n
+ *
+ * where status 0 means success. All other lines on stdout and stderr are logged. Workers should exit when stdin is
+ * closed. If a worker dies while processing a chunk, does not respond within config::get_streaming_worker_timeout(),
+ * or responds with a different chunk id, it is killed and restarted and the chunk is retried once.
+ */
+class stream_worker_pool {
+   public:
+    /**
+     * @brief Run the external program for one chunk whose input has already been written to f_in
+     * @details Depending on config::get_streaming_workers(), a persistent worker or a new process is used.
+     * @param cmd command of the external program
+     * @param id chunk id
+     * @param f_in input file
+     * @param f_out output file to be written by the external program
+     * @param errstr output of the external program on stderr
+     * @return exit status (one-shot processes) or reported status (persistent workers), 0 means success
+     */
+    static int execute(std::string cmd, chunkid_t id, std::string f_in, std::string f_out, std::string &errstr);
+
+    /**
+     * @brief Stop all persistent workers
+     */
+    static void shutdown_all();
+
+    stream_worker_pool(std::string cmd, uint16_t size);
+    ~stream_worker_pool();
+
+    /**
+     * @brief Process one chunk with a persistent worker, see execute()
+     */
+    int run(chunkid_t id, std::string f_in, std::string f_out, std::string &errstr);
+
+   private:
+    struct worker {
+        worker();
+        ~worker();
+        std::mutex m;
+        std::condition_variable cv;
+        std::string stdout_buf;  // incomplete line
+        std::string errstr;
+        bool done;
+        std::string reply_id;  // chunk id of the last response
+        int status;
+        std::string message;
+        std::unique_ptr<TinyProcessLib::Process> process;  // declared last to stop reader threads first
+    };
+
+    std::shared_ptr<worker> spawn();
+    std::shared_ptr<worker> acquire();
+    void release(std::shared_ptr<worker> w, bool alive);
+
+    // returns false if the worker died, timed out, or did not respond properly; such workers must not be reused
+    bool run_on(std::shared_ptr<worker> w, chunkid_t id, std::string f_in, std::string f_out, int &status, std::string &errstr);
+
+    static int execute_once(std::string cmd, chunkid_t id, std::string f_in, std::string f_out, std::string &errstr);
+    static std::shared_ptr<stream_worker_pool> get(std::string cmd, uint16_t size);
+
+    std::string _cmd;
+    uint16_t _size;
+    uint16_t _count;
+    std::list<std::shared_ptr<worker>> _idle;
+    std::mutex _mutex;
+    std::condition_variable _cv;
+
+    static std::mutex _pools_mutex;
+    static std::map<std::string, std::shared_ptr<stream_worker_pool>> _pools;
+};
+
+}  // namespace gdalcubes
+
+#endif  // STREAM_WORKER_POOL_H
@@ -26,88 +26,260 @@
 
 #include "swarm.h"
 
-#include <fstream>
+#include <cctype>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <set>
 #include <thread>
 
+#include "chunk_wire.h"
+
 namespace gdalcubes {
 
-size_t post_file_read_callback(char *buffer, size_t size, size_t nitems, void *userdata) {
+size_t swarm_read_callback(char *buffer, size_t size, size_t nitems, void *userdata) {
     std::ifstream *is = ((std::ifstream *)userdata);
-    is->read(buffer, size * nitems);  // or use readsome() ?
+    is->read(buffer, size * nitems);
     return is->gcount();
 }
 
-std::shared_ptr<gdalcubes_swarm> gdalcubes_swarm::from_txtfile(std::string path) {
-    std::ifstream file(path);
-    std::vector<std::string> urllist;
-    std::string line;
-    while (std::getline(file, line)) {
-        // TODO: check if valid URL
-        if (!line.empty()) urllist.push_back(line);
+size_t swarm_write_callback(char *buffer, size_t size, size_t nitems, void *userdata) {
+    swarm_request *x = (swarm_request *)userdata;
+    std::size_t n = size * nitems;
+    if (x->response_size + n > x->response_capacity) {
+        std::size_t capacity = 2 * x->response_capacity;
+        if (x->response_capacity == 0) {
+            curl_off_t content_length = -1;
+            curl_easy_getinfo(x->_handle, CURLINFO_CONTENT_LENGTH_DOWNLOAD_T, &content_length);
+            capacity = content_length > 0 ? std::size_t(content_length) : 0;
+        }
+        capacity = std::max(capacity, x->response_size + n);
+        char *data = (char *)std::realloc(x->response, capacity);
+        if (!data) {
+            return 0;  // abort transfer
+        }
+        x->response = data;
+        x->response_capacity = capacity;
     }
+    std::memcpy(x->response + x->response_size, buffer, n);
+    x->response_size += n;
+    return n;
+}
 
-    file.close();
-    return gdalcubes_swarm::from_urls(urllist);
+// percent-encode a query parameter value (RFC 3986 unreserved characters are kept)
+static std::string swarm_url_encode(const std::string &s) {
+    static const char *hex = "0123456789ABCDEF";
+    std::string out;
+    out.reserve(s.size());
+    for (std::size_t i = 0; i < s.size(); ++i) {
+        unsigned char c = s[i];
+        if (std::isalnum(c) || c == '-' || c == '_' || c == '.' || c == '~') {
+            out += c;
+        } else {
+            out += '%';
+            out += hex[c >> 4];
+            out += hex[c & 15];
+        }
+    }
+    return out;
 }
 
-void gdalcubes_swarm::post_file(std::string path, uint16_t server_index) {
-    if (_server_handles[server_index]) {
-        curl_easy_reset(_server_handles[server_index]);
+swarm_multi::swarm_multi(uint16_t nservers, uint16_t max_per_server) : _multi(curl_multi_init()),
+                                                                       _max_per_server(std::max(uint16_t(1), max_per_server)),
+                                                                       _pending(nservers),
+                                                                       _inflight(nservers, 0),
+                                                                       _running(),
+                                                                       _handles(),
+                                                                       _stop(false) {}
+
+swarm_multi::~swarm_multi() {
+    for (auto it = _running.begin(); it != _running.end(); ++it) {
+        curl_multi_remove_handle(_multi, it->first);
+        curl_easy_cleanup(it->first);
+        if (it->second->_headers) {
+            curl_slist_free_all(it->second->_headers);
+            it->second->_headers = nullptr;
+        }
+    }
+    for (uint32_t i = 0; i < _handles.size(); ++i) {
+        curl_easy_cleanup(_handles[i]);
+    }
+    curl_multi_cleanup(_multi);
+}
 
-        // Step 1: send a HEAD HTTP request to check whether the file already exists on the server
-        curl_easy_setopt(_server_handles[server_index], CURLOPT_URL, (_server_uris[server_index] + "/file" + "?name=" + path + "&size=" + std::to_string(filesystem::file_size(path))).c_str());
-        curl_easy_setopt(_server_handles[server_index], CURLOPT_CUSTOMREQUEST, "HEAD");
-        curl_easy_setopt(_server_handles[server_index], CURLOPT_VERBOSE, config::instance()->get_swarm_curl_verbose() ? 1L : 0L);
+void swarm_multi::add(std::shared_ptr<swarm_request> r) {
+    if (r->server_index >= _pending.size()) {
+        throw std::string("ERROR in swarm_multi::add(): invalid server index");
+    }
+    _pending[r->server_index].push_back(r);
+}
 
-        CURLcode res = curl_easy_perform(_server_handles[server_index]);
-        long response_code;
-        if (res != CURLE_OK) {
-            throw std::string("ERROR in gdalcubes_swarm::post_file(): HEAD /file?name='" + path + "' to '" + _server_uris[server_index] + "' failed");
-        } else {
-            curl_easy_getinfo(_server_handles[server_index], CURLINFO_RESPONSE_CODE, &response_code);
+void swarm_multi::start_pending() {
+    for (uint16_t is = 0; is < _pending.size(); ++is) {
+        while (!_pending[is].empty() && _inflight[is] < _max_per_server) {
+            std::shared_ptr<swarm_request> r = _pending[is].front();
+            _pending[is].pop_front();
+
+            CURL *h;
+            if (_handles.empty()) {
+                h = curl_easy_init();
+            } else {
+                h = _handles.back();
+                _handles.pop_back();
+            }
+            r->_handle = h;
+            curl_easy_setopt(h, CURLOPT_URL, r->url.c_str());
+            curl_easy_setopt(h, CURLOPT_VERBOSE, config::instance()->get_swarm_curl_verbose() ? 1L : 0L);
+            curl_easy_setopt(h, CURLOPT_WRITEFUNCTION, &swarm_write_callback);
+            curl_easy_setopt(h, CURLOPT_WRITEDATA, r.get());
+            if (r->method == "HEAD") {
+                curl_easy_setopt(h, CURLOPT_NOBODY, 1L);
+            } else if (r->method == "POST") {
+                r->_headers = curl_slist_append(r->_headers, "Expect:");
+                if (!r->content_type.empty()) {
+                    r->_headers = curl_slist_append(r->_headers, ("Content-Type: " + r->content_type).c_str());
+                }
+                curl_easy_setopt(h, CURLOPT_HTTPHEADER, r->_headers);
+                if (!r->upload_file.empty()) {
+                    r->_upload.reset(new std::ifstream(r->upload_file, std::ifstream::in | std::ifstream::binary));
+                    curl_easy_setopt(h, CURLOPT_UPLOAD, 1L);
+                    curl_easy_setopt(h, CURLOPT_READFUNCTION, &swarm_read_callback);
+                    curl_easy_setopt(h, CURLOPT_READDATA, r->_upload.get());
+                    curl_easy_setopt(h, CURLOPT_INFILESIZE_LARGE, (curl_off_t)filesystem::file_size(r->upload_file));
+                } else {
+                    curl_easy_setopt(h, CURLOPT_POST, 1L);
+                    curl_easy_setopt(h, CURLOPT_POSTFIELDS, r->body.c_str());
+                    curl_easy_setopt(h, CURLOPT_POSTFIELDSIZE, (long)r->body.size());
+                }
+                curl_easy_setopt(h, CURLOPT_CUSTOMREQUEST, "POST");  // for whatever reason all uploads are PUT if not set
+            } else {
+                curl_easy_setopt(h, CURLOPT_HTTPGET, 1L);
+            }
+            curl_multi_add_handle(_multi, h);
+            _running[h] = r;
+            ++_inflight[is];
         }
+    }
+}
 
-        if (response_code == 200) {
-            // already exists on server
-            return;
-        } else if (response_code == 204 || response_code == 409) {
-            // file does not exist or has different size
-
-            // Step 2: if not upload
+void swarm_multi::finish(CURL *h, CURLcode result) {
+    std::shared_ptr<swarm_request> r = _running[h];
+    _running.erase(h);
+    r->result = result;
+    curl_easy_getinfo(h, CURLINFO_RESPONSE_CODE, &r->response_code);
+    curl_multi_remove_handle(_multi, h);
+    if (r->_headers) {
+        curl_slist_free_all(r->_headers);
+        r->_headers = nullptr;
+    }
+    r->_upload.reset();
+    r->_handle = nullptr;
+    curl_easy_reset(h);
+    _handles.push_back(h);  // keeps connections alive for subsequent requests
+    --_inflight[r->server_index];
+    if (r->callback) {
+        r->callback(r);
+    }
+}
 
-            std::ifstream is(path, std::ifstream::in | std::ifstream::binary);
-            if (!is.is_open()) {
-                throw std::string("ERROR in gdalcubes_swarm::push_execution_context(): cannot open file '" + path + "'");
+void swarm_multi::run(std::function<void()> tick) {
+    _stop = false;
+    start_pending();
+    while (!_running.empty() && !_stop) {
+        int still_running = 0;
+        curl_multi_perform(_multi, &still_running);
+
+        CURLMsg *msg;
+        int msgs_left = 0;
+        while (!_stop && (msg = curl_multi_info_read(_multi, &msgs_left))) {
+            if (msg->msg == CURLMSG_DONE && _running.count(msg->easy_handle) > 0) {
+                finish(msg->easy_handle, msg->data.result);
+            }
+        }
+        if (tick && !_stop) {
+            tick();
+        }
+        if (_stop) break;
+        start_pending();
+        if (!_running.empty()) {
+            curl_multi_wait(_multi, nullptr, 0, 100, nullptr);
+        }
+    }
+    if (_stop) {
+        // cancel outstanding requests
+        for (auto it = _running.begin(); it != _running.end(); ++it) {
+            curl_multi_remove_handle(_multi, it->first);
+            if (it->second->_headers) {
+                curl_slist_free_all(it->second->_headers);
+                it->second->_headers = nullptr;
             }
+            it->second->_upload.reset();
+            it->second->_handle = nullptr;
+            curl_easy_reset(it->first);
+            _handles.push_back(it->first);
+            --_inflight[it->second->server_index];
+        }
+        _running.clear();
+        for (uint16_t is = 0; is < _pending.size(); ++is) {
+            _pending[is].clear();
+        }
+    }
+}
 
-            curl_easy_setopt(_server_handles[server_index], CURLOPT_URL, (_server_uris[server_index] + "/file" + "?name=" + path).c_str());
+std::shared_ptr<gdalcubes_swarm> gdalcubes_swarm::from_txtfile(std::string path) {
+    std::ifstream file(path);
+    std::vector<std::string> urllist;
+    std::string line;
+    while (std::getline(file, line)) {
+        // TODO: check if valid URL
+        if (!line.empty()) urllist.push_back(line);
+    }
 
-            //struct curl_slist *header = NULL;
-            //header = curl_slist_append(header, "Content-Type: application/octet-stream");
-            // curl_easy_setopt(curl, CURLOPT_HTTPHEADER, header);
+    file.close();
+    return gdalcubes_swarm::from_urls(urllist);
+}
 
-            curl_easy_setopt(_server_handles[server_index], CURLOPT_UPLOAD, 1L);
-            curl_easy_setopt(_server_handles[server_index], CURLOPT_POST, 1L);
-            curl_easy_setopt(_server_handles[server_index], CURLOPT_CUSTOMREQUEST, "POST");  // for whatever reason all requests are PUT if not set
+std::shared_ptr<swarm_request> gdalcubes_swarm::make_head_file(std::string path, uint16_t server_index) {
+    std::shared_ptr<swarm_request> r = std::make_shared<swarm_request>();
+    r->server_index = server_index;
+    r->method = "HEAD";
+    r->url = _server_uris[server_index] + "/file" + "?name=" + swarm_url_encode(path) + "&size=" + std::to_string(filesystem::file_size(path));
+    return r;
+}
 
-            // This will most likely work only as long as curl_easy_perform is synchronous, otherwise &is might become invalid
-            curl_easy_setopt(_server_handles[server_index], CURLOPT_READDATA, &is);
-            curl_easy_setopt(_server_handles[server_index], CURLOPT_READFUNCTION, &post_file_read_callback);
+std::shared_ptr<swarm_request> gdalcubes_swarm::make_post_file(std::string path, uint16_t server_index) {
+    std::shared_ptr<swarm_request> r = std::make_shared<swarm_request>();
+    r->server_index = server_index;
+    r->method = "POST";
+    r->url = _server_uris[server_index] + "/file" + "?name=" + swarm_url_encode(path);
+    r->upload_file = path;
+    return r;
+}
 
-            curl_easy_setopt(_server_handles[server_index], CURLOPT_INFILESIZE_LARGE, (curl_off_t)filesystem::file_size(path));
+std::shared_ptr<swarm_request> gdalcubes_swarm::make_post_cube(std::string json, uint16_t server_index) {
+    std::shared_ptr<swarm_request> r = std::make_shared<swarm_request>();
+    r->server_index = server_index;
+    r->method = "POST";
+    r->url = _server_uris[server_index] + "/cube";
+    r->body = json;
+    r->content_type = "application/json";
+    return r;
+}
 
-            curl_easy_setopt(_server_handles[server_index], CURLOPT_VERBOSE, config::instance()->get_swarm_curl_verbose() ? 1L : 0L);
+std::shared_ptr<swarm_request> gdalcubes_swarm::make_post_start(uint32_t chunk_id, uint16_t server_index) {
+    std::shared_ptr<swarm_request> r = std::make_shared<swarm_request>();
+    r->server_index = server_index;
+    r->method = "POST";
+    r->url = _server_uris[server_index] + "/cube/" + std::to_string(_cube_ids[server_index]) + "/" + std::to_string(chunk_id) + "/start";
+    return r;
+}
 
-            CURLcode res = curl_easy_perform(_server_handles[server_index]);
-            if (res != CURLE_OK) {
-                if (is.is_open()) is.close();
-                throw std::string("ERROR in gdalcubes_swarm::post_file(): uploading '" + path + "' to '" + _server_uris[server_index] + "' failed");
-            }
-            if (is.is_open()) is.close();
-        } else {
-            throw std::string("ERROR in gdalcubes_swarm::post_file(): HEAD /file?name='" + path + "' to '" + _server_uris[server_index] + "' returned HTTP code " + std::to_string(response_code));
-        }
-    }
+std::shared_ptr<swarm_request> gdalcubes_swarm::make_get_download(uint32_t chunk_id, uint16_t server_index) {
+    std::shared_ptr<swarm_request> r = std::make_shared<swarm_request>();
+    r->server_index = server_index;
+    r->method = "GET";
+    r->url = _server_uris[server_index] + "/cube/" + std::to_string(_cube_ids[server_index]) + "/" + std::to_string(chunk_id) + "/download?compression=" + std::to_string(config::instance()->get_swarm_compression());
+    return r;
 }
 
 void gdalcubes_swarm::push_execution_context(bool recursive) {
@@ -128,141 +300,288 @@ void gdalcubes_swarm::push_execution_context(bool recursive) {
         });
     }
 
-    // TODO: parallel upload
+    // check whether files exist on servers with HEAD requests and upload missing files, all concurrently
+    swarm_multi m(_server_uris.size(), config::instance()->get_swarm_max_requests_per_server());
+    std::string err;
     for (auto it_f = file_list.begin(); it_f != file_list.end(); ++it_f) {
         for (uint16_t is = 0; is < _server_uris.size(); ++is) {
-            post_file(*it_f, is);
+            std::string path = *it_f;
+            std::shared_ptr<swarm_request> r = make_head_file(path, is);
+            r->callback = [this, &m, &err, path](std::shared_ptr<swarm_request> r) {
+                if (r->result != CURLE_OK) {
+                    err = "ERROR in gdalcubes_swarm::push_execution_context(): HEAD /file?name='" + path + "' to '" + _server_uris[r->server_index] + "' failed";
+                    m.stop();  // cancel outstanding requests
+                } else if (r->response_code == 204 || r->response_code == 409) {
+                    // file does not exist or has different size
+                    std::shared_ptr<swarm_request> u = make_post_file(path, r->server_index);
+                    u->callback = [this, &m, &err, path](std::shared_ptr<swarm_request> u) {
+                        if (!u->ok()) {
+                            err = "ERROR in gdalcubes_swarm::push_execution_context(): uploading '" + path + "' to '" + _server_uris[u->server_index] + "' failed";
+                            m.stop();
+                        }
+                    };
+                    m.add(u);
+                } else if (r->response_code != 200) {
+                    err = "ERROR in gdalcubes_swarm::push_execution_context(): HEAD /file?name='" + path + "' to '" + _server_uris[r->server_index] + "' returned HTTP code " + std::to_string(r->response_code);
+                    m.stop();
+                }
+            };
+            m.add(r);
         }
     }
+    m.run();
+    if (!err.empty()) {
+        throw err;
+    }
 }
 
-size_t post_cube_read_callback(char *buffer, size_t size, size_t nitems, void *userdata) {
-    std::istringstream *is = (std::istringstream *)userdata;
-    is->readsome(buffer, size * nitems);  // or use readsome() ?
-    return is->gcount();
-}
-
-size_t post_cube_write_callback(char *buffer, size_t size, size_t nitems, void *userdata) {
-    std::vector<char> *x = (std::vector<char> *)userdata;
-    x->insert(x->end(), buffer, buffer + (size * nitems));
-    return size * nitems;
-}
-
-uint32_t gdalcubes_swarm::post_cube(std::string json, uint16_t server_index) {
-    std::istringstream is(json);
-    if (_server_handles[server_index]) {
-        curl_easy_reset(_server_handles[server_index]);
-        curl_easy_setopt(_server_handles[server_index], CURLOPT_URL, (_server_uris[server_index] + "/cube").c_str());
-
-        // TODO: Disable Expect: 100-Continue header?
+void gdalcubes_swarm::push_cube(std::shared_ptr<cube> c) {
+    _cube = c;  // Does this require a mutex?
+    std::string json = c->make_constructible_json().dump();
 
-        curl_easy_setopt(_server_handles[server_index], CURLOPT_UPLOAD, 1L);
-        curl_easy_setopt(_server_handles[server_index], CURLOPT_POST, 1L);
-        curl_easy_setopt(_server_handles[server_index], CURLOPT_CUSTOMREQUEST, "POST");  // for whatever reason all requests are PUT if not set
+    _cube_ids.assign(_server_uris.size(), 0);
 
-        struct curl_slist *header = NULL;
-        header = curl_slist_append(header, "Content-Type: application/json");
-        header = curl_slist_append(header, "Expect:");
-        curl_easy_setopt(_server_handles[server_index], CURLOPT_HTTPHEADER, header);
+    swarm_multi m(_server_uris.size(), config::instance()->get_swarm_max_requests_per_server());
+    std::string err;
+    for (uint16_t is = 0; is < _server_uris.size(); ++is) {
+        std::shared_ptr<swarm_request> r = make_post_cube(json, is);
+        r->callback = [this, &m, &err](std::shared_ptr<swarm_request> r) {
+            if (!r->ok()) {
+                err = "ERROR in gdalcubes_swarm::push_cube(): POST /cube to '" + _server_uris[r->server_index] + "' failed";
+                m.stop();  // cancel outstanding requests
+                return;
+            }
+            try {
+                _cube_ids[r->server_index] = std::stoi(r->response_string());
+            } catch (...) {
+                err = "ERROR in gdalcubes_swarm::push_cube(): invalid response from '" + _server_uris[r->server_index] + "'";
+                m.stop();
+            }
+        };
+        m.add(r);
+    }
+    m.run();
+    if (!err.empty()) {
+        throw err;
+    }
+}
 
-        curl_easy_setopt(_server_handles[server_index], CURLOPT_READFUNCTION, &post_cube_read_callback);
+std::shared_ptr<chunk_data> gdalcubes_swarm::read_download(std::shared_ptr<swarm_request> r) {
+    if (chunk_wire::is_encoded(r->response, r->response_size)) {
+        return chunk_wire::decode(r->response, r->response_size);
+    }
 
-        // This will most likely work only as long as curl_easy_perform is synchronous, otherwise &is might become invalid
-        curl_easy_setopt(_server_handles[server_index], CURLOPT_READDATA, &is);
+    // legacy format of older servers: uint32 size[4] followed by values, used without copying
+    if (r->response_size < 4 * sizeof(uint32_t)) {
+        throw std::string("ERROR in gdalcubes_swarm::read_download(): invalid response from '" + _server_uris[r->server_index] + "'");
+    }
+    std::shared_ptr<chunk_data> out = std::make_shared<chunk_data>();
+    std::array<uint32_t, 4> size = {((uint32_t *)r->response)[0], ((uint32_t *)r->response)[1], ((uint32_t *)r->response)[2], ((uint32_t *)r->response)[3]};
+    out->size(size);
+    if (size[0] * size[1] * size[2] * size[3] > 0) {
+        if (r->response_size < 4 * sizeof(uint32_t) + out->size()[0] * out->size()[1] * out->size()[2] * out->size()[3] * sizeof(double)) {
+            throw std::string("ERROR in gdalcubes_swarm::read_download(): incomplete response from '" + _server_uris[r->server_index] + "'");
+        }
+        char *data = r->response;
+        out->buf(data + 4 * sizeof(uint32_t), r->take_response());
+    }
+    return out;
+}
 
-        //curl_easy_setopt(_server_handles[server_index], CURLOPT_INFILESIZE, json.size() + 1);
+void gdalcubes_swarm::apply(std::shared_ptr<cube> c, std::function<void(chunkid_t, std::shared_ptr<chunk_data>, std::mutex &)> f) {
+    std::vector<chunkid_t> chunks(c->count_chunks());
+    for (uint32_t i = 0; i < c->count_chunks(); ++i) {
+        chunks[i] = i;
+    }
+    apply(c, chunks, f);
+}
 
-        curl_easy_setopt(_server_handles[server_index], CURLOPT_WRITEFUNCTION, &post_cube_write_callback);
+swarm_scheduler::swarm_scheduler(swarm_multi &m, std::vector<std::string> servers, const std::vector<chunkid_t> &chunks,
+                                 std::function<std::shared_ptr<swarm_request>(chunkid_t, uint16_t)> make_start,
+                                 std::function<std::shared_ptr<swarm_request>(chunkid_t, uint16_t)> make_download,
+                                 std::function<void(chunkid_t, std::shared_ptr<swarm_request>)> deliver) : _m(m),
+                                                                                                            _server_uris(servers),
+                                                                                                            _chunks(),
+                                                                                                            _servers(servers.size()),
+                                                                                                            _queue(),
+                                                                                                            _running(),
+                                                                                                            _make_start(make_start),
+                                                                                                            _make_download(make_download),
+                                                                                                            _deliver(deliver),
+                                                                                                            _nalive(servers.size()),
+                                                                                                            _ndone(0),
+                                                                                                            _ncompleted(0),
+                                                                                                            _sum_duration(0),
+                                                                                                            _error() {
+    for (uint32_t i = 0; i < chunks.size(); ++i) {
+        chunk_state c;
+        c.id = chunks[i];
+        c.done = false;
+        c.failures = 0;
+        c.failed_on = -1;
+        _chunks.push_back(c);
+        _queue.push_back(i);
+    }
+    for (uint16_t is = 0; is < _servers.size(); ++is) {
+        _servers[is].inflight = 0;
+        _servers[is].failures = 0;
+        _servers[is].alive = true;
+    }
+}
 
-        // This will most likely work only as long as curl_easy_perform is synchronous, otherwise &response_body_bytes might become invalid
-        std::vector<char> response_body_bytes;
-        curl_easy_setopt(_server_handles[server_index], CURLOPT_WRITEDATA, &response_body_bytes);
+constexpr double swarm_scheduler::STRAGGLER_FACTOR;
+const uint16_t swarm_scheduler::MAX_COPIES;
+const uint16_t swarm_scheduler::MAX_SERVER_FAILURES;
+const uint16_t swarm_scheduler::MAX_CHUNK_FAILURES;
 
-        curl_easy_setopt(_server_handles[server_index], CURLOPT_VERBOSE, config::instance()->get_swarm_curl_verbose() ? 1L : 0L);
+void swarm_scheduler::start() {
+    if (_chunks.empty()) {
+        return;
+    }
+    for (uint16_t is = 0; is < _servers.size(); ++is) {
+        fill(is);
+    }
+}
 
-        CURLcode res = curl_easy_perform(_server_handles[server_index]);
-        if (res != CURLE_OK) {
-            throw std::string("ERROR in gdalcubes_swarm::post_cube(): POST /cube to '" + _server_uris[server_index] + "' failed");
+void swarm_scheduler::tick() {
+    if (!_queue.empty() || _ncompleted == 0 || !_error.empty()) {
+        return;
+    }
+    for (uint16_t is = 0; is < _servers.size(); ++is) {
+        while (_servers[is].alive && _servers[is].inflight < limit() && speculate(is)) {
         }
-        std::string response_body(response_body_bytes.begin(), response_body_bytes.end());
-        return std::stoi(response_body);
-    } else {
-        throw std::string("ERROR in gdalcubes_swarm::post_cube(): no connection with given server index available");
     }
 }
 
-void gdalcubes_swarm::push_cube(std::shared_ptr<cube> c) {
-    _cube = c;  // Does this require a mutex?
-    std::string json = c->make_constructible_json().dump();
-
-    _cube_ids.clear();
-
-    // TODO: parallelize requests
-    for (uint16_t is = 0; is < _server_uris.size(); ++is) {
-        _cube_ids.push_back(post_cube(json, is));
+void swarm_scheduler::fill(uint16_t is) {
+    while (_servers[is].alive && _servers[is].inflight < limit() && !_queue.empty()) {
+        // chunks that failed on this server are left to other servers if possible, failed chunks are at the front
+        auto it = _queue.begin();
+        while (it != _queue.end() && _nalive > 1 && _chunks[*it].failed_on == is) ++it;
+        if (it == _queue.end()) break;
+        uint32_t ci = *it;
+        _queue.erase(it);
+        if (_chunks[ci].done) continue;
+        launch(ci, is);
+    }
+    if (_queue.empty()) {
+        tick();
     }
 }
 
-void gdalcubes_swarm::post_start(uint32_t chunk_id, uint16_t server_index) {
-    if (_server_handles[server_index]) {
-        // TODO: URLencode?
-        curl_easy_reset(_server_handles[server_index]);
-        curl_easy_setopt(_server_handles[server_index], CURLOPT_URL, (_server_uris[server_index] + "/cube/" + std::to_string(_cube_ids[server_index]) + "/" + std::to_string(chunk_id) + "/start").c_str());
-        curl_easy_setopt(_server_handles[server_index], CURLOPT_POST, 1L);
-        curl_easy_setopt(_server_handles[server_index], CURLOPT_CUSTOMREQUEST, "POST");
-        curl_easy_setopt(_server_handles[server_index], CURLOPT_VERBOSE, config::instance()->get_swarm_curl_verbose() ? 1L : 0L);
-
-        CURLcode res = curl_easy_perform(_server_handles[server_index]);
-        if (res != CURLE_OK) {
-            throw std::string("ERROR in gdalcubes_swarm::post_start(): POST /cube/{cube_id}/{chunk_id}/start to '" + _server_uris[server_index] + "' failed");
+bool swarm_scheduler::speculate(uint16_t is) {
+    // only chunks in progress are considered, oldest first, such that costs do not depend on the total number of chunks
+    double threshold = STRAGGLER_FACTOR * _sum_duration / _ncompleted;
+    auto now = std::chrono::steady_clock::now();
+    for (auto it = _running.begin(); it != _running.end(); ++it) {
+        if (std::chrono::duration<double>(now - it->first).count() <= threshold) {
+            return false;  // all remaining chunks started later
         }
-        return;
+        chunk_state &c = _chunks[it->second];
+        if (c.servers.size() >= MAX_COPIES || c.servers.count(is) > 0) continue;
+        GCBS_DEBUG("Speculatively executing chunk " + std::to_string(c.id) + " on '" + _server_uris[is] + "'");
+        launch(it->second, is);
+        return true;
     }
+    return false;
 }
 
-size_t get_download_callback(char *buffer, size_t size, size_t nitems, void *userdata) {
-    std::vector<char> *x = (std::vector<char> *)userdata;
-    x->insert(x->end(), buffer, buffer + (size * nitems));
-    return size * nitems;
+void swarm_scheduler::launch(uint32_t ci, uint16_t is) {
+    chunk_state &c = _chunks[ci];
+    if (c.servers.empty()) {
+        c.started = std::chrono::steady_clock::now();
+        _running.insert(std::make_pair(c.started, ci));
+    }
+    c.servers.insert(is);
+    ++_servers[is].inflight;
+
+    std::shared_ptr<swarm_request> r = _make_start(c.id, is);
+    r->callback = [this, ci](std::shared_ptr<swarm_request> r) {
+        if (!r->ok()) {
+            failure(ci, r->server_index, "POST /cube/{cube_id}/{chunk_id}/start", r);
+            return;
+        }
+        if (_chunks[ci].done) {
+            finished(ci, r->server_index);  // another copy has been delivered meanwhile
+            return;
+        }
+        std::shared_ptr<swarm_request> d = _make_download(_chunks[ci].id, r->server_index);
+        d->callback = [this, ci](std::shared_ptr<swarm_request> d) {
+            if (!d->ok()) {
+                failure(ci, d->server_index, "GET /cube/{cube_id}/{chunk_id}/download", d);
+                return;
+            }
+            _servers[d->server_index].failures = 0;
+            chunk_state &c = _chunks[ci];
+            if (!c.done) {
+                c.done = true;
+                _running.erase(std::make_pair(c.started, ci));
+                ++_ndone;
+                ++_ncompleted;
+                _sum_duration += std::chrono::duration<double>(std::chrono::steady_clock::now() - c.started).count();
+                _deliver(c.id, d);
+            }
+            finished(ci, d->server_index);
+        };
+        _m.add(d);
+    };
+    _m.add(r);
 }
 
-std::shared_ptr<chunk_data> gdalcubes_swarm::get_download(uint32_t chunk_id, uint16_t server_index) {
-    if (_server_handles[server_index]) {
-        // TODO: URLencode?
-        curl_easy_reset(_server_handles[server_index]);
-        curl_easy_setopt(_server_handles[server_index], CURLOPT_URL, (_server_uris[server_index] + "/cube/" + std::to_string(_cube_ids[server_index]) + "/" + std::to_string(chunk_id) + "/download").c_str());
-        curl_easy_setopt(_server_handles[server_index], CURLOPT_HTTPGET, 1L);
-        curl_easy_setopt(_server_handles[server_index], CURLOPT_CUSTOMREQUEST, "GET");
-        curl_easy_setopt(_server_handles[server_index], CURLOPT_WRITEFUNCTION, &get_download_callback);
+void swarm_scheduler::release(uint32_t ci, uint16_t is) {
+    chunk_state &c = _chunks[ci];
+    c.servers.erase(is);
+    --_servers[is].inflight;
+    if (c.servers.empty()) {
+        _running.erase(std::make_pair(c.started, ci));
+    }
+}
 
-        // This will most likely work only as long as curl_easy_perform is synchronous, otherwise &response_body_bytes might become invalid
-        std::vector<char> response_body_bytes;
-        curl_easy_setopt(_server_handles[server_index], CURLOPT_WRITEDATA, &response_body_bytes);
+void swarm_scheduler::finished(uint32_t ci, uint16_t is) {
+    release(ci, is);
+    if (_ndone == _chunks.size()) {
+        _m.stop();  // cancel remaining speculative copies
+        return;
+    }
+    fill(is);
+}
 
-        curl_easy_setopt(_server_handles[server_index], CURLOPT_VERBOSE, config::instance()->get_swarm_curl_verbose() ? 1L : 0L);
+void swarm_scheduler::failure(uint32_t ci, uint16_t is, std::string what, std::shared_ptr<swarm_request> r) {
+    chunk_state &c = _chunks[ci];
+    std::string msg = what + " of chunk " + std::to_string(c.id) + " to '" + _server_uris[is] + "' failed";
+    msg += (r->result != CURLE_OK) ? (": " + std::string(curl_easy_strerror(r->result))) : (" with HTTP code " + std::to_string(r->response_code));
+    GCBS_WARN(msg);
+
+    release(ci, is);
+    if (++_servers[is].failures >= MAX_SERVER_FAILURES && _servers[is].alive) {
+        _servers[is].alive = false;
+        --_nalive;
+        GCBS_WARN("Server '" + _server_uris[is] + "' failed repeatedly and will not be used anymore");
+    }
 
-        CURLcode res = curl_easy_perform(_server_handles[server_index]);
-        if (res != CURLE_OK) {
-            throw std::string("ERROR in gdalcubes_swarm::get_download(): GET /cube/{cube_id}/{chunk_id}/download to '" + _server_uris[server_index] + "' failed");
+    if (!c.done) {
+        c.failed_on = is;
+        if (++c.failures >= MAX_CHUNK_FAILURES) {
+            _error = "ERROR in gdalcubes_swarm::apply(): chunk " + std::to_string(c.id) + " failed " + std::to_string(c.failures) + " times, last error: " + msg;
+            _m.stop();
+            return;
         }
-
-        // construct chunk_data from byte vector
-        std::shared_ptr<chunk_data> out = std::make_shared<chunk_data>();
-        std::array<uint32_t, 4> size = {((uint32_t *)response_body_bytes.data())[0], ((uint32_t *)response_body_bytes.data())[1], ((uint32_t *)response_body_bytes.data())[2], ((uint32_t *)response_body_bytes.data())[3]};
-        out->size(size);
-        if (size[0] * size[1] * size[2] * size[3] > 0) {
-            out->buf(std::malloc(out->size()[0] * out->size()[1] * out->size()[2] * out->size()[3] * sizeof(double)));
-            std::copy(response_body_bytes.begin() + sizeof(std::array<uint32_t, 4>), response_body_bytes.end(),
-                      (char *)out->buf());
+        if (c.servers.empty()) {
+            _queue.push_front(ci);  // reassign
         }
+    }
 
-        return out;
-    } else {
-        throw std::string("ERROR in gdalcubes_swarm::get_download(): no connection with given server index available");
+    if (_nalive == 0) {
+        _error = "ERROR in gdalcubes_swarm::apply(): all servers failed, last error: " + msg;
+        _m.stop();
+        return;
+    }
+    for (uint16_t j = 0; j < _servers.size(); ++j) {
+        fill((is + 1 + j) % _servers.size());
     }
 }
 
-void gdalcubes_swarm::apply(std::shared_ptr<cube> c, std::function<void(chunkid_t, std::shared_ptr<chunk_data>, std::mutex &)> f) {
+void gdalcubes_swarm::apply(std::shared_ptr<cube> c, std::vector<chunkid_t> chunks, std::function<void(chunkid_t, std::shared_ptr<chunk_data>, std::mutex &)> f) {
     uint32_t nthreads = 1;
     // try whether default chunk processor is multithread and read number of threads if successful
     if (std::dynamic_pointer_cast<chunk_processor_multithread>(config::instance()->get_default_chunk_processor())) {
@@ -272,28 +591,73 @@ void gdalcubes_swarm::apply(std::shared_ptr<cube> c, std::function<void(chunkid_
     push_execution_context(false);
     push_cube(c);
 
-    // TODO: what if servers fail?
-    std::map<uint16_t, std::vector<uint32_t>> chunk_distr;
-    for (uint32_t i = 0; i < c->count_chunks(); ++i) {
-        post_start(i, i % _server_uris.size());  // start computations on remote servers
-        chunk_distr[i % _server_uris.size()].push_back(i);
-    }
+    // finished downloads are decoded and passed to f by worker threads while further requests are in flight
+    std::deque<std::pair<chunkid_t, std::shared_ptr<swarm_request>>> downloaded;
+    std::mutex mutex_downloaded;
+    std::condition_variable cond_downloaded;
+    bool finished = false;
+    std::string err;
+    std::mutex mutex_err;
+
+    swarm_multi m(_server_uris.size(), config::instance()->get_swarm_max_requests_per_server());
+
     std::mutex mutex;
     std::vector<std::thread> workers;
     for (uint16_t it = 0; it < nthreads; ++it) {
-        workers.push_back(std::thread([this, c, &chunk_distr, &f, it, &mutex](void) {
-            // One remote server is processed by a single thread for now, changing this will require to using the multi interface of curl
-            for (uint32_t iserver = it; iserver < _server_uris.size(); iserver += _server_uris.size()) {
-                for (uint32_t ichunk = 0; ichunk < chunk_distr[iserver].size(); ++ichunk) {
-                    std::shared_ptr<chunk_data> dat = get_download(chunk_distr[iserver][ichunk], iserver);
-                    f(chunk_distr[iserver][ichunk], dat, mutex);
+        workers.push_back(std::thread([this, &f, &m, &mutex, &downloaded, &mutex_downloaded, &cond_downloaded, &finished, &err, &mutex_err](void) {
+            while (true) {
+                std::pair<chunkid_t, std::shared_ptr<swarm_request>> d;
+                {
+                    std::unique_lock<std::mutex> lock(mutex_downloaded);
+                    cond_downloaded.wait(lock, [&downloaded, &finished] { return finished || !downloaded.empty(); });
+                    if (downloaded.empty()) break;
+                    d = downloaded.front();
+                    downloaded.pop_front();
+                }
+                {
+                    std::lock_guard<std::mutex> lock(mutex_err);
+                    if (!err.empty()) continue;  // job has failed, remaining downloads are dropped
+                }
+                try {
+                    f(d.first, read_download(d.second), mutex);
+                } catch (std::string s) {
+                    std::lock_guard<std::mutex> lock(mutex_err);
+                    if (err.empty()) err = s;
+                    m.stop();  // cancel outstanding requests
                 }
             }
         }));
     }
+
+    swarm_scheduler scheduler(
+        m, _server_uris, chunks,
+        [this](chunkid_t id, uint16_t is) { return make_post_start(id, is); },
+        [this](chunkid_t id, uint16_t is) { return make_get_download(id, is); },
+        [&downloaded, &mutex_downloaded, &cond_downloaded](chunkid_t id, std::shared_ptr<swarm_request> d) {
+            std::lock_guard<std::mutex> lock(mutex_downloaded);
+            downloaded.push_back(std::make_pair(id, d));
+            cond_downloaded.notify_one();
+        });
+    scheduler.start();
+    m.run([&scheduler]() { scheduler.tick(); });
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_downloaded);
+        finished = true;
+        cond_downloaded.notify_all();
+    }
     for (uint16_t it = 0; it < nthreads; ++it) {
         workers[it].join();
     }
+    if (!scheduler.error().empty()) {
+        throw scheduler.error();
+    }
+    if (!err.empty()) {
+        throw err;
+    }
+    if (!scheduler.complete()) {
+        throw std::string("ERROR in gdalcubes_swarm::apply(): only " + std::to_string(scheduler.count_done()) + " of " + std::to_string(chunks.size()) + " chunks have been processed");
+    }
 }
 
 }  // namespace gdalcubes
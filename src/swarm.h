@@ -29,28 +29,225 @@
 
 #include <curl/curl.h>
 
+#include <atomic>
+#include <deque>
+#include <fstream>
+#include <chrono>
+#include <map>
+#include <set>
+
 #include "cube.h"
 
 namespace gdalcubes {
 
+/**
+ * @brief HTTP request to a gdalcubes_server instance, performed asynchronously by swarm_multi
+ */
+struct swarm_request {
+    swarm_request() : server_index(0), method("GET"), body(), content_type(), upload_file(), callback(nullptr), result(CURLE_OK), response_code(0), response(nullptr), response_size(0), response_capacity(0), _handle(nullptr), _headers(nullptr), _upload() {}
+    ~swarm_request() {
+        if (response) std::free(response);
+    }
+    swarm_request(const swarm_request &) = delete;
+
+    uint16_t server_index;
+    std::string url;
+    std::string method;        // "GET", "POST", or "HEAD"
+    std::string body;          // body of POST requests
+    std::string content_type;  // optional Content-Type header of POST requests
+    std::string upload_file;   // if not empty, the body of POST requests is streamed from this file
+
+    // called in the thread running swarm_multi::run() after the request has finished
+    std::function<void(std::shared_ptr<swarm_request>)> callback;
+
+    CURLcode result;
+    long response_code;
+    char *response;  // response body, allocated once according to Content-Length if known
+    std::size_t response_size;
+    std::size_t response_capacity;
+
+    /**
+     * @brief Check whether the transfer succeeded with a 2xx HTTP status
+     */
+    inline bool ok() { return result == CURLE_OK && response_code >= 200 && response_code < 300; }
+
+    /**
+     * @brief Release ownership of the response body
+     * @return shared pointer that frees the response body
+     */
+    std::shared_ptr<void> take_response() {
+        std::shared_ptr<void> out(response, std::free);
+        response = nullptr;
+        response_size = 0;
+        response_capacity = 0;
+        return out;
+    }
+
+    inline std::string response_string() { return std::string(response ? response : "", response_size); }
+
+    CURL *_handle;
+    struct curl_slist *_headers;
+    std::unique_ptr<std::ifstream> _upload;
+};
+
+/**
+ * @brief Executes many HTTP requests concurrently with the curl multi interface
+ *
+ * Requests are queued per server and at most a given number of requests per server are in flight at the same time.
+ * Callbacks of finished requests may add further requests.
+ */
+class swarm_multi {
+   public:
+    /**
+     * @brief Construct an empty request set
+     * @param nservers number of servers
+     * @param max_per_server maximum number of concurrent requests per server
+     */
+    swarm_multi(uint16_t nservers, uint16_t max_per_server);
+    virtual ~swarm_multi();
+    swarm_multi(const swarm_multi &) = delete;
+
+    /**
+     * @brief Add a request, not thread-safe but may be called from callbacks
+     * @param r request
+     */
+    virtual void add(std::shared_ptr<swarm_request> r);
+
+    /**
+     * @brief Perform all requests, returns after all requests and requests added by callbacks have finished or stop() has been called
+     * @param tick optional function that is called periodically, e.g. to add requests depending on time
+     */
+    void run(std::function<void()> tick = nullptr);
+
+    /**
+     * @brief Let run() return as soon as possible, pending and running requests are cancelled without calling callbacks
+     *
+     * This function may be called from any thread.
+     */
+    virtual void stop() { _stop = true; }
+
+   private:
+    void start_pending();
+    void finish(CURL *h, CURLcode result);
+
+    CURLM *_multi;
+    uint16_t _max_per_server;
+    std::vector<std::deque<std::shared_ptr<swarm_request>>> _pending;
+    std::vector<uint16_t> _inflight;
+    std::map<CURL *, std::shared_ptr<swarm_request>> _running;
+    std::vector<CURL *> _handles;  // idle easy handles, reused
+    std::atomic<bool> _stop;
+};
+
+/**
+ * @brief Assignment of chunks to the servers of a swarm during gdalcubes_swarm::apply()
+ *
+ * Chunks are pulled by servers, i.e. each server processes a bounded number of chunks and gets a new chunk as soon as
+ * one finishes. Chunks are reassigned if they fail, servers are not used anymore after repeated failures. If no
+ * unassigned chunks are left, idle servers additionally execute chunks that take much longer than the average
+ * (stragglers). Whichever copy finishes first is used, the job ends as soon as all chunks have been delivered.
+ *
+ * All methods are called from the thread running swarm_multi::run() and hence need no synchronization.
+ */
+class swarm_scheduler {
+   public:
+    /**
+     * @brief Create a scheduler, no requests are added before start()
+     * @param m request set that performs all requests
+     * @param servers server URLs, used in messages only
+     * @param chunks chunks to be processed
+     * @param make_start creates the request that starts computing a chunk on a server
+     * @param make_download creates the request that downloads a computed chunk from a server
+     * @param deliver called once per chunk with the successful download request
+     */
+    swarm_scheduler(swarm_multi &m, std::vector<std::string> servers, const std::vector<chunkid_t> &chunks,
+                    std::function<std::shared_ptr<swarm_request>(chunkid_t, uint16_t)> make_start,
+                    std::function<std::shared_ptr<swarm_request>(chunkid_t, uint16_t)> make_download,
+                    std::function<void(chunkid_t, std::shared_ptr<swarm_request>)> deliver);
+
+    /**
+     * @brief Assign initial chunks to all servers
+     */
+    void start();
+
+    /**
+     * @brief Called periodically to start speculative execution of stragglers
+     */
+    void tick();
+
+    inline std::string error() { return _error; }
+
+    /**
+     * @brief Number of chunks that have been delivered
+     */
+    inline uint32_t count_done() { return _ndone; }
+
+    /**
+     * @brief Check whether all chunks have been delivered
+     */
+    inline bool complete() { return _ndone == _chunks.size(); }
+
+   private:
+    // speculative copies are started for chunks taking longer than this factor times the average duration
+    static constexpr double STRAGGLER_FACTOR = 2.0;
+    static const uint16_t MAX_COPIES = 2;
+    static const uint16_t MAX_SERVER_FAILURES = 3;  // consecutive failures before a server is not used anymore
+    static const uint16_t MAX_CHUNK_FAILURES = 3;
+
+    struct chunk_state {
+        chunkid_t id;
+        bool done;
+        uint16_t failures;
+        int32_t failed_on;           // server of the last failure, -1 if none
+        std::set<uint16_t> servers;  // servers currently processing the chunk
+        std::chrono::steady_clock::time_point started;
+    };
+
+    struct server_state {
+        uint16_t inflight;
+        uint16_t failures;
+        bool alive;
+    };
+
+    inline uint16_t limit() { return std::max(uint16_t(1), config::instance()->get_swarm_chunks_per_server()); }
+
+    void fill(uint16_t is);
+    bool speculate(uint16_t is);
+    void launch(uint32_t ci, uint16_t is);
+    void release(uint32_t ci, uint16_t is);
+    void finished(uint32_t ci, uint16_t is);
+    void failure(uint32_t ci, uint16_t is, std::string what, std::shared_ptr<swarm_request> r);
+
+    swarm_multi &_m;
+    std::vector<std::string> _server_uris;
+    std::vector<chunk_state> _chunks;
+    std::vector<server_state> _servers;
+    std::deque<uint32_t> _queue;  // unassigned chunks (indexes into _chunks)
+    std::set<std::pair<std::chrono::steady_clock::time_point, uint32_t>> _running;  // chunks in progress and not yet delivered, oldest first
+    std::function<std::shared_ptr<swarm_request>(chunkid_t, uint16_t)> _make_start;
+    std::function<std::shared_ptr<swarm_request>(chunkid_t, uint16_t)> _make_download;
+    std::function<void(chunkid_t, std::shared_ptr<swarm_request>)> _deliver;
+    uint16_t _nalive;
+    uint32_t _ndone;
+    uint32_t _ncompleted;
+    double _sum_duration;  // seconds
+    std::string _error;
+};
+
 /**
  * @brief Chunk processor implementation for distributed processing by connecting to gdalcubes_server instances
  *
- * This class connects the several gdalcubes_server instances in order to distribute read_chunk() operations
+ * This class connects the several gdalcubes_server instances in order to distribute read_chunk() operations.
+ * Requests to all servers are performed concurrently with the curl multi interface, see
+ * config::set_swarm_max_requests_per_server(). Chunks are assigned to servers dynamically, each server processes
+ * at most config::get_swarm_chunks_per_server() chunks at the same time. Chunks of failed servers are reassigned and
+ * slow chunks are executed speculatively on idle servers when no unassigned chunks are left.
  *
  * @todo implement add / remove method for workers
  */
 class gdalcubes_swarm : public chunk_processor {
    public:
-    gdalcubes_swarm(std::vector<std::string> urls) : _cube(nullptr), _cube_ids(), _server_handles(), _server_uris(urls), _nthreads(1) {
-        for (uint16_t i = 0; i < _server_uris.size(); ++i)
-            _server_handles.push_back(curl_easy_init());
-    }
-
-    ~gdalcubes_swarm() {
-        for (uint16_t i = 0; i < _server_uris.size(); ++i)
-            curl_easy_cleanup(_server_handles[i]);
-    }
+    gdalcubes_swarm(std::vector<std::string> urls) : _cube(nullptr), _cube_ids(), _server_uris(urls), _nthreads(1) {}
 
     inline static std::shared_ptr<gdalcubes_swarm> from_urls(std::vector<std::string> urls) { return std::make_shared<gdalcubes_swarm>(urls); }
 
@@ -66,6 +263,9 @@ class gdalcubes_swarm : public chunk_processor {
     // Mimic cube::apply with distributed calls to cube::read_chunk()
     void apply(std::shared_ptr<cube> c, std::function<void(chunkid_t, std::shared_ptr<chunk_data>, std::mutex &)> f) override;
 
+    // Mimic cube::apply for a subset of chunks
+    void apply(std::shared_ptr<cube> c, std::vector<chunkid_t> chunks, std::function<void(chunkid_t, std::shared_ptr<chunk_data>, std::mutex &)> f) override;
+
     /**
     * @copydoc chunk_processor::max_threads
     */
@@ -75,17 +275,18 @@ class gdalcubes_swarm : public chunk_processor {
     inline void set_threads(uint16_t threads) { _nthreads = threads; }
 
    private:
-    void post_file(std::string path, uint16_t server_index);
-
-    void post_start(uint32_t chunk_id, uint16_t server_index);
-    std::shared_ptr<chunk_data> get_download(uint32_t chunk_id, uint16_t server_index);
+    std::shared_ptr<swarm_request> make_head_file(std::string path, uint16_t server_index);
+    std::shared_ptr<swarm_request> make_post_file(std::string path, uint16_t server_index);
+    std::shared_ptr<swarm_request> make_post_cube(std::string json, uint16_t server_index);
+    std::shared_ptr<swarm_request> make_post_start(uint32_t chunk_id, uint16_t server_index);
+    std::shared_ptr<swarm_request> make_get_download(uint32_t chunk_id, uint16_t server_index);
 
-    uint32_t post_cube(std::string json, uint16_t server_index);
+    // construct chunk data from the response of a download request
+    std::shared_ptr<chunk_data> read_download(std::shared_ptr<swarm_request> r);
 
     std::shared_ptr<cube> _cube;
     std::vector<uint32_t> _cube_ids;  // IDs of the cube for each server
 
-    std::vector<CURL *> _server_handles;
     std::vector<std::string> _server_uris;
 
     uint16_t _nthreads;
@@ -95,4 +296,4 @@ class gdalcubes_swarm : public chunk_processor {
 
 #endif  //SWARM_H
 
-#endif  // GDALCUBES_NO_SWARM
\ No newline at end of file
+#endif  // GDALCUBES_NO_SWARM
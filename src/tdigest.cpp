@@ -0,0 +1,132 @@
+/*
+    MIT License
+
+    Copyright (c) 2026 Marius Appel <marius.appel@uni-muenster.de>
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+#include "tdigest.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace gdalcubes {
+
+tdigest::tdigest(uint16_t compression) : _compression(std::max(compression, uint16_t(10))), _centroids(), _buffer(), _total_weight(0),
+                                         _min(std::numeric_limits<double>::max()), _max(std::numeric_limits<double>::lowest()) {}
+
+void tdigest::add(double x, double w) {
+    _buffer.push_back({x, w});
+    _total_weight += w;
+    _min = std::min(_min, x);
+    _max = std::max(_max, x);
+    if (_buffer.size() >= _compression) {
+        compress();
+    }
+}
+
+void tdigest::clear() {
+    std::vector<centroid>().swap(_centroids);
+    std::vector<centroid>().swap(_buffer);
+    _total_weight = 0;
+    _min = std::numeric_limits<double>::max();
+    _max = std::numeric_limits<double>::lowest();
+}
+
+double tdigest::k_scale(double q) {
+    // scale function k_1 from Dunning & Ertl (2019)
+    return double(_compression) / (2.0 * M_PI) * std::asin(2.0 * q - 1.0);
+}
+
+void tdigest::compress() {
+    if (_buffer.empty()) return;
+
+    _buffer.insert(_buffer.end(), _centroids.begin(), _centroids.end());
+    std::sort(_buffer.begin(), _buffer.end(), [](const centroid &a, const centroid &b) { return a.mean < b.mean; });
+
+    // weight of centroids that are already in the sketch or the buffer
+    double total = 0;
+    for (uint32_t i = 0; i < _buffer.size(); ++i) {
+        total += _buffer[i].weight;
+    }
+
+    _centroids.clear();
+    double w_so_far = 0;
+    double k_lower = k_scale(0);
+    centroid cur = _buffer[0];
+    for (uint32_t i = 1; i < _buffer.size(); ++i) {
+        double q_upper = (w_so_far + cur.weight + _buffer[i].weight) / total;
+        if (k_scale(std::min(q_upper, 1.0)) - k_lower <= 1.0) {
+            cur.weight += _buffer[i].weight;
+            cur.mean += (_buffer[i].mean - cur.mean) * _buffer[i].weight / cur.weight;
+        } else {
+            _centroids.push_back(cur);
+            w_so_far += cur.weight;
+            k_lower = k_scale(w_so_far / total);
+            cur = _buffer[i];
+        }
+    }
+    _centroids.push_back(cur);
+    _buffer.clear();
+}
+
+double tdigest::quantile(double p) {
+    compress();
+    if (_centroids.empty() || _total_weight <= 0) {
+        return NAN;
+    }
+    if (_centroids.size() == 1) {
+        return _centroids[0].mean;
+    }
+    if (p <= 1e-8) {
+        return _min;
+    }
+    if (p >= 1 - 1e-8) {
+        return _max;
+    }
+
+    uint32_t n = _centroids.size();
+    if (double(n) == _total_weight) {
+        // no values have been merged so far, compute the exact quantile (type 7)
+        double h = (double(n) - 1.0) * p;
+        return _centroids[std::floor(h)].mean + (h - std::floor(h)) * (_centroids[std::ceil(h)].mean - _centroids[std::floor(h)].mean);
+    }
+
+    // interpolate between centroid centers, and between the extreme values and the first / last centroid
+    double target = p * _total_weight;
+    double cum = _centroids[0].weight / 2.0;
+    if (target < cum) {
+        return _min + (target / cum) * (_centroids[0].mean - _min);
+    }
+    for (uint32_t i = 0; i < n - 1; ++i) {
+        double dw = (_centroids[i].weight + _centroids[i + 1].weight) / 2.0;
+        if (target < cum + dw) {
+            return _centroids[i].mean + (target - cum) / dw * (_centroids[i + 1].mean - _centroids[i].mean);
+        }
+        cum += dw;
+    }
+    double rem = _total_weight - cum;
+    if (rem <= 0) {
+        return _centroids[n - 1].mean;
+    }
+    return _centroids[n - 1].mean + std::min((target - cum) / rem, 1.0) * (_max - _centroids[n - 1].mean);
+}
+
+}  // namespace gdalcubes
@@ -0,0 +1,95 @@
+/*
+    MIT License
+
+    Copyright (c) 2026 Marius Appel <marius.appel@uni-muenster.de>
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+#ifndef TDIGEST_H
+#define TDIGEST_H
+
+#include <cstdint>  // 2023-01-12: GCC 13 compatibility
+#include <vector>
+
+namespace gdalcubes {
+
+/**
+ * @brief A sketch to estimate quantiles of a stream of values with bounded memory
+ *
+ * This is an implementation of the merging t-digest (Dunning & Ertl, 2019, Computing Extremely Accurate Quantiles Using t-Digests,
+ * arXiv:1902.04023). Values are collected in a small buffer that is merged into a sorted list of weighted centroids
+ * whenever the buffer is full. The number of centroids is bounded by the compression parameter, such that memory
+ * consumption per sketch is fixed, independent of the number of added values.
+ *
+ * As long as no centroids have been merged (i.e., fewer values than the buffer size have been added), quantiles are computed
+ * exactly, using the same definition (type 7) as the exact quantile reducers.
+ */
+class tdigest {
+   public:
+    /**
+     * @brief Create an empty sketch
+     * @param compression compression parameter (delta), larger values give smaller errors and require more memory;
+     * the number of stored centroids and the buffer size are both bounded by this value
+     */
+    tdigest(uint16_t compression = 50);
+
+    /**
+     * @brief Add a value to the sketch
+     * @param x value, must not be NaN
+     * @param w weight of the value
+     */
+    void add(double x, double w = 1.0);
+
+    /**
+     * @brief Estimate a quantile
+     * @param p probability in [0,1]
+     * @return estimated quantile or NAN if the sketch is empty
+     */
+    double quantile(double p);
+
+    /**
+     * @brief Total weight (number of values) added to the sketch
+     */
+    inline double count() const { return _total_weight; }
+
+    /**
+     * @brief Remove all values and free memory
+     */
+    void clear();
+
+   private:
+    struct centroid {
+        double mean;
+        double weight;
+    };
+
+    void compress();
+    double k_scale(double q);
+
+    uint16_t _compression;
+    std::vector<centroid> _centroids;
+    std::vector<centroid> _buffer;
+    double _total_weight;
+    double _min;
+    double _max;
+};
+
+}  // namespace gdalcubes
+
+#endif  //TDIGEST_H
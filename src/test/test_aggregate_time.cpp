@@ -44,3 +44,21 @@ TEST_CASE("aggregate_time_create", "[aggregate_time]") {
 
 
 }
+
+TEST_CASE("aggregate_time_quantile_approx", "[aggregate_time]") {
+    cube_view r;
+    r.srs("EPSG:3857");
+    r.set_x_axis(-6180000.0, -6080000.0, 1000.0);
+    r.set_y_axis(-550000.0, -450000.0, 1000.0);
+    r.set_t_axis(datetime::from_string("2014-01-01"), datetime::from_string("2014-02-28"), duration::from_string("P1D"));
+
+    auto c = dummy_cube::create(r, 1, 3.0);
+    for (std::string func : {"median_approx", "Q1_approx", "Q3_approx"}) {
+        auto ca = aggregate_time_cube::create(c, "P1M", func);
+        REQUIRE(ca->st_reference()->nt() == 2);
+        std::shared_ptr<chunk_data> dat = ca->read_chunk(0);
+        REQUIRE(!dat->empty());
+        REQUIRE(((double *)dat->buf())[0] == 3.0);
+    }
+    REQUIRE_THROWS(aggregate_time_cube::create(c, "P1M", "Q2_approx"));
+}
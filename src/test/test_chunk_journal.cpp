@@ -0,0 +1,81 @@
+/*
+    MIT License
+
+    Copyright (c) 2026 Marius Appel <marius.appel@uni-muenster.de>
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+#include <fstream>
+#include <string>
+
+#include "../chunk_journal.h"
+#include "../external/catch.hpp"
+#include "../filesystem.h"
+
+using namespace gdalcubes;
+
+TEST_CASE("chunk_journal_resume", "[chunk_journal]") {
+    std::string path = filesystem::join(filesystem::get_tempdir(), "test_chunk_journal.journal");
+    std::string key = chunk_journal::make_key("{\"cube_type\":\"dummy\"}");
+    if (filesystem::exists(path)) filesystem::remove(path);
+
+    {
+        chunk_journal j(path, key);
+        REQUIRE(!j.resumed());
+        j.done(0);
+        j.done(2, "64 128");
+    }
+    // simulate an interruption while writing a line
+    {
+        std::ofstream os(path, std::ios::out | std::ios::app);
+        os << "1";
+    }
+    {
+        chunk_journal j(path, key);
+        REQUIRE(j.resumed());
+        REQUIRE(j.count_done() == 2);
+        REQUIRE(!j.is_done(1));
+        REQUIRE(j.info(2) == "64 128");
+        REQUIRE(j.remaining(4) == std::vector<chunkid_t>({1, 3}));
+        j.done(1);
+        REQUIRE(!j.finish(4));
+    }
+    REQUIRE(filesystem::exists(path));
+    {
+        chunk_journal j(path, key);
+        REQUIRE(j.count_done() == 3);
+        j.done(3);
+        REQUIRE(j.finish(4));
+    }
+    REQUIRE(!filesystem::exists(path));
+}
+
+TEST_CASE("chunk_journal_key_mismatch", "[chunk_journal]") {
+    std::string path = filesystem::join(filesystem::get_tempdir(), "test_chunk_journal_key.journal");
+    {
+        chunk_journal j(path, chunk_journal::make_key("a"));
+        j.done(0);
+    }
+    {
+        chunk_journal j(path, chunk_journal::make_key("b"));
+        REQUIRE(!j.resumed());
+        REQUIRE(j.count_done() == 0);
+    }
+    filesystem::remove(path);
+}
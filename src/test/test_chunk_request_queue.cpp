@@ -0,0 +1,94 @@
+/*
+    MIT License
+
+    Copyright (c) 2026 Marius Appel <marius.appel@uni-muenster.de>
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "../chunk_request_queue.h"
+#include "../external/catch.hpp"
+
+using namespace gdalcubes;
+
+TEST_CASE("chunk_request_queue_order", "[chunk_request_queue]") {
+    chunk_request_queue q;
+    // cube 1 submits a large batch before cube 2
+    for (uint32_t i = 0; i < 4; ++i) {
+        REQUIRE(q.push(std::make_pair(1, i)));
+    }
+    REQUIRE(q.push(std::make_pair(2, 0)));
+    REQUIRE(q.push(std::make_pair(2, 1)));
+    REQUIRE(!q.push(std::make_pair(2, 1)));
+    REQUIRE(q.push(std::make_pair(3, 0), chunk_request_queue::PRIORITY_INTERACTIVE));
+    // raise the priority of a queued request
+    REQUIRE(!q.push(std::make_pair(1, 3), chunk_request_queue::PRIORITY_INTERACTIVE));
+    REQUIRE(q.depth() == 7);
+    REQUIRE(q.depth(chunk_request_queue::PRIORITY_INTERACTIVE) == 2);
+    REQUIRE(q.max_depth() == 7);
+
+    std::vector<std::pair<uint32_t, uint32_t>> expected = {{1, 3}, {3, 0}, {1, 0}, {2, 0}, {1, 1}, {2, 1}, {1, 2}};
+    for (uint16_t i = 0; i < expected.size(); ++i) {
+        std::pair<uint32_t, uint32_t> key;
+        REQUIRE(q.pop(key));
+        REQUIRE(key == expected[i]);
+        REQUIRE(q.is_running(key));
+        REQUIRE(!q.push(key));  // running requests are not queued again
+        q.done(key);
+    }
+    REQUIRE(q.depth() == 0);
+    REQUIRE(q.running() == 0);
+    REQUIRE(q.processed() == 7);
+}
+
+TEST_CASE("chunk_request_queue_workers", "[chunk_request_queue]") {
+    chunk_request_queue q;
+    std::atomic<int> finished(0);
+    std::vector<std::thread> workers;
+    for (int i = 0; i < 4; ++i) {
+        workers.push_back(std::thread([&q, &finished]() {
+            std::pair<uint32_t, uint32_t> key;
+            while (q.pop(key)) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                ++finished;
+                q.done(key);
+            }
+        }));
+    }
+    for (uint32_t i = 0; i < 100; ++i) {
+        q.push(std::make_pair(i % 3, i));
+    }
+    // waiting returns as soon as the request has been processed
+    q.wait(std::make_pair(99 % 3, 99));
+    REQUIRE(!q.is_queued(std::make_pair(99 % 3, 99)));
+    REQUIRE(!q.is_running(std::make_pair(99 % 3, 99)));
+
+    while (q.processed() < 100) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    q.close();
+    for (auto &t : workers) {
+        t.join();
+    }
+    REQUIRE(finished == 100);
+}
@@ -0,0 +1,107 @@
+/*
+    MIT License
+
+    Copyright (c) 2026 Marius Appel <marius.appel@uni-muenster.de>
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <cmath>
+#include <cstring>
+#include <random>
+
+#include "../chunk_wire.h"
+#include "../external/catch.hpp"
+
+using namespace gdalcubes;
+
+static std::shared_ptr<chunk_data> chunk_wire_test_chunk(bool sparse, bool f32) {
+    std::shared_ptr<chunk_data> c = std::make_shared<chunk_data>();
+    c->size({2, 4, 32, 32});
+    std::size_t n = 2 * 4 * 32 * 32;
+    double *v = (double *)std::malloc(n * sizeof(double));
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<double> dist(0, 1);
+    for (std::size_t i = 0; i < n; ++i) {
+        if (sparse && dist(gen) < 0.8) {
+            v[i] = NAN;
+        } else {
+            v[i] = f32 ? double(float(std::round(dist(gen) * 10000) / 10000)) : dist(gen);
+        }
+    }
+    c->buf(v);
+    return c;
+}
+
+static bool chunk_wire_equal(std::shared_ptr<chunk_data> a, std::shared_ptr<chunk_data> b) {
+    if (a->size() != b->size()) return false;
+    double *x = (double *)a->buf();
+    double *y = (double *)b->buf();
+    for (uint32_t i = 0; i < a->size()[0] * a->count_values(); ++i) {
+        if (!(x[i] == y[i] || (std::isnan(x[i]) && std::isnan(y[i])))) return false;
+    }
+    return true;
+}
+
+TEST_CASE("chunk_wire_roundtrip", "[chunk_wire]") {
+    for (uint8_t comp : {chunk_wire::NONE, chunk_wire::SHUFFLE_RLE, chunk_wire::SHUFFLE_DEFLATE}) {
+        for (bool sparse : {false, true}) {
+            for (bool f32 : {false, true}) {
+                std::shared_ptr<chunk_data> c = chunk_wire_test_chunk(sparse, f32);
+                std::vector<char> enc = chunk_wire::encode(c, comp);
+                REQUIRE(chunk_wire::is_encoded(enc.data(), enc.size()));
+                REQUIRE(chunk_wire_equal(c, chunk_wire::decode(enc.data(), enc.size())));
+                if (sparse) {
+                    // legacy format sends all values as float64
+                    REQUIRE(enc.size() * 3 < c->total_size_bytes());
+                }
+            }
+        }
+    }
+
+    // all NaN
+    std::shared_ptr<chunk_data> c = chunk_wire_test_chunk(false, true);
+    std::fill((double *)c->buf(), (double *)c->buf() + 2 * 4 * 32 * 32, NAN);
+    std::vector<char> enc = chunk_wire::encode(c, chunk_wire::SHUFFLE_RLE);
+    REQUIRE(enc.size() < 100);
+    REQUIRE(chunk_wire_equal(c, chunk_wire::decode(enc.data(), enc.size())));
+
+    // empty chunk
+    std::shared_ptr<chunk_data> e = std::make_shared<chunk_data>();
+    enc = chunk_wire::encode(e, chunk_wire::SHUFFLE_RLE);
+    REQUIRE(enc.size() == chunk_wire::HEADER_SIZE);
+    REQUIRE(chunk_wire::decode(enc.data(), enc.size())->empty());
+}
+
+TEST_CASE("chunk_wire_corrupt", "[chunk_wire]") {
+    std::shared_ptr<chunk_data> c = chunk_wire_test_chunk(true, true);
+    std::vector<char> enc = chunk_wire::encode(c, chunk_wire::SHUFFLE_RLE);
+    REQUIRE_THROWS(chunk_wire::decode(enc.data(), enc.size() - 1));
+    enc[6] = 7;  // unknown compression
+    REQUIRE_THROWS(chunk_wire::decode(enc.data(), enc.size()));
+    REQUIRE(!chunk_wire::is_encoded("GCW", 3));
+
+    std::vector<uint8_t> in = {1, 1, 1, 1, 2, 3, 3, 4, 4, 4};
+    std::vector<uint8_t> rle;
+    chunk_wire::rle_encode(in.data(), in.size(), rle);
+    std::vector<uint8_t> out(in.size());
+    REQUIRE(chunk_wire::rle_decode(rle.data(), rle.size(), out.data(), out.size()));
+    REQUIRE(in == out);
+    REQUIRE(!chunk_wire::rle_decode(rle.data(), rle.size() - 1, out.data(), out.size()));
+}
@@ -0,0 +1,112 @@
+/*
+    MIT License
+
+    Copyright (c) 2026 Marius Appel <marius.appel@uni-muenster.de>
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <thread>
+
+#include "../chunk_write_queue.h"
+#include "../external/catch.hpp"
+
+using namespace gdalcubes;
+
+TEST_CASE("chunk_write_queue_ordered", "[chunk_write_queue]") {
+    std::vector<chunkid_t> written;
+    chunk_write_queue q(8, true, [&written](chunk_write_job& job) {
+        written.push_back(job.id);
+    });
+    for (chunkid_t i = 0; i < 8; ++i) {
+        chunk_write_job job;
+        job.id = 7 - i;
+        job.packed.resize(1);
+        q.push(std::move(job));
+    }
+    q.finish();
+    REQUIRE(written.size() == 8);
+    for (uint32_t i = 0; i < written.size(); ++i) {
+        REQUIRE(written[i] == i);
+    }
+}
+
+TEST_CASE("chunk_write_queue_threads", "[chunk_write_queue]") {
+    uint32_t count = 0;
+    {
+        chunk_write_queue q(4, true, [&count](chunk_write_job& job) {
+            ++count;
+        });
+        std::vector<std::thread> workers;
+        for (uint16_t it = 0; it < 4; ++it) {
+            workers.push_back(std::thread([&q, it]() {
+                for (chunkid_t i = it; i < 100; i += 4) {
+                    chunk_write_job job;
+                    job.id = i;
+                    if (i % 10 != 0) job.packed.resize(1);  // some empty chunks
+                    q.push(std::move(job));
+                }
+            }));
+        }
+        for (uint16_t it = 0; it < 4; ++it) {
+            workers[it].join();
+        }
+    }
+    REQUIRE(count == 90);
+}
+
+TEST_CASE("chunk_write_queue_missing_chunk", "[chunk_write_queue]") {
+    // chunk 0 never arrives, writing must not block
+    std::vector<chunkid_t> written;
+    chunk_write_queue q(2, true, [&written](chunk_write_job& job) {
+        written.push_back(job.id);
+    });
+    for (chunkid_t i = 1; i < 10; ++i) {
+        chunk_write_job job;
+        job.id = i;
+        job.packed.resize(1);
+        q.push(std::move(job));
+    }
+    q.finish();
+    REQUIRE(written.size() == 9);
+}
+
+TEST_CASE("chunk_write_queue_error", "[chunk_write_queue]") {
+    // failures of the write function must be reported by finish()
+    uint32_t count = 0;
+    chunk_write_queue q(2, true, [&count](chunk_write_job& job) {
+        ++count;
+        if (job.id == 3) throw std::string("disk full");
+    });
+    for (chunkid_t i = 0; i < 10; ++i) {
+        chunk_write_job job;
+        job.id = i;
+        job.packed.resize(1);
+        q.push(std::move(job));
+    }
+    bool thrown = false;
+    try {
+        q.finish();
+    } catch (std::string s) {
+        thrown = true;
+        REQUIRE(s.find("disk full") != std::string::npos);
+    }
+    REQUIRE(thrown);
+    REQUIRE(count == 4);  // chunks after the failure are not written
+}
@@ -0,0 +1,128 @@
+/*
+    MIT License
+
+    Copyright (c) 2026 Marius Appel <marius.appel@uni-muenster.de>
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+#include <string>
+
+#include "../external/catch.hpp"
+#include "../gdalcubes.h"
+
+using namespace gdalcubes;
+
+// dummy cube whose second chunk cannot be computed
+class failing_dummy_cube : public dummy_cube {
+   public:
+    failing_dummy_cube(cube_view v, uint16_t nbands) : dummy_cube(v, nbands) {}
+    std::shared_ptr<chunk_data> read_chunk(chunkid_t id) override {
+        if (id == 1) throw std::string("ERROR in failing_dummy_cube::read_chunk(): chunk 1 cannot be computed");
+        return dummy_cube::read_chunk(id);
+    }
+};
+
+TEST_CASE("chunkstore_roundtrip", "[chunkstore]") {
+    cube_view r;
+    r.srs("EPSG:3857");
+    r.set_x_axis(-6180000.0, -6080000.0, 1000.0);
+    r.set_y_axis(-550000.0, -450000.0, 1000.0);
+    r.set_t_axis(datetime::from_string("2014-01-01"), datetime::from_string("2014-01-10"), duration::from_string("P1D"));
+
+    auto c = dummy_cube::create(r, 3, 2.0);
+    c->set_chunk_size(4, 32, 32);
+    std::string path = filesystem::join(filesystem::get_tempdir(), "test_chunkstore.gcbs");
+
+    SECTION("unpacked") {
+        c->write_chunkstore(path);
+        auto cs = chunkstore_cube::create(path);
+        REQUIRE(cs->bands().count() == 3);
+        REQUIRE(cs->count_chunks() == c->count_chunks());
+        REQUIRE(cs->size_x() == c->size_x());
+        REQUIRE(cs->size_t() == c->size_t());
+
+        // last chunk is smaller than the chunk size
+        std::shared_ptr<chunk_data> x = cs->read_chunk(cs->count_chunks() - 1);
+        REQUIRE(!x->empty());
+        REQUIRE(x->size()[0] == 3);
+        REQUIRE(x->size()[1] == 2);
+        REQUIRE(x->size()[3] == 4);
+        REQUIRE(((double *)x->buf())[0] == 2.0);
+
+        cs->select_bands({"band3", "band1"});
+        x = cs->read_chunk(0);
+        REQUIRE(x->size()[0] == 2);
+        REQUIRE(((double *)x->buf())[x->count_values()] == 2.0);
+    }
+
+    SECTION("packed_compressed") {
+        c->write_chunkstore(path, 6, packed_export::make_uint16(0.5, 0.0, 0));
+        auto cs = chunkstore_cube::create(path);
+        std::shared_ptr<chunk_data> x = cs->read_chunk(0);
+        REQUIRE(!x->empty());
+        REQUIRE(((double *)x->buf())[x->count_values() * 3 - 1] == 2.0);
+    }
+
+    filesystem::remove(path);
+}
+
+TEST_CASE("chunkstore_roundtrip_labeled_time", "[chunkstore]") {
+    cube_view r;
+    r.srs("EPSG:3857");
+    r.set_x_axis(-6180000.0, -6080000.0, 1000.0);
+    r.set_y_axis(-550000.0, -450000.0, 1000.0);
+    r.set_t_axis(datetime::from_string("2014-01-01"), datetime::from_string("2014-01-10"), duration::from_string("P1D"));
+
+    auto d = dummy_cube::create(r, 2, 3.0);
+    d->set_chunk_size(2, 32, 32);
+    auto c = select_time_cube::create(d, std::vector<std::string>{"2014-01-02", "2014-01-03", "2014-01-07"});
+    REQUIRE(!c->st_reference()->has_regular_time());
+    std::string path = filesystem::join(filesystem::get_tempdir(), "test_chunkstore_labeled.gcbs");
+
+    c->write_chunkstore(path);
+    auto cs = chunkstore_cube::create(path);
+    REQUIRE(!cs->st_reference()->has_regular_time());
+    REQUIRE(cs->size_t() == 3);
+    REQUIRE(cs->count_chunks() == c->count_chunks());
+    REQUIRE(cs->st_reference()->datetime_at_index(2).to_string() == "2014-01-07");
+
+    std::shared_ptr<chunk_data> x = cs->read_chunk(cs->count_chunks() - 1);
+    REQUIRE(!x->empty());
+    REQUIRE(((double *)x->buf())[0] == 3.0);
+
+    filesystem::remove(path);
+}
+
+TEST_CASE("chunkstore_failed_chunk", "[chunkstore]") {
+    cube_view r;
+    r.srs("EPSG:3857");
+    r.set_x_axis(-6180000.0, -6080000.0, 1000.0);
+    r.set_y_axis(-550000.0, -450000.0, 1000.0);
+    r.set_t_axis(datetime::from_string("2014-01-01"), datetime::from_string("2014-01-10"), duration::from_string("P1D"));
+
+    auto c = std::make_shared<failing_dummy_cube>(r, 2);
+    c->set_chunk_size(4, 32, 32);
+    std::string path = filesystem::join(filesystem::get_tempdir(), "test_chunkstore_failed.gcbs");
+
+    // the multithreaded chunk processor skips chunks that fail, the export must not look complete
+    REQUIRE_THROWS(c->write_chunkstore(path, 0, packed_export::make_none(), std::make_shared<chunk_processor_multithread>(2)));
+    REQUIRE_THROWS(chunkstore_cube::create(path));
+
+    filesystem::remove(path);
+}
@@ -0,0 +1,115 @@
+/*
+    MIT License
+
+    Copyright (c) 2026 Marius Appel <marius.appel@uni-muenster.de>
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "../cog_writer.h"
+#include "../external/catch.hpp"
+#include "../filesystem.h"
+
+using namespace gdalcubes;
+
+// Minimal reader for classic TIFF files in native byte order
+static std::vector<std::map<uint16_t, std::vector<uint32_t>>> read_ifds(const std::vector<char> &d) {
+    std::vector<std::map<uint16_t, std::vector<uint32_t>>> out;
+    uint32_t off;
+    std::memcpy(&off, d.data() + 4, 4);
+    while (off) {
+        uint16_t n;
+        std::memcpy(&n, d.data() + off, 2);
+        std::map<uint16_t, std::vector<uint32_t>> tags;
+        for (uint16_t i = 0; i < n; ++i) {
+            const char *e = d.data() + off + 2 + 12 * i;
+            uint16_t tag, type;
+            uint32_t count, pos;
+            std::memcpy(&tag, e, 2);
+            std::memcpy(&type, e + 2, 2);
+            std::memcpy(&count, e + 4, 4);
+            if (type != 3 && type != 4) continue;
+            uint32_t size = type == 3 ? 2 : 4;
+            pos = off + 2 + 12 * i + 8;
+            if (count * size > 4) std::memcpy(&pos, e + 8, 4);
+            for (uint32_t j = 0; j < count; ++j) {
+                uint32_t v = 0;
+                std::memcpy(&v, d.data() + pos + j * size, size);  // little endian host assumed
+                tags[tag].push_back(v);
+            }
+        }
+        out.push_back(tags);
+        std::memcpy(&off, d.data() + off + 2 + 12 * n, 4);
+    }
+    return out;
+}
+
+TEST_CASE("cog_writer_overviews", "[cog_writer]") {
+    std::string path = filesystem::join(filesystem::get_tempdir(), "test_cog_writer.tif");
+    uint32_t nx = 40, ny = 21;
+    double affine[6] = {0, 10, 0, 210, 0, -10};
+    REQUIRE(cog_writer::count_overviews(nx, ny, 16) == 2);
+
+    {
+        cog_writer w(path, nx, ny, {"band1"}, affine, 32632, false, packed_export::make_none(), 16, 0, "AVERAGE");
+        // write blocks of 7 x 5 pixels in reverse order
+        for (int32_t y0 = 20; y0 >= 0; y0 -= 5) {
+            for (int32_t x0 = 35; x0 >= 0; x0 -= 7) {
+                uint32_t w_ = std::min<uint32_t>(7, nx - x0), h_ = std::min<uint32_t>(5, ny - y0);
+                std::vector<double> buf(w_ * h_);
+                for (uint32_t y = 0; y < h_; ++y) {
+                    for (uint32_t x = 0; x < w_; ++x) {
+                        buf[y * w_ + x] = (y0 + y) * 100 + (x0 + x);
+                    }
+                }
+                w.write(buf.data(), buf.size(), x0, y0, w_, h_);
+            }
+        }
+        w.finish();
+    }
+
+    std::ifstream is(path, std::ios::binary);
+    std::vector<char> d((std::istreambuf_iterator<char>(is)), std::istreambuf_iterator<char>());
+    is.close();
+    std::vector<std::map<uint16_t, std::vector<uint32_t>>> ifds = read_ifds(d);
+    REQUIRE(ifds.size() == 3);
+    REQUIRE(ifds[0][256][0] == 40);
+    REQUIRE(ifds[0][257][0] == 21);
+    REQUIRE(ifds[1][256][0] == 20);
+    REQUIRE(ifds[2][257][0] == 6);
+    REQUIRE(ifds[2][254][0] == 1);
+
+    // first tile of the smallest overview precedes all other tile data
+    REQUIRE(ifds[2][324][0] < ifds[1][324][0]);
+    REQUIRE(ifds[1][324][0] < ifds[0][324][0]);
+
+    double v[2];
+    std::memcpy(v, d.data() + ifds[0][324][0] + 8 * 16, 16);  // second row of full resolution
+    REQUIRE(v[0] == 100);
+    REQUIRE(v[1] == 101);
+    std::memcpy(v, d.data() + ifds[1][324][0], 16);
+    REQUIRE(v[0] == Approx((0 + 1 + 100 + 101) / 4.0));
+    REQUIRE(v[1] == Approx((2 + 3 + 102 + 103) / 4.0));
+    filesystem::remove(path);
+}
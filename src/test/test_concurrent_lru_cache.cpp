@@ -0,0 +1,106 @@
+/*
+    MIT License
+
+    Copyright (c) 2026 Marius Appel <marius.appel@uni-muenster.de>
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../concurrent_lru_cache.h"
+#include "../external/catch.hpp"
+
+using namespace gdalcubes;
+
+namespace {
+struct string_weight {
+    uint64_t operator()(const std::string &s) const { return s.size(); }
+};
+}  // namespace
+
+TEST_CASE("concurrent_lru_cache_eviction", "[concurrent_lru_cache]") {
+    concurrent_lru_cache<int, std::string, string_weight> cache(10, 1);
+    REQUIRE(cache.put(1, "aaaa"));
+    REQUIRE(cache.put(2, "bbbb"));
+    REQUIRE(cache.size() == 8);
+
+    std::string v;
+    REQUIRE(cache.get(1, v));  // 2 becomes least recently used
+    REQUIRE(v == "aaaa");
+    REQUIRE(cache.put(3, "cccc"));
+    REQUIRE(!cache.contains(2));
+    REQUIRE(cache.contains(1));
+    REQUIRE(cache.size() == 8);
+    REQUIRE(cache.evictions() == 1);
+
+    // replacing entries accounts for the old weight
+    REQUIRE(cache.put(3, "cc"));
+    REQUIRE(cache.size() == 6);
+
+    REQUIRE(!cache.put(4, "too large value"));
+    REQUIRE(!cache.get(4, v));
+    REQUIRE(cache.hits() == 1);
+    REQUIRE(cache.misses() == 1);
+
+    cache.capacity(4);
+    REQUIRE(cache.count() == 1);
+    REQUIRE(cache.contains(3));
+    REQUIRE(cache.size() == 2);
+}
+
+TEST_CASE("concurrent_lru_cache_bounded", "[concurrent_lru_cache]") {
+    concurrent_lru_cache<int, std::string, string_weight> cache(1000, 8);
+    std::atomic<int> errors(0);  // Catch assertions are not thread-safe
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; ++t) {
+        threads.push_back(std::thread([&cache, &errors, t]() {
+            std::string v;
+            for (int i = 0; i < 2000; ++i) {
+                int key = (t * 7919 + i * 31) % 500;
+                if (!cache.get(key, v)) {
+                    cache.put(key, std::string(1 + key % 50, 'x'));
+                } else if (v.size() != std::size_t(1 + key % 50)) {
+                    ++errors;
+                }
+                if (cache.size() > 1000) {
+                    ++errors;
+                }
+            }
+        }));
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+    REQUIRE(errors == 0);
+    REQUIRE(cache.hits() + cache.misses() == 16000);
+    REQUIRE(cache.size() <= 1000);
+
+    uint64_t sum = 0;
+    for (int key = 0; key < 500; ++key) {
+        if (cache.contains(key)) sum += 1 + key % 50;
+    }
+    REQUIRE(sum == cache.size());
+    cache.clear();
+    REQUIRE(cache.size() == 0);
+    REQUIRE(cache.count() == 0);
+}
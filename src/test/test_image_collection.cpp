@@ -0,0 +1,110 @@
+/*
+    MIT License
+
+    Copyright (c) 2026 Marius Appel <marius.appel@uni-muenster.de>
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <gdal_priv.h>
+#include <ogr_spatialref.h>
+#include <sqlite3.h>
+
+#include <string>
+#include <vector>
+
+#include "../external/catch.hpp"
+#include "../gdalcubes.h"
+
+using namespace gdalcubes;
+
+// write a single band GeoTIFF with given size, filled with a constant value
+static void write_test_tif(std::string path, uint32_t size, double value) {
+    GDALDriver *drv = GetGDALDriverManager()->GetDriverByName("GTiff");
+    REQUIRE(drv != nullptr);
+    GDALDataset *ds = drv->Create(path.c_str(), size, size, 1, GDT_Byte, NULL);
+    REQUIRE(ds != nullptr);
+    double affine[6] = {7.0, 1.0 / size, 0.0, 52.0, 0.0, -1.0 / size};
+    ds->SetGeoTransform(affine);
+    OGRSpatialReference srs;
+    srs.SetFromUserInput("EPSG:4326");
+    char *wkt;
+    srs.exportToWkt(&wkt);
+    ds->SetProjection(wkt);
+    CPLFree(wkt);
+    ds->GetRasterBand(1)->Fill(value);
+    GDALClose((GDALDatasetH)ds);
+}
+
+TEST_CASE("image_collection_refresh", "[image_collection]") {
+    config::instance()->gdalcubes_init();
+
+    std::string dir = filesystem::join(filesystem::get_tempdir(), "test_image_collection_refresh");
+    if (!filesystem::exists(dir)) filesystem::mkdir(dir);
+    std::string f1 = filesystem::join(dir, "test_refresh_2020-01-01.tif");
+    std::string f2 = filesystem::join(dir, "test_refresh_2020-01-02.tif");
+    std::string f3 = filesystem::join(dir, "test_refresh_2020-01-03.tif");
+    std::string db = filesystem::join(dir, "test_refresh.db");
+    write_test_tif(f1, 4, 1);
+    write_test_tif(f2, 4, 2);
+    write_test_tif(f3, 4, 3);
+    if (filesystem::exists(db)) filesystem::remove(db);
+
+    collection_format fmt;
+    fmt.load_string(R"({
+        "pattern" : ".*test_refresh_.+\\.tif",
+        "images" : {"pattern" : ".*/(.+)\\.tif"},
+        "datetime" : {"pattern" : ".*test_refresh_(.{10})\\.tif", "format" : "%Y-%m-%d"},
+        "bands" : {"b1" : {"pattern" : ".+", "nodata" : 0}}
+    })");
+    image_collection::create(fmt, {f1, f2})->write(db);
+
+    {
+        // f2 has been removed, f3 is new, f1 is unchanged
+        image_collection ic(db);
+        ic.refresh({f1, f3});
+        REQUIRE(ic.count_images() == 2);
+        REQUIRE(ic.count_gdalrefs() == 2);
+
+        // descriptors are indexed to delete removed datasets efficiently
+        sqlite3_stmt *stmt;
+        sqlite3_prepare_v2(ic.get_db_handle(), "SELECT COUNT(*) FROM sqlite_master WHERE type='index' AND name='idx_gdalrefs_descriptor';", -1, &stmt, NULL);
+        REQUIRE(sqlite3_step(stmt) == SQLITE_ROW);
+        REQUIRE(sqlite3_column_int(stmt, 0) == 1);
+        sqlite3_finalize(stmt);
+    }
+
+    {
+        // modified datasets are replaced, unchanged datasets are kept
+        write_test_tif(f3, 8, 3);
+        image_collection ic(db);
+        ic.refresh({f1, f3});
+        REQUIRE(ic.count_images() == 2);
+        REQUIRE(ic.count_gdalrefs() == 2);
+        ic.refresh({f3});
+        REQUIRE(ic.count_images() == 1);
+        REQUIRE(ic.count_gdalrefs() == 1);
+    }
+
+    filesystem::remove(f1);
+    filesystem::remove(f2);
+    filesystem::remove(f3);
+    filesystem::remove(db);
+    filesystem::remove(dir);
+}
@@ -0,0 +1,76 @@
+/*
+    MIT License
+
+    Copyright (c) 2026 Marius Appel <marius.appel@uni-muenster.de>
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <string>
+#include <vector>
+
+#include "../config.h"
+#include "../error.h"
+#include "../external/catch.hpp"
+
+using namespace gdalcubes;
+
+static std::vector<std::string> test_logger_messages;
+static void test_logger_handler(error_level type, std::string msg, std::string where, int error_code) {
+    test_logger_messages.push_back(msg);
+}
+
+static uint32_t test_logger_evaluated = 0;
+static std::string test_logger_message(std::string msg) {
+    ++test_logger_evaluated;
+    return msg;
+}
+
+TEST_CASE("logger_lazy", "[logger]") {
+    error_action handler = config::instance()->get_error_handler();
+
+    config::instance()->set_error_handler(error_handler::default_error_handler);
+    REQUIRE(logger::level() == error_level::ERRLVL_WARNING);
+    REQUIRE(!logger::enabled(error_level::ERRLVL_DEBUG));
+    test_logger_evaluated = 0;
+    GCBS_TRACE(test_logger_message("trace"));
+    GCBS_DEBUG(test_logger_message("debug"));
+    REQUIRE(test_logger_evaluated == 0);  // disabled messages are never formatted
+
+    config::instance()->set_error_handler(test_logger_handler);
+    REQUIRE(logger::level() == error_level::ERRLVL_TRACE);
+    test_logger_messages.clear();
+    GCBS_TRACE(test_logger_message("trace"));
+    if (test_logger_messages.empty())
+        GCBS_WARN("warn");
+    else
+        GCBS_INFO("info");
+    REQUIRE(test_logger_evaluated == 1);
+    REQUIRE(test_logger_messages.size() == 2);
+    REQUIRE(test_logger_messages[0] == "trace");
+    REQUIRE(test_logger_messages[1] == "info");
+
+    logger::set_level(error_level::ERRLVL_ERROR);
+    GCBS_WARN("warn");
+    GCBS_ERROR("error");
+    REQUIRE(test_logger_messages.size() == 3);
+    REQUIRE(test_logger_messages[2] == "error");
+
+    config::instance()->set_error_handler(handler);
+}
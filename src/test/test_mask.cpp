@@ -0,0 +1,153 @@
+/*
+    MIT License
+
+    Copyright (c) 2026 Marius Appel <marius.appel@uni-muenster.de>
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <cmath>
+
+#include "../external/catch.hpp"
+#include "../image_collection_cube.h"
+
+using namespace gdalcubes;
+
+TEST_CASE("bitflag_mask", "[mask]") {
+    const uint32_t ny = 10, nx = 13, nb = 2;
+    std::vector<uint32_t> qa(ny * nx);
+    for (uint32_t i = 0; i < qa.size(); ++i) {
+        qa[i] = i % 4;  // 0, 1, 2, 3
+    }
+    std::vector<double> px(nb * ny * nx, 1.0);
+
+    // mask pixels with bit 1 set
+    bitflag_mask m({{2, 2}});
+    m.apply_uint32(qa.data(), nullptr, px.data(), nb, ny, nx);
+    for (uint32_t ib = 0; ib < nb; ++ib) {
+        for (uint32_t i = 0; i < qa.size(); ++i) {
+            REQUIRE(std::isnan(px[ib * ny * nx + i]) == ((qa[i] & 2) != 0));
+        }
+    }
+
+    // inverted, double input, two tests
+    std::vector<double> qd(qa.begin(), qa.end());
+    std::fill(px.begin(), px.end(), 1.0);
+    bitflag_mask m2({{3, 0}, {3, 3}}, true);
+    m2.apply(qd.data(), px.data(), nb, ny, nx);
+    for (uint32_t ib = 0; ib < nb; ++ib) {
+        for (uint32_t i = 0; i < qa.size(); ++i) {
+            REQUIRE(std::isnan(px[ib * ny * nx + i]) == (qa[i] == 1 || qa[i] == 2));
+        }
+    }
+}
+
+TEST_CASE("value_mask_bits", "[mask]") {
+    const uint32_t ny = 3, nx = 70, nb = 3;
+    std::vector<double> qd(ny * nx);
+    for (uint32_t i = 0; i < qd.size(); ++i) {
+        qd[i] = i % 8;
+    }
+    std::vector<double> px(nb * ny * nx, 1.0);
+    value_mask m({1}, false, {0, 2});  // (x & 5) == 1
+    m.apply(qd.data(), px.data(), nb, ny, nx);
+    for (uint32_t ib = 0; ib < nb; ++ib) {
+        for (uint32_t i = 0; i < qd.size(); ++i) {
+            REQUIRE(std::isnan(px[ib * ny * nx + i]) == ((((uint32_t)qd[i]) & 5) == 1));
+        }
+    }
+}
+
+TEST_CASE("value_mask_values", "[mask]") {
+    const uint32_t ny = 4, nx = 50, nb = 2;
+    std::vector<double> qd(ny * nx);
+    for (uint32_t i = 0; i < qd.size(); ++i) {
+        qd[i] = i % 20;
+    }
+
+    // few values are compared directly, many values use binary search
+    std::unordered_set<double> few = {3, 7, NAN};
+    std::unordered_set<double> many = {0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 100};
+    std::vector<double> px(nb * ny * nx, 1.0);
+    value_mask m1(few);
+    m1.apply(qd.data(), px.data(), nb, ny, nx);
+    for (uint32_t i = 0; i < qd.size(); ++i) {
+        REQUIRE(std::isnan(px[(nb - 1) * ny * nx + i]) == (qd[i] == 3 || qd[i] == 7));
+    }
+
+    std::fill(px.begin(), px.end(), 1.0);
+    value_mask m2(many, true);
+    m2.apply(qd.data(), px.data(), nb, ny, nx);
+    for (uint32_t i = 0; i < qd.size(); ++i) {
+        REQUIRE(std::isnan(px[i]) == (int(qd[i]) % 2 == 1));
+    }
+}
+
+TEST_CASE("mask_bits_out_of_range", "[mask]") {
+    REQUIRE_NOTHROW(value_mask({1}, false, {31}));
+    REQUIRE_THROWS(value_mask({1}, false, {32}));
+    REQUIRE_THROWS(range_mask(0, 1, false, {0, 40}));
+}
+
+TEST_CASE("mask_nodata", "[mask]") {
+    const uint32_t ny = 2, nx = 40, nb = 2;
+    std::vector<uint32_t> qa(ny * nx, 0);
+    std::vector<uint8_t> valid(ny * nx);
+    for (uint32_t i = 0; i < valid.size(); ++i) {
+        valid[i] = i % 3 == 0 ? 0 : 255;
+    }
+
+    // pixels without data never match, even if their value (0) would
+    std::vector<double> px(nb * ny * nx, 1.0);
+    bitflag_mask m({{1, 0}});
+    m.apply_uint32(qa.data(), valid.data(), px.data(), nb, ny, nx);
+    for (uint32_t i = 0; i < qa.size(); ++i) {
+        REQUIRE(std::isnan(px[ny * nx + i]) == (valid[i] != 0));
+    }
+
+    // ... and are hence masked by inverted masks
+    std::fill(px.begin(), px.end(), 1.0);
+    bitflag_mask m2({{1, 0}}, true);
+    m2.apply_uint32(qa.data(), valid.data(), px.data(), nb, ny, nx);
+    for (uint32_t i = 0; i < qa.size(); ++i) {
+        REQUIRE(std::isnan(px[i]) == (valid[i] == 0));
+    }
+
+    // NAN values of double mask bands are no data, also if bits are extracted
+    std::vector<double> qd(ny * nx, 0.0);
+    for (uint32_t i = 0; i < qd.size(); i += 3) qd[i] = NAN;
+    std::fill(px.begin(), px.end(), 1.0);
+    value_mask m3({0}, false, {0});
+    m3.apply(qd.data(), px.data(), nb, ny, nx);
+    for (uint32_t i = 0; i < qd.size(); ++i) {
+        REQUIRE(std::isnan(px[i]) == !std::isnan(qd[i]));
+    }
+    std::fill(px.begin(), px.end(), 1.0);
+    range_mask m4(0, 0, false, {0});
+    m4.apply(qd.data(), px.data(), nb, ny, nx);
+    for (uint32_t i = 0; i < qd.size(); ++i) {
+        REQUIRE(std::isnan(px[i]) == !std::isnan(qd[i]));
+    }
+    std::fill(px.begin(), px.end(), 1.0);
+    bitflag_mask m5({{1, 0}});
+    m5.apply(qd.data(), px.data(), nb, ny, nx);
+    for (uint32_t i = 0; i < qd.size(); ++i) {
+        REQUIRE(std::isnan(px[i]) == !std::isnan(qd[i]));
+    }
+}
@@ -0,0 +1,67 @@
+/*
+    MIT License
+
+    Copyright (c) 2026 Marius Appel <marius.appel@uni-muenster.de>
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+#include <cmath>
+#include <vector>
+
+#include "../external/catch.hpp"
+#include "../packing.h"
+
+using namespace gdalcubes;
+
+TEST_CASE("packing_kernels_pack", "[packing]") {
+    std::vector<double> in = {0.0, 2.5, -2.5, 0.49999999999999994, 1e10, -1e10, NAN, 254.6};
+    std::vector<uint8_t> out_u8(in.size());
+    packing_kernels::pack(packed_export::packing_type::PACK_UINT8, in.data(), out_u8.data(), in.size(), 1.0, 0.0, 255);
+    REQUIRE(out_u8 == std::vector<uint8_t>({0, 3, 0, 0, 255, 0, 255, 255}));
+
+    std::vector<int16_t> out_i16(in.size());
+    packing_kernels::pack(packed_export::packing_type::PACK_INT16, in.data(), out_i16.data(), in.size(), 0.5, 1.0, -32768);
+    REQUIRE(out_i16 == std::vector<int16_t>({-2, 3, -7, -1, 32767, -32768, -32768, 507}));
+
+    std::vector<float> out_f32(in.size());
+    packing_kernels::pack(packed_export::packing_type::PACK_FLOAT32, in.data(), out_f32.data(), in.size(), 0.5, 1.0, 0);
+    REQUIRE(out_f32[1] == 2.5f);
+    REQUIRE(std::isnan(out_f32[6]));
+}
+
+TEST_CASE("packing_kernels_roundtrip", "[packing]") {
+    packed_export p = packed_export::make_uint16({0.01, 0.1}, {0.0, -100.0}, {0, 65535});
+    std::vector<double> in = {1.23, NAN, 42.0, 100.0, NAN, 12.3};
+    std::vector<uint16_t> packed(in.size());
+    packing_kernels::pack_band(p, 0, in.data(), packed.data(), 3);
+    packing_kernels::pack_band(p, 1, in.data() + 3, packed.data() + 3, 3);
+    REQUIRE(packing_kernels::value_size(p.type) == 2);
+    REQUIRE(packed[1] == 0);
+    REQUIRE(packed[4] == 65535);
+
+    std::vector<double> out(in.size());
+    packing_kernels::unpack(p.type, packed.data(), out.data(), 3, 0.01, 0.0, 0);
+    packing_kernels::unpack(p.type, packed.data() + 3, out.data() + 3, 3, 0.1, -100.0, 65535);
+    REQUIRE(out[0] == Approx(1.23));
+    REQUIRE(std::isnan(out[1]));
+    REQUIRE(out[2] == Approx(42.0));
+    REQUIRE(out[3] == Approx(100.0));
+    REQUIRE(std::isnan(out[4]));
+    REQUIRE(out[5] == Approx(12.3));
+}
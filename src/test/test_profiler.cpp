@@ -0,0 +1,91 @@
+/*
+    MIT License
+
+    Copyright (c) 2026 Marius Appel <marius.appel@uni-muenster.de>
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <string>
+
+#include "../external/catch.hpp"
+#include "../gdalcubes.h"
+
+using namespace gdalcubes;
+
+TEST_CASE("profiler", "[profiler]") {
+    cube_view r;
+    r.srs("EPSG:3857");
+    r.set_x_axis(-6180000.0, -6080000.0, 1000.0);
+    r.set_y_axis(-550000.0, -450000.0, 1000.0);
+    r.set_t_axis(datetime::from_string("2014-01-01"), datetime::from_string("2014-01-10"), duration::from_string("P1D"));
+
+    auto c = dummy_cube::create(r, 1, 2.0);
+    c->set_chunk_size(4, 32, 32);
+    auto cr = reduce_time_cube::create(c, {{"mean", "band1"}});
+
+    profiler::reset();
+    cr->read_chunk(0);
+    REQUIRE(profiler::get(cr.get()).calls == 0);  // disabled by default
+
+    profiler::enable();
+    cr->read_chunk(0);
+    cr->read_chunk(1);
+    cr->read_chunk(cr->count_chunks());  // out of range, empty
+    profiler::enable(false);
+
+    profiler::cube_stats s = profiler::get(cr.get());
+    REQUIRE(s.calls == 3);
+    REQUIRE(s.empty == 1);
+    REQUIRE(s.bytes > 0);
+    REQUIRE(s.wall <= s.wall_total);
+
+    profiler::cube_stats s_in = profiler::get(c.get());
+    REQUIRE(s_in.calls > 0);
+    REQUIRE(s_in.wall_total <= s.wall_total);
+
+    json11::Json j = profiler::report(cr);
+    REQUIRE(j["cube_type"].string_value() == "reduce_time");
+    REQUIRE(j["profile"]["calls"].number_value() == 3);
+    REQUIRE(j["in_cube"]["cube_type"].string_value() == "dummy");
+    REQUIRE(j["in_cube"]["profile"]["calls"].number_value() == s_in.calls);
+    REQUIRE(j["in_cube"]["in_cube"].is_null());
+
+    profiler::reset();
+    REQUIRE(profiler::get(cr.get()).calls == 0);
+}
+
+TEST_CASE("profiler_destructed_cube", "[profiler]") {
+    cube_view r;
+    r.srs("EPSG:3857");
+    r.set_x_axis(-6180000.0, -6080000.0, 1000.0);
+    r.set_y_axis(-550000.0, -450000.0, 1000.0);
+    r.set_t_axis(datetime::from_string("2014-01-01"), datetime::from_string("2014-01-10"), duration::from_string("P1D"));
+
+    // statistics of destructed cubes must not be kept or inherited by new cubes at the same address
+    profiler::reset();
+    profiler::enable();
+    auto c = dummy_cube::create(r, 1, 2.0);
+    const cube *addr = c.get();
+    c->read_chunk(0);
+    REQUIRE(profiler::get(addr).calls == 1);
+    c.reset();
+    profiler::enable(false);
+    REQUIRE(profiler::get(addr).calls == 0);
+}
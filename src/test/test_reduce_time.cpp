@@ -0,0 +1,54 @@
+/*
+    MIT License
+
+    Copyright (c) 2026 Marius Appel <marius.appel@uni-muenster.de>
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <string>
+
+#include "../external/catch.hpp"
+#include "../gdalcubes.h"
+
+using namespace gdalcubes;
+
+TEST_CASE("reduce_time_fused", "[reduce_time]") {
+    cube_view r;
+    r.srs("EPSG:3857");
+    r.set_x_axis(-6180000.0, -6080000.0, 1000.0);
+    r.set_y_axis(-550000.0, -450000.0, 1000.0);
+    r.set_t_axis(datetime::from_string("2014-01-01"), datetime::from_string("2014-01-10"), duration::from_string("P1D"));
+
+    auto c = dummy_cube::create(r, 1, 2.0);
+    auto cr = reduce_time_cube::create(c, {{"mean", "band1"}, {"sd", "band1"}, {"count", "band1"}, {"min", "band1"}, {"max", "band1"}, {"sum", "band1"}, {"median", "band1"}});
+    REQUIRE(cr->bands().count() == 7);
+
+    std::shared_ptr<chunk_data> x = cr->read_chunk(0);
+    REQUIRE(!x->empty());
+    uint32_t nxy = x->size()[2] * x->size()[3];
+    double *v = (double *)x->buf();
+    REQUIRE(v[0 * nxy] == 2.0);
+    REQUIRE(v[1 * nxy] == 0.0);
+    REQUIRE(v[2 * nxy] == 10.0);
+    REQUIRE(v[3 * nxy] == 2.0);
+    REQUIRE(v[4 * nxy] == 2.0);
+    REQUIRE(v[5 * nxy] == 20.0);
+    REQUIRE(v[6 * nxy] == 2.0);
+}
@@ -0,0 +1,102 @@
+/*
+    MIT License
+
+    Copyright (c) 2026 Marius Appel <marius.appel@uni-muenster.de>
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <cstring>
+#include <fstream>
+#include <string>
+
+#include "../external/catch.hpp"
+#include "../filesystem.h"
+#include "../stream_transport.h"
+
+using namespace gdalcubes;
+
+static void stream_transport_roundtrip(bool shm) {
+    config::instance()->set_streaming_dir(filesystem::get_tempdir());
+    config::instance()->set_streaming_shm(shm);
+
+    int size[] = {2, 1, 2, 3};
+    std::vector<std::string> band_names = {"B04", "B08"};
+    double dims[] = {17000, 10.5, 9.5, 0.5, 1.5, 2.5};
+    double data[12];
+    for (int i = 0; i < 12; ++i) data[i] = i;
+
+    std::string in_path, out_path;
+    {
+        stream_transport transport(1);
+        transport.write_input(size, band_names, dims, "EPSG:4326", data);
+        in_path = transport.input_path();
+        out_path = transport.output_path();
+
+        // check input layout and act as external program returning the second band only
+        std::ifstream fin(in_path, std::ios::in | std::ios::binary);
+        REQUIRE(fin.is_open());
+        int in_size[4];
+        fin.read((char *)in_size, 4 * sizeof(int));
+        REQUIRE(std::memcmp(in_size, size, 4 * sizeof(int)) == 0);
+        for (uint16_t i = 0; i < 2; ++i) {
+            int n;
+            fin.read((char *)&n, sizeof(int));
+            std::string name(n, ' ');
+            fin.read(&name[0], n);
+            REQUIRE(name == band_names[i]);
+        }
+        double in_dims[6];
+        fin.read((char *)in_dims, 6 * sizeof(double));
+        REQUIRE(in_dims[5] == 2.5);
+        int n;
+        fin.read((char *)&n, sizeof(int));
+        std::string srs(n, ' ');
+        fin.read(&srs[0], n);
+        REQUIRE(srs == "EPSG:4326");
+        double in_data[12];
+        fin.read((char *)in_data, 12 * sizeof(double));
+        REQUIRE(in_data[11] == 11);
+
+        std::ofstream fout(out_path, std::ios::out | std::ios::binary | std::ios::trunc);
+        int out_size[] = {1, 1, 2, 3};
+        fout.write((char *)out_size, 4 * sizeof(int));
+        fout.write((char *)(in_data + 6), 6 * sizeof(double));
+        fout.close();
+
+        std::shared_ptr<chunk_data> out = transport.read_output();
+        REQUIRE(out->size()[0] == 1);
+        REQUIRE(out->size()[3] == 3);
+        for (int i = 0; i < 6; ++i) {
+            REQUIRE(((double *)out->buf())[i] == 6 + i);
+        }
+        ((double *)out->buf())[0] = -1;  // chunk buffers must be writable
+    }
+    REQUIRE(!filesystem::exists(in_path));
+    REQUIRE(!filesystem::exists(out_path));
+}
+
+TEST_CASE("stream_transport_files", "[stream_transport]") {
+    stream_transport_roundtrip(false);
+}
+
+TEST_CASE("stream_transport_shared_memory", "[stream_transport]") {
+    stream_transport_roundtrip(true);
+    config::instance()->set_streaming_shm(false);
+}
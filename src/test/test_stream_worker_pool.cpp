@@ -0,0 +1,99 @@
+/*
+    MIT License
+
+    Copyright (c) 2026 Marius Appel <marius.appel@uni-muenster.de>
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+#include <chrono>
+#include <fstream>
+#include <string>
+
+#include "../external/catch.hpp"
+#include "../config.h"
+#include "../filesystem.h"
+#include "../stream_worker_pool.h"
+
+using namespace gdalcubes;
+
+#ifndef _WIN32
+TEST_CASE("stream_worker_pool_persistent", "[stream_worker_pool]") {
+    // a worker that copies input to output files and logs some noise on stdout
+    std::string cmd =
+        "sh -c 'while IFS=$(printf \"\\t\") read -r tag id fin fout; do "
+        "echo \"processing $id\"; cp \"$fin\" \"$fout\"; printf \"GDALCUBES_DONE\\t%s\\t0\\n\" \"$id\"; done'";
+    stream_worker_pool pool(cmd, 2);
+    for (chunkid_t id = 0; id < 6; ++id) {
+        std::string f_in = filesystem::join(filesystem::get_tempdir(), "test_stream_worker_" + std::to_string(id) + "_in");
+        std::string f_out = filesystem::join(filesystem::get_tempdir(), "test_stream_worker_" + std::to_string(id) + "_out");
+        {
+            std::ofstream os(f_in);
+            os << "chunk" << id;
+        }
+        std::string errstr;
+        REQUIRE(pool.run(id, f_in, f_out, errstr) == 0);
+        std::ifstream is(f_out);
+        std::string content;
+        is >> content;
+        REQUIRE(content == "chunk" + std::to_string(id));
+        filesystem::remove(f_in);
+        filesystem::remove(f_out);
+    }
+}
+
+TEST_CASE("stream_worker_pool_failure", "[stream_worker_pool]") {
+    std::string errstr;
+    stream_worker_pool reporting("sh -c 'while read -r line; do printf \"GDALCUBES_DONE\\t0\\t5\\tinvalid input\\n\"; done'", 1);
+    REQUIRE(reporting.run(0, "in", "out", errstr) == 5);
+    REQUIRE(errstr == "invalid input");
+
+    // workers that die are restarted once, afterwards the exit status is returned
+    stream_worker_pool dying("sh -c 'exit 7'", 1);
+    REQUIRE(dying.run(0, "in", "out", errstr) == 7);
+
+    // worker dies after receiving the request
+    stream_worker_pool dying_read("sh -c 'read -r line; exit 7'", 1);
+    REQUIRE(dying_read.run(0, "in", "out", errstr) == 7);
+
+    // request cannot be written, since the worker closed its input before exiting
+    stream_worker_pool dying_closed("sh -c 'exec 0<&-; sleep 0.5; exit 7'", 1);
+    REQUIRE(dying_closed.run(0, "in", "out", errstr) == 7);
+}
+
+TEST_CASE("stream_worker_pool_timeout", "[stream_worker_pool]") {
+    uint32_t timeout = config::instance()->get_streaming_worker_timeout();
+    config::instance()->set_streaming_worker_timeout(1);
+    std::string errstr;
+    stream_worker_pool silent("sh -c 'while read -r line; do :; done'", 1);
+    auto start = std::chrono::steady_clock::now();
+    int status = silent.run(0, "in", "out", errstr);
+    config::instance()->set_streaming_worker_timeout(timeout);
+    REQUIRE(status == -1);
+    REQUIRE(errstr.find("did not respond") != std::string::npos);
+    REQUIRE(std::chrono::steady_clock::now() - start < std::chrono::seconds(10));
+}
+
+TEST_CASE("stream_worker_pool_wrong_id", "[stream_worker_pool]") {
+    // responses for other chunks are not accepted
+    std::string errstr;
+    stream_worker_pool confused("sh -c 'while read -r line; do printf \"GDALCUBES_DONE\\t99\\t0\\n\"; done'", 1);
+    REQUIRE(confused.run(3, "in", "out", errstr) == -1);
+    REQUIRE(errstr.find("chunk id '99'") != std::string::npos);
+}
+#endif
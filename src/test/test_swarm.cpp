@@ -0,0 +1,326 @@
+/*
+    MIT License
+
+    Copyright (c) 2026 Marius Appel <marius.appel@uni-muenster.de>
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#ifndef GDALCUBES_NO_SWARM
+#ifndef _WIN32
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "../external/catch.hpp"
+#include "../filesystem.h"
+#include "../swarm.h"
+
+using namespace gdalcubes;
+
+/**
+ * Minimal HTTP/1.1 server on localhost that records request lines and answers each request
+ * with status code and body from a handler function, connections are handled one after another
+ */
+class mock_http_server {
+   public:
+    mock_http_server(std::function<std::pair<int, std::string>(std::string)> handler) : _handler(handler), _fd(-1), _port(0), _stop(false), _requests(), _mutex(), _thread() {
+        _fd = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr;
+        std::memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = 0;
+        socklen_t len = sizeof(addr);
+        if (_fd < 0 || bind(_fd, (sockaddr *)&addr, sizeof(addr)) != 0 || listen(_fd, 16) != 0 || getsockname(_fd, (sockaddr *)&addr, &len) != 0) {
+            throw std::string("mock_http_server: cannot listen on localhost");
+        }
+        _port = ntohs(addr.sin_port);
+        _thread = std::thread(&mock_http_server::run, this);
+    }
+
+    ~mock_http_server() {
+        _stop = true;
+        _thread.join();
+        close(_fd);
+    }
+
+    std::string url() { return "http://127.0.0.1:" + std::to_string(_port); }
+
+    std::vector<std::string> requests() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _requests;
+    }
+
+   private:
+    void run() {
+        while (!_stop) {
+            pollfd p;
+            p.fd = _fd;
+            p.events = POLLIN;
+            if (poll(&p, 1, 20) <= 0) continue;
+            int c = accept(_fd, nullptr, nullptr);
+            if (c < 0) continue;
+            serve(c);
+            close(c);
+        }
+    }
+
+    void serve(int c) {
+        // read header and body according to Content-Length
+        std::string in;
+        char buf[4096];
+        std::size_t header_end = std::string::npos;
+        std::size_t content_length = 0;
+        while (true) {
+            if (header_end != std::string::npos && in.size() >= header_end + 4 + content_length) break;
+            ssize_t n = recv(c, buf, sizeof(buf), 0);
+            if (n <= 0) return;
+            in.append(buf, n);
+            if (header_end == std::string::npos && (header_end = in.find("\r\n\r\n")) != std::string::npos) {
+                std::string header = in.substr(0, header_end);
+                std::transform(header.begin(), header.end(), header.begin(), ::tolower);
+                std::size_t pos = header.find("content-length:");
+                if (pos != std::string::npos) content_length = std::stoul(header.substr(pos + 15));
+            }
+        }
+        std::string line = in.substr(0, in.find("\r\n"));
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _requests.push_back(line);
+        }
+        std::pair<int, std::string> res = _handler(line);
+        std::string out = "HTTP/1.1 " + std::to_string(res.first) + " X\r\nContent-Length: " + std::to_string(res.second.size()) + "\r\nConnection: close\r\n\r\n";
+        if (line.compare(0, 5, "HEAD ") != 0) out += res.second;
+        send(c, out.data(), out.size(), 0);
+    }
+
+    std::function<std::pair<int, std::string>(std::string)> _handler;
+    int _fd;
+    uint16_t _port;
+    std::atomic<bool> _stop;
+    std::vector<std::string> _requests;
+    std::mutex _mutex;
+    std::thread _thread;
+};
+
+// creates a directory with a few files and makes it the working directory while in scope
+class temp_working_dir {
+   public:
+    temp_working_dir(std::string name, std::vector<std::string> files) : _old(filesystem::get_working_dir()), _dir(filesystem::join(filesystem::get_tempdir(), name)), _files() {
+        filesystem::mkdir(_dir);
+        for (uint16_t i = 0; i < files.size(); ++i) {
+            _files.push_back(filesystem::join(_dir, files[i]));
+            std::ofstream f(_files.back());
+            f << "test";
+        }
+        REQUIRE(chdir(_dir.c_str()) == 0);
+    }
+    ~temp_working_dir() {
+        if (chdir(_old.c_str()) == 0) {
+            for (uint16_t i = 0; i < _files.size(); ++i) {
+                filesystem::remove(_files[i]);
+            }
+            filesystem::remove(_dir);
+        }
+    }
+
+   private:
+    std::string _old;
+    std::string _dir;
+    std::vector<std::string> _files;
+};
+
+TEST_CASE("swarm_multi_requests", "[swarm]") {
+    mock_http_server server([](std::string line) { return std::make_pair(200, line.substr(0, line.find(' '))); });
+    swarm_multi m(1, 2);
+    std::vector<std::string> responses;
+    for (uint16_t i = 0; i < 3; ++i) {
+        std::shared_ptr<swarm_request> r = std::make_shared<swarm_request>();
+        r->url = server.url() + "/cube/" + std::to_string(i);
+        r->method = "POST";
+        r->body = "{}";
+        r->callback = [&m, &responses, &server](std::shared_ptr<swarm_request> r) {
+            REQUIRE(r->ok());
+            responses.push_back(r->response_string());
+            if (responses.size() == 1) {
+                // callbacks may add further requests
+                std::shared_ptr<swarm_request> g = std::make_shared<swarm_request>();
+                g->url = server.url() + "/version";
+                g->callback = [&responses](std::shared_ptr<swarm_request> g) {
+                    responses.push_back(g->response_string());
+                };
+                m.add(g);
+            }
+        };
+        m.add(r);
+    }
+    m.run();
+    REQUIRE(responses.size() == 4);
+    REQUIRE(std::count(responses.begin(), responses.end(), "POST") == 3);
+    REQUIRE(std::count(responses.begin(), responses.end(), "GET") == 1);
+}
+
+TEST_CASE("swarm_push_execution_context_urlencode", "[swarm]") {
+    temp_working_dir wd("test_swarm_urlencode", {"a b&c=d.txt"});
+    mock_http_server server([](std::string line) { return std::make_pair(200, std::string()); });
+    gdalcubes_swarm swarm({server.url()});
+    swarm.push_execution_context(false);
+
+    std::vector<std::string> req = server.requests();
+    REQUIRE(req.size() == 1);
+    REQUIRE(req[0].compare(0, 15, "HEAD /file?name") == 0);
+    REQUIRE(req[0].find("a%20b%26c%3Dd.txt&size=4 ") != std::string::npos);
+}
+
+TEST_CASE("swarm_push_execution_context_abort", "[swarm]") {
+    // the first failed request cancels all outstanding requests
+    temp_working_dir wd("test_swarm_abort", {"f1.txt", "f2.txt", "f3.txt", "f4.txt", "f5.txt"});
+    mock_http_server server([](std::string line) { return std::make_pair(500, std::string()); });
+    uint16_t max_requests = config::instance()->get_swarm_max_requests_per_server();
+    config::instance()->set_swarm_max_requests_per_server(1);
+    gdalcubes_swarm swarm({server.url()});
+    REQUIRE_THROWS(swarm.push_execution_context(false));
+    config::instance()->set_swarm_max_requests_per_server(max_requests);
+    REQUIRE(server.requests().size() == 1);
+}
+
+// request set that only records requests, tests complete them by calling callbacks directly
+class fake_swarm_multi : public swarm_multi {
+   public:
+    fake_swarm_multi(uint16_t nservers) : swarm_multi(nservers, 1), requests(), stopped(false) {}
+    void add(std::shared_ptr<swarm_request> r) override { requests.push_back(r); }
+    void stop() override { stopped = true; }
+
+    // complete the oldest request with given HTTP status code
+    void complete(long code) {
+        std::shared_ptr<swarm_request> r = requests.front();
+        requests.pop_front();
+        r->result = CURLE_OK;
+        r->response_code = code;
+        r->callback(r);
+    }
+
+    std::deque<std::shared_ptr<swarm_request>> requests;
+    bool stopped;
+};
+
+static std::shared_ptr<swarm_request> make_fake_request(std::string what, chunkid_t id, uint16_t is) {
+    std::shared_ptr<swarm_request> r = std::make_shared<swarm_request>();
+    r->server_index = is;
+    r->url = what + "/" + std::to_string(id);
+    return r;
+}
+
+TEST_CASE("swarm_scheduler_failures", "[swarm]") {
+    // server 1 fails all requests, its chunks are reassigned to server 0 and it is retired after three failures
+    uint16_t chunks_per_server = config::instance()->get_swarm_chunks_per_server();
+    config::instance()->set_swarm_chunks_per_server(1);
+    fake_swarm_multi m(2);
+    std::vector<chunkid_t> chunks = {0, 1, 2, 3, 4, 5};
+    std::vector<chunkid_t> delivered;
+    swarm_scheduler s(
+        m, {"s0", "s1"}, chunks,
+        [](chunkid_t id, uint16_t is) { return make_fake_request("start", id, is); },
+        [](chunkid_t id, uint16_t is) { return make_fake_request("download", id, is); },
+        [&delivered](chunkid_t id, std::shared_ptr<swarm_request> d) { delivered.push_back(id); });
+    s.start();
+    uint32_t nrequests_s1 = 0;
+    while (!m.requests.empty() && !m.stopped) {
+        if (m.requests.front()->server_index == 1) {
+            ++nrequests_s1;
+            m.complete(500);
+        } else {
+            m.complete(200);
+        }
+    }
+    config::instance()->set_swarm_chunks_per_server(chunks_per_server);
+
+    REQUIRE(s.error().empty());
+    REQUIRE(s.complete());
+    REQUIRE(m.stopped);
+    REQUIRE(nrequests_s1 == 3);
+    std::sort(delivered.begin(), delivered.end());
+    REQUIRE(delivered == chunks);
+}
+
+TEST_CASE("swarm_scheduler_all_servers_fail", "[swarm]") {
+    fake_swarm_multi m(2);
+    swarm_scheduler s(
+        m, {"s0", "s1"}, {0, 1, 2},
+        [](chunkid_t id, uint16_t is) { return make_fake_request("start", id, is); },
+        [](chunkid_t id, uint16_t is) { return make_fake_request("download", id, is); },
+        [](chunkid_t id, std::shared_ptr<swarm_request> d) {});
+    s.start();
+    while (!m.requests.empty() && !m.stopped) {
+        m.complete(503);
+    }
+    REQUIRE(m.stopped);
+    REQUIRE(!s.error().empty());
+    REQUIRE(!s.complete());
+}
+
+TEST_CASE("swarm_scheduler_speculation", "[swarm]") {
+    // a slow chunk is executed on an idle server, the first delivered copy is used
+    uint16_t chunks_per_server = config::instance()->get_swarm_chunks_per_server();
+    config::instance()->set_swarm_chunks_per_server(1);
+    fake_swarm_multi m(2);
+    std::vector<chunkid_t> delivered;
+    swarm_scheduler s(
+        m, {"s0", "s1"}, {0, 1},
+        [](chunkid_t id, uint16_t is) { return make_fake_request("start", id, is); },
+        [](chunkid_t id, uint16_t is) { return make_fake_request("download", id, is); },
+        [&delivered](chunkid_t id, std::shared_ptr<swarm_request> d) { delivered.push_back(id); });
+    s.start();
+    REQUIRE(m.requests.size() == 2);
+    std::shared_ptr<swarm_request> slow = m.requests.back();  // start of chunk 1 on server 1
+    m.requests.pop_back();
+    m.complete(200);  // start of chunk 0
+    m.complete(200);  // download of chunk 0
+    REQUIRE(delivered.size() == 1);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    s.tick();
+    REQUIRE(m.requests.size() == 1);
+    REQUIRE(m.requests.front()->server_index == 0);
+    REQUIRE(m.requests.front()->url == "start/1");
+    m.complete(200);
+    m.complete(200);
+    config::instance()->set_swarm_chunks_per_server(chunks_per_server);
+
+    REQUIRE(s.complete());
+    REQUIRE(m.stopped);
+    REQUIRE(delivered.size() == 2);
+    REQUIRE(delivered[1] == 1);
+    (void)slow;
+}
+
+#endif  // _WIN32
+#endif  // GDALCUBES_NO_SWARM
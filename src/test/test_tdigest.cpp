@@ -0,0 +1,63 @@
+/*
+    MIT License
+
+    Copyright (c) 2026 Marius Appel <marius.appel@uni-muenster.de>
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+#include "../external/catch.hpp"
+#include "../tdigest.h"
+
+using namespace gdalcubes;
+
+TEST_CASE("tdigest_exact_small", "[tdigest]") {
+    tdigest s;
+    REQUIRE(std::isnan(s.quantile(0.5)));
+    s.add(3);
+    s.add(1);
+    s.add(2);
+    s.add(10);
+    REQUIRE(s.quantile(0.5) == 2.5);
+    REQUIRE(s.quantile(0.25) == 1.75);
+    REQUIRE(s.quantile(0) == 1);
+    REQUIRE(s.quantile(1) == 10);
+}
+
+TEST_CASE("tdigest_large", "[tdigest]") {
+    std::vector<double> v;
+    for (uint32_t i = 1; i <= 100000; ++i) v.push_back(i);
+    std::mt19937 g(42);
+    std::shuffle(v.begin(), v.end(), g);
+
+    tdigest s;
+    for (uint32_t i = 0; i < v.size(); ++i) {
+        s.add(v[i]);
+    }
+    REQUIRE(s.count() == 100000);
+    REQUIRE(s.quantile(0) == 1);
+    REQUIRE(s.quantile(1) == 100000);
+    REQUIRE(std::fabs(s.quantile(0.5) - 50000) < 500);
+    REQUIRE(std::fabs(s.quantile(0.25) - 25000) < 500);
+    REQUIRE(std::fabs(s.quantile(0.75) - 75000) < 500);
+}
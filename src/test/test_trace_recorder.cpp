@@ -0,0 +1,122 @@
+/*
+    MIT License
+
+    Copyright (c) 2026 Marius Appel <marius.appel@uni-muenster.de>
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../external/catch.hpp"
+#include "../external/json11/json11.hpp"
+#include "../filesystem.h"
+#include "../trace_recorder.h"
+
+using namespace gdalcubes;
+
+TEST_CASE("trace_recorder", "[trace_recorder]") {
+    trace_recorder::stop();
+    {
+        trace_span s("disabled", "test", 0);
+    }
+
+    trace_recorder::start(8);
+    REQUIRE(trace_recorder::count() == 0);
+    std::vector<std::thread> threads;
+    for (uint16_t it = 0; it < 2; ++it) {
+        threads.push_back(std::thread([it]() {
+            trace_recorder::thread_name("test_worker");
+            for (uint32_t i = 0; i < 10; ++i) {
+                trace_span s("span", "test", it * 100 + i);
+            }
+            trace_recorder::instant("instant", "test");
+        }));
+    }
+    for (uint16_t it = 0; it < threads.size(); ++it) {
+        threads[it].join();
+    }
+    trace_recorder::stop();
+    {
+        trace_span s("stopped", "test", 0);
+    }
+    REQUIRE(trace_recorder::count() == 16);  // ring buffers keep the 8 most recent events per thread
+
+    std::string path = filesystem::join(filesystem::get_tempdir(), "test_trace_recorder.json");
+    trace_recorder::write(path);
+    std::ifstream is(path);
+    std::stringstream buf;
+    buf << is.rdbuf();
+    std::string err;
+    json11::Json j = json11::Json::parse(buf.str(), err);
+    REQUIRE(err.empty());
+
+    uint32_t nspan = 0, ninstant = 0, nthreadname = 0;
+    for (const json11::Json &e : j["traceEvents"].array_items()) {
+        REQUIRE(e["name"].string_value() != "disabled");
+        REQUIRE(e["name"].string_value() != "stopped");
+        if (e["ph"].string_value() == "X") {
+            ++nspan;
+            REQUIRE(e["dur"].number_value() >= 0);
+            REQUIRE(int(e["args"]["chunk"].number_value()) % 100 >= 3);  // oldest events have been overwritten
+        } else if (e["ph"].string_value() == "i") {
+            ++ninstant;
+        } else if (e["name"].string_value() == "thread_name") {
+            ++nthreadname;
+            REQUIRE(e["args"]["name"].string_value() == "test_worker");
+        }
+    }
+    REQUIRE(nspan == 14);
+    REQUIRE(ninstant == 2);
+    REQUIRE(nthreadname == 2);
+    filesystem::remove(path);
+}
+
+TEST_CASE("trace_recorder_stop_concurrent", "[trace_recorder]") {
+    std::string path = filesystem::join(filesystem::get_tempdir(), "test_trace_recorder_concurrent.json");
+    trace_recorder::start(64);
+    REQUIRE_THROWS(trace_recorder::write(path));
+
+    // threads keep recording while recording is stopped and events are written
+    std::atomic<bool> running(true);
+    std::vector<std::thread> threads;
+    for (uint16_t it = 0; it < 4; ++it) {
+        threads.push_back(std::thread([&running]() {
+            while (running) {
+                trace_span s("span", "test");
+            }
+        }));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    trace_recorder::stop();
+    uint64_t n = trace_recorder::count();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    REQUIRE(trace_recorder::count() == n);  // no events are recorded after stop() returned
+    REQUIRE_NOTHROW(trace_recorder::write(path));
+    running = false;
+    for (uint16_t it = 0; it < threads.size(); ++it) {
+        threads[it].join();
+    }
+    filesystem::remove(path);
+}
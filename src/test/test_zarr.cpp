@@ -0,0 +1,109 @@
+/*
+    MIT License
+
+    Copyright (c) 2026 Marius Appel <marius.appel@uni-muenster.de>
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "../external/catch.hpp"
+#include "../gdalcubes.h"
+
+using namespace gdalcubes;
+
+// dummy cube whose second chunk cannot be computed
+class failing_dummy_cube : public dummy_cube {
+   public:
+    failing_dummy_cube(cube_view v, uint16_t nbands) : dummy_cube(v, nbands) {}
+    std::shared_ptr<chunk_data> read_chunk(chunkid_t id) override {
+        if (id == 1) throw std::string("ERROR in failing_dummy_cube::read_chunk(): chunk 1 cannot be computed");
+        return dummy_cube::read_chunk(id);
+    }
+};
+
+static json11::Json read_json(std::string path) {
+    std::ifstream is(path);
+    std::stringstream ss;
+    ss << is.rdbuf();
+    std::string err;
+    return json11::Json::parse(ss.str(), err);
+}
+
+TEST_CASE("zarr_roundtrip", "[zarr]") {
+    cube_view r;
+    r.srs("EPSG:3857");
+    r.set_x_axis(-6180000.0, -6080000.0, 1000.0);
+    r.set_y_axis(-550000.0, -450000.0, 1000.0);
+    r.set_t_axis(datetime::from_string("2014-01-01"), datetime::from_string("2014-01-10"), duration::from_string("P1D"));
+
+    auto c = dummy_cube::create(r, 2, 2.0);
+    c->set_chunk_size(4, 32, 32);
+    std::string dir = filesystem::join(filesystem::get_tempdir(), "test_zarr.zarr");
+    std::string chunk0 = filesystem::join(filesystem::join(dir, "band2"), "0.0.0");
+    std::string chunk_last = filesystem::join(filesystem::join(dir, "band2"), "2.3.3");
+
+    c->write_zarr(dir);
+
+    json11::Json zarray = read_json(filesystem::join(filesystem::join(dir, "band2"), ".zarray"));
+    REQUIRE(zarray["shape"][0].int_value() == 10);
+    REQUIRE(zarray["shape"][1].int_value() == 100);
+    REQUIRE(zarray["shape"][2].int_value() == 100);
+    REQUIRE(zarray["chunks"][0].int_value() == 4);
+    REQUIRE(zarray["chunks"][2].int_value() == 32);
+
+    // boundary chunks are padded to the full chunk size
+    REQUIRE(filesystem::file_size(chunk_last) == 4 * 32 * 32 * sizeof(double));
+    std::vector<double> values(4 * 32 * 32);
+    std::ifstream is(chunk_last, std::ios::in | std::ios::binary);
+    is.read((char *)values.data(), values.size() * sizeof(double));
+    is.close();
+    REQUIRE(values[0] == 2.0);
+    REQUIRE(std::isnan(values[values.size() - 1]));
+
+    // overwriting the store with empty chunks must remove chunk files of the previous export
+    auto e = empty_cube::create(r, 2);
+    e->set_chunk_size(4, 32, 32);
+    e->write_zarr(dir);
+    REQUIRE(filesystem::exists(filesystem::join(filesystem::join(dir, "band2"), ".zarray")));
+    REQUIRE(!filesystem::exists(chunk0));
+    REQUIRE(!filesystem::exists(chunk_last));
+}
+
+TEST_CASE("zarr_failed_chunk", "[zarr]") {
+    cube_view r;
+    r.srs("EPSG:3857");
+    r.set_x_axis(-6180000.0, -6080000.0, 1000.0);
+    r.set_y_axis(-550000.0, -450000.0, 1000.0);
+    r.set_t_axis(datetime::from_string("2014-01-01"), datetime::from_string("2014-01-10"), duration::from_string("P1D"));
+
+    auto c = std::make_shared<failing_dummy_cube>(r, 2);
+    c->set_chunk_size(4, 32, 32);
+    std::string dir = filesystem::join(filesystem::get_tempdir(), "test_zarr_failed.zarr");
+
+    // the multithreaded chunk processor skips chunks that fail, the export must not look complete
+    REQUIRE_THROWS(c->write_zarr(dir, 0, packed_export::make_none(), std::make_shared<chunk_processor_multithread>(2)));
+    REQUIRE(!filesystem::exists(filesystem::join(dir, ".zgroup")));
+    REQUIRE(!filesystem::exists(filesystem::join(filesystem::join(dir, "band1"), "0.0.1")));
+    REQUIRE(filesystem::exists(filesystem::join(filesystem::join(dir, "band1"), "0.0.0")));
+}
@@ -0,0 +1,181 @@
+/*
+    MIT License
+
+    Copyright (c) 2026 Marius Appel <marius.appel@uni-muenster.de>
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+#include "trace_recorder.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <thread>
+
+namespace gdalcubes {
+
+std::atomic<bool> trace_recorder::_enabled(false);
+std::mutex trace_recorder::_mutex;
+std::mutex trace_recorder::_mutex_control;
+std::vector<std::shared_ptr<trace_recorder::thread_buffer>> trace_recorder::_buffers;
+uint32_t trace_recorder::_capacity = 1 << 16;
+std::chrono::steady_clock::time_point trace_recorder::_t0 = std::chrono::steady_clock::now();
+std::atomic<uint32_t> trace_recorder::_generation(0);
+std::atomic<uint32_t> trace_recorder::_recording(0);
+
+// buffer of the current thread, additionally owned by _buffers such that events survive their threads
+static thread_local std::shared_ptr<void> trace_thread_buffer;
+
+void trace_recorder::quiesce() {
+    // threads increment _recording before checking _enabled again (both sequentially consistent), i.e. threads that are
+    // not counted here will see that recording is disabled
+    _enabled.store(false);
+    while (_recording.load() > 0) {
+        std::this_thread::yield();
+    }
+}
+
+void trace_recorder::start(uint32_t capacity) {
+    std::lock_guard<std::mutex> lock_control(_mutex_control);
+    quiesce();
+    std::lock_guard<std::mutex> lock(_mutex);
+    _capacity = capacity < 1 ? 1 : capacity;
+    _buffers.clear();
+    ++_generation;  // threads register new buffers on their next event
+    _t0 = std::chrono::steady_clock::now();
+    _enabled.store(true);
+}
+
+void trace_recorder::stop() {
+    std::lock_guard<std::mutex> lock(_mutex_control);
+    quiesce();
+}
+
+trace_recorder::thread_buffer *trace_recorder::buffer() {
+    thread_buffer *b = static_cast<thread_buffer *>(trace_thread_buffer.get());
+    uint32_t gen = _generation.load(std::memory_order_relaxed);
+    if (b && b->generation == gen) {
+        return b;
+    }
+    std::shared_ptr<thread_buffer> nb = std::make_shared<thread_buffer>();
+    std::lock_guard<std::mutex> lock(_mutex);
+    nb->generation = gen;
+    nb->tid = _buffers.size() + 1;
+    nb->name = b ? b->name : nullptr;
+    nb->capacity = _capacity;
+    _buffers.push_back(nb);
+    trace_thread_buffer = nb;
+    return nb.get();
+}
+
+void trace_recorder::push(const event &e) {
+    thread_buffer *b = buffer();
+    if (b->events.size() < b->capacity) {
+        b->events.push_back(e);
+    } else {
+        b->events[b->n % b->capacity] = e;
+    }
+    ++b->n;
+}
+
+void trace_recorder::complete(const char *name, const char *cat, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end, int64_t chunk) {
+    if (!enabled()) return;
+    ++_recording;
+    if (_enabled.load()) {  // _t0 and buffers are not modified until _recording is zero
+        event e;
+        e.name = name;
+        e.cat = cat;
+        e.ts = std::chrono::duration_cast<std::chrono::nanoseconds>(start - _t0).count();
+        e.dur = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+        e.chunk = chunk;
+        push(e);
+    }
+    --_recording;
+}
+
+void trace_recorder::instant(const char *name, const char *cat, int64_t chunk) {
+    if (!enabled()) return;
+    ++_recording;
+    if (_enabled.load()) {
+        event e;
+        e.name = name;
+        e.cat = cat;
+        e.ts = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - _t0).count();
+        e.dur = -1;
+        e.chunk = chunk;
+        push(e);
+    }
+    --_recording;
+}
+
+void trace_recorder::thread_name(const char *name) {
+    if (!enabled()) return;
+    ++_recording;
+    if (_enabled.load()) {
+        buffer()->name = name;
+    }
+    --_recording;
+}
+
+uint64_t trace_recorder::count() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    uint64_t n = 0;
+    for (uint32_t i = 0; i < _buffers.size(); ++i) {
+        n += std::min(_buffers[i]->n, (uint64_t)_buffers[i]->capacity);
+    }
+    return n;
+}
+
+void trace_recorder::write(std::string path) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (enabled()) {
+        // buffers may be modified concurrently
+        throw std::string("ERROR in trace_recorder::write(): recording must be stopped before writing events");
+    }
+    std::FILE *f = std::fopen(path.c_str(), "w");
+    if (!f) {
+        throw std::string("ERROR in trace_recorder::write(): cannot open file '" + path + "'");
+    }
+    std::fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", f);
+    std::fputs("{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"gdalcubes\"}}", f);
+    for (uint32_t i = 0; i < _buffers.size(); ++i) {
+        thread_buffer *b = _buffers[i].get();
+        if (b->name) {
+            std::fprintf(f, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}", b->tid, b->name);
+        }
+        uint64_t cap = b->capacity;
+        uint64_t first = b->n > cap ? b->n - cap : 0;  // oldest event still in the ring buffer
+        for (uint64_t k = first; k < b->n; ++k) {
+            const event &e = b->events[k % cap];
+            if (e.dur >= 0) {
+                std::fprintf(f, ",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f", e.name, e.cat, b->tid, double(e.ts) / 1000.0, double(e.dur) / 1000.0);
+            } else {
+                std::fprintf(f, ",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":%u,\"ts\":%.3f", e.name, e.cat, b->tid, double(e.ts) / 1000.0);
+            }
+            if (e.chunk >= 0) {
+                std::fprintf(f, ",\"args\":{\"chunk\":%lld}}", (long long)e.chunk);
+            } else {
+                std::fputs("}", f);
+            }
+        }
+    }
+    std::fputs("\n]}\n", f);
+    std::fclose(f);
+}
+
+}  // namespace gdalcubes
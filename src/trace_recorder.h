@@ -0,0 +1,169 @@
+/*
+    MIT License
+
+    Copyright (c) 2026 Marius Appel <marius.appel@uni-muenster.de>
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+#ifndef TRACE_RECORDER_H
+#define TRACE_RECORDER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace gdalcubes {
+
+/**
+ * @brief Low-overhead recorder of timeline events that can be exported in the Chrome trace event format
+ *
+ * Events are recorded in per-thread ring buffers, i.e. recording an event never locks and only the most recent events
+ * of each thread are kept if a buffer is full. Buffers grow with the number of recorded events up to their capacity, such
+ * that short-lived threads with few events do not allocate the full capacity. The recorded timeline can be written as Chrome trace event JSON and be
+ * loaded in chrome://tracing or https://ui.perfetto.dev.
+ *
+ * Recording is disabled by default and is enabled by config::set_trace_file() or by setting the environment variable
+ * GDALCUBES_TRACE to an output file before calling config::gdalcubes_init(). If disabled, recording an event costs a
+ * single atomic load. Threads that are recording an event are counted, such that start() and stop() can wait until
+ * no buffer is modified anymore.
+ *
+ * Event names and categories must be string literals (or otherwise outlive the recorder), since only pointers are
+ * stored.
+ */
+class trace_recorder {
+   public:
+    /**
+     * @brief Start recording, previously recorded events are discarded
+     * @param capacity maximum number of events per thread
+     */
+    static void start(uint32_t capacity = 1 << 16);
+
+    /**
+     * @brief Stop recording, recorded events are kept until the next call of start()
+     *
+     * Returns after all events that are being recorded concurrently have been stored.
+     */
+    static void stop();
+
+    static inline bool enabled() { return _enabled.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Write recorded events as Chrome trace event JSON
+     *
+     * Throws if recording has not been stopped before.
+     * @param path output file
+     */
+    static void write(std::string path);
+
+    /**
+     * @brief Record a complete event with given start and end time
+     * @param name event name
+     * @param cat comma-separated event categories
+     * @param start start time
+     * @param end end time
+     * @param chunk chunk id added as argument, or negative if not related to a specific chunk
+     */
+    static void complete(const char *name, const char *cat, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end, int64_t chunk = -1);
+
+    /**
+     * @brief Record an instant event
+     */
+    static void instant(const char *name, const char *cat, int64_t chunk = -1);
+
+    /**
+     * @brief Set the name of the calling thread as shown in trace viewers
+     */
+    static void thread_name(const char *name);
+
+    /**
+     * @brief Get the number of events currently stored in all buffers
+     */
+    static uint64_t count();
+
+   private:
+    struct event {
+        const char *name;
+        const char *cat;
+        int64_t ts;   // nanoseconds since start()
+        int64_t dur;  // nanoseconds, negative for instant events
+        int64_t chunk;
+    };
+
+    struct thread_buffer {
+        thread_buffer() : generation(0), tid(0), name(nullptr), capacity(0), events(), n(0) {}
+        uint32_t generation;
+        uint32_t tid;
+        const char *name;
+        uint32_t capacity;
+        std::vector<event> events;  // grows until capacity is reached, then used as ring buffer
+        uint64_t n;  // number of events recorded since start(), only modified by the owning thread
+    };
+
+    static thread_buffer *buffer();
+    static void push(const event &e);
+
+    /**
+     * @brief Disable recording and wait until no thread is recording an event
+     * @note must be called with _mutex_control but without _mutex locked, since recording threads may need _mutex to
+     * register their buffer
+     */
+    static void quiesce();
+
+    static std::atomic<bool> _enabled;
+    static std::mutex _mutex;          // protects _buffers
+    static std::mutex _mutex_control;  // serializes start() and stop()
+    static std::vector<std::shared_ptr<thread_buffer>> _buffers;
+    static uint32_t _capacity;
+    static std::chrono::steady_clock::time_point _t0;
+    static std::atomic<uint32_t> _generation;
+    static std::atomic<uint32_t> _recording;  // number of threads currently recording an event
+};
+
+/**
+ * @brief Records a complete trace event for the lifetime of the object, or until end() is called
+ */
+class trace_span {
+   public:
+    trace_span(const char *name, const char *cat, int64_t chunk = -1) : _active(trace_recorder::enabled()), _name(name), _cat(cat), _chunk(chunk), _start() {
+        if (_active) _start = std::chrono::steady_clock::now();
+    }
+    ~trace_span() { end(); }
+
+    inline void end() {
+        if (_active) {
+            trace_recorder::complete(_name, _cat, _start, std::chrono::steady_clock::now(), _chunk);
+            _active = false;
+        }
+    }
+
+   private:
+    bool _active;
+    const char *_name;
+    const char *_cat;
+    int64_t _chunk;
+    std::chrono::steady_clock::time_point _start;
+};
+
+}  // namespace gdalcubes
+
+#endif  //TRACE_RECORDER_H
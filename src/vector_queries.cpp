@@ -24,6 +24,8 @@
 
 #include "vector_queries.h"
 
+#include "tdigest.h"
+
 #include <gdal_utils.h>
 #include <ogrsf_frmts.h>
 
@@ -380,6 +382,14 @@ struct zonal_statistics_func {
     virtual void update(double x, uint32_t ifeature, uint32_t it) = 0;
     virtual std::shared_ptr<std::vector<double>> finalize() = 0;
 
+    /**
+     * @brief Finalizes the aggregation and returns one result vector per output field
+     * @details Aggregators computing a single statistic return exactly one vector, fused aggregators return one vector for each of their statistics
+     */
+    virtual std::vector<std::shared_ptr<std::vector<double>>> finalize_fields() {
+        return {finalize()};
+    }
+
    protected:
     uint32_t _nfeatures;
     uint32_t _nt;
@@ -552,6 +562,33 @@ struct zonal_statistics_median : public zonal_statistics_func {
     std::vector<std::vector<double>> _values;
 };
 
+struct zonal_statistics_quantile_approx : public zonal_statistics_func {
+    zonal_statistics_quantile_approx(double p) : _p(p) {}
+
+    void init(uint32_t nfeatures, uint32_t nt) override {
+        zonal_statistics_func::init(nfeatures, nt);
+        _sketches.resize(_nt * _nfeatures, tdigest(config::instance()->get_approx_quantile_compression()));
+    }
+
+    void update(double x, uint32_t ifeature, uint32_t it) override {
+        if (std::isfinite(x)) {
+            _sketches[ifeature * _nt + it].add(x);
+        }
+    }
+
+    std::shared_ptr<std::vector<double>> finalize() override {
+        std::shared_ptr<std::vector<double>> out = std::make_shared<std::vector<double>>();
+        out->resize(_nt * _nfeatures);
+        for (uint32_t i = 0; i < _nfeatures * _nt; ++i) {
+            (*out)[i] = _sketches[i].quantile(_p);
+        }
+        return out;
+    }
+
+    double _p;
+    std::vector<tdigest> _sketches;
+};
+
 struct zonal_statistics_var : public zonal_statistics_func {
     void init(uint32_t nfeatures, uint32_t nt) override {
         zonal_statistics_func::init(nfeatures, nt);
@@ -600,6 +637,94 @@ struct zonal_statistics_sd : public zonal_statistics_var {
     }
 };
 
+/**
+ * @brief Fused aggregator computing several moment-based statistics ("count", "sum", "mean", "var", "sd", "min", "max")
+ * of the same band from a shared state in a single pass
+ */
+struct zonal_statistics_fused : public zonal_statistics_func {
+    static bool is_fusable(std::string func) {
+        return func == "count" || func == "sum" || func == "mean" ||
+               func == "var" || func == "sd" || func == "min" || func == "max";
+    }
+
+    zonal_statistics_fused(std::vector<std::string> stats) : _stats(stats), _need_m2(false), _need_min(false), _need_max(false) {
+        for (uint16_t i = 0; i < _stats.size(); ++i) {
+            if (_stats[i] == "var" || _stats[i] == "sd") _need_m2 = true;
+            if (_stats[i] == "min") _need_min = true;
+            if (_stats[i] == "max") _need_max = true;
+        }
+    }
+
+    void init(uint32_t nfeatures, uint32_t nt) override {
+        zonal_statistics_func::init(nfeatures, nt);
+        _n.resize(_nt * _nfeatures, 0);
+        _sum.resize(_nt * _nfeatures, 0);
+        if (_need_m2) {
+            _cur_mean.resize(_nt * _nfeatures, 0);
+            _cur_M2.resize(_nt * _nfeatures, 0);
+        }
+        if (_need_min) _min.resize(_nt * _nfeatures, std::numeric_limits<double>::max());
+        if (_need_max) _max.resize(_nt * _nfeatures, std::numeric_limits<double>::lowest());
+    }
+
+    void update(double x, uint32_t ifeature, uint32_t it) override {
+        if (std::isfinite(x)) {
+            uint32_t i = ifeature * _nt + it;
+            _n[i]++;
+            _sum[i] += x;
+            if (_need_m2) {
+                double delta = x - _cur_mean[i];
+                _cur_mean[i] += delta / _n[i];
+                _cur_M2[i] += delta * (x - _cur_mean[i]);
+            }
+            if (_need_min) _min[i] = std::min(x, _min[i]);
+            if (_need_max) _max[i] = std::max(x, _max[i]);
+        }
+    }
+
+    std::shared_ptr<std::vector<double>> finalize() override {
+        return finalize_fields()[0];
+    }
+
+    std::vector<std::shared_ptr<std::vector<double>>> finalize_fields() override {
+        std::vector<std::shared_ptr<std::vector<double>>> out;
+        for (uint16_t is = 0; is < _stats.size(); ++is) {
+            std::shared_ptr<std::vector<double>> x = std::make_shared<std::vector<double>>();
+            x->resize(_nt * _nfeatures);
+            for (uint32_t i = 0; i < _nfeatures * _nt; ++i) {
+                if (_stats[is] == "count") {
+                    (*x)[i] = _n[i];
+                } else if (_stats[is] == "sum") {
+                    (*x)[i] = _n[i] > 0 ? _sum[i] : NAN;
+                } else if (_stats[is] == "mean") {
+                    (*x)[i] = _sum[i] / double(_n[i]);
+                } else if (_stats[is] == "var") {
+                    (*x)[i] = _n[i] < 2 ? NAN : _cur_M2[i] / double(_n[i]);
+                } else if (_stats[is] == "sd") {
+                    (*x)[i] = _n[i] < 2 ? NAN : std::sqrt(_cur_M2[i] / double(_n[i]));
+                } else if (_stats[is] == "min") {
+                    (*x)[i] = _n[i] > 0 ? _min[i] : NAN;
+                } else if (_stats[is] == "max") {
+                    (*x)[i] = _n[i] > 0 ? _max[i] : NAN;
+                }
+            }
+            out.push_back(x);
+        }
+        return out;
+    }
+
+    std::vector<std::string> _stats;
+    bool _need_m2;
+    bool _need_min;
+    bool _need_max;
+    std::vector<uint32_t> _n;
+    std::vector<double> _sum;
+    std::vector<double> _cur_mean;
+    std::vector<double> _cur_M2;
+    std::vector<double> _min;
+    std::vector<double> _max;
+};
+
 void vector_queries::zonal_statistics(std::shared_ptr<cube> cube, std::string ogr_dataset,
                                       std::vector<std::pair<std::string, std::string>> agg_band_functions,
                                       std::string out_path, bool overwrite_if_exists, std::string ogr_layer) {
@@ -640,6 +765,12 @@ void vector_queries::zonal_statistics(std::shared_ptr<cube> cube, std::string og
                 agg_func_creators.push_back([]() { return std::unique_ptr<zonal_statistics_func>(new zonal_statistics_mean()); });
             } else if (agg_band_functions[i].first == "median") {
                 agg_func_creators.push_back([]() { return std::unique_ptr<zonal_statistics_func>(new zonal_statistics_median()); });
+            } else if (agg_band_functions[i].first == "median_approx") {
+                agg_func_creators.push_back([]() { return std::unique_ptr<zonal_statistics_func>(new zonal_statistics_quantile_approx(0.5)); });
+            } else if (agg_band_functions[i].first == "Q1_approx") {
+                agg_func_creators.push_back([]() { return std::unique_ptr<zonal_statistics_func>(new zonal_statistics_quantile_approx(0.25)); });
+            } else if (agg_band_functions[i].first == "Q3_approx") {
+                agg_func_creators.push_back([]() { return std::unique_ptr<zonal_statistics_func>(new zonal_statistics_quantile_approx(0.75)); });
             } else if (agg_band_functions[i].first == "sd") {
                 agg_func_creators.push_back([]() { return std::unique_ptr<zonal_statistics_func>(new zonal_statistics_sd()); });
             } else if (agg_band_functions[i].first == "var") {
@@ -658,6 +789,37 @@ void vector_queries::zonal_statistics(std::shared_ptr<cube> cube, std::string og
         return;
     }
 
+    // Group output fields into aggregators: fusable statistics of the same band share one
+    // fused aggregator that is updated once per pixel, all other fields get their own aggregator
+    std::map<uint16_t, std::vector<uint16_t>> fusable_fields_of_band;
+    for (uint16_t ifield = 0; ifield < agg_func_names.size(); ++ifield) {
+        if (zonal_statistics_fused::is_fusable(agg_func_names[ifield])) {
+            fusable_fields_of_band[band_index[ifield]].push_back(ifield);
+        }
+    }
+    std::vector<std::function<std::unique_ptr<zonal_statistics_func>()>> aggregator_creators;
+    std::vector<uint16_t> aggregator_band_index;
+    std::vector<std::vector<uint16_t>> aggregator_fields;
+    for (auto it = fusable_fields_of_band.begin(); it != fusable_fields_of_band.end(); ++it) {
+        if (it->second.size() > 1) {
+            std::vector<std::string> stats;
+            for (uint16_t i = 0; i < it->second.size(); ++i) {
+                stats.push_back(agg_func_names[it->second[i]]);
+            }
+            aggregator_creators.push_back([stats]() { return std::unique_ptr<zonal_statistics_func>(new zonal_statistics_fused(stats)); });
+            aggregator_band_index.push_back(it->first);
+            aggregator_fields.push_back(it->second);
+        }
+    }
+    for (uint16_t ifield = 0; ifield < agg_func_names.size(); ++ifield) {
+        if (zonal_statistics_fused::is_fusable(agg_func_names[ifield]) && fusable_fields_of_band[band_index[ifield]].size() > 1) {
+            continue;  // already part of a fused aggregator
+        }
+        aggregator_creators.push_back(agg_func_creators[ifield]);
+        aggregator_band_index.push_back(band_index[ifield]);
+        aggregator_fields.push_back({ifield});
+    }
+
     // open input OGR dataset
     GDALDataset *in_ogr_dataset;
     in_ogr_dataset = (GDALDataset *)GDALOpenEx(ogr_dataset.c_str(), GDAL_OF_VECTOR | GDAL_OF_READONLY, NULL, NULL,
@@ -848,7 +1010,7 @@ void vector_queries::zonal_statistics(std::shared_ptr<cube> cube, std::string og
     std::vector<std::thread> workers;
     std::vector<std::string> out_temp_files;
     for (uint16_t ithread = 0; ithread < nthreads; ++ithread) {
-        workers.push_back(std::thread([ithread, nthreads, &cube, &agg_func_names, &agg_func_creators, nfeatures, &features_in_chunk, &fid_column, &band_index, &output_file, &index_of_FID, FID_of_index, &mutex, &prg, &out_temp_files, &ogr_dataset, &ogr_layer](void) {
+        workers.push_back(std::thread([ithread, nthreads, &cube, &agg_func_names, &aggregator_creators, &aggregator_band_index, &aggregator_fields, nfeatures, &features_in_chunk, &fid_column, &band_index, &output_file, &index_of_FID, FID_of_index, &mutex, &prg, &out_temp_files, &ogr_dataset, &ogr_layer](void) {
             GDALDriver *gpkg_driver = GetGDALDriverManager()->GetDriverByName("GPKG");
             //            if (gpkg_driver == NULL) {
             //                GCBS_ERROR("OGR GeoPackage driver not found");
@@ -879,8 +1041,8 @@ void vector_queries::zonal_statistics(std::shared_ptr<cube> cube, std::string og
                 // initialize per geometry + time aggregators
                 uint32_t nt = cube->chunk_size(cube->chunk_id_from_coords({ct, 0, 0}))[0];
                 std::vector<std::unique_ptr<zonal_statistics_func>> pixel_aggregators;
-                for (uint16_t i = 0; i < agg_func_names.size(); ++i) {
-                    pixel_aggregators.push_back(agg_func_creators[i]());
+                for (uint16_t i = 0; i < aggregator_creators.size(); ++i) {
+                    pixel_aggregators.push_back(aggregator_creators[i]());
                     pixel_aggregators[i]->init(nfeatures, nt);
                 }
 
@@ -998,13 +1160,13 @@ void vector_queries::zonal_statistics(std::shared_ptr<cube> cube, std::string og
                                             // if mask is 1
                                             if (geom_mask[(iy - y_start) * (x_end - x_start + 1) + ix - x_start] == 1) {
                                                 for (uint32_t it = 0; it < chunk->size()[1]; ++it) {
-                                                    for (uint16_t ifield = 0; ifield < agg_func_names.size(); ++ifield) {
-                                                        uint16_t b_index = band_index[ifield];
+                                                    for (uint16_t iagg = 0; iagg < pixel_aggregators.size(); ++iagg) {
+                                                        uint16_t b_index = aggregator_band_index[iagg];
                                                         double v = ((double *)chunk->buf())[b_index * chunk->size()[1] * chunk->size()[2] * chunk->size()[3] +
                                                                                             it * chunk->size()[2] * chunk->size()[3] +
                                                                                             iy * chunk->size()[3] +
                                                                                             ix];
-                                                        pixel_aggregators[ifield]->update(v, index_of_FID[fid], it);
+                                                        pixel_aggregators[iagg]->update(v, index_of_FID[fid], it);
                                                     }
                                                 }
                                             }
@@ -1019,9 +1181,12 @@ void vector_queries::zonal_statistics(std::shared_ptr<cube> cube, std::string og
                     }
                 }
 
-                std::vector<std::shared_ptr<std::vector<double>>> res;
-                for (uint16_t iband = 0; iband < agg_func_names.size(); ++iband) {
-                    res.push_back(pixel_aggregators[iband]->finalize());
+                std::vector<std::shared_ptr<std::vector<double>>> res(agg_func_names.size());
+                for (uint16_t iagg = 0; iagg < pixel_aggregators.size(); ++iagg) {
+                    std::vector<std::shared_ptr<std::vector<double>>> agg_res = pixel_aggregators[iagg]->finalize_fields();
+                    for (uint16_t i = 0; i < aggregator_fields[iagg].size(); ++i) {
+                        res[aggregator_fields[iagg][i]] = agg_res[i];
+                    }
                 }
 
                 // write output layers
@@ -69,6 +69,7 @@ class vector_queries {
      * are spatial views of these time slices by joining attribute layers with the geometry layer in a SQLite database view.
      *
      * Available aggregation functions currently include "min", "max", "mean", "median", "sum", "prod", "count", "var" and "sd".
+     * Approximate quantiles with bounded memory per feature and time slice can be computed with "median_approx", "Q1_approx", and "Q3_approx".
      *
      *
      * @param cube input data cube
@@ -56,7 +56,7 @@ gdalwarp_client::gdal_transformation_cache::~gdal_transformation_cache() {
 
 GDALDataset *gdalwarp_client::warp(GDALDataset *in, std::string s_srs, std::string t_srs, double te_left,
                                    double te_right, double te_top, double te_bottom, uint32_t ts_x, uint32_t ts_y,
-                                   std::string resampling, std::vector<double> srcnodata) {
+                                   std::string resampling, std::vector<double> srcnodata, GDALDataType dst_type, bool dst_alpha) {
     char *wkt_out = NULL;
 
     OGRSpatialReference srs_out;
@@ -77,7 +77,9 @@ GDALDataset *gdalwarp_client::warp(GDALDataset *in, std::string s_srs, std::stri
         throw std::string("Cannot find GDAL MEM driver");
     }
 
-    GDALDataset *out = mem_driver->Create("", ts_x, ts_y, in->GetRasterCount(), GDT_Float64, NULL);
+    GDALDataset *out = mem_driver->Create("", ts_x, ts_y, in->GetRasterCount() + (dst_alpha ? 1 : 0), dst_type, NULL);
+    // NAN cannot be represented by integer types
+    bool dst_float = dst_type == GDT_Float32 || dst_type == GDT_Float64;
 
     out->SetProjection(wkt_out);
     out->SetGeoTransform(dst_geotransform);
@@ -221,11 +223,20 @@ GDALDataset *gdalwarp_client::warp(GDALDataset *in, std::string s_srs, std::stri
             std::free(src_nodata_img);
         }
     }
-    psWarpOptions->padfDstNoDataReal = dst_nodata;
-    psWarpOptions->padfDstNoDataImag = dst_nodata_img;
+    if (dst_float) {
+        psWarpOptions->padfDstNoDataReal = dst_nodata;
+        psWarpOptions->padfDstNoDataImag = dst_nodata_img;
+    } else {
+        // a target no data value would make GDAL change valid pixels with the same value, use the alpha band instead
+        CPLFree(dst_nodata);
+        CPLFree(dst_nodata_img);
+    }
+    if (dst_alpha) {
+        psWarpOptions->nDstAlphaBand = out->GetRasterCount();
+    }
 
     char **wo = nullptr;
-    wo = CSLAddString(wo, "INIT_DEST=nan");
+    wo = CSLAddString(wo, dst_float ? "INIT_DEST=nan" : "INIT_DEST=0");
     wo = CSLAddString(wo, ("NUM_THREADS=" + std::to_string(config::instance()->get_gdal_num_threads())).c_str());
     psWarpOptions->papszWarpOptions = wo;
 
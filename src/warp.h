@@ -92,9 +92,12 @@ class gdalwarp_client {
      * @param ts_y number of pixels of the target grid in y direction
      * @param resampling  resampling method, given as a string (see https://gdal.org/programs/gdalwarp.html#cmdoption-gdalwarp-r for possible options)
      * @param srcnodata vector with no data values of the source dataset per band
+     * @param dst_type data type of the target dataset, for integer types, target pixels without data are initialized with 0
+     * @param dst_alpha if true, the target dataset gets an additional last alpha band, which is 0 for target pixels without data
      * @return A new in-memory GDALDataset object
      */
-    static GDALDataset *warp(GDALDataset *in, std::string s_srs, std::string t_srs, double te_left, double te_right, double te_top, double te_bottom, uint32_t ts_x, uint32_t ts_y, std::string resampling, std::vector<double> srcnodata);
+    static GDALDataset *warp(GDALDataset *in, std::string s_srs, std::string t_srs, double te_left, double te_right, double te_top, double te_bottom, uint32_t ts_x, uint32_t ts_y, std::string resampling, std::vector<double> srcnodata,
+                             GDALDataType dst_type = GDT_Float64, bool dst_alpha = false);
 
     static gdalcubes_transform_info *create_transform(GDALDataset *in, GDALDataset *out, std::string srs_in_str, std::string srs_out_str);
     static void destroy_transform(gdalcubes_transform_info *transform);
@@ -120,6 +120,7 @@ std::function<double(double* buf, uint16_t n)> window_time_cube::get_kernel_redu
 std::shared_ptr<chunk_data> window_time_cube::read_chunk(chunkid_t id) {
     GCBS_TRACE("window_time_cube::read_chunk(" + std::to_string(id) + ")");
     std::shared_ptr<chunk_data> out = std::make_shared<chunk_data>();
+    profile_scope profile(this, out);
     if (id >= count_chunks())
         return out;  // chunk is outside of the view, we don't need to read anything.
 